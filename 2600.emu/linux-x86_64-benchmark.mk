@@ -0,0 +1,7 @@
+include $(IMAGINE_PATH)/make/config.mk
+O_RELEASE := 1
+LTO_MODE ?= lto
+emuFramework_headlessBenchmark := 1
+-include $(projectPath)/config.mk
+include $(IMAGINE_PATH)/make/linux-x86_64-gcc.mk
+include $(projectPath)/build.mk
@@ -48,6 +48,9 @@ Controller::Type autoDetectedInput1{};
 const char *EmuSystem::creditsViewStr = CREDITS_INFO_STRING "(c) 2011-2021\nRobert Broglia\nwww.explusalpha.com\n\nPortions (c) the\nStella Team\nstella-emu.github.io";
 bool EmuSystem::hasPALVideoSystem = true;
 bool EmuSystem::hasResetModes = true;
+bool EmuSystem::hasRunAhead = true;
+bool EmuSystem::hasRewind = true;
+bool EmuSystem::hasMemoryStates = true;
 IG::Audio::SampleFormat EmuSystem::audioSampleFormat = IG::Audio::SampleFormats::f32;
 EmuSystem::NameFilterFunc EmuSystem::defaultFsFilter =
 	[](const char *name)
@@ -211,6 +214,33 @@ EmuSystem::Error EmuSystem::loadState(const char *path)
 	return {};
 }
 
+EmuSystem::Error EmuSystem::saveState(IG::ByteBuffer &buff)
+{
+	Serializer state;
+	if(!osystem->state().saveState(state))
+	{
+		return makeError("Error saving state");
+	}
+	auto size = state.size();
+	buff.resize(size);
+	state.rewind();
+	state.getByteArray(buff.data(), size);
+	return {};
+}
+
+EmuSystem::Error EmuSystem::loadState(IG::ConstBufferView buff)
+{
+	Serializer state;
+	state.putByteArray((const uInt8*)buff.data(), buff.size());
+	state.rewind();
+	if(!osystem->state().loadState(state))
+	{
+		return makeError("Error loading state");
+	}
+	updateSwitchValues();
+	return {};
+}
+
 void EmuApp::onCustomizeNavView(EmuApp::NavView &view)
 {
 	const Gfx::LGradientStopDesc navViewGrad[] =
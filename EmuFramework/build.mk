@@ -11,12 +11,16 @@ Cheats.cc \
 ConfigFile.cc \
 CreditsView.cc \
 EmuApp.cc \
+EmuArchiveCache.cc \
 EmuAudio.cc \
 EmuInput.cc \
+EmuInputMovie.cc \
 EmuInputView.cc \
 EmuLoadProgressView.cc \
 EmuMainMenuView.cc \
 EmuOptions.cc \
+EmuRewind.cc \
+EmuRunAhead.cc \
 EmuSystemActionsView.cc \
 EmuSystem.cc \
 EmuSystemTask.cc \
@@ -27,7 +31,9 @@ EmuView.cc \
 EmuViewController.cc \
 FilePicker.cc \
 FileUtils.cc \
+FramePacingTrace.cc \
 GUIOptionView.cc \
+HeadlessBenchmark.cc \
 InputManagerView.cc \
 Recent.cc \
 RecentGameView.cc \
@@ -98,6 +98,7 @@ public:
 	static FS::PathString assetPath();
 	static FS::PathString libPath();
 	static FS::PathString supportPath();
+	static FS::PathString cachePath();
 	static AssetIO openAppAssetIO(const char *name, IO::AccessHint access);
 	static void saveSessionOptions();
 	static void loadSessionOptions();
@@ -16,6 +16,7 @@
 	along with EmuFramework.  If not, see <http://www.gnu.org/licenses/> */
 
 #include <imagine/audio/OutputStream.hh>
+#include <imagine/audio/Resampler.hh>
 #include <imagine/time/Time.hh>
 #include <imagine/vmem/RingBuffer.hh>
 #include <memory>
@@ -24,6 +25,11 @@
 class EmuAudio
 {
 public:
+	// max fraction the output rate is stretched or squeezed by when
+	// steering the buffer towards its target fill level
+	static constexpr float MAX_RATE_DELTA = .005f;
+	static constexpr float FILL_SMOOTHING = .1f;
+
 	enum class AudioWriteState : uint8_t
 	{
 		BUFFER,
@@ -34,6 +40,7 @@ public:
 
 	constexpr EmuAudio() {}
 	void open(IG::Audio::Api api);
+	void openMemorySink();
 	void start(IG::Microseconds targetBufferFillUSecs, IG::Microseconds bufferIncrementUSecs);
 	void stop();
 	void close();
@@ -43,26 +50,42 @@ public:
 	void setStereo(bool on);
 	void setSpeedMultiplier(uint8_t speed);
 	void setAddSoundBuffersOnUnderrun(bool on);
+	void setDynamicRateControl(bool on);
+	void setResamplerQuality(IG::Audio::ResamplerQuality quality);
 	void setVolume(uint8_t vol);
 	IG::Audio::Format format() const;
+	uint32_t framesWritten() const;
 	explicit operator bool() const;
 
+	// memory sink only, passes the samples written since the last call to func and discards them
+	template<class Func>
+	void consumeMemorySink(Func &&func)
+	{
+		auto bytes = rBuff.size();
+		func(rBuff.readAddr(), bytes);
+		rBuff.commitRead(bytes);
+	}
+
 protected:
 	std::unique_ptr<IG::Audio::OutputStream> audioStream{};
 	IG::RingBuffer rBuff{};
+	IG::Audio::Resampler resampler{};
 	IG::Time lastUnderrunTime{};
 	uint32_t targetBufferFillBytes = 0;
 	uint32_t bufferIncrementBytes = 0;
 	uint32_t rate{44100};
 	float volume = 1.0;
+	float avgFillFrames = 0;
+	float rateFrameRemainder = 0;
 	std::atomic<AudioWriteState> audioWriteState = AudioWriteState::BUFFER;
 	bool addSoundBuffersOnUnderrun = false;
+	bool dynamicRateControl = false;
 	uint8_t speedMultiplier = 1;
 	uint8_t channels = 2;
 
 	uint32_t framesFree() const;
-	uint32_t framesWritten() const;
 	uint32_t framesCapacity() const;
 	bool shouldStartAudioWrites(uint32_t bytesToWrite = 0) const;
+	uint32_t rateControlledFrames(uint32_t frames);
 	void resizeAudioBuffer(uint32_t targetBufferFillBytes);
 };
@@ -23,6 +23,7 @@
 #include <imagine/input/Input.hh>
 #include <imagine/audio/SampleFormat.hh>
 #include <imagine/util/string.h>
+#include <imagine/util/ByteBuffer.hh>
 #include <emuframework/config.hh>
 #include <optional>
 #include <stdexcept>
@@ -129,6 +130,9 @@ public:
 	static bool handlesArchiveFiles;
 	static bool handlesGenericIO;
 	static bool hasCheats;
+	static bool hasRunAhead;
+	static bool hasRewind;
+	static bool hasMemoryStates;
 	static bool hasSound;
 	static int forcedSoundRate;
 	static IG::Audio::SampleFormat audioSampleFormat;
@@ -146,6 +150,8 @@ public:
 	static void startAutoSaveStateTimer();
 	static Error loadState(const char *path);
 	static Error saveState(const char *path);
+	static Error loadState(IG::ConstBufferView buff);
+	static Error saveState(IG::ByteBuffer &buff);
 	static bool stateExists(int slot);
 	static bool shouldOverwriteExistingState();
 	static const char *systemName();
@@ -184,12 +190,23 @@ public:
 	static void createWithMedia(GenericIO io, const char *path, const char *name,
 		Error &err, EmuSystemCreateParams, OnLoadProgressDelegate onLoadProgress);
 	static Error loadGame(IO &io, EmuSystemCreateParams, OnLoadProgressDelegate onLoadProgress);
+	// for loadGame(), maps an uncompressed game file to the page aligned addr in place of
+	// reading it, copy-on-write so any patched pages become private, until the game closes.
+	// Returns the bytes mapped, a multiple of the page size with io positioned after them.
+	static size_t mapGameFile(IO &io, void *addr, size_t maxSize);
 	static FS::PathString willLoadGameFromPath(FS::PathString path);
 	static Error loadGameFromPath(const char *path, EmuSystemCreateParams params, OnLoadProgressDelegate onLoadProgress);
 	static Error loadGameFromFile(GenericIO io, const char *name, EmuSystemCreateParams params, OnLoadProgressDelegate onLoadProgress);
 	[[gnu::hot]] static void runFrame(EmuSystemTask *task, EmuVideo *video, EmuAudio *audio);
+	// headless benchmark --trace, records per-frame state for offline benchmarks
+	static void writeFrameTrace(IO &io);
+	// headless benchmark, prints any system specific ,"name":value fields to stdout
+	static void printBenchmarkStats();
 	static void skipFrames(EmuSystemTask *task, uint32_t frames, EmuAudio *audio);
 	static bool skipForwardFrames(EmuSystemTask *task, uint32_t frames);
+	static bool rewindFrame(EmuSystemTask *task, EmuVideo *video);
+	static void recordRewindFrames(uint32_t frames);
+	static bool runAheadFrame(EmuSystemTask *task, EmuVideo *video, EmuAudio *audio);
 	static bool shouldFastForward();
 	static void onPrepareAudio(EmuAudio &audio);
 	static void onPrepareVideo(EmuVideo &video);
@@ -216,6 +233,8 @@ public:
 		bool turbo;
 		return translateInputAction(input, turbo);
 	}
+	static void dispatchInputAction(uint state, uint emuKey);
+	static void updateFrameInput();
 	static bool touchControlsApplicable();
 	static bool handlePointerInputEvent(Input::Event e, IG::WindowRect gameRect);
 	static EmuFrameTimeInfo advanceFramesWithTime(IG::FrameTime time);
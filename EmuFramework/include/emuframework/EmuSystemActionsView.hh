@@ -30,7 +30,7 @@ public:
 	void onShow() override;
 	void loadStandardItems();
 
-	static const uint STANDARD_ITEMS = 9;
+	static const uint STANDARD_ITEMS = 11;
 	static const uint MAX_SYSTEM_ITEMS = 6;
 
 protected:
@@ -43,6 +43,8 @@ protected:
 	TextMenuItem addLauncherIcon;
 	#endif
 	TextMenuItem screenshot;
+	TextMenuItem framePacingTrace;
+	TextMenuItem inputMovie;
 	TextMenuItem resetSessionOptions;
 	TextMenuItem close;
 	StaticArrayList<MenuItem*, STANDARD_ITEMS + MAX_SYSTEM_ITEMS> item{};
@@ -17,6 +17,7 @@
 
 #include <imagine/gfx/PixmapBufferTexture.hh>
 #include <imagine/gfx/SyncFence.hh>
+#include <imagine/util/ByteBuffer.hh>
 
 class EmuVideo;
 class EmuSystemTask;
@@ -70,12 +71,17 @@ public:
 	bool setImageBuffers(unsigned num);
 	unsigned imageBuffers() const;
 	void setCompatTextureSampler(const Gfx::TextureSampler &);
+	// frame contents when no renderer is set
+	IG::ConstBufferView memoryImage() const { return memImg.view(); }
 
 protected:
 	Gfx::RendererTask *rTask{};
 	const Gfx::TextureSampler *texSampler{};
 	Gfx::SyncFence fence{};
 	Gfx::PixmapBufferTexture vidImg{};
+	// used in place of vidImg when no renderer is set, such as in headless runs
+	IG::ByteBuffer memImg{};
+	IG::PixmapDesc memImgDesc{};
 	FrameFinishedDelegate onFrameFinished{};
 	FormatChangedDelegate onFormatChanged{};
 	Gfx::TextureBufferMode bufferMode{};
@@ -87,4 +93,5 @@ protected:
 	void postFrameFinished(EmuSystemTask *task);
 	void syncImageAccess();
 	void updateNeedsFence();
+	IG::Pixmap memPixmap();
 };
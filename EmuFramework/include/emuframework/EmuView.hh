@@ -16,9 +16,7 @@
 	along with EmuFramework.  If not, see <http://www.gnu.org/licenses/> */
 
 #include <imagine/gui/View.hh>
-#ifdef CONFIG_EMUFRAMEWORK_AUDIO_STATS
 #include <imagine/gfx/GfxText.hh>
-#endif
 
 class EmuInputView;
 class EmuVideoLayer;
@@ -34,8 +32,10 @@ public:
 	bool inputEvent(Input::Event e) final;
 	bool hasLayer() const { return layer; }
 	void setLayoutInputView(EmuInputView *view);
-	void updateAudioStats(uint underruns, uint overruns, uint callbacks, double avgCallbackFrames, uint frames);
+	void updateAudioStats(uint underruns, uint overruns, uint callbacks, double avgCallbackFrames, uint frames, double avgFillSecs, double avgRateRatio);
 	void clearAudioStats();
+	void updateFramePacingStats(const char *str);
+	void clearFramePacingStats();
 	EmuVideoLayer *videoLayer() const { return layer; }
 
 private:
@@ -45,4 +45,6 @@ private:
 	Gfx::Text audioStatsText{};
 	Gfx::GCRect audioStatsRect{};
 	#endif
+	Gfx::Text framePacingStatsText{};
+	Gfx::GCRect framePacingStatsRect{};
 };
@@ -54,6 +54,7 @@ protected:
 	MultiChoiceMenuItem frameInterval;
 	#endif
 	BoolMenuItem dropLateFrames;
+	BoolMenuItem showFramePacingStats;
 	TextMenuItem frameRate;
 	TextMenuItem frameRatePAL;
 	StaticArrayList<TextMenuItem, MAX_ASPECT_RATIO_ITEMS> aspectRatioItem;
@@ -120,6 +121,9 @@ protected:
 	TextMenuItem soundBuffersItem[7];
 	MultiChoiceMenuItem soundBuffers;
 	BoolMenuItem addSoundBuffersOnUnderrun;
+	BoolMenuItem dynamicRateControl;
+	TextMenuItem resamplerQualityItem[3];
+	MultiChoiceMenuItem resamplerQuality;
 	StaticArrayList<TextMenuItem, 5> audioRateItem{};
 	MultiChoiceMenuItem audioRate;
 	#ifdef CONFIG_AUDIO_MANAGER_SOLO_MIX
@@ -151,6 +155,14 @@ protected:
 	static constexpr uint MIN_FAST_FORWARD_SPEED = 2;
 	TextMenuItem fastForwardSpeedItem[6];
 	MultiChoiceMenuItem fastForwardSpeed;
+	TextMenuItem rewindBufferSizeItem[6];
+	MultiChoiceMenuItem rewindBufferSize;
+	TextMenuItem rewindIntervalItem[4];
+	MultiChoiceMenuItem rewindInterval;
+	TextMenuItem runAheadItem[5];
+	MultiChoiceMenuItem runAhead;
+	TextMenuItem archiveCacheSizeItem[5];
+	MultiChoiceMenuItem archiveCacheSize;
 	#if defined __ANDROID__
 	BoolMenuItem performanceMode;
 	#endif
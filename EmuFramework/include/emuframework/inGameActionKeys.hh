@@ -18,7 +18,7 @@
 namespace EmuControls
 {
 
-static const uint gameActionKeys = 10;
+static const uint gameActionKeys = 11;
 static const uint systemKeyMapStart = gameActionKeys;
 typedef uint GameActionKeyArray[gameActionKeys];
 
@@ -34,6 +34,7 @@ static const char *gameActionName[gameActionKeys] =
 	"Take Screenshot",
 	"Open Menu",
 	"Toggle Fast-forward",
+	"Rewind",
 };
 
 }
@@ -42,7 +43,7 @@ static const char *gameActionName[gameActionKeys] =
 {"Set In-Game Actions", gameActionName, 0}
 
 #define EMU_CONTROLS_IN_GAME_ACTIONS_UNBINDED_PROFILE_INIT \
-0, 0, 0, 0, 0, 0, 0, 0, 0, 0
+0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0
 
 #define EMU_CONTROLS_IN_GAME_ACTIONS_ICP_NUBS_PROFILE_INIT \
 Input::iControlPad::RNUB_DOWN, \
@@ -54,6 +55,7 @@ Input::iControlPad::RNUB_UP, \
 Input::iControlPad::LNUB_UP, \
 0, \
 0, \
+0, \
 0
 
 #define EMU_CONTROLS_IN_GAME_ACTIONS_ICADE_PROFILE_INIT \
@@ -66,6 +68,7 @@ Input::ICade::Z, \
 0, \
 0, \
 0, \
+0, \
 0
 
 #define EMU_CONTROLS_IN_GAME_ACTIONS_WIIMOTE_PROFILE_INIT \
@@ -78,6 +81,7 @@ Input::Wiimote::HOME, \
 0, \
 0, \
 0, \
+0, \
 0
 
 #define EMU_CONTROLS_IN_GAME_ACTIONS_WII_CC_PROFILE_INIT \
@@ -90,6 +94,7 @@ Input::WiiCC::HOME, \
 Input::WiiCC::ZR, \
 0, \
 0, \
+0, \
 0
 
 #define EMU_CONTROLS_IN_GAME_ACTIONS_ANDROID_NAV_PROFILE_INIT \
@@ -102,6 +107,7 @@ Input::Keycode::MENU, \
 Input::Keycode::SEARCH, \
 0, \
 Input::Keycode::BACK, \
+0, \
 0
 
 #define EMU_CONTROLS_IN_GAME_ACTIONS_ANDROID_GENERIC_GAMEPAD_PROFILE_INIT \
@@ -114,6 +120,7 @@ Input::Keycode::JS2_YAXIS_NEG, \
 Input::Keycode::JS_RTRIGGER_AXIS, \
 0, \
 0, \
+0, \
 0
 
 #define EMU_CONTROLS_IN_GAME_ACTIONS_OUYA_PROFILE_INIT \
@@ -126,6 +133,7 @@ Input::Keycode::MENU, \
 Input::Keycode::Ouya::R2, \
 0, \
 0, \
+0, \
 0
 
 #define EMU_CONTROLS_IN_GAME_ACTIONS_OUYA_MINIMAL_PROFILE_INIT \
@@ -138,6 +146,7 @@ Input::Keycode::MENU, \
 0, \
 0, \
 0, \
+0, \
 0
 
 #define EMU_CONTROLS_IN_GAME_ACTIONS_NVIDIA_SHIELD_PROFILE_INIT \
@@ -150,6 +159,7 @@ Input::Keycode::MENU, \
 Input::Keycode::JS_RTRIGGER_AXIS, \
 0, \
 Input::Keycode::BACK, \
+0, \
 0
 
 #define EMU_CONTROLS_IN_GAME_ACTIONS_NVIDIA_SHIELD_MINIMAL_PROFILE_INIT \
@@ -162,6 +172,7 @@ Input::Keycode::BACK, \
 Input::Keycode::JS_RTRIGGER_AXIS, \
 0, \
 Input::Keycode::BACK, \
+0, \
 0
 
 #define EMU_CONTROLS_IN_GAME_ACTIONS_ANDROID_PS3_GAMEPAD_PROFILE_INIT \
@@ -174,6 +185,7 @@ Input::Keycode::GAME_1, \
 Input::Keycode::GAME_R2, \
 0, \
 0, \
+0, \
 0
 
 #define EMU_CONTROLS_IN_GAME_ACTIONS_ANDROID_PS3_GAMEPAD_MINIMAL_PROFILE_INIT \
@@ -186,6 +198,7 @@ Input::Keycode::GAME_1, \
 0, \
 0, \
 0, \
+0, \
 0
 
 #define EMU_CONTROLS_IN_GAME_ACTIONS_GENERIC_KB_PROFILE_INIT \
@@ -198,6 +211,7 @@ Input::Keycode::RIGHT_BRACKET, \
 Input::Keycode::GRAVE, \
 0, \
 Input::Keycode::ESCAPE, \
+0, \
 0
 
 #define EMU_CONTROLS_IN_GAME_ACTIONS_GENERIC_KB_ALT_PROFILE_INIT \
@@ -210,6 +224,7 @@ Input::Keycode::RIGHT_BRACKET, \
 Input::Keycode::GRAVE, \
 0, \
 Input::Keycode::ESCAPE, \
+0, \
 0
 
 #ifdef __ANDROID__
@@ -223,6 +238,7 @@ Input::Keycode::MENU, \
 Input::Keycode::SEARCH, \
 0, \
 0, \
+0, \
 0
 #else
 #define EMU_CONTROLS_IN_GAME_ACTIONS_GENERIC_KB_MINIMAL_PROFILE_INIT \
@@ -235,6 +251,7 @@ Input::Keycode::MENU, \
 Input::Keycode::F11, \
 0, \
 0, \
+0, \
 0
 #endif
 
@@ -250,6 +267,7 @@ Input::Keycode::F11, \
 	Input::PS3::R2, \
 	0, \
 	0, \
+	0, \
 	0
 
 #define EMU_CONTROLS_IN_GAME_ACTIONS_GENERIC_PS3PAD_ALT_MINIMAL_PROFILE_INIT \
@@ -262,6 +280,7 @@ Input::Keycode::F11, \
 	0, \
 	0, \
 	0, \
+	0, \
 	0
 
 #define EMU_CONTROLS_IN_GAME_ACTIONS_PANDORA_PROFILE_INIT \
@@ -274,6 +293,7 @@ Input::Keycode::F11, \
 	Input::Keycode::Pandora::R, \
 	0, \
 	Input::Keycode::BACK_SPACE, \
+	0, \
 	0
 
 #define EMU_CONTROLS_IN_GAME_ACTIONS_PANDORA_ALT_PROFILE_INIT \
@@ -286,6 +306,7 @@ Input::Keycode::F11, \
 	Input::Keycode::_0, \
 	0, \
 	Input::Keycode::BACK_SPACE, \
+	0, \
 	0
 
 #define EMU_CONTROLS_IN_GAME_ACTIONS_PANDORA_ALT_MINIMAL_PROFILE_INIT \
@@ -298,6 +319,7 @@ Input::Keycode::F11, \
 	Input::Keycode::Pandora::R, \
 	0, \
 	0, \
+	0, \
 	0
 
 #define EMU_CONTROLS_IN_GAME_ACTIONS_APPLEGC_PROFILE_INIT \
@@ -310,6 +332,7 @@ Input::Keycode::F11, \
 	Input::AppleGC::R2, \
 	0, \
 	0, \
+	0, \
 	0
 
 #define EMU_CONTROLS_IN_GAME_ACTIONS_APPLEGC_MINIMAL_PROFILE_INIT \
@@ -322,6 +345,7 @@ Input::Keycode::F11, \
 	0, \
 	0, \
 	0, \
+	0, \
 	0
 
 #define EMU_CONTROLS_IN_GAME_ACTIONS_8BITDO_SF30_PRO_PROFILE_INIT \
@@ -334,6 +358,7 @@ Input::Keycode::JS2_YAXIS_NEG, \
 Input::Keycode::GAME_R2, \
 0, \
 Input::Keycode::GAME_L2, \
+0, \
 0
 
 #define EMU_CONTROLS_IN_GAME_ACTIONS_8BITDO_SF30_PRO_MINIMAL_PROFILE_INIT \
@@ -346,6 +371,7 @@ Input::Keycode::JS2_YAXIS_NEG, \
 Input::Keycode::GAME_R2, \
 0, \
 Input::Keycode::GAME_L2, \
+0, \
 0
 
 #define EMU_CONTROLS_IN_GAME_ACTIONS_8BITDO_SN30_PRO_PLUS_PROFILE_INIT \
@@ -358,6 +384,7 @@ Input::Keycode::JS2_YAXIS_NEG, \
 Input::Keycode::GAME_R2, \
 0, \
 Input::Keycode::GAME_L2, \
+0, \
 0
 
 #define EMU_CONTROLS_IN_GAME_ACTIONS_8BITDO_SN30_PRO_PLUS_MINIMAL_PROFILE_INIT \
@@ -370,6 +397,7 @@ Input::Keycode::JS2_YAXIS_NEG, \
 Input::Keycode::GAME_R2, \
 0, \
 Input::Keycode::GAME_L2, \
+0, \
 0
 
 #define EMU_CONTROLS_IN_GAME_ACTIONS_8BITDO_M30_GAMEPAD_PROFILE_INIT \
@@ -382,6 +410,7 @@ Input::Keycode::JS2_YAXIS_NEG, \
 Input::Keycode::GAME_R2, \
 0, \
 Input::Keycode::GAME_L2, \
+0, \
 0
 
 #define EMU_CONTROLS_IN_GAME_ACTIONS_8BITDO_M30_GAMEPAD_MINIMAL_PROFILE_INIT \
@@ -394,4 +423,5 @@ Input::Keycode::JS2_YAXIS_NEG, \
 Input::Keycode::GAME_R2, \
 0, \
 Input::Keycode::GAME_L2, \
+0, \
 0
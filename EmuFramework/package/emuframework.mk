@@ -9,4 +9,9 @@ endif
 
 pkgConfigDeps += emuframework$(imagineLibExt)
 
+ifdef emuFramework_headlessBenchmark
+ # imagine's main() only references the runner weakly so pull it out of the static lib
+ LDFLAGS += -Wl,-u,_ZN4Base11runHeadlessEiPPc
+endif
+
 endif
@@ -31,6 +31,12 @@ static void setSoundBuffers(int val)
 	optionSoundBuffers = val;
 }
 
+static void setResamplerQuality(IG::Audio::ResamplerQuality val, EmuAudio &audio)
+{
+	optionAudioResamplerQuality = (uint8_t)val;
+	audio.setResamplerQuality(val);
+}
+
 static void setSoundVolume(uint8_t val, EmuAudio &audio)
 {
 	optionSoundVolume = val;
@@ -142,6 +148,28 @@ AudioOptionView::AudioOptionView(ViewAttachParams attach, bool customMenu):
 			audio->setAddSoundBuffersOnUnderrun(optionAddSoundBuffersOnUnderrun);
 		}
 	},
+	dynamicRateControl
+	{
+		"Dynamic Rate Control",
+		(bool)optionAudioDynamicRateControl,
+		[this](BoolMenuItem &item, Input::Event e)
+		{
+			optionAudioDynamicRateControl = item.flipBoolValue(*this);
+			audio->setDynamicRateControl(optionAudioDynamicRateControl);
+		}
+	},
+	resamplerQualityItem
+	{
+		{"Low", [this]() { setResamplerQuality(IG::Audio::ResamplerQuality::LOW, *audio); }},
+		{"Medium", [this]() { setResamplerQuality(IG::Audio::ResamplerQuality::MEDIUM, *audio); }},
+		{"High", [this]() { setResamplerQuality(IG::Audio::ResamplerQuality::HIGH, *audio); }},
+	},
+	resamplerQuality
+	{
+		"Resampler Quality",
+		optionAudioResamplerQuality.val,
+		resamplerQualityItem
+	},
 	audioRate
 	{
 		"Sound Rate",
@@ -221,6 +249,8 @@ void AudioOptionView::loadStockItems()
 	}
 	item.emplace_back(&soundBuffers);
 	item.emplace_back(&addSoundBuffersOnUnderrun);
+	item.emplace_back(&dynamicRateControl);
+	item.emplace_back(&resamplerQuality);
 	#ifdef CONFIG_AUDIO_MANAGER_SOLO_MIX
 	item.emplace_back(&audioSoloMix);
 	#endif
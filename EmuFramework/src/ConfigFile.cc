@@ -170,6 +170,10 @@ static OptionBase *cfgFileOption[] =
 	#endif
 	&optionConfirmOverwriteState,
 	&optionFastForwardSpeed,
+	&optionRewindBufferSize,
+	&optionRewindInterval,
+	&optionRunAheadFrames,
+	&optionArchiveCacheSize,
 	#ifdef CONFIG_INPUT_DEVICE_HOTSWAP
 	&optionNotifyInputDeviceChange,
 	#endif
@@ -180,6 +184,7 @@ static OptionBase *cfgFileOption[] =
 	&optionFrameInterval,
 	#endif
 	&optionSkipLateFrames,
+	&optionShowFramePacingStats,
 	&optionFrameRate,
 	&optionFrameRatePAL,
 	&optionVibrateOnPush,
@@ -207,6 +212,8 @@ static OptionBase *cfgFileOption[] =
 	#endif
 	&optionSoundBuffers,
 	&optionAddSoundBuffersOnUnderrun,
+	&optionAudioDynamicRateControl,
+	&optionAudioResamplerQuality,
 	#ifdef CONFIG_AUDIO_MANAGER_SOLO_MIX
 	&optionAudioSoloMix,
 	#endif
@@ -455,6 +462,7 @@ void loadConfigFile()
 				bcase CFGKEY_FRAME_INTERVAL: optionFrameInterval.readFromIO(io, size);
 				#endif
 				bcase CFGKEY_SKIP_LATE_FRAMES: optionSkipLateFrames.readFromIO(io, size);
+				bcase CFGKEY_SHOW_FRAME_PACING_STATS: optionShowFramePacingStats.readFromIO(io, size);
 				bcase CFGKEY_FRAME_RATE: optionFrameRate.readFromIO(io, size);
 				bcase CFGKEY_FRAME_RATE_PAL: optionFrameRatePAL.readFromIO(io, size);
 				bcase CFGKEY_LAST_DIR: optionLastLoadPath.readFromIO(io, size);
@@ -490,6 +498,10 @@ void loadConfigFile()
 				bcase CFGKEY_HIDE_STATUS_BAR: optionHideStatusBar.readFromIO(io, size);
 				bcase CFGKEY_CONFIRM_OVERWRITE_STATE: optionConfirmOverwriteState.readFromIO(io, size);
 				bcase CFGKEY_FAST_FORWARD_SPEED: optionFastForwardSpeed.readFromIO(io, size);
+				bcase CFGKEY_REWIND_BUFFER_SIZE: optionRewindBufferSize.readFromIO(io, size);
+				bcase CFGKEY_REWIND_INTERVAL: optionRewindInterval.readFromIO(io, size);
+				bcase CFGKEY_RUN_AHEAD_FRAMES: optionRunAheadFrames.readFromIO(io, size);
+				bcase CFGKEY_ARCHIVE_CACHE_SIZE: optionArchiveCacheSize.readFromIO(io, size);
 				#ifdef CONFIG_INPUT_DEVICE_HOTSWAP
 				bcase CFGKEY_NOTIFY_INPUT_DEVICE_CHANGE: optionNotifyInputDeviceChange.readFromIO(io, size);
 				#endif
@@ -513,6 +525,8 @@ void loadConfigFile()
 				bcase CFGKEY_SOUND_BUFFERS: optionSoundBuffers.readFromIO(io, size);
 				bcase CFGKEY_SOUND_VOLUME: optionSoundVolume.readFromIO(io, size);
 				bcase CFGKEY_ADD_SOUND_BUFFERS_ON_UNDERRUN: optionAddSoundBuffersOnUnderrun.readFromIO(io, size);
+				bcase CFGKEY_AUDIO_DYNAMIC_RATE_CONTROL: optionAudioDynamicRateControl.readFromIO(io, size);
+				bcase CFGKEY_AUDIO_RESAMPLER_QUALITY: optionAudioResamplerQuality.readFromIO(io, size);
 				#ifdef CONFIG_AUDIO_MANAGER_SOLO_MIX
 				bcase CFGKEY_AUDIO_SOLO_MIX: optionAudioSoloMix.readFromIO(io, size);
 				#endif
@@ -35,6 +35,7 @@
 #include "privateInput.hh"
 #include "configFile.hh"
 #include "EmuSystemTask.hh"
+#include "EmuInputMovie.hh"
 
 class ExitConfirmAlertView : public AlertView
 {
@@ -82,6 +83,7 @@ EmuVideo emuVideo{};
 static std::unique_ptr<EmuVideoLayer> emuVideoLayerPtr{};
 static std::unique_ptr<EmuViewController> emuViewControllerPtr{};
 EmuAudio emuAudio{};
+EmuInputMovie emuInputMovie{};
 DelegateFunc<void ()> onUpdateInputDevices{};
 #ifdef CONFIG_BLUETOOTH
 BluetoothAdapter *bta{};
@@ -254,6 +256,8 @@ void mainInitCommon(int argc, char** argv)
 	if(optionSoundRate > optionSoundRate.defaultVal)
 		optionSoundRate.reset();
 	emuAudio.setAddSoundBuffersOnUnderrun(optionAddSoundBuffersOnUnderrun);
+	emuAudio.setDynamicRateControl(optionAudioDynamicRateControl);
+	emuAudio.setResamplerQuality((IG::Audio::ResamplerQuality)optionAudioResamplerQuality.val);
 	applyOSNavStyle(false);
 
 	{
@@ -824,6 +828,11 @@ FS::PathString EmuApp::supportPath()
 	return Base::supportPath(appName());
 }
 
+FS::PathString EmuApp::cachePath()
+{
+	return Base::cachePath(appName());
+}
+
 AssetIO EmuApp::openAppAssetIO(const char *name, IO::AccessHint access)
 {
 	return FileUtils::openAppAsset(name, access, appName());
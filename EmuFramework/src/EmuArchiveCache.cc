@@ -0,0 +1,175 @@
+/*  This file is part of EmuFramework.
+
+	Imagine is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	Imagine is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with EmuFramework.  If not, see <http://www.gnu.org/licenses/> */
+
+#define LOGTAG "ArchiveCache"
+#include "EmuArchiveCache.hh"
+#include <emuframework/EmuApp.hh>
+#include <imagine/logger/logger.h>
+#include <algorithm>
+#include <cstring>
+#include <vector>
+#include <fcntl.h>
+#include <sys/stat.h>
+
+static uint64_t fnv1a(uint64_t hash, const void *data, size_t size)
+{
+	auto bytes = (const uint8_t*)data;
+	for(size_t i = 0; i < size; i++)
+	{
+		hash = (hash ^ bytes[i]) * 0x100000001b3ull;
+	}
+	return hash;
+}
+
+FS::PathString EmuArchiveCache::cacheDir()
+{
+	return FS::makePathStringPrintf("%s/ArchiveCache", EmuApp::cachePath().data());
+}
+
+void EmuArchiveCache::setMaxSize(uint64_t bytes)
+{
+	maxSize = bytes;
+	// also clears out what a larger limit, or the cache before it was disabled, left behind
+	trim();
+}
+
+FS::PathString EmuArchiveCache::entryPath(const char *archivePath, uint32_t crc32, uint64_t size) const
+{
+	if(!maxSize)
+		return {};
+	std::error_code ec{};
+	auto archiveStatus = FS::status(archivePath, ec);
+	if(ec)
+		return {};
+	// a replaced archive or entry hashes to a new name, the old one ages out
+	int64_t mTime = archiveStatus.lastWriteTime();
+	uint64_t archiveSize = archiveStatus.size();
+	uint64_t hash = 0xcbf29ce484222325ull;
+	hash = fnv1a(hash, archivePath, strlen(archivePath));
+	hash = fnv1a(hash, &mTime, sizeof(mTime));
+	hash = fnv1a(hash, &archiveSize, sizeof(archiveSize));
+	hash = fnv1a(hash, &size, sizeof(size));
+	return FS::makePathStringPrintf("%s/%016llx-%08x", cacheDir().data(), (unsigned long long)hash, crc32);
+}
+
+FileIO EmuArchiveCache::open(const FS::PathString &path, uint64_t size)
+{
+	FileIO io{};
+	if(io.open(path, IO::AccessHint::ALL) || io.size() != size)
+	{
+		misses++;
+		if(io)
+		{
+			logWarn("removing %s with wrong size", path.data());
+			io.close();
+			FS::remove(path);
+		}
+		return {};
+	}
+	hits++;
+	// refresh the modification time, trim() removes the oldest first
+	if(utimensat(AT_FDCWD, path.data(), nullptr, 0) == -1)
+	{
+		logWarn("error updating time of %s", path.data());
+	}
+	return io;
+}
+
+bool EmuArchiveCache::store(const FS::PathString &path, IO &io)
+{
+	auto size = io.size();
+	if(!maxSize || !size || size > maxSize)
+		return false;
+	FS::create_directory(cacheDir());
+	// written to a temporary name so a partial file is never used
+	auto tempPath = FS::makePathStringPrintf("%s.tmp", path.data());
+	FileIO file{};
+	if(file.create(tempPath))
+	{
+		logErr("error creating %s", tempPath.data());
+		return false;
+	}
+	bool written = false;
+	io.seekS(0);
+	if(auto data = io.mmapConst();
+		data)
+	{
+		written = file.write(data, size) == (ssize_t)size;
+	}
+	else
+	{
+		char buff[64 * 1024];
+		size_t left = size;
+		while(left)
+		{
+			auto bytesRead = io.read(buff, std::min(left, sizeof(buff)));
+			if(bytesRead <= 0 || file.write(buff, bytesRead) != bytesRead)
+				break;
+			left -= bytesRead;
+		}
+		written = !left;
+	}
+	io.seekS(0);
+	file.close();
+	std::error_code ec{};
+	if(written)
+		FS::rename(tempPath.data(), path.data(), ec);
+	if(!written || ec)
+	{
+		logErr("error writing %s", path.data());
+		FS::remove(tempPath);
+		return false;
+	}
+	logMsg("cached %zu bytes as %s", size, path.data());
+	trim();
+	return true;
+}
+
+void EmuArchiveCache::trim()
+{
+	struct CacheFile
+	{
+		FS::PathString path;
+		FS::file_time_type lastWriteTime;
+		uint64_t size;
+	};
+	std::vector<CacheFile> files{};
+	uint64_t totalSize = 0;
+	std::error_code ec{};
+	for(auto &entry : FS::directory_iterator{cacheDir(), ec})
+	{
+		if(entry.type() != FS::file_type::regular)
+			continue;
+		auto path = entry.path();
+		auto fileStatus = FS::status(path, ec);
+		if(ec)
+			continue;
+		files.emplace_back(CacheFile{path, fileStatus.lastWriteTime(), fileStatus.size()});
+		totalSize += fileStatus.size();
+	}
+	if(totalSize <= maxSize)
+		return;
+	std::sort(files.begin(), files.end(),
+		[](const CacheFile &a, const CacheFile &b){ return a.lastWriteTime < b.lastWriteTime; });
+	for(auto &f : files)
+	{
+		if(totalSize <= maxSize)
+			break;
+		logMsg("evicting %s", f.path.data());
+		FS::remove(f.path);
+		totalSize -= f.size;
+		evictions++;
+	}
+}
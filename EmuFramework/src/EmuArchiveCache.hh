@@ -0,0 +1,61 @@
+#pragma once
+
+/*  This file is part of EmuFramework.
+
+	Imagine is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	Imagine is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with EmuFramework.  If not, see <http://www.gnu.org/licenses/> */
+
+#include <imagine/fs/FS.hh>
+#include <imagine/io/FileIO.hh>
+
+// Keeps decompressed archive entries on disk so relaunching an archived game maps the
+// cached copy instead of inflating it again. Files are named by a hash of the archive's
+// path & modification time and the entry's CRC32 & size, and the least recently used
+// (by file modification time, refreshed on each hit) are removed past the size limit.
+// Only the single entry passed to EmuSystem::loadGame() is cached, which covers
+// single-file games on systems with handlesGenericIO set. Out of scope by design:
+// - Systems that load by path (handlesGenericIO false) never reach the cache. Saturn only
+//   opens CD images from a plain directory, and NEO's core inflates its own zip sets,
+//   which its .gno file (the whole decoded ROM set) already avoids repeating.
+// - Multi-file games whose other files are opened by name, like a PCE-CD CUE sheet and its
+//   BIN/WAV tracks, only load from a plain directory so there's no archive to cache.
+class EmuArchiveCache
+{
+public:
+	struct Stats
+	{
+		uint32_t hits;
+		uint32_t misses;
+		uint32_t evictions;
+	};
+
+	void setMaxSize(uint64_t bytes);
+	bool isEnabled() const { return maxSize; }
+	// path the entry is cached at, empty if the cache is disabled or the archive can't be read
+	FS::PathString entryPath(const char *archivePath, uint32_t crc32, uint64_t size) const;
+	// opens a cached entry, counting a hit or miss
+	FileIO open(const FS::PathString &path, uint64_t size);
+	// writes an entry to the cache & evicts the least recently used entries to make room
+	bool store(const FS::PathString &path, IO &io);
+	// removes the least recently used entries until the cache fits in maxSize
+	void trim();
+	Stats stats() const { return {hits, misses, evictions}; }
+
+protected:
+	uint64_t maxSize = 0;
+	uint32_t hits = 0;
+	uint32_t misses = 0;
+	uint32_t evictions = 0;
+
+	static FS::PathString cacheDir();
+};
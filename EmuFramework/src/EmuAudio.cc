@@ -19,21 +19,63 @@
 #include "private.hh"
 #include <imagine/audio/AudioManager.hh>
 #include <imagine/logger/logger.h>
+#include <mutex>
 
 struct AudioStats
 {
+	// updated on each write from the emulation thread
+	struct WriteStats
+	{
+		unsigned overruns = 0;
+		unsigned writes = 0;
+		double fillFramesSum = 0;
+		double rateRatioSum = 0;
+	};
+
 	constexpr AudioStats() {}
-	unsigned underruns = 0;
-	unsigned overruns = 0;
+	// updated from the audio callback
+	std::atomic_uint underruns{};
 	std::atomic_uint callbacks{};
 	std::atomic_uint callbackBytes{};
 
 	void reset()
 	{
-		underruns = overruns = 0;
+		underruns = 0;
 		callbacks = 0;
 		callbackBytes = 0;
+		std::lock_guard lock{writeMutex};
+		writeStats = {};
 	}
+
+	void addWrite(double fillFrames, double rateRatio)
+	{
+		std::lock_guard lock{writeMutex};
+		writeStats.writes++;
+		writeStats.fillFramesSum += fillFrames;
+		writeStats.rateRatioSum += rateRatio;
+	}
+
+	void addOverrun()
+	{
+		std::lock_guard lock{writeMutex};
+		writeStats.overruns++;
+	}
+
+	// returns the write stats since the last call and starts a new interval,
+	// overruns keep counting until reset() like underruns
+	WriteStats takeWriteStats()
+	{
+		std::lock_guard lock{writeMutex};
+		auto stats = writeStats;
+		writeStats.writes = 0;
+		writeStats.fillFramesSum = 0;
+		writeStats.rateRatioSum = 0;
+		return stats;
+	}
+
+private:
+	std::mutex writeMutex{};
+	WriteStats writeStats{};
 };
 
 #ifdef CONFIG_EMUFRAMEWORK_AUDIO_STATS
@@ -45,14 +87,17 @@ static void startAudioStats(IG::Audio::Format format)
 {
 	#ifdef CONFIG_EMUFRAMEWORK_AUDIO_STATS
 	audioStats.reset();
-	audioStatsTimer.run(IG::Seconds(1), IG::Seconds(1), {},
+	audioStatsTimer.run(IG::Seconds(1), IG::Seconds(1), false, {},
 		[format]()
 		{
-			auto frames = format.bytesToFrames(audioStats.callbackBytes);
-			emuViewController.updateEmuAudioStats(audioStats.underruns, audioStats.overruns,
-				audioStats.callbacks, frames / (double)audioStats.callbacks, frames);
-			audioStats.callbacks = 0;
-			audioStats.callbackBytes = 0;
+			auto frames = format.bytesToFrames(audioStats.callbackBytes.exchange(0));
+			auto callbacks = audioStats.callbacks.exchange(0);
+			auto writeStats = audioStats.takeWriteStats();
+			auto writes = std::max(writeStats.writes, 1u);
+			emuViewController().updateEmuAudioStats(audioStats.underruns.load(), writeStats.overruns,
+				callbacks, frames / (double)callbacks, frames,
+				writeStats.fillFramesSum / writes / format.rate, writeStats.rateRatioSum / writes);
+			return true;
 		});
 	#endif
 }
@@ -60,8 +105,8 @@ static void startAudioStats(IG::Audio::Format format)
 static void stopAudioStats()
 {
 	#ifdef CONFIG_EMUFRAMEWORK_AUDIO_STATS
-	audioStatsTimer.deinit();
-	clearEmuAudioStats();
+	audioStatsTimer.cancel();
+	emuViewController().clearEmuAudioStats();
 	#endif
 }
 
@@ -86,44 +131,18 @@ bool EmuAudio::shouldStartAudioWrites(uint32_t bytesToWrite) const
 	return rBuff.size() + bytesToWrite >= targetBufferFillBytes;
 }
 
-template<typename T>
-static void simpleResample(T * __restrict__ dest, unsigned destFrames, const T * __restrict__ src, unsigned srcFrames)
-{
-	if(!destFrames)
-		return;
-	float ratio = (float)srcFrames/(float)destFrames;
-	iterateTimes(destFrames, i)
-	{
-		unsigned srcPos = round(i * ratio);
-		if(unlikely(srcPos > srcFrames))
-		{
-			logMsg("resample pos %u too high", srcPos);
-			srcPos = srcFrames-1;
-		}
-		dest[i] = src[srcPos];
-	}
-}
-
-static void simpleResample(void *dest, unsigned destFrames, const void *src, unsigned srcFrames, IG::Audio::Format format)
+uint32_t EmuAudio::rateControlledFrames(uint32_t frames)
 {
-	if(format.channels == 1)
-	{
-		if(format.sample.isFloat())
-			simpleResample((uint32_t*)dest, destFrames, (uint32_t*)src, srcFrames);
-		else
-			simpleResample((uint16_t*)dest, destFrames, (uint16_t*)src, srcFrames);
-	}
-	else
-	{
-		if(format.channels != 2)
-		{
-			bug_unreachable("channels == %d", format.channels);
-		}
-		if(format.sample.isFloat())
-			simpleResample((uint64_t*)dest, destFrames, (uint64_t*)src, srcFrames);
-		else
-			simpleResample((uint32_t*)dest, destFrames, (uint32_t*)src, srcFrames);
-	}
+	auto inputFormat = format();
+	float targetFrames = inputFormat.bytesToFrames(targetBufferFillBytes);
+	// smooth out the sawtooth from the output callback draining the buffer in chunks
+	avgFillFrames += (inputFormat.bytesToFrames(rBuff.size()) - avgFillFrames) * FILL_SMOOTHING;
+	float deviation = std::clamp((targetFrames - avgFillFrames) / targetFrames, -1.f, 1.f);
+	float ratio = 1.f + MAX_RATE_DELTA * deviation;
+	float outFrames = frames * ratio + rateFrameRemainder;
+	uint32_t wholeFrames = outFrames;
+	rateFrameRemainder = outFrames - wholeFrames;
+	return std::max(wholeFrames, 1u);
 }
 
 void EmuAudio::resizeAudioBuffer(uint32_t targetBufferFillBytes)
@@ -144,6 +163,14 @@ void EmuAudio::open(IG::Audio::Api api)
 	audioStream = IG::Audio::makeOutputStream(api);
 }
 
+void EmuAudio::openMemorySink()
+{
+	close();
+	targetBufferFillBytes = format().timeToBytes(IG::FloatSeconds{1.});
+	bufferIncrementBytes = 0;
+	resizeAudioBuffer(targetBufferFillBytes);
+}
+
 void EmuAudio::start(IG::Microseconds targetBufferFillUSecs, IG::Microseconds bufferIncrementUSecs)
 {
 	if(!audioStream)
@@ -153,8 +180,11 @@ void EmuAudio::start(IG::Microseconds targetBufferFillUSecs, IG::Microseconds bu
 	}
 	lastUnderrunTime = {};
 	auto inputFormat = format();
+	resampler.setFormat(inputFormat);
 	targetBufferFillBytes = inputFormat.timeToBytes(targetBufferFillUSecs);
 	bufferIncrementBytes = inputFormat.timeToBytes(bufferIncrementUSecs);
+	avgFillFrames = inputFormat.bytesToFrames(targetBufferFillBytes);
+	rateFrameRemainder = 0;
 	if(!audioStream->isOpen())
 	{
 		resizeAudioBuffer(targetBufferFillBytes);
@@ -168,7 +198,7 @@ void EmuAudio::start(IG::Microseconds targetBufferFillUSecs, IG::Microseconds bu
 				IG::Audio::Format outputFormat{{}, outputSampleFormat, channels};
 				#ifdef CONFIG_EMUFRAMEWORK_AUDIO_STATS
 				audioStats.callbacks++;
-				audioStats.callbackBytes += bytes;
+				audioStats.callbackBytes += outputFormat.framesToBytes(frames);
 				#endif
 				if(audioWriteState == AudioWriteState::ACTIVE)
 				{
@@ -234,6 +264,7 @@ void EmuAudio::stop()
 	if(audioStream)
 		audioStream->close();
 	rBuff.clear();
+	resampler.reset();
 }
 
 void EmuAudio::close()
@@ -252,16 +283,27 @@ void EmuAudio::flush()
 	if(audioStream)
 		audioStream->flush();
 	rBuff.clear();
+	resampler.reset();
 }
 
 void EmuAudio::writeFrames(const void *samples, uint32_t framesToWrite)
 {
 	assumeExpr(rBuff);
 	auto inputFormat = format();
+	if(unlikely(!audioStream))
+	{
+		// memory sink, nothing consumes the samples so start over once the buffer fills
+		auto bytes = inputFormat.framesToBytes(framesToWrite);
+		if(bytes > rBuff.freeSpace())
+			rBuff.clear();
+		rBuff.write(samples, bytes);
+		return;
+	}
 	switch(audioWriteState)
 	{
 		case AudioWriteState::MULTI_UNDERRUN:
-			if(speedMultiplier == 1 && addSoundBuffersOnUnderrun &&
+			// rate control keeps the fill level steady on its own, growing the buffer would only add latency
+			if(speedMultiplier == 1 && addSoundBuffersOnUnderrun && !dynamicRateControl &&
 				inputFormat.bytesToTime(rBuff.capacity()).count() <= 1.) // hard cap buffer increase to 1 sec
 			{
 				logWarn("increasing buffer size due to multiple underruns within a short time");
@@ -281,26 +323,29 @@ void EmuAudio::writeFrames(const void *samples, uint32_t framesToWrite)
 		framesToWrite = std::ceil((double)framesToWrite / speedMultiplier);
 		framesToWrite = std::max(framesToWrite, 1u);
 	}
+	else if(dynamicRateControl && audioWriteState == AudioWriteState::ACTIVE)
+	{
+		framesToWrite = rateControlledFrames(framesToWrite);
+	}
+	#ifdef CONFIG_EMUFRAMEWORK_AUDIO_STATS
+	audioStats.addWrite(inputFormat.bytesToFrames(rBuff.size()), (double)framesToWrite / sampleFrames);
+	#endif
 	auto bytes = inputFormat.framesToBytes(framesToWrite);
 	auto freeBytes = rBuff.freeSpace();
 	if(bytes <= freeBytes)
 	{
-		if(sampleFrames > framesToWrite)
-		{
-			simpleResample(rBuff.writeAddr(), framesToWrite, samples, sampleFrames, inputFormat);
-			rBuff.commitWrite(bytes);
-		}
-		else
-			rBuff.writeUnchecked(samples, bytes);
+		// a 1:1 ratio still goes through the resampler so its delay matches the filtered path
+		resampler.resample(rBuff.writeAddr(), framesToWrite, samples, sampleFrames);
+		rBuff.commitWrite(bytes);
 	}
 	else
 	{
 		logMsg("overrun, only %d out of %d bytes free", freeBytes, bytes);
 		#ifdef CONFIG_EMUFRAMEWORK_AUDIO_STATS
-		audioStats.overruns++;
+		audioStats.addOverrun();
 		#endif
 		auto freeFrames = inputFormat.bytesToFrames(freeBytes);
-		simpleResample(rBuff.writeAddr(), freeFrames, samples, sampleFrames, inputFormat);
+		resampler.resample(rBuff.writeAddr(), freeFrames, samples, sampleFrames);
 		rBuff.commitWrite(freeBytes);
 	}
 	if(audioWriteState == AudioWriteState::BUFFER && shouldStartAudioWrites(bytes))
@@ -344,6 +389,16 @@ void EmuAudio::setAddSoundBuffersOnUnderrun(bool on)
 	addSoundBuffersOnUnderrun = on;
 }
 
+void EmuAudio::setDynamicRateControl(bool on)
+{
+	dynamicRateControl = on;
+}
+
+void EmuAudio::setResamplerQuality(IG::Audio::ResamplerQuality quality)
+{
+	resampler.setQuality(quality);
+}
+
 void EmuAudio::setVolume(uint8_t vol)
 {
 	if(vol == 100)
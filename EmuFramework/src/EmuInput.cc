@@ -200,7 +200,7 @@ void processRelPtr(Input::Event e)
 	{
 		//logMsg("reversed trackball X direction");
 		relPtr.x = e.pos().x;
-		EmuSystem::handleInputAction(Input::RELEASED, relPtr.xAction);
+		EmuSystem::dispatchInputAction(Input::RELEASED, relPtr.xAction);
 	}
 	else
 		relPtr.x += e.pos().x;
@@ -208,14 +208,14 @@ void processRelPtr(Input::Event e)
 	if(e.pos().x)
 	{
 		relPtr.xAction = EmuSystem::translateInputAction(e.pos().x > 0 ? EmuControls::systemKeyMapStart+1 : EmuControls::systemKeyMapStart+3);
-		EmuSystem::handleInputAction(Input::PUSHED, relPtr.xAction);
+		EmuSystem::dispatchInputAction(Input::PUSHED, relPtr.xAction);
 	}
 
 	if(relPtr.y != 0 && sign(relPtr.y) != sign(e.pos().y))
 	{
 		//logMsg("reversed trackball Y direction");
 		relPtr.y = e.pos().y;
-		EmuSystem::handleInputAction(Input::RELEASED, relPtr.yAction);
+		EmuSystem::dispatchInputAction(Input::RELEASED, relPtr.yAction);
 	}
 	else
 		relPtr.y += e.pos().y;
@@ -223,7 +223,7 @@ void processRelPtr(Input::Event e)
 	if(e.pos().y)
 	{
 		relPtr.yAction = EmuSystem::translateInputAction(e.pos().y > 0 ? EmuControls::systemKeyMapStart+2 : EmuControls::systemKeyMapStart);
-		EmuSystem::handleInputAction(Input::PUSHED, relPtr.yAction);
+		EmuSystem::dispatchInputAction(Input::PUSHED, relPtr.yAction);
 	}
 
 	//logMsg("trackball event %d,%d, rel ptr %d,%d", e.x, e.y, relPtr.x, relPtr.y);
@@ -247,12 +247,12 @@ void TurboInput::update()
 			if(clock == 0)
 			{
 				//logMsg("turbo push for player %d, action %d", e.player, e.action);
-				EmuSystem::handleInputAction(Input::PUSHED, e.action);
+				EmuSystem::dispatchInputAction(Input::PUSHED, e.action);
 			}
 			else if(clock == turboFrames/2)
 			{
 				//logMsg("turbo release for player %d, action %d", e.player, e.action);
-				EmuSystem::handleInputAction(Input::RELEASED, e.action);
+				EmuSystem::dispatchInputAction(Input::RELEASED, e.action);
 			}
 		}
 	}
@@ -0,0 +1,182 @@
+/*  This file is part of EmuFramework.
+
+	Imagine is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	Imagine is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with EmuFramework.  If not, see <http://www.gnu.org/licenses/> */
+
+#define LOGTAG "EmuInputMovie"
+#include "EmuInputMovie.hh"
+#include <imagine/io/FileIO.hh>
+#include <imagine/logger/logger.h>
+#include <imagine/util/string.h>
+#include <array>
+#include <cstring>
+
+// File layout, all values in host byte order:
+// magic, version, system short name, frame count, state size, event count,
+// state data, then the events in frame order
+static constexpr char MOVIE_MAGIC[8]{'E', 'M', 'U', 'M', 'O', 'V', 'I', 'E'};
+static constexpr uint32_t MOVIE_VERSION = 1;
+using SystemNameString = std::array<char, 16>;
+static_assert(sizeof(EmuInputMovie::Event) == 12);
+
+EmuSystem::Error EmuInputMovie::startRecording(const char *path_)
+{
+	stop();
+	if(auto err = EmuSystem::saveState(startState);
+		err)
+	{
+		return err;
+	}
+	string_copy(path, path_);
+	events.clear();
+	pendingEvents.clear();
+	frames_ = 0;
+	mode = Mode::RECORDING;
+	logMsg("recording to %s", path_);
+	return {};
+}
+
+EmuSystem::Error EmuInputMovie::stopRecording()
+{
+	if(!isRecording())
+		return {};
+	mode = Mode::OFF;
+	logMsg("stopped recording after %u frames with %zu events", frames_, events.size());
+	return write();
+}
+
+EmuSystem::Error EmuInputMovie::write() const
+{
+	FileIO file;
+	if(auto ec = file.create(path.data());
+		ec)
+	{
+		return EmuSystem::makeError(ec);
+	}
+	SystemNameString systemName{};
+	string_copy(systemName, EmuSystem::shortSystemName());
+	bool success = file.write(MOVIE_MAGIC, sizeof(MOVIE_MAGIC)) == sizeof(MOVIE_MAGIC)
+		&& file.write(MOVIE_VERSION) == sizeof(uint32_t)
+		&& file.write(systemName) == sizeof(systemName)
+		&& file.write(frames_) == sizeof(uint32_t)
+		&& file.write((uint32_t)startState.size()) == sizeof(uint32_t)
+		&& file.write((uint32_t)events.size()) == sizeof(uint32_t)
+		&& file.write(startState.data(), startState.size()) == (ssize_t)startState.size()
+		&& file.write(events.data(), events.size() * sizeof(Event)) == (ssize_t)(events.size() * sizeof(Event));
+	if(!success)
+		return EmuSystem::makeFileWriteError();
+	return {};
+}
+
+EmuSystem::Error EmuInputMovie::load(const char *path_)
+{
+	stop();
+	FileIO file;
+	if(auto ec = file.open(path_, IO::AccessHint::ALL);
+		ec)
+	{
+		return EmuSystem::makeError(ec);
+	}
+	char magic[sizeof(MOVIE_MAGIC)]{};
+	file.read(magic, sizeof(magic));
+	if(memcmp(magic, MOVIE_MAGIC, sizeof(magic)) != 0)
+		return EmuSystem::makeError("Not an input movie file");
+	if(auto version = file.get<uint32_t>();
+		version != MOVIE_VERSION)
+	{
+		return EmuSystem::makeError("Unsupported input movie version %u", version);
+	}
+	auto systemName = file.get<SystemNameString>();
+	systemName.back() = 0;
+	if(!string_equal(systemName.data(), EmuSystem::shortSystemName()))
+		return EmuSystem::makeError("Input movie is for system %s", systemName.data());
+	auto frames = file.get<uint32_t>();
+	auto stateSize = file.get<uint32_t>();
+	auto eventCount = file.get<uint32_t>();
+	if((size_t)stateSize + (size_t)eventCount * sizeof(Event) > file.size())
+		return EmuSystem::makeFileReadError();
+	startState.resize(stateSize);
+	events.resize(eventCount);
+	if(file.read(startState.data(), stateSize) != (ssize_t)stateSize
+		|| file.read(events.data(), eventCount * sizeof(Event)) != (ssize_t)(eventCount * sizeof(Event)))
+	{
+		return EmuSystem::makeFileReadError();
+	}
+	frames_ = frames;
+	string_copy(path, path_);
+	logMsg("loaded %s with %u frames and %u events", path_, frames, eventCount);
+	return {};
+}
+
+EmuSystem::Error EmuInputMovie::startPlayback()
+{
+	if(!startState)
+		return EmuSystem::makeError("No input movie loaded");
+	if(auto err = EmuSystem::loadState(startState.view());
+		err)
+	{
+		return err;
+	}
+	nextEvent = 0;
+	playbackFrame = 0;
+	mode = Mode::PLAYBACK;
+	return {};
+}
+
+void EmuInputMovie::stop()
+{
+	if(isRecording())
+		logWarn("discarding recording to %s", path.data());
+	mode = Mode::OFF;
+}
+
+void EmuInputMovie::queueInput(uint32_t state, uint32_t key)
+{
+	if(!isRecording())
+		return; // live input is ignored during playback
+	std::lock_guard lock{pendingMutex};
+	pendingEvents.push_back({0, key, state});
+}
+
+void EmuInputMovie::update()
+{
+	switch(mode)
+	{
+		case Mode::OFF: return;
+		case Mode::RECORDING:
+		{
+			{
+				std::lock_guard lock{pendingMutex};
+				for(auto e : pendingEvents)
+				{
+					EmuSystem::handleInputAction(e.state, e.key);
+					e.frame = frames_;
+					events.push_back(e);
+				}
+				pendingEvents.clear();
+			}
+			frames_++;
+			return;
+		}
+		case Mode::PLAYBACK:
+		{
+			while(nextEvent < events.size() && events[nextEvent].frame == playbackFrame)
+			{
+				auto &e = events[nextEvent++];
+				EmuSystem::handleInputAction(e.state, e.key);
+			}
+			playbackFrame++;
+			return;
+		}
+	}
+}
@@ -0,0 +1,69 @@
+#pragma once
+
+/*  This file is part of EmuFramework.
+
+	Imagine is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	Imagine is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with EmuFramework.  If not, see <http://www.gnu.org/licenses/> */
+
+#include <emuframework/EmuSystem.hh>
+#include <imagine/util/ByteBuffer.hh>
+#include <vector>
+#include <mutex>
+
+// Records the input actions passed to EmuSystem::handleInputAction() along with the
+// emulated frame they were applied on, starting from an in-memory snapshot so replays
+// don't depend on reset behavior or battery saves. While recording, live input is
+// queued and applied at the next frame boundary so the recording reproduces exactly.
+// Loading states, resetting and rewinding aren't captured and shouldn't be used
+// while a movie is active.
+class EmuInputMovie
+{
+public:
+	struct Event
+	{
+		uint32_t frame;
+		uint32_t key;
+		uint32_t state;
+	};
+
+	EmuSystem::Error startRecording(const char *path);
+	EmuSystem::Error stopRecording();
+	EmuSystem::Error load(const char *path);
+	EmuSystem::Error startPlayback();
+	void stop();
+	void queueInput(uint32_t state, uint32_t key);
+	void update();
+	bool isActive() const { return mode != Mode::OFF; }
+	bool isRecording() const { return mode == Mode::RECORDING; }
+	uint32_t frames() const { return frames_; }
+
+protected:
+	enum class Mode : uint8_t
+	{
+		OFF,
+		RECORDING,
+		PLAYBACK
+	};
+
+	FS::PathString path{};
+	IG::ByteBuffer startState{};
+	std::vector<Event> events{};
+	std::vector<Event> pendingEvents{};
+	std::mutex pendingMutex{};
+	uint32_t frames_ = 0;
+	uint32_t nextEvent = 0;
+	uint32_t playbackFrame = 0;
+	Mode mode = Mode::OFF;
+
+	EmuSystem::Error write() const;
+};
@@ -254,6 +254,14 @@ bool EmuInputView::inputEvent(Input::Event e)
 						logMsg("fast-forward state:%d", ffToggleActive);
 					}
 
+					bcase guiKeyIdxRewind:
+					{
+						if(e.repeated())
+							continue;
+						emuViewController().setRewindActive(e.pushed());
+						logMsg("rewind state:%d", e.pushed());
+					}
+
 					bcase guiKeyIdxExit:
 					if(e.pushed())
 					{
@@ -283,7 +291,7 @@ bool EmuInputView::inputEvent(Input::Event e)
 								turboActions.removeEvent(sysAction);
 							}
 						}
-						EmuSystem::handleInputAction(e.state(), sysAction);
+						EmuSystem::dispatchInputAction(e.state(), sysAction);
 					}
 				}
 			}
@@ -25,6 +25,7 @@
 #include <imagine/base/platformExtras.hh>
 #include <imagine/gfx/Renderer.hh>
 #include <imagine/util/bits.h>
+#include <imagine/audio/Resampler.hh>
 
 template<class T>
 bool optionFrameTimeIsValid(T val)
@@ -66,6 +67,9 @@ Byte1Option optionSoundVolume(CFGKEY_SOUND_VOLUME,
 Byte1Option optionSoundBuffers(CFGKEY_SOUND_BUFFERS,
 	4, 0, optionIsValidWithMinMax<2, 8, uint8_t>);
 Byte1Option optionAddSoundBuffersOnUnderrun(CFGKEY_ADD_SOUND_BUFFERS_ON_UNDERRUN, 1, 0);
+Byte1Option optionAudioDynamicRateControl(CFGKEY_AUDIO_DYNAMIC_RATE_CONTROL, 1, 0);
+Byte1Option optionAudioResamplerQuality(CFGKEY_AUDIO_RESAMPLER_QUALITY,
+	(uint8_t)IG::Audio::ResamplerQuality::MEDIUM, 0, optionIsValidWithMax<(uint8_t)IG::Audio::ResamplerQuality::HIGH>);
 
 #ifdef CONFIG_AUDIO_MANAGER_SOLO_MIX
 OptionAudioSoloMix optionAudioSoloMix(CFGKEY_AUDIO_SOLO_MIX, 1);
@@ -104,6 +108,10 @@ OptionSwappedGamepadConfirm optionSwappedGamepadConfirm(CFGKEY_SWAPPED_GAMEPAD_C
 Byte1Option optionConsumeUnboundGamepadKeys(CFGKEY_CONSUME_UNBOUND_GAMEPAD_KEYS, 0, 0);
 Byte1Option optionConfirmOverwriteState(CFGKEY_CONFIRM_OVERWRITE_STATE, 1, 0);
 Byte1Option optionFastForwardSpeed(CFGKEY_FAST_FORWARD_SPEED, 4, 0, optionIsValidWithMinMax<2, 7>);
+Byte2Option optionRewindBufferSize(CFGKEY_REWIND_BUFFER_SIZE, 0, 0, optionIsValidWithMax<512>); // in MiB, 0 disables rewind
+Byte1Option optionRewindInterval(CFGKEY_REWIND_INTERVAL, 2, 0, optionIsValidWithMinMax<1, 30>); // frames between snapshots
+Byte1Option optionRunAheadFrames(CFGKEY_RUN_AHEAD_FRAMES, 0, 0, optionIsValidWithMax<4>); // 0 disables run-ahead
+Byte2Option optionArchiveCacheSize(CFGKEY_ARCHIVE_CACHE_SIZE, 0, 0, optionIsValidWithMax<2048>); // in MiB, 0 disables caching decompressed archive entries
 #ifdef CONFIG_INPUT_DEVICE_HOTSWAP
 Byte1Option optionNotifyInputDeviceChange(CFGKEY_NOTIFY_INPUT_DEVICE_CHANGE, Config::Input::DEVICE_HOTSWAP, !Config::Input::DEVICE_HOTSWAP);
 #endif
@@ -221,6 +229,7 @@ Byte1Option optionFrameInterval
 	{CFGKEY_FRAME_INTERVAL,	1, !Config::envIsIOS, optionIsValidWithMinMax<1, 4>};
 #endif
 Byte1Option optionSkipLateFrames{CFGKEY_SKIP_LATE_FRAMES, 1, 0};
+Byte1Option optionShowFramePacingStats{CFGKEY_SHOW_FRAME_PACING_STATS, 0, 0};
 DoubleOption optionFrameRate{CFGKEY_FRAME_RATE, 0, 0, optionFrameTimeIsValid};
 DoubleOption optionFrameRatePAL{CFGKEY_FRAME_RATE_PAL, 1./50., !EmuSystem::hasPALVideoSystem, optionFrameTimePALIsValid};
 
@@ -348,7 +357,9 @@ void initOptions()
 	}
 	#endif
 
-	if(!Base::Screen::screen(0)->frameRateIsReliable())
+	// no screen exists when running headless
+	if(auto screen = Base::Screen::screen(0);
+		!screen || !screen->frameRateIsReliable())
 	{
 		optionFrameRate.initDefault(60);
 	}
@@ -79,7 +79,10 @@ enum { CFGKEY_SOUND = 0, CFGKEY_TOUCH_CONTROL_DISPLAY = 1,
 	CFGKEY_SUSTAINED_PERFORMANCE_MODE = 80, CFGKEY_SHOW_BLUETOOTH_SCAN = 81,
 	CFGKEY_ADD_SOUND_BUFFERS_ON_UNDERRUN = 82, CFGKEY_VIDEO_IMAGE_BUFFERS = 83,
 	CFGKEY_AUDIO_API = 84, CFGKEY_SOUND_VOLUME = 85,
-	CFGKEY_CONSUME_UNBOUND_GAMEPAD_KEYS = 86
+	CFGKEY_CONSUME_UNBOUND_GAMEPAD_KEYS = 86, CFGKEY_REWIND_BUFFER_SIZE = 87,
+	CFGKEY_REWIND_INTERVAL = 88, CFGKEY_AUDIO_RESAMPLER_QUALITY = 89,
+	CFGKEY_AUDIO_DYNAMIC_RATE_CONTROL = 90, CFGKEY_SHOW_FRAME_PACING_STATS = 91,
+	CFGKEY_RUN_AHEAD_FRAMES = 92, CFGKEY_ARCHIVE_CACHE_SIZE = 93
 	// 256+ is reserved
 };
 
@@ -112,6 +115,8 @@ extern Byte1Option optionSound;
 extern Byte1Option optionSoundVolume;
 extern Byte1Option optionSoundBuffers;
 extern Byte1Option optionAddSoundBuffersOnUnderrun;
+extern Byte1Option optionAudioResamplerQuality;
+extern Byte1Option optionAudioDynamicRateControl;
 #ifdef CONFIG_AUDIO_MANAGER_SOLO_MIX
 using OptionAudioSoloMix = Option<OptionMethodFunc<bool, IG::AudioManager::soloMix, IG::AudioManager::setSoloMix>, uint8_t>;
 extern OptionAudioSoloMix optionAudioSoloMix;
@@ -135,6 +140,10 @@ extern OptionSwappedGamepadConfirm optionSwappedGamepadConfirm;
 extern Byte1Option optionConsumeUnboundGamepadKeys;
 extern Byte1Option optionConfirmOverwriteState;
 extern Byte1Option optionFastForwardSpeed;
+extern Byte2Option optionRewindBufferSize;
+extern Byte1Option optionRewindInterval;
+extern Byte1Option optionRunAheadFrames;
+extern Byte2Option optionArchiveCacheSize;
 #ifdef CONFIG_INPUT_DEVICE_HOTSWAP
 extern Byte1Option optionNotifyInputDeviceChange;
 #endif
@@ -191,6 +200,7 @@ extern OptionVControllerLayoutPosition optionVControllerLayoutPos;
 extern Byte1Option optionFrameInterval;
 #endif
 extern Byte1Option optionSkipLateFrames;
+extern Byte1Option optionShowFramePacingStats;
 extern DoubleOption optionFrameRate;
 extern DoubleOption optionFrameRatePAL;
 extern DoubleOption optionRefreshRateOverride;
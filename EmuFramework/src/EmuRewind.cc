@@ -0,0 +1,349 @@
+/*  This file is part of EmuFramework.
+
+	Imagine is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	Imagine is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with EmuFramework.  If not, see <http://www.gnu.org/licenses/> */
+
+#define LOGTAG "EmuRewind"
+#include "EmuRewind.hh"
+#include <emuframework/EmuSystem.hh>
+#include <imagine/logger/logger.h>
+#include <imagine/util/algorithm.h>
+#include <cstring>
+
+// Delta format: repeated (zero run length, literal length, literal bytes) tokens with
+// lengths as LEB128 varints. Runs are found a word at a time since consecutive states
+// mostly differ in a few scattered regions. The tokens are then raw deflated at the
+// fastest level since the literals are XORs of mostly small changes and compress well.
+
+static uint64_t loadWord(const uint8_t *p)
+{
+	uint64_t w;
+	memcpy(&w, p, sizeof(w));
+	return w;
+}
+
+static void putVarint(IG::ByteBuffer &out, size_t val)
+{
+	uint8_t bytes[10];
+	uint32_t len = 0;
+	do
+	{
+		uint8_t b = val & 0x7F;
+		val >>= 7;
+		bytes[len++] = val ? (b | 0x80) : b;
+	} while(val);
+	out.append(bytes, len);
+}
+
+static bool getVarint(const uint8_t *&p, const uint8_t *end, size_t &val)
+{
+	val = 0;
+	for(uint32_t shift = 0; p != end && shift < 64; shift += 7)
+	{
+		uint8_t b = *p++;
+		val |= size_t(b & 0x7F) << shift;
+		if(!(b & 0x80))
+			return true;
+	}
+	return false;
+}
+
+static void appendXor(IG::ByteBuffer &out, const uint8_t *a, const uint8_t *b, size_t words)
+{
+	auto offset = out.size();
+	out.resize(offset + words * 8);
+	auto dest = out.data() + offset;
+	iterateTimes(words, i)
+	{
+		uint64_t w = loadWord(a + i * 8) ^ loadWord(b + i * 8);
+		memcpy(dest + i * 8, &w, 8);
+	}
+}
+
+// encodes the bytes needed to rebuild older from newer
+static void encodeXorDelta(IG::ByteBuffer &out, const uint8_t *older, size_t olderSize,
+	const uint8_t *newer, size_t newerSize)
+{
+	out.clear();
+	const size_t wordEnd = std::min(olderSize, newerSize) & ~size_t(7);
+	size_t i = 0;
+	while(i < wordEnd)
+	{
+		auto zeroStart = i;
+		while(i < wordEnd && loadWord(older + i) == loadWord(newer + i))
+			i += 8;
+		auto litStart = i;
+		while(i < wordEnd && loadWord(older + i) != loadWord(newer + i))
+			i += 8;
+		putVarint(out, litStart - zeroStart);
+		putVarint(out, i - litStart);
+		appendXor(out, older + litStart, newer + litStart, (i - litStart) / 8);
+	}
+	if(wordEnd < olderSize)
+	{
+		// unaligned tail or bytes past the end of the newer state
+		putVarint(out, 0);
+		putVarint(out, olderSize - wordEnd);
+		auto offset = out.size();
+		out.resize(offset + olderSize - wordEnd);
+		for(size_t j = wordEnd; j < olderSize; j++)
+		{
+			out[offset++] = older[j] ^ (j < newerSize ? newer[j] : 0);
+		}
+	}
+}
+
+static bool applyXorDelta(uint8_t *state, size_t stateSize, const uint8_t *delta, size_t deltaSize)
+{
+	auto p = delta;
+	auto end = delta + deltaSize;
+	size_t i = 0;
+	while(p != end)
+	{
+		size_t zeros, lits;
+		if(!getVarint(p, end, zeros) || !getVarint(p, end, lits))
+			return false;
+		i += zeros;
+		if(i > stateSize || lits > stateSize - i || lits > size_t(end - p))
+			return false;
+		iterateTimes(lits, j)
+		{
+			state[i + j] ^= p[j];
+		}
+		i += lits;
+		p += lits;
+	}
+	return true;
+}
+
+EmuRewind::~EmuRewind()
+{
+	endDeflater();
+}
+
+void EmuRewind::endDeflater()
+{
+	if(!deflaterInit)
+		return;
+	deflateEnd(&deflater);
+	deflaterInit = false;
+}
+
+void EmuRewind::setBufferSize(size_t bytes)
+{
+	if(bytes == ringSize)
+		return;
+	reset();
+	ring.reset();
+	ringSize = bytes;
+	if(bytes)
+	{
+		ring = std::make_unique<uint8_t[]>(bytes);
+		logMsg("allocated %zuKB snapshot buffer", bytes / 1024);
+	}
+	else
+	{
+		// release the scratch buffers too since they're sized to the current system's states
+		lastState = {};
+		newState = {};
+		delta = {};
+		packedDelta = {};
+		endDeflater();
+	}
+}
+
+void EmuRewind::setInterval(uint8_t frames)
+{
+	interval = frames ? frames : 1;
+}
+
+void EmuRewind::reset()
+{
+	if(snapshotsTaken)
+		logStats();
+	entries.clear();
+	usedBytes = 0;
+	lastState.clear();
+	frameCount = 0;
+	snapshotsTaken = 0;
+	deltaBytesTotal = 0;
+	packedBytesTotal = 0;
+	snapshotTimeTotal = {};
+}
+
+void EmuRewind::addFrames(uint32_t frames)
+{
+	if(!ringSize)
+		return;
+	frameCount += frames;
+	if(frameCount < interval)
+		return;
+	frameCount = 0;
+	capture();
+}
+
+void EmuRewind::capture()
+{
+	auto startTime = IG::steadyClockTimestamp();
+	if(auto err = EmuSystem::saveState(newState);
+		err)
+	{
+		logErr("error taking snapshot:%s", err->what());
+		return;
+	}
+	if(lastState)
+	{
+		encodeXorDelta(delta, lastState.data(), lastState.size(), newState.data(), newState.size());
+		auto &stored = packDelta() ? packedDelta : delta;
+		if(!push(stored, delta.size(), lastState.size()))
+			return;
+		deltaBytesTotal += delta.size();
+		packedBytesTotal += stored.size();
+	}
+	std::swap(lastState, newState);
+	snapshotTimeTotal += IG::steadyClockTimestamp() - startTime;
+	if(++snapshotsTaken % 600 == 0)
+		logStats();
+}
+
+// deflates delta into packedDelta, returns false if it didn't get any smaller
+bool EmuRewind::packDelta()
+{
+	if(!deflaterInit)
+	{
+		if(deflateInit2(&deflater, Z_BEST_SPEED, Z_DEFLATED, -MAX_WBITS, 8, Z_DEFAULT_STRATEGY) != Z_OK)
+		{
+			logErr("error initializing deflate");
+			return false;
+		}
+		deflaterInit = true;
+	}
+	else
+	{
+		deflateReset(&deflater);
+	}
+	packedDelta.resize(deflateBound(&deflater, delta.size()));
+	deflater.next_in = delta.data();
+	deflater.avail_in = delta.size();
+	deflater.next_out = packedDelta.data();
+	deflater.avail_out = packedDelta.size();
+	if(deflate(&deflater, Z_FINISH) != Z_STREAM_END)
+		return false;
+	packedDelta.resize(deflater.total_out);
+	return packedDelta.size() < delta.size();
+}
+
+static bool inflateDelta(IG::ByteBuffer &out, size_t size, const uint8_t *packed, size_t packedSize)
+{
+	z_stream strm{};
+	if(inflateInit2(&strm, -MAX_WBITS) != Z_OK)
+		return false;
+	out.resize(size);
+	strm.next_in = (Bytef*)packed;
+	strm.avail_in = packedSize;
+	strm.next_out = out.data();
+	strm.avail_out = size;
+	auto result = inflate(&strm, Z_FINISH);
+	inflateEnd(&strm);
+	return result == Z_STREAM_END && !strm.avail_out;
+}
+
+bool EmuRewind::push(const IG::ByteBuffer &data, size_t deltaSize, size_t stateSize)
+{
+	if(data.size() > ringSize)
+	{
+		logWarn("delta of %zu bytes doesn't fit in snapshot buffer", data.size());
+		return false;
+	}
+	size_t offset = entries.size() ? entries.back().offset + entries.back().size : 0;
+	if(offset + data.size() > ringSize)
+		offset = 0;
+	// entries are laid out oldest first from the write position so only the front can overlap
+	while(entries.size())
+	{
+		auto &oldest = entries.front();
+		if(oldest.offset >= offset + data.size() || oldest.offset + oldest.size <= offset)
+			break;
+		usedBytes -= oldest.size;
+		entries.pop_front();
+	}
+	memcpy(&ring[offset], data.data(), data.size());
+	entries.push_back({offset, (uint32_t)data.size(), (uint32_t)deltaSize, (uint32_t)stateSize});
+	usedBytes += data.size();
+	return true;
+}
+
+bool EmuRewind::stepBack()
+{
+	if(!lastState)
+		return false;
+	if(entries.size())
+	{
+		auto entry = entries.back();
+		auto newerSize = lastState.size();
+		lastState.resize(entry.stateSize);
+		if(entry.stateSize > newerSize)
+			std::fill(lastState.begin() + newerSize, lastState.end(), 0);
+		const uint8_t *deltaData = &ring[entry.offset];
+		if(entry.size != entry.deltaSize)
+		{
+			if(!inflateDelta(delta, entry.deltaSize, deltaData, entry.size))
+			{
+				logErr("corrupt delta in snapshot buffer");
+				reset();
+				return false;
+			}
+			deltaData = delta.data();
+		}
+		if(!applyXorDelta(lastState.data(), lastState.size(), deltaData, entry.deltaSize))
+		{
+			logErr("corrupt delta in snapshot buffer");
+			reset();
+			return false;
+		}
+		usedBytes -= entry.size;
+		entries.pop_back();
+	}
+	frameCount = 0;
+	if(auto err = EmuSystem::loadState(lastState.view());
+		err)
+	{
+		logErr("error restoring snapshot:%s", err->what());
+		reset();
+		return false;
+	}
+	return true;
+}
+
+EmuRewind::Stats EmuRewind::stats() const
+{
+	auto deltas = snapshotsTaken ? snapshotsTaken - 1 : 0;
+	return
+	{
+		entries.size() + (lastState ? 1 : 0),
+		usedBytes + lastState.size(),
+		ringSize,
+		lastState.size(),
+		deltas ? deltaBytesTotal / deltas : 0,
+		deltas ? packedBytesTotal / deltas : 0,
+		snapshotsTaken ? snapshotTimeTotal / snapshotsTaken : IG::Time{}
+	};
+}
+
+void EmuRewind::logStats() const
+{
+	auto s = stats();
+	logMsg("%zu snapshots using %zuKB of %zuKB, state:%zuKB avg delta:%zu bytes (%zu deflated) avg cost:%.3fms",
+		s.snapshots, s.bytesUsed / 1024, s.capacity / 1024, s.stateSize / 1024, s.avgDeltaSize, s.avgPackedSize,
+		std::chrono::duration_cast<IG::FloatSeconds>(s.avgSnapshotTime).count() * 1000.);
+}
@@ -0,0 +1,83 @@
+#pragma once
+
+/*  This file is part of EmuFramework.
+
+	Imagine is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	Imagine is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with EmuFramework.  If not, see <http://www.gnu.org/licenses/> */
+
+#include <imagine/util/ByteBuffer.hh>
+#include <imagine/time/Time.hh>
+#include <memory>
+#include <deque>
+#include <zlib.h>
+
+// Keeps the most recent snapshot in full and older ones as XOR deltas against their
+// successor, run-length encoded then deflated, inside a fixed-size ring, evicting the
+// oldest when full.
+class EmuRewind
+{
+public:
+	~EmuRewind();
+
+	struct Stats
+	{
+		size_t snapshots;
+		size_t bytesUsed;
+		size_t capacity;
+		size_t stateSize;
+		size_t avgDeltaSize;
+		size_t avgPackedSize;
+		IG::Time avgSnapshotTime;
+	};
+
+	void setBufferSize(size_t bytes);
+	void setInterval(uint8_t frames);
+	void reset();
+	void addFrames(uint32_t frames);
+	bool stepBack();
+	bool isEnabled() const { return ringSize; }
+	Stats stats() const;
+
+protected:
+	struct Entry
+	{
+		size_t offset;
+		uint32_t size;
+		uint32_t deltaSize; // size before deflating, equal to size if stored as is
+		uint32_t stateSize;
+	};
+
+	std::unique_ptr<uint8_t[]> ring{};
+	size_t ringSize = 0;
+	size_t usedBytes = 0;
+	std::deque<Entry> entries{};
+	IG::ByteBuffer lastState{};
+	IG::ByteBuffer newState{};
+	IG::ByteBuffer delta{};
+	IG::ByteBuffer packedDelta{};
+	z_stream deflater{};
+	bool deflaterInit = false;
+	uint32_t frameCount = 0;
+	uint8_t interval = 1;
+	// running totals for stats()
+	uint32_t snapshotsTaken = 0;
+	size_t deltaBytesTotal = 0;
+	size_t packedBytesTotal = 0;
+	IG::Time snapshotTimeTotal{};
+
+	void capture();
+	bool packDelta();
+	bool push(const IG::ByteBuffer &data, size_t deltaSize, size_t stateSize);
+	void endDeflater();
+	void logStats() const;
+};
@@ -0,0 +1,122 @@
+/*  This file is part of EmuFramework.
+
+	Imagine is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	Imagine is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with EmuFramework.  If not, see <http://www.gnu.org/licenses/> */
+
+#define LOGTAG "EmuRunAhead"
+#include "EmuRunAhead.hh"
+#include <emuframework/EmuSystem.hh>
+#include <imagine/logger/logger.h>
+#include <imagine/util/algorithm.h>
+
+static double toMSecs(IG::Time t)
+{
+	return std::chrono::duration_cast<IG::FloatSeconds>(t).count() * 1000.;
+}
+
+void EmuRunAhead::setFrames(uint8_t frames_)
+{
+	reset();
+	frames = frames_;
+	if(!frames)
+	{
+		// release the snapshot since it's sized to the current system
+		state = {};
+	}
+}
+
+void EmuRunAhead::reset()
+{
+	if(measuredFrames)
+		logStats();
+	state.clear();
+	saveTimeTotal = {};
+	loadTimeTotal = {};
+	totalTimeTotal = {};
+	measuredFrames = 0;
+	viable = true;
+}
+
+bool EmuRunAhead::runFrame(EmuSystemTask *task, EmuVideo *video, EmuAudio *audio)
+{
+	if(!isActive())
+		return false;
+	auto startTime = IG::steadyClockTimestamp();
+	EmuSystem::runFrame(task, nullptr, audio);
+	auto saveStartTime = IG::steadyClockTimestamp();
+	if(auto err = EmuSystem::saveState(state);
+		err)
+	{
+		logErr("error taking snapshot:%s, disabling", err->what());
+		viable = false;
+		return true;
+	}
+	auto saveTime = IG::steadyClockTimestamp() - saveStartTime;
+	iterateTimes(frames - 1, i)
+	{
+		EmuSystem::runFrame(task, nullptr, nullptr);
+	}
+	EmuSystem::runFrame(task, video, nullptr);
+	auto loadStartTime = IG::steadyClockTimestamp();
+	if(auto err = EmuSystem::loadState(state.view());
+		err)
+	{
+		logErr("error restoring snapshot:%s, disabling", err->what());
+		viable = false;
+		return true;
+	}
+	auto endTime = IG::steadyClockTimestamp();
+	if(measuredFrames < MEASURE_FRAMES)
+	{
+		saveTimeTotal += saveTime;
+		loadTimeTotal += endTime - loadStartTime;
+		totalTimeTotal += endTime - startTime;
+		if(++measuredFrames == MEASURE_FRAMES)
+			checkViability();
+	}
+	return true;
+}
+
+void EmuRunAhead::checkViability()
+{
+	auto s = stats();
+	auto budget = std::chrono::duration_cast<IG::Time>(EmuSystem::frameTime() * MAX_FRAME_TIME_FRACTION);
+	if(s.avgTotalTime > budget)
+	{
+		logWarn("%u frame run-ahead needs %.3fms of %.3fms budget, disabling",
+			frames, toMSecs(s.avgTotalTime), toMSecs(budget));
+		viable = false;
+	}
+	logStats();
+}
+
+EmuRunAhead::Stats EmuRunAhead::stats() const
+{
+	if(!measuredFrames)
+		return {state.size()};
+	return
+	{
+		state.size(),
+		saveTimeTotal / measuredFrames,
+		loadTimeTotal / measuredFrames,
+		totalTimeTotal / measuredFrames
+	};
+}
+
+void EmuRunAhead::logStats() const
+{
+	auto s = stats();
+	logMsg("%u frame(s) ahead, state:%zuKB avg save:%.3fms load:%.3fms total:%.3fms over %u frames",
+		frames, s.stateSize / 1024, toMSecs(s.avgSaveTime), toMSecs(s.avgLoadTime),
+		toMSecs(s.avgTotalTime), measuredFrames);
+}
@@ -0,0 +1,63 @@
+#pragma once
+
+/*  This file is part of EmuFramework.
+
+	Imagine is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	Imagine is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with EmuFramework.  If not, see <http://www.gnu.org/licenses/> */
+
+#include <imagine/util/ByteBuffer.hh>
+#include <imagine/time/Time.hh>
+
+class EmuSystemTask;
+class EmuVideo;
+class EmuAudio;
+
+// Hides a game's built-in input lag by presenting a frame from the future. The real
+// frame runs with audio but no video, the system is snapshotted, the speculative
+// frames run with the same input and the last one is shown, then the snapshot is
+// restored. The restore happens after the video frame is handed off so it overlaps
+// with the main thread presenting it.
+class EmuRunAhead
+{
+public:
+	struct Stats
+	{
+		size_t stateSize;
+		IG::Time avgSaveTime;
+		IG::Time avgLoadTime;
+		IG::Time avgTotalTime; // everything done for one displayed frame
+	};
+
+	void setFrames(uint8_t frames);
+	void reset();
+	bool isActive() const { return frames && viable; }
+	bool runFrame(EmuSystemTask *task, EmuVideo *video, EmuAudio *audio);
+	Stats stats() const;
+
+protected:
+	// frames timed before deciding if the system is fast enough
+	static constexpr uint32_t MEASURE_FRAMES = 120;
+	// fraction of the frame time run-ahead may use, leaving the rest for presenting
+	static constexpr double MAX_FRAME_TIME_FRACTION = .75;
+
+	IG::ByteBuffer state{};
+	IG::Time saveTimeTotal{};
+	IG::Time loadTimeTotal{};
+	IG::Time totalTimeTotal{};
+	uint32_t measuredFrames = 0;
+	uint8_t frames = 0;
+	bool viable = true;
+
+	void checkViability();
+	void logStats() const;
+};
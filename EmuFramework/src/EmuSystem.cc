@@ -25,11 +25,19 @@
 #include <imagine/util/utility.h>
 #include <imagine/util/math/int.hh>
 #include <imagine/util/ScopeGuard.hh>
+#include <imagine/util/fd-utils.h>
 #include <algorithm>
 #include <string>
+#include <vector>
+#include <sys/mman.h>
+#include <fcntl.h>
 #include "private.hh"
 #include "privateInput.hh"
 #include "EmuTiming.hh"
+#include "EmuRewind.hh"
+#include "EmuRunAhead.hh"
+#include "EmuInputMovie.hh"
+#include "EmuArchiveCache.hh"
 
 EmuSystem::State EmuSystem::state = EmuSystem::State::OFF;
 FS::PathString EmuSystem::gamePath_{};
@@ -62,6 +70,9 @@ IG::FloatSeconds EmuSystem::frameTimePAL{1./50.};
 [[gnu::weak]] bool EmuSystem::handlesArchiveFiles = false;
 [[gnu::weak]] bool EmuSystem::handlesGenericIO = true;
 [[gnu::weak]] bool EmuSystem::hasCheats = false;
+[[gnu::weak]] bool EmuSystem::hasRunAhead = false;
+[[gnu::weak]] bool EmuSystem::hasRewind = false;
+[[gnu::weak]] bool EmuSystem::hasMemoryStates = false;
 [[gnu::weak]] bool EmuSystem::hasSound = true;
 [[gnu::weak]] int EmuSystem::forcedSoundRate = 0;
 [[gnu::weak]] IG::Audio::SampleFormat EmuSystem::audioSampleFormat = IG::Audio::SampleFormats::i16;
@@ -71,6 +82,20 @@ double EmuSystem::audioFramesPerVideoFrameFloat = 0;
 double EmuSystem::currentAudioFramesPerVideoFrame = 0;
 uint32_t EmuSystem::audioFramesPerVideoFrame = 0;
 static EmuTiming emuTiming{};
+static EmuRewind emuRewind{};
+static EmuRunAhead emuRunAhead{};
+static EmuArchiveCache emuArchiveCache{};
+
+// set while loadGame() reads straight from an uncompressed file
+static const char *mappableGamePath{};
+
+// ranges mapGameFile() replaced, given back as anonymous memory when the game closes
+struct GameFileMapping
+{
+	void *addr;
+	size_t size;
+};
+static std::vector<GameFileMapping> gameFileMappings{};
 
 static IG::Microseconds makeWantedAudioLatencyUSecs(uint8_t buffers)
 {
@@ -283,6 +308,48 @@ FS::PathString EmuSystem::baseDefaultGameSavePath()
 	return FS::makePathStringPrintf("%s/Game Data/%s", Base::sharedStoragePath().data(), shortSystemName());
 }
 
+size_t EmuSystem::mapGameFile(IO &io, void *addr, size_t maxSize)
+{
+	if(!mappableGamePath || !io.mmapConst())
+		return 0;
+	size_t pageSize = sysconf(_SC_PAGESIZE);
+	if((uintptr_t)addr & (pageSize - 1))
+	{
+		logWarn("can't map game file to unaligned address:%p", addr);
+		return 0;
+	}
+	int fd = ::open(mappableGamePath, O_RDONLY);
+	if(fd == -1)
+		return 0;
+	auto closeFd = IG::scopeGuard([&](){ ::close(fd); });
+	off_t fileSize = fd_size(fd);
+	if(fileSize <= 0 || (size_t)fileSize != io.size())
+		return 0;
+	size_t size = std::min((size_t)fileSize, maxSize) & ~(pageSize - 1);
+	if(!size)
+		return 0;
+	if(mmap(addr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_FIXED, fd, 0) == MAP_FAILED)
+	{
+		logErr("error mapping game file to %p", addr);
+		// a failed fixed mapping may have removed what was there
+		mmap(addr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_FIXED, -1, 0);
+		return 0;
+	}
+	gameFileMappings.push_back({addr, size});
+	io.seekS(size);
+	logMsg("mapped %zu bytes of game file to %p", size, addr);
+	return size;
+}
+
+static void unmapGameFiles()
+{
+	for(auto m : gameFileMappings)
+	{
+		mmap(m.addr, m.size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_FIXED, -1, 0);
+	}
+	gameFileMappings.clear();
+}
+
 void EmuSystem::closeRuntimeSystem(bool allowAutosaveState)
 {
 	if(gameIsRunning())
@@ -293,9 +360,18 @@ void EmuSystem::closeRuntimeSystem(bool allowAutosaveState)
 		EmuApp::saveSessionOptions();
 		logMsg("closing game %s", gameName_.data());
 		closeSystem();
+		emuRewind.setBufferSize(0);
+		emuRunAhead.setFrames(0);
+		if(auto err = emuInputMovie.stopRecording();
+			err)
+		{
+			logErr("error saving input movie:%s", err->what());
+		}
+		emuInputMovie.stop();
 		cancelAutoSaveStateTimer();
 		state = State::OFF;
 	}
+	unmapGameFiles();
 	clearGamePaths();
 }
 
@@ -317,6 +393,9 @@ void EmuSystem::start()
 	state = State::ACTIVE;
 	clearInputBuffers(emuViewController().inputView());
 	resetFrameTime();
+	emuRewind.setBufferSize(hasRewind ? optionRewindBufferSize * 1024 * 1024 : 0);
+	emuRewind.setInterval(optionRewindInterval);
+	emuRunAhead.setFrames(hasRunAhead ? (uint8_t)optionRunAheadFrames : 0);
 	emuAudio.start(makeWantedAudioLatencyUSecs(optionSoundBuffers), makeWantedAudioLatencyUSecs(1));
 	startAutoSaveStateTimer();
 }
@@ -337,7 +416,7 @@ void EmuSystem::skipFrames(EmuSystemTask *task, uint32_t frames, EmuAudio *audio
 	assumeExpr(gameIsRunning());
 	iterateTimes(frames, i)
 	{
-		turboActions.update();
+		updateFrameInput();
 		runFrame(task, nullptr, audio);
 	}
 }
@@ -356,6 +435,45 @@ bool EmuSystem::skipForwardFrames(EmuSystemTask *task, uint32_t frames)
 	return true;
 }
 
+bool EmuSystem::rewindFrame(EmuSystemTask *task, EmuVideo *video)
+{
+	assumeExpr(gameIsRunning());
+	if(!emuRewind.isEnabled() || emuInputMovie.isActive())
+		return false;
+	// audio stays muted while stepping backwards
+	emuRewind.stepBack();
+	runFrame(task, video, nullptr);
+	return true;
+}
+
+void EmuSystem::recordRewindFrames(uint32_t frames)
+{
+	emuRewind.addFrames(frames);
+}
+
+void EmuSystem::dispatchInputAction(uint state, uint emuKey)
+{
+	if(unlikely(emuInputMovie.isActive()))
+	{
+		// applied on the emulation thread at the next frame boundary
+		emuInputMovie.queueInput(state, emuKey);
+		return;
+	}
+	handleInputAction(state, emuKey);
+}
+
+void EmuSystem::updateFrameInput()
+{
+	turboActions.update();
+	emuInputMovie.update();
+}
+
+bool EmuSystem::runAheadFrame(EmuSystemTask *task, EmuVideo *video, EmuAudio *audio)
+{
+	assumeExpr(gameIsRunning());
+	return emuRunAhead.runFrame(task, video, audio);
+}
+
 void EmuSystem::configFrameTime(uint32_t rate)
 {
 	auto fTime = frameTime();
@@ -497,6 +615,8 @@ EmuSystem::Error EmuSystem::loadGameFromPath(const char *pathStr, EmuSystemCreat
 	{
 		return makeError("Error opening file: %s", ec.message().c_str());
 	}
+	mappableGamePath = path.data();
+	auto clearMappablePath = IG::scopeGuard([&](){ mappableGamePath = {}; });
 	return loadGameFromFile(io.makeGeneric(), path.data(), params, onLoadProgress);
 }
 
@@ -505,22 +625,95 @@ EmuSystem::Error EmuSystem::loadGameFromFile(GenericIO file, const char *name, E
 	Error err;
 	if(EmuApp::hasArchiveExtension(name))
 	{
-		ArchiveIO io{};
-		std::error_code ec{};
+		GenericIO io{};
 		FS::FileString originalName{};
-		for(auto &entry : FS::ArchiveIterator{std::move(file), ec})
+		FS::PathString cachedEntryPath{};
+		// name is only a file on disk when called from loadGameFromPath(), content URIs and
+		// other generic IO can't be re-opened by name, so they skip the index and cache
+		const char *archivePath = mappableGamePath;
+		emuArchiveCache.setMaxSize((uint64_t)optionArchiveCacheSize * 1024 * 1024);
+		// returns the entry's decompressed copy from the cache, otherwise where to store it
+		auto openCachedEntry =
+			[&](uint32_t crc32, uint64_t size) -> GenericIO
+			{
+				if(!archivePath)
+					return {};
+				cachedEntryPath = emuArchiveCache.entryPath(archivePath, crc32, size);
+				if(!strlen(cachedEntryPath.data()))
+					return {};
+				auto cachedIO = emuArchiveCache.open(cachedEntryPath, size);
+				auto stats = emuArchiveCache.stats();
+				logMsg("archive cache %s (%u hits, %u misses)", cachedIO ? "hit" : "miss", stats.hits, stats.misses);
+				if(!cachedIO)
+					return {};
+				return cachedIO.makeGeneric();
+			};
+		auto cacheEntry =
+			[&](IO &entryIO)
+			{
+				if(strlen(cachedEntryPath.data()) && !emuArchiveCache.store(cachedEntryPath, entryIO))
+					cachedEntryPath = {};
+			};
+		// zips on disk go straight to the entry through their central directory
+		if(auto index = archivePath ? FS::archiveIndex(archivePath) : nullptr;
+			index)
 		{
-			if(entry.type() == FS::file_type::directory)
+			for(auto &entry : index->entries())
 			{
-				continue;
+				if(entry.type() == FS::file_type::directory)
+				{
+					continue;
+				}
+				logMsg("archive file entry:%s", entry.name.c_str());
+				if(EmuSystem::defaultFsFilter(entry.name.c_str()))
+				{
+					// stored entries are already read in place from the mapped archive
+					if(entry.isCompressed())
+						io = openCachedEntry(entry.crc32, entry.size);
+					if(!io)
+					{
+						if(auto entryIO = index->open(entry);
+							entryIO)
+						{
+							if(entry.isCompressed())
+								cacheEntry(entryIO);
+							io = entryIO.makeGeneric();
+						}
+					}
+					if(io)
+						string_copy(originalName, entry.name.c_str());
+					break;
+				}
 			}
-			auto name = entry.name();
-			logMsg("archive file entry:%s", name);
-			if(EmuSystem::defaultFsFilter(name))
+		}
+		std::error_code ec{};
+		if(!io)
+		{
+			for(auto &entry : FS::ArchiveIterator{std::move(file), ec})
 			{
-				string_copy(originalName, name);
-				io = entry.moveIO();
-				break;
+				if(entry.type() == FS::file_type::directory)
+				{
+					continue;
+				}
+				auto name = entry.name();
+				logMsg("archive file entry:%s", name);
+				if(EmuSystem::defaultFsFilter(name))
+				{
+					string_copy(originalName, name);
+					io = openCachedEntry(entry.crc32(), entry.size());
+					if(!io && strlen(cachedEntryPath.data()))
+					{
+						auto entryIO = entry.moveIO().moveToMapIO();
+						if(entryIO)
+							cacheEntry(entryIO);
+						io = entryIO.makeGeneric();
+					}
+					else if(!io)
+					{
+						io = entry.moveIO().makeGeneric();
+					}
+					break;
+				}
 			}
 		}
 		if(ec)
@@ -535,6 +728,9 @@ EmuSystem::Error EmuSystem::loadGameFromFile(GenericIO file, const char *name, E
 		}
 		closeAndSetupNew(name);
 		originalGameName_ = originalName;
+		// the entry isn't the file at mappableGamePath, but a cached copy of it can be mapped
+		mappableGamePath = strlen(cachedEntryPath.data()) ? cachedEntryPath.data() : nullptr;
+		auto clearMappablePath = IG::scopeGuard([&](){ mappableGamePath = {}; });
 		err = EmuSystem::loadGame(io, params, onLoadProgress);
 	}
 	else
@@ -544,6 +740,7 @@ EmuSystem::Error EmuSystem::loadGameFromFile(GenericIO file, const char *name, E
 	}
 	if(err)
 	{
+		unmapGameFiles();
 		clearGamePaths();
 	}
 	return err;
@@ -616,6 +813,17 @@ void EmuSystem::sessionOptionSet()
 	sessionOptionsSet = true;
 }
 
+// only called when hasMemoryStates is set
+[[gnu::weak]] EmuSystem::Error EmuSystem::saveState(IG::ByteBuffer &buff)
+{
+	return makeError("In-memory states aren't supported");
+}
+
+[[gnu::weak]] EmuSystem::Error EmuSystem::loadState(IG::ConstBufferView buff)
+{
+	return makeError("In-memory states aren't supported");
+}
+
 [[gnu::weak]] EmuSystem::Error EmuSystem::onInit() { return {}; }
 
 [[gnu::weak]] void EmuSystem::initOptions() {}
@@ -658,3 +866,7 @@ void EmuSystem::sessionOptionSet()
 [[gnu::weak]] void EmuSystem::writeSessionConfig(IO &io) {}
 
 [[gnu::weak]] bool EmuSystem::readSessionConfig(IO &io, uint key, uint readSize) { return false; }
+
+[[gnu::weak]] void EmuSystem::writeFrameTrace(IO &io) {}
+
+[[gnu::weak]] void EmuSystem::printBenchmarkStats() {}
@@ -27,6 +27,7 @@
 #include <emuframework/InputManagerView.hh>
 #include <emuframework/BundledGamesView.hh>
 #include "private.hh"
+#include "EmuInputMovie.hh"
 
 class ResetAlertView : public BaseAlertView
 {
@@ -91,6 +92,9 @@ void EmuSystemActionsView::onShow()
 	loadState.setActive(EmuSystem::gameIsRunning() && EmuSystem::stateExists(EmuSystem::saveStateSlot));
 	stateSlot.compile(makeStateSlotStr(EmuSystem::saveStateSlot).data(), renderer(), projP);
 	screenshot.setActive(EmuSystem::gameIsRunning());
+	framePacingTrace.setActive(EmuSystem::gameIsRunning());
+	inputMovie.compile(emuInputMovie.isRecording() ? "Stop Input Recording" : "Record Input Movie", renderer(), projP);
+	inputMovie.setActive(EmuSystem::gameIsRunning());
 	#ifdef CONFIG_EMUFRAMEWORK_ADD_LAUNCHER_ICON
 	addLauncherIcon.setActive(EmuSystem::gameIsRunning());
 	#endif
@@ -113,6 +117,11 @@ void EmuSystemActionsView::loadStandardItems()
 	item.emplace_back(&addLauncherIcon);
 	#endif
 	item.emplace_back(&screenshot);
+	item.emplace_back(&framePacingTrace);
+	if(EmuSystem::hasMemoryStates)
+	{
+		item.emplace_back(&inputMovie);
+	}
 	item.emplace_back(&resetSessionOptions);
 	item.emplace_back(&close);
 }
@@ -267,6 +276,61 @@ EmuSystemActionsView::EmuSystemActionsView(ViewAttachParams attach, bool customM
 			pushAndShowModal(std::move(ynAlertView), e);
 		}
 	},
+	framePacingTrace
+	{
+		"Save Frame Pacing Trace",
+		[this](Input::Event e)
+		{
+			if(!EmuSystem::gameIsRunning())
+				return;
+			auto &trace = emuViewController().framePacing();
+			if(!trace.size())
+			{
+				EmuApp::postMessage("No frames recorded yet");
+				return;
+			}
+			auto path = FS::makePathStringPrintf("%s/%s.framepacing.csv", EmuSystem::savePath(), EmuSystem::gameName().data());
+			if(trace.writeCSV(path.data(), emuAudio ? emuAudio.format().rate : 0))
+				EmuApp::printfMessage(3, false, "Wrote %u frames to %s", trace.size(), path.data());
+			else
+				EmuApp::printfMessage(3, true, "Error writing %s", path.data());
+		}
+	},
+	inputMovie
+	{
+		"Record Input Movie",
+		[this](Input::Event e)
+		{
+			if(!EmuSystem::gameIsRunning())
+				return;
+			if(emuInputMovie.isRecording())
+			{
+				auto frames = emuInputMovie.frames();
+				if(auto err = emuInputMovie.stopRecording();
+					err)
+				{
+					EmuApp::printfMessage(3, true, "Error saving input movie:\n%s", err->what());
+				}
+				else
+				{
+					EmuApp::printfMessage(3, false, "Saved %u frames of input", frames);
+				}
+			}
+			else
+			{
+				auto path = FS::makePathStringPrintf("%s/%s.emumovie", EmuSystem::savePath(), EmuSystem::gameName().data());
+				if(auto err = emuInputMovie.startRecording(path.data());
+					err)
+				{
+					EmuApp::printfMessage(3, true, "Error starting input movie:\n%s", err->what());
+					return;
+				}
+				EmuApp::postMessage("Recording input, resume to start");
+			}
+			inputMovie.compile(emuInputMovie.isRecording() ? "Stop Input Recording" : "Record Input Movie", renderer(), projP);
+			postDraw();
+		}
+	},
 	resetSessionOptions
 	{
 		"Reset Saved Options",
@@ -39,7 +39,8 @@ void EmuSystemTask::start()
 					}
 					bcase Reply::FRAME_FINISHED:
 					{
-						msg.args.videoFormat.videoAddr->dispatchFrameFinished();
+						lastFrameEmulationTime = msg.args.frameFinished.emulationTime;
+						msg.args.frameFinished.videoAddr->dispatchFrameFinished();
 					}
 					bcase Reply::TOOK_SCREENSHOT:
 					{
@@ -66,11 +67,16 @@ void EmuSystemTask::start()
 						{
 							bcase Command::RUN_FRAME:
 							{
+								frameStartTime = IG::steadyClockTimestamp();
 								auto frames = msg.args.run.frames;
 								assumeExpr(frames);
 								auto *video = msg.args.run.video;
 								auto *audio = msg.args.run.audio;
 								//logMsg("running %d frame(s)", frames);
+								if(unlikely(msg.args.run.rewind) && EmuSystem::rewindFrame(this, video))
+								{
+									continue;
+								}
 								if(unlikely(msg.args.run.skipForward))
 								{
 									if(EmuSystem::skipForwardFrames(this, frames - 1))
@@ -88,8 +94,12 @@ void EmuSystemTask::start()
 								{
 									EmuSystem::skipFrames(this, frames - 1, audio);
 								}
-								turboActions.update();
-								EmuSystem::runFrame(this, video, audio);
+								EmuSystem::updateFrameInput();
+								if(msg.args.run.skipForward || !EmuSystem::runAheadFrame(this, video, audio))
+								{
+									EmuSystem::runFrame(this, video, audio);
+								}
+								EmuSystem::recordRewindFrames(frames);
 							}
 							bcase Command::PAUSE:
 							{
@@ -140,12 +150,12 @@ void EmuSystemTask::stop()
 	replyPort.detach();
 }
 
-void EmuSystemTask::runFrame(EmuVideo *video, EmuAudio *audio, uint8_t frames, bool skipForward)
+void EmuSystemTask::runFrame(EmuVideo *video, EmuAudio *audio, uint8_t frames, bool skipForward, bool rewind)
 {
 	assumeExpr(frames);
 	if(unlikely(!started))
 		return;
-	commandPort.send({Command::RUN_FRAME, video, audio, frames, skipForward});
+	commandPort.send({Command::RUN_FRAME, video, audio, frames, skipForward, rewind});
 }
 
 void EmuSystemTask::sendVideoFormatChangedReply(EmuVideo &video)
@@ -155,7 +165,7 @@ void EmuSystemTask::sendVideoFormatChangedReply(EmuVideo &video)
 
 void EmuSystemTask::sendFrameFinishedReply(EmuVideo &video)
 {
-	replyPort.send({Reply::FRAME_FINISHED, video});
+	replyPort.send({video, IG::steadyClockTimestamp() - frameStartTime});
 }
 
 void EmuSystemTask::sendScreenshotReply(int num, bool success)
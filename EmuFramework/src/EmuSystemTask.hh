@@ -15,10 +15,11 @@
 	You should have received a copy of the GNU General Public License
 	along with EmuFramework.  If not, see <http://www.gnu.org/licenses/> */
 
-#include <imagine/base/MessagePort.hh>
+#include <imagine/base/SPSCMessagePort.hh>
 #include <imagine/base/CustomEvent.hh>
 #include <imagine/thread/Semaphore.hh>
 #include <imagine/pixmap/PixmapDesc.hh>
+#include <imagine/time/Time.hh>
 
 class EmuVideo;
 class EmuAudio;
@@ -45,6 +46,7 @@ public:
 				EmuAudio *audio;
 				uint8_t frames;
 				bool skipForward;
+				bool rewind;
 			} run;
 		} args{};
 		Command command{Command::UNSET};
@@ -52,8 +54,9 @@ public:
 		constexpr CommandMessage() {}
 		constexpr CommandMessage(Command command, IG::Semaphore *semPtr = nullptr):
 			semPtr{semPtr}, command{command} {}
-		constexpr CommandMessage(Command command, EmuVideo *video, EmuAudio *audio, uint8_t frames, bool skipForward = false):
-			args{video, audio, frames, skipForward}, command{command} {}
+		constexpr CommandMessage(Command command, EmuVideo *video, EmuAudio *audio, uint8_t frames,
+			bool skipForward = false, bool rewind = false):
+			args{video, audio, frames, skipForward, rewind}, command{command} {}
 		explicit operator bool() const { return command != Command::UNSET; }
 		void setReplySemaphore(IG::Semaphore *semPtr_) { assert(!semPtr); semPtr = semPtr_; };
 	};
@@ -74,6 +77,11 @@ public:
 			{
 				EmuVideo *videoAddr;
 			} videoFormat;
+			struct FrameFinishedArgs
+			{
+				EmuVideo *videoAddr;
+				IG::Time emulationTime;
+			} frameFinished;
 			struct ScreenshotArgs
 			{
 				int num;
@@ -85,6 +93,11 @@ public:
 		constexpr ReplyMessage() {}
 		constexpr ReplyMessage(Reply reply, EmuVideo &video):
 			args{&video}, reply{reply} {}
+		constexpr ReplyMessage(EmuVideo &video, IG::Time emulationTime):
+			reply{Reply::FRAME_FINISHED}
+		{
+			args.frameFinished = {&video, emulationTime};
+		}
 		constexpr ReplyMessage(Reply reply, int num, bool success):
 			reply{reply}
 		{
@@ -96,13 +109,18 @@ public:
 	void start();
 	void pause();
 	void stop();
-	void runFrame(EmuVideo *video, EmuAudio *audio, uint8_t frames, bool skipForward = false);
+	void runFrame(EmuVideo *video, EmuAudio *audio, uint8_t frames, bool skipForward = false, bool rewind = false);
 	void sendVideoFormatChangedReply(EmuVideo &video);
 	void sendFrameFinishedReply(EmuVideo &video);
 	void sendScreenshotReply(int num, bool success);
+	// emulation thread time taken by the most recently finished frame
+	IG::Time frameEmulationTime() const { return lastFrameEmulationTime; }
 
 private:
-	Base::MessagePort<CommandMessage> commandPort{"EmuSystemTask Command"};
-	Base::MessagePort<ReplyMessage> replyPort{"EmuSystemTask Reply"};
+	// commands only come from the main thread and replies only from the emulation thread
+	Base::SPSCMessagePort<CommandMessage> commandPort{"EmuSystemTask Command"};
+	Base::SPSCMessagePort<ReplyMessage> replyPort{"EmuSystemTask Reply"};
+	IG::Time frameStartTime{}; // only accessed by the emulation thread
+	IG::Time lastFrameEmulationTime{}; // only accessed by the main thread
 	bool started = false;
 };
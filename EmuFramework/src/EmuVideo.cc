@@ -46,7 +46,12 @@ void EmuVideo::setFormat(IG::PixmapDesc desc, EmuSystemTask *task)
 	{
 		return; // no change to format
 	}
-	if(!vidImg)
+	if(!rTask)
+	{
+		memImgDesc = desc;
+		memImg.resize(desc.pixelBytes());
+	}
+	else if(!vidImg)
 	{
 		Gfx::TextureConfig conf{desc, texSampler};
 		vidImg = renderer().makePixmapBufferTexture(conf, bufferMode, singleBuffer);
@@ -69,7 +74,7 @@ void EmuVideo::setFormat(IG::PixmapDesc desc, EmuSystemTask *task)
 
 void EmuVideo::dispatchFormatChanged()
 {
-	onFormatChanged(*this);
+	onFormatChanged.callSafe(*this);
 }
 
 void EmuVideo::syncImageAccess()
@@ -79,6 +84,10 @@ void EmuVideo::syncImageAccess()
 
 EmuVideoImage EmuVideo::startFrame(EmuSystemTask *task)
 {
+	if(unlikely(!rTask))
+	{
+		return {task, *this, Gfx::LockedTextureBuffer{nullptr, memPixmap(), {}, 0, false}};
+	}
 	auto lockedTex = vidImg.lock();
 	syncImageAccess();
 	return {task, *this, lockedTex};
@@ -126,7 +135,8 @@ void EmuVideo::finishFrame(EmuSystemTask *task, Gfx::LockedTextureBuffer texBuff
 	{
 		doScreenshot(task, texBuff.pixmap());
 	}
-	vidImg.unlock(texBuff);
+	if(likely(rTask))
+		vidImg.unlock(texBuff);
 	postFrameFinished(task);
 }
 
@@ -136,8 +146,15 @@ void EmuVideo::finishFrame(EmuSystemTask *task, IG::Pixmap pix)
 	{
 		doScreenshot(task, pix);
 	}
-	syncImageAccess();
-	vidImg.write(pix, vidImg.WRITE_FLAG_ASYNC);
+	if(unlikely(!rTask))
+	{
+		memPixmap().write(pix);
+	}
+	else
+	{
+		syncImageAccess();
+		vidImg.write(pix, vidImg.WRITE_FLAG_ASYNC);
+	}
 	postFrameFinished(task);
 }
 
@@ -233,6 +250,8 @@ void EmuVideoImage::endFrame()
 
 IG::WP EmuVideo::size() const
 {
+	if(!rTask)
+		return memImgDesc.size();
 	if(!vidImg)
 		return {};
 	else
@@ -241,9 +260,16 @@ IG::WP EmuVideo::size() const
 
 bool EmuVideo::formatIsEqual(IG::PixmapDesc desc) const
 {
+	if(!rTask)
+		return memImg && desc == memImgDesc;
 	return vidImg && desc == vidImg.usedPixmapDesc();
 }
 
+IG::Pixmap EmuVideo::memPixmap()
+{
+	return {memImgDesc, memImg.data()};
+}
+
 void EmuVideo::setOnFrameFinished(FrameFinishedDelegate del)
 {
 	onFrameFinished = del;
@@ -15,6 +15,9 @@
 
 #include <emuframework/EmuView.hh>
 #include <emuframework/EmuVideoLayer.hh>
+#include <imagine/gfx/RendererCommands.hh>
+#include <imagine/gui/TableView.hh>
+#include <imagine/util/string.h>
 #include <algorithm>
 
 EmuView::EmuView() {}
@@ -29,6 +32,7 @@ void EmuView::prepareDraw()
 	#ifdef CONFIG_EMUFRAMEWORK_AUDIO_STATS
 	audioStatsText.makeGlyphs(renderer());
 	#endif
+	framePacingStatsText.makeGlyphs(renderer());
 }
 
 void EmuView::draw(Gfx::RendererCommands &cmds)
@@ -51,6 +55,17 @@ void EmuView::draw(Gfx::RendererCommands &cmds)
 			projP.alignYToPixel(audioStatsRect.yCenter()), LC2DO, projP);
 	}
 	#endif
+	if(framePacingStatsText.isVisible())
+	{
+		cmds.setCommonProgram(CommonProgram::NO_TEX);
+		cmds.setBlendMode(BLEND_MODE_ALPHA);
+		cmds.setColor(0., 0., 0., .7);
+		GeomRect::draw(cmds, framePacingStatsRect);
+		cmds.setColor(1., 1., 1., 1.);
+		cmds.setCommonProgram(CommonProgram::TEX_ALPHA);
+		framePacingStatsText.draw(cmds, projP.alignXToPixel(framePacingStatsRect.x + TableView::globalXIndent),
+			projP.alignYToPixel(framePacingStatsRect.yCenter()), LC2DO, projP);
+	}
 }
 
 void EmuView::place()
@@ -63,10 +78,17 @@ void EmuView::place()
 	if(audioStatsText.compile(renderer(), projP))
 	{
 		audioStatsRect = projP.bounds();
-		audioStatsRect.y2 = (audioStatsRect.y + audioStatsText.nominalHeight * audioStatsText.lines)
-			+ audioStatsText.nominalHeight * .5f; // adjust to bottom
+		audioStatsRect.y2 = (audioStatsRect.y + audioStatsText.nominalHeight() * audioStatsText.currentLines())
+			+ audioStatsText.nominalHeight() * .5f; // adjust to bottom
 	}
 	#endif
+	if(framePacingStatsText.compile(renderer(), projP))
+	{
+		// opposite edge from the audio stats
+		framePacingStatsRect = projP.bounds();
+		framePacingStatsRect.y = (framePacingStatsRect.y2 - framePacingStatsText.nominalHeight() * framePacingStatsText.currentLines())
+			- framePacingStatsText.nominalHeight() * .5f;
+	}
 }
 
 bool EmuView::inputEvent(Input::Event e)
@@ -79,15 +101,31 @@ void EmuView::setLayoutInputView(EmuInputView *view)
 	inputView = view;
 }
 
-void EmuView::updateAudioStats(uint underruns, uint overruns, uint callbacks, double avgCallbackFrames, uint frames)
+void EmuView::updateAudioStats(uint underruns, uint overruns, uint callbacks, double avgCallbackFrames, uint frames, double avgFillSecs, double avgRateRatio)
 {
 	#ifdef CONFIG_EMUFRAMEWORK_AUDIO_STATS
-	audioStatsText.setString(string_makePrintf<512>("Underruns:%u\nOverruns:%u\nCallbacks per second:%u\nFrames per callback:%.2f\nTotal frames:%u",
-		underruns, overruns, callbacks, avgCallbackFrames, frames), &View::defaultFace);
+	audioStatsText.setString(string_makePrintf<512>("Underruns:%u\nOverruns:%u\nCallbacks per second:%u\nFrames per callback:%.2f\nTotal frames:%u\nBuffer fill:%.1fms\nRate ratio:%.5f",
+		underruns, overruns, callbacks, avgCallbackFrames, frames, avgFillSecs * 1000., avgRateRatio).data());
+	audioStatsText.setFace(&View::defaultFace);
 	place();
 	#endif
 }
 
+void EmuView::updateFramePacingStats(const char *str)
+{
+	framePacingStatsText.setString(str);
+	framePacingStatsText.setFace(&View::defaultFace);
+	place();
+}
+
+void EmuView::clearFramePacingStats()
+{
+	if(!framePacingStatsText.isVisible())
+		return;
+	framePacingStatsText.setString(nullptr);
+	place();
+}
+
 void EmuView::clearAudioStats()
 {
 	#ifdef CONFIG_EMUFRAMEWORK_AUDIO_STATS
@@ -26,6 +26,7 @@
 #include <imagine/gfx/RendererCommands.hh>
 #include <imagine/gui/AlertView.hh>
 #include <imagine/gui/ToastView.hh>
+#include <imagine/util/string.h>
 #include "EmuOptions.hh"
 #include "private.hh"
 #include "privateInput.hh"
@@ -256,6 +257,7 @@ void EmuViewController::initViews(ViewAttachParams viewAttach)
 			{
 				return true;
 			}
+			auto framesDue = frameInfo.advanced;
 			if(!optionSkipLateFrames && !fastForwarding)
 			{
 				frameInfo.advanced = currentFrameInterval();
@@ -263,7 +265,8 @@ void EmuViewController::initViews(ViewAttachParams viewAttach)
 			constexpr uint maxFrameSkip = 8;
 			uint32_t framesToEmulate = std::min(frameInfo.advanced, maxFrameSkip);
 			EmuAudio *audioPtr = emuAudio ? &emuAudio : nullptr;
-			systemTask->runFrame(&videoLayer().emuVideo(), audioPtr, framesToEmulate, skipForward);
+			framePacingTrace.beginFrame(params.timestamp(), framesDue, framesToEmulate);
+			systemTask->runFrame(&videoLayer().emuVideo(), audioPtr, framesToEmulate, skipForward, rewindActive);
 			r.setPresentationTime(emuWindowData().drawableHolder, params.presentTime());
 			/*logMsg("frame present time:%.4f next display frame:%.4f",
 				std::chrono::duration_cast<IG::FloatSeconds>(frameInfo.presentTime).count(),
@@ -309,7 +312,14 @@ void EmuViewController::initViews(ViewAttachParams viewAttach)
 	videoLayer().emuVideo().setOnFrameFinished(
 		[this](EmuVideo &)
 		{
-			emuWindow().drawNow();
+			auto presentTime = IG::timeFunc([&](){ emuWindow().drawNow(); });
+			framePacingTrace.endFrame(systemTask->frameEmulationTime(), presentTime,
+				emuAudio ? emuAudio.framesWritten() : 0);
+			if(optionShowFramePacingStats && ++framesSinceFramePacingStats == 60)
+			{
+				framesSinceFramePacingStats = 0;
+				updateFramePacingStats();
+			}
 			addOnFrame();
 		});
 	videoLayer().emuVideo().setOnFormatChanged(
@@ -664,9 +674,9 @@ void EmuViewController::updateWindowViewport(Base::Window &win, Base::Window::Su
 	}
 }
 
-void EmuViewController::updateEmuAudioStats(uint underruns, uint overruns, uint callbacks, double avgCallbackFrames, uint frames)
+void EmuViewController::updateEmuAudioStats(uint underruns, uint overruns, uint callbacks, double avgCallbackFrames, uint frames, double avgFillSecs, double avgRateRatio)
 {
-	emuView.updateAudioStats(underruns, overruns, callbacks, avgCallbackFrames, frames);
+	emuView.updateAudioStats(underruns, overruns, callbacks, avgCallbackFrames, frames, avgFillSecs, avgRateRatio);
 }
 
 void EmuViewController::clearEmuAudioStats()
@@ -674,6 +684,29 @@ void EmuViewController::clearEmuAudioStats()
 	emuView.clearAudioStats();
 }
 
+void EmuViewController::updateFramePacingStats()
+{
+	auto stats = framePacingTrace.summary(60);
+	if(!stats.frames)
+		return;
+	auto toMSecs = [](auto t){ return std::chrono::duration_cast<IG::FloatSeconds>(t).count() * 1000.; };
+	auto audioRate = emuAudio ? emuAudio.format().rate : 0;
+	auto toAudioMSecs = [=](uint32_t frames){ return audioRate ? frames * 1000. / audioRate : 0.; };
+	auto str = string_makePrintf<192>("Frames due:%u run:%u late:%u\nVsync gap max:%.2fms\n"
+		"Emu avg:%.2fms max:%.2fms\nPresent avg:%.2fms max:%.2fms\nAudio avg:%.1fms min:%.1fms",
+		stats.framesDue, stats.framesRun, stats.lateFrames, toMSecs(stats.maxVsyncInterval),
+		toMSecs(stats.avgEmulationTime), toMSecs(stats.maxEmulationTime),
+		toMSecs(stats.avgPresentTime), toMSecs(stats.maxPresentTime),
+		toAudioMSecs(stats.avgAudioFrames), toAudioMSecs(stats.minAudioFrames));
+	emuView.updateFramePacingStats(str.data());
+}
+
+void EmuViewController::clearFramePacingStats()
+{
+	framesSinceFramePacingStats = 0;
+	emuView.clearFramePacingStats();
+}
+
 bool EmuViewController::allWindowsAreFocused() const
 {
 	return mainWindowData().focused && (!hasExtraWindow() || extraWindowIsFocused());
@@ -754,6 +787,7 @@ void EmuViewController::pauseEmulation()
 	EmuSystem::pause();
 	videoLayer().setBrightness(showingEmulation ? .75f : .25f);
 	setFastForwardActive(false);
+	setRewindActive(false);
 	emuWindow().setDrawEventPriority();
 	removeOnFrame();
 }
@@ -882,6 +916,7 @@ void EmuViewController::onInputDevicesChanged()
 
 void EmuViewController::onSystemCreated()
 {
+	framePacingTrace.reset();
 	viewStack.navView()->showRightBtn(true);
 }
 
@@ -1012,6 +1047,11 @@ void EmuViewController::setFastForwardActive(bool active)
 	emuAudio.setVolume(soundVolume);
 }
 
+void EmuViewController::setRewindActive(bool active)
+{
+	rewindActive = active;
+}
+
 void EmuViewController::setWindowFrameClockSource(Base::Window::FrameTimeSource src)
 {
 	winFrameTimeSrc = src;
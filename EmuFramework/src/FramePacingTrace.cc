@@ -0,0 +1,122 @@
+/*  This file is part of EmuFramework.
+
+	Imagine is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	Imagine is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with EmuFramework.  If not, see <http://www.gnu.org/licenses/> */
+
+#define LOGTAG "FramePacing"
+#include "FramePacingTrace.hh"
+#include <imagine/io/FileIO.hh>
+#include <imagine/logger/logger.h>
+#include <imagine/util/algorithm.h>
+#include <algorithm>
+#include <cstdio>
+
+template<class T>
+static double toMSecs(T t)
+{
+	return std::chrono::duration_cast<IG::FloatSeconds>(t).count() * 1000.;
+}
+
+void FramePacingTrace::beginFrame(IG::FrameTime vsyncTime, uint32_t framesDue, uint32_t framesRun)
+{
+	auto &rec = records[nextIdx];
+	rec = {};
+	rec.vsyncTime = vsyncTime;
+	rec.framesDue = std::min(framesDue, 255u);
+	rec.framesRun = std::min(framesRun, 255u);
+	frameStarted = true;
+}
+
+void FramePacingTrace::endFrame(IG::Time emulationTime, IG::Time presentTime, uint32_t audioFrames)
+{
+	if(!frameStarted)
+		return; // frame wasn't started from the frame callback, like a screenshot
+	frameStarted = false;
+	auto &rec = records[nextIdx];
+	rec.emulationTime = emulationTime;
+	rec.presentTime = presentTime;
+	rec.audioFrames = audioFrames;
+	nextIdx = (nextIdx + 1) % CAPACITY;
+	size_ = std::min(size_ + 1, CAPACITY);
+}
+
+void FramePacingTrace::reset()
+{
+	nextIdx = 0;
+	size_ = 0;
+	frameStarted = false;
+}
+
+const FramePacingRecord &FramePacingTrace::recordFromEnd(uint32_t i) const
+{
+	return records[(nextIdx + CAPACITY - 1 - i) % CAPACITY];
+}
+
+FramePacingTrace::Summary FramePacingTrace::summary(uint32_t lastFrames) const
+{
+	Summary s{};
+	s.frames = std::min(lastFrames, size_);
+	if(!s.frames)
+		return s;
+	IG::Time emulationTotal{}, presentTotal{};
+	uint64_t audioTotal = 0;
+	s.minAudioFrames = UINT32_MAX;
+	iterateTimes(s.frames, i)
+	{
+		auto &rec = recordFromEnd(i);
+		s.framesDue += rec.framesDue;
+		s.framesRun += rec.framesRun;
+		if(rec.framesDue > 1)
+			s.lateFrames++;
+		emulationTotal += rec.emulationTime;
+		s.maxEmulationTime = std::max(s.maxEmulationTime, rec.emulationTime);
+		presentTotal += rec.presentTime;
+		s.maxPresentTime = std::max(s.maxPresentTime, rec.presentTime);
+		audioTotal += rec.audioFrames;
+		s.minAudioFrames = std::min(s.minAudioFrames, rec.audioFrames);
+		if(i + 1 < size_)
+			s.maxVsyncInterval = std::max(s.maxVsyncInterval, rec.vsyncTime - recordFromEnd(i + 1).vsyncTime);
+	}
+	s.avgEmulationTime = emulationTotal / s.frames;
+	s.avgPresentTime = presentTotal / s.frames;
+	s.avgAudioFrames = audioTotal / s.frames;
+	return s;
+}
+
+bool FramePacingTrace::writeCSV(const char *path, uint32_t audioRate) const
+{
+	FileIO file;
+	if(auto ec = file.create(path);
+		ec)
+	{
+		logErr("error creating %s", path);
+		return false;
+	}
+	static constexpr char header[] = "vsync_ms,frames_due,frames_run,emulation_ms,present_ms,audio_buffered_ms\n";
+	file.write(header, sizeof(header) - 1);
+	if(!size_)
+		return true;
+	auto startTime = recordFromEnd(size_ - 1).vsyncTime;
+	for(int i = size_ - 1; i >= 0; i--)
+	{
+		auto &rec = recordFromEnd(i);
+		char line[128];
+		auto len = snprintf(line, sizeof(line), "%.3f,%u,%u,%.3f,%.3f,%.3f\n",
+			toMSecs(rec.vsyncTime - startTime), rec.framesDue, rec.framesRun,
+			toMSecs(rec.emulationTime), toMSecs(rec.presentTime),
+			audioRate ? rec.audioFrames * 1000. / audioRate : 0.);
+		file.write(line, len);
+	}
+	logMsg("wrote %u frame records to %s", size_, path);
+	return true;
+}
@@ -0,0 +1,66 @@
+#pragma once
+
+/*  This file is part of EmuFramework.
+
+	Imagine is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	Imagine is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with EmuFramework.  If not, see <http://www.gnu.org/licenses/> */
+
+#include <imagine/time/Time.hh>
+#include <array>
+
+struct FramePacingRecord
+{
+	IG::FrameTime vsyncTime{}; // timestamp of the screen frame that started emulation
+	IG::Time emulationTime{}; // emulation thread time from run command to finished frame
+	IG::Time presentTime{}; // main thread time drawing & presenting the finished frame
+	uint32_t audioFrames{}; // audio frames buffered once the frame finished
+	uint8_t framesDue{}; // frames that elapsed according to EmuTiming
+	uint8_t framesRun{}; // frames actually emulated, less than due when capped
+};
+
+// Fixed ring of per-frame timing records, kept on the main thread only
+class FramePacingTrace
+{
+public:
+	static constexpr uint32_t CAPACITY = 1024;
+
+	struct Summary
+	{
+		uint32_t frames{};
+		uint32_t framesDue{};
+		uint32_t framesRun{};
+		uint32_t lateFrames{}; // frames where more than one was due
+		IG::Time avgEmulationTime{};
+		IG::Time maxEmulationTime{};
+		IG::Time avgPresentTime{};
+		IG::Time maxPresentTime{};
+		IG::FrameTime maxVsyncInterval{};
+		uint32_t minAudioFrames{};
+		uint32_t avgAudioFrames{};
+	};
+
+	void beginFrame(IG::FrameTime vsyncTime, uint32_t framesDue, uint32_t framesRun);
+	void endFrame(IG::Time emulationTime, IG::Time presentTime, uint32_t audioFrames);
+	void reset();
+	uint32_t size() const { return size_; }
+	Summary summary(uint32_t lastFrames) const;
+	bool writeCSV(const char *path, uint32_t audioRate) const;
+
+protected:
+	std::array<FramePacingRecord, CAPACITY> records{};
+	uint32_t nextIdx = 0;
+	uint32_t size_ = 0;
+	bool frameStarted = false;
+
+	const FramePacingRecord &recordFromEnd(uint32_t i) const;
+};
@@ -0,0 +1,302 @@
+/*  This file is part of EmuFramework.
+
+	Imagine is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	Imagine is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with EmuFramework.  If not, see <http://www.gnu.org/licenses/> */
+
+#define LOGTAG "HeadlessBenchmark"
+#include <emuframework/EmuSystem.hh>
+#include <emuframework/EmuAudio.hh>
+#include <emuframework/EmuVideo.hh>
+#include <imagine/base/Base.hh>
+#include <imagine/io/FileIO.hh>
+#include <imagine/io/BufferMapIO.hh>
+#include <imagine/logger/logger.h>
+#include <imagine/util/algorithm.h>
+#include "EmuOptions.hh"
+#include "private.hh"
+#include "EmuInputMovie.hh"
+#include <sys/resource.h>
+#include <algorithm>
+#include <vector>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+// Only linked into the linux-x86_64-benchmark targets (see package/emuframework.mk),
+// loads a game and times EmuSystem::runFrame() with video & audio going to memory.
+// With --movie, input is replayed from a recorded movie for its full length with no
+// warmup, and --checksums writes a hash of each frame's video & audio output so runs
+// can be diffed across builds. --trace writes whatever per-frame state the system
+// records with EmuSystem::writeFrameTrace(), for replaying in core benchmarks.
+// --option overrides a single byte system option by its config key after the saved
+// config loads, to compare core settings in the same build.
+// loadMs and loadRssKB are the game load time and resident memory right after it.
+// Systems append their own counters, like cache hit rates, with
+// EmuSystem::printBenchmarkStats().
+// Usage: <app> [--frames N] [--warmup N] [--no-video] [--no-audio]
+//   [--movie file] [--checksums file] [--trace file] [--option KEY=VALUE]... <game path>
+
+static void printJSONString(const char *str)
+{
+	putchar('"');
+	for(; *str; str++)
+	{
+		switch(*str)
+		{
+			case '"': fputs("\\\"", stdout); break;
+			case '\\': fputs("\\\\", stdout); break;
+			case '\n': fputs("\\n", stdout); break;
+			default:
+				if((unsigned char)*str < 0x20)
+					printf("\\u%04x", *str);
+				else
+					putchar(*str);
+		}
+	}
+	putchar('"');
+}
+
+static int printErrorResult(const char *msg)
+{
+	fputs("{\"error\":", stdout);
+	printJSONString(msg);
+	fputs("}\n", stdout);
+	return 1;
+}
+
+// 64-bit FNV-1a
+static uint64_t hashBytes(const void *data, size_t size, uint64_t hash = 0xcbf29ce484222325)
+{
+	auto bytes = (const uint8_t*)data;
+	for(size_t i = 0; i < size; i++)
+	{
+		hash = (hash ^ bytes[i]) * 0x100000001b3;
+	}
+	return hash;
+}
+
+static double toMSecs(IG::Time t)
+{
+	return std::chrono::duration_cast<IG::FloatSeconds>(t).count() * 1000.;
+}
+
+// current resident set, unlike ru_maxrss this drops when memory is released
+static long residentKB()
+{
+	long pages = 0, residentPages = 0;
+	if(auto f = fopen("/proc/self/statm", "r"))
+	{
+		if(fscanf(f, "%ld %ld", &pages, &residentPages) != 2)
+			residentPages = 0;
+		fclose(f);
+	}
+	return residentPages * (sysconf(_SC_PAGESIZE) / 1024);
+}
+
+namespace Base
+{
+
+int runHeadless(int argc, char** argv)
+{
+	uint32_t frames = 1800;
+	uint32_t warmupFrames = 60;
+	bool useVideo = true;
+	bool useAudio = true;
+	const char *gamePath{};
+	const char *moviePath{};
+	const char *checksumPath{};
+	const char *tracePath{};
+	struct OptionOverride
+	{
+		unsigned key;
+		uint8_t value;
+	};
+	std::vector<OptionOverride> optionOverrides;
+	for(int i = 1; i < argc; i++)
+	{
+		if(string_equal(argv[i], "--frames") && i + 1 < argc)
+			frames = std::max(strtoul(argv[++i], nullptr, 10), 1ul);
+		else if(string_equal(argv[i], "--warmup") && i + 1 < argc)
+			warmupFrames = strtoul(argv[++i], nullptr, 10);
+		else if(string_equal(argv[i], "--no-video"))
+			useVideo = false;
+		else if(string_equal(argv[i], "--no-audio"))
+			useAudio = false;
+		else if(string_equal(argv[i], "--movie") && i + 1 < argc)
+			moviePath = argv[++i];
+		else if(string_equal(argv[i], "--checksums") && i + 1 < argc)
+			checksumPath = argv[++i];
+		else if(string_equal(argv[i], "--trace") && i + 1 < argc)
+			tracePath = argv[++i];
+		else if(string_equal(argv[i], "--option") && i + 1 < argc)
+		{
+			char *valueStr;
+			unsigned key = strtoul(argv[++i], &valueStr, 10);
+			if(*valueStr != '=')
+				return printErrorResult("--option expects KEY=VALUE");
+			optionOverrides.push_back({key, (uint8_t)strtoul(valueStr + 1, nullptr, 10)});
+		}
+		else
+			gamePath = argv[i];
+	}
+	if(!gamePath)
+	{
+		fprintf(stderr, "usage: %s [--frames N] [--warmup N] [--no-video] [--no-audio] "
+			"[--movie file] [--checksums file] [--trace file] [--option KEY=VALUE]... <game path>\n", argv[0]);
+		return printErrorResult("no game path given");
+	}
+	if(auto err = EmuSystem::onInit();
+		err)
+	{
+		return printErrorResult(err->what());
+	}
+	initOptions();
+	// use the saved config so firmware paths and core options match the interactive app
+	loadConfigFile();
+	for(auto o : optionOverrides)
+	{
+		BufferMapIO io;
+		io.open(&o.value, sizeof(o.value));
+		if(!EmuSystem::readConfig(io, o.key, sizeof(o.value)))
+			return printErrorResult("unknown option key");
+	}
+	if(auto err = EmuSystem::onOptionsLoaded();
+		err)
+	{
+		return printErrorResult(err->what());
+	}
+	auto loadStartTime = IG::steadyClockTimestamp();
+	if(auto err = EmuSystem::loadGameFromPath(gamePath, {},
+		[](int pos, int max, const char *label){ return true; });
+		err)
+	{
+		return printErrorResult(err->what());
+	}
+	auto loadTime = IG::steadyClockTimestamp() - loadStartTime;
+	auto loadRssKB = residentKB();
+	EmuSystem::prepareAudioVideo(emuAudio, emuVideo);
+	emuAudio.openMemorySink();
+	EmuVideo *videoPtr = useVideo ? &emuVideo : nullptr;
+	EmuAudio *audioPtr = useAudio ? &emuAudio : nullptr;
+	if(moviePath)
+	{
+		if(auto err = emuInputMovie.load(moviePath);
+			err)
+		{
+			return printErrorResult(err->what());
+		}
+		if(!emuInputMovie.frames())
+			return printErrorResult("input movie has no frames");
+		frames = emuInputMovie.frames();
+		warmupFrames = 0;
+	}
+	iterateTimes(warmupFrames, i)
+	{
+		EmuSystem::runFrame(nullptr, videoPtr, audioPtr);
+	}
+	if(moviePath)
+	{
+		if(auto err = emuInputMovie.startPlayback();
+			err)
+		{
+			return printErrorResult(err->what());
+		}
+	}
+	FileIO checksumFile;
+	if(checksumPath)
+	{
+		if(auto ec = checksumFile.create(checksumPath);
+			ec)
+		{
+			return printErrorResult("can't create checksum file");
+		}
+	}
+	FileIO traceFile;
+	if(tracePath)
+	{
+		if(auto ec = traceFile.create(tracePath);
+			ec)
+		{
+			return printErrorResult("can't create trace file");
+		}
+	}
+	// drop samples from loading & warmup so each hash only covers its own frame
+	emuAudio.consumeMemorySink([](const void *, size_t){});
+	uint64_t outputHash = hashBytes(nullptr, 0);
+	IG::Time checksumTime{}, traceTime{};
+	std::vector<IG::Time> frameTimes(frames);
+	auto startTime = IG::steadyClockTimestamp();
+	iterateTimes(frames, frame)
+	{
+		frameTimes[frame] = IG::timeFunc(
+			[&]()
+			{
+				EmuSystem::updateFrameInput();
+				EmuSystem::runFrame(nullptr, videoPtr, audioPtr);
+			});
+		if(moviePath || checksumPath)
+		{
+			auto checksumStartTime = IG::steadyClockTimestamp();
+			auto videoHash = useVideo ? hashBytes(emuVideo.memoryImage().data(), emuVideo.memoryImage().size()) : 0;
+			uint64_t audioHash = 0;
+			emuAudio.consumeMemorySink(
+				[&](const void *samples, size_t bytes)
+				{
+					audioHash = hashBytes(samples, bytes);
+				});
+			outputHash = hashBytes(&videoHash, sizeof(videoHash), outputHash);
+			outputHash = hashBytes(&audioHash, sizeof(audioHash), outputHash);
+			if(checksumFile)
+			{
+				char line[64];
+				auto len = snprintf(line, sizeof(line), "%u %016llx %016llx\n", frame,
+					(unsigned long long)videoHash, (unsigned long long)audioHash);
+				checksumFile.write(line, len);
+			}
+			checksumTime += IG::steadyClockTimestamp() - checksumStartTime;
+		}
+		if(traceFile)
+		{
+			traceTime += IG::timeFunc([&](){ EmuSystem::writeFrameTrace(traceFile); });
+		}
+	}
+	auto totalTime = IG::steadyClockTimestamp() - startTime - checksumTime - traceTime;
+	std::sort(frameTimes.begin(), frameTimes.end());
+	auto percentile = [&](unsigned p){ return frameTimes[(frameTimes.size() - 1) * p / 100]; };
+	struct rusage usage{};
+	getrusage(RUSAGE_SELF, &usage);
+	auto secs = std::chrono::duration_cast<IG::FloatSeconds>(totalTime).count();
+	fputs("{\"system\":", stdout);
+	printJSONString(EmuSystem::shortSystemName());
+	fputs(",\"game\":", stdout);
+	printJSONString(EmuSystem::fullGameName().data());
+	printf(",\"video\":%s,\"audio\":%s,\"frames\":%u,\"seconds\":%.6f,\"fps\":%.3f,"
+		"\"frameTimeP50Ms\":%.4f,\"frameTimeP99Ms\":%.4f,\"frameTimeMaxMs\":%.4f,\"peakRssKB\":%ld,"
+		"\"loadMs\":%.3f,\"loadRssKB\":%ld",
+		useVideo ? "true" : "false", useAudio ? "true" : "false",
+		frames, secs, frames / secs,
+		toMSecs(percentile(50)), toMSecs(percentile(99)), toMSecs(frameTimes.back()),
+		usage.ru_maxrss, toMSecs(loadTime), loadRssKB);
+	if(moviePath || checksumPath)
+	{
+		// printed after the fixed fields so existing result parsers keep working
+		printf(",\"outputHash\":\"%016llx\"", (unsigned long long)outputHash);
+	}
+	EmuSystem::printBenchmarkStats();
+	fputs("}\n", stdout);
+	fflush(stdout);
+	EmuSystem::closeSystem();
+	return 0;
+}
+
+}
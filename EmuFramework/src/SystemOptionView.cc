@@ -220,6 +220,92 @@ SystemOptionView::SystemOptionView(ViewAttachParams attach, bool customMenu):
 			return 0;
 		}(),
 		fastForwardSpeedItem
+	},
+	rewindBufferSizeItem
+	{
+		{"Off", [this]() { optionRewindBufferSize = 0; }},
+		{"16MB", [this]() { optionRewindBufferSize = 16; }},
+		{"32MB", [this]() { optionRewindBufferSize = 32; }},
+		{"64MB", [this]() { optionRewindBufferSize = 64; }},
+		{"128MB", [this]() { optionRewindBufferSize = 128; }},
+		{"256MB", [this]() { optionRewindBufferSize = 256; }},
+	},
+	rewindBufferSize
+	{
+		"Rewind Buffer",
+		[]()
+		{
+			switch(optionRewindBufferSize.val)
+			{
+				default: return 0;
+				case 16: return 1;
+				case 32: return 2;
+				case 64: return 3;
+				case 128: return 4;
+				case 256: return 5;
+			}
+		}(),
+		rewindBufferSizeItem
+	},
+	rewindIntervalItem
+	{
+		{"1 Frame", [this]() { optionRewindInterval = 1; }},
+		{"2 Frames", [this]() { optionRewindInterval = 2; }},
+		{"4 Frames", [this]() { optionRewindInterval = 4; }},
+		{"8 Frames", [this]() { optionRewindInterval = 8; }},
+	},
+	rewindInterval
+	{
+		"Rewind Snapshot Interval",
+		[]()
+		{
+			switch(optionRewindInterval.val)
+			{
+				default: return 1;
+				case 1: return 0;
+				case 4: return 2;
+				case 8: return 3;
+			}
+		}(),
+		rewindIntervalItem
+	},
+	runAheadItem
+	{
+		{"Off", [this]() { optionRunAheadFrames = 0; }},
+		{"1 Frame", [this]() { optionRunAheadFrames = 1; }},
+		{"2 Frames", [this]() { optionRunAheadFrames = 2; }},
+		{"3 Frames", [this]() { optionRunAheadFrames = 3; }},
+		{"4 Frames", [this]() { optionRunAheadFrames = 4; }},
+	},
+	runAhead
+	{
+		"Run-ahead",
+		std::min((int)optionRunAheadFrames, 4),
+		runAheadItem
+	},
+	archiveCacheSizeItem
+	{
+		{"Off", [this]() { optionArchiveCacheSize = 0; }},
+		{"256MB", [this]() { optionArchiveCacheSize = 256; }},
+		{"512MB", [this]() { optionArchiveCacheSize = 512; }},
+		{"1GB", [this]() { optionArchiveCacheSize = 1024; }},
+		{"2GB", [this]() { optionArchiveCacheSize = 2048; }},
+	},
+	archiveCacheSize
+	{
+		"Archive Cache",
+		[]()
+		{
+			switch(optionArchiveCacheSize.val)
+			{
+				default: return 0;
+				case 256: return 1;
+				case 512: return 2;
+				case 1024: return 3;
+				case 2048: return 4;
+			}
+		}(),
+		archiveCacheSizeItem
 	}
 	#if defined __ANDROID__
 	,performanceMode
@@ -249,6 +335,16 @@ void SystemOptionView::loadStockItems()
 	item.emplace_back(&savePath);
 	item.emplace_back(&checkSavePathWriteAccess);
 	item.emplace_back(&fastForwardSpeed);
+	if(EmuSystem::hasRewind)
+	{
+		item.emplace_back(&rewindBufferSize);
+		item.emplace_back(&rewindInterval);
+	}
+	if(EmuSystem::hasRunAhead)
+		item.emplace_back(&runAhead);
+	// systems loading games by path bypass the cache, see EmuArchiveCache.hh
+	if(!EmuSystem::handlesArchiveFiles && EmuSystem::handlesGenericIO)
+		item.emplace_back(&archiveCacheSize);
 	#ifdef __ANDROID__
 	if(!optionSustainedPerformanceMode.isConst)
 		item.emplace_back(&performanceMode);
@@ -283,11 +283,11 @@ bool VControllerKeyboard::keyInput(VController &v, Gfx::Renderer &r, Input::Even
 		}
 		else if(e.pushed())
 		{
-			EmuSystem::handleInputAction(Input::PUSHED, currentKey());
+			EmuSystem::dispatchInputAction(Input::PUSHED, currentKey());
 		}
 		else
 		{
-			EmuSystem::handleInputAction(Input::RELEASED, currentKey());
+			EmuSystem::dispatchInputAction(Input::RELEASED, currentKey());
 		}
 		return true;
 	}
@@ -950,7 +950,7 @@ void VController::inputAction(uint action, uint vBtn)
 {
 	if(isInKeyboardMode())
 	{
-		EmuSystem::handleInputAction(action, kb.translateInput(vBtn));
+		EmuSystem::dispatchInputAction(action, kb.translateInput(vBtn));
 	}
 	else
 	{
@@ -968,7 +968,7 @@ void VController::inputAction(uint action, uint vBtn)
 				turboActions.removeEvent(keyCode);
 			}
 		}
-		EmuSystem::handleInputAction(action, keyCode);
+		EmuSystem::dispatchInputAction(action, keyCode);
 	}
 }
 
@@ -283,6 +283,17 @@ VideoOptionView::VideoOptionView(ViewAttachParams attach, bool customMenu):
 			optionSkipLateFrames.val = item.flipBoolValue(*this);
 		}
 	},
+	showFramePacingStats
+	{
+		"Show Frame Pacing Stats",
+		(bool)optionShowFramePacingStats,
+		[this](BoolMenuItem &item, Input::Event e)
+		{
+			optionShowFramePacingStats.val = item.flipBoolValue(*this);
+			if(!optionShowFramePacingStats)
+				emuViewController().clearFramePacingStats();
+		}
+	},
 	frameRate
 	{
 		nullptr,
@@ -730,6 +741,7 @@ void VideoOptionView::loadStockItems()
 	item.emplace_back(&frameInterval);
 	#endif
 	item.emplace_back(&dropLateFrames);
+	item.emplace_back(&showFramePacingStats);
 	if(!optionFrameRate.isConst)
 	{
 		frameRate.setName(makeFrameRateStr().data());
@@ -30,11 +30,13 @@
 #include <emuframework/EmuAudio.hh>
 #include <emuframework/EmuVideo.hh>
 #include "Recent.hh"
+#include "FramePacingTrace.hh"
 #include <memory>
 
 enum AssetID { ASSET_ARROW, ASSET_CLOSE, ASSET_ACCEPT, ASSET_GAME_ICON, ASSET_MENU, ASSET_FAST_FORWARD };
 
 class EmuSystemTask;
+class EmuInputMovie;
 class EmuViewController;
 
 struct WindowData
@@ -79,8 +81,10 @@ public:
 	void placeElements();
 	void setEmuViewOnExtraWindow(bool on, Base::Screen &screen);
 	void startMainViewportAnimation();
-	void updateEmuAudioStats(uint underruns, uint overruns, uint callbacks, double avgCallbackFrames, uint frames);
+	void updateEmuAudioStats(uint underruns, uint overruns, uint callbacks, double avgCallbackFrames, uint frames, double avgFillSecs, double avgRateRatio);
 	void clearEmuAudioStats();
+	void clearFramePacingStats();
+	const FramePacingTrace &framePacing() const { return framePacingTrace; }
 	void closeSystem(bool allowAutosaveState = true);
 	void popToSystemActionsMenu();
 	void postDrawToEmuWindows();
@@ -106,6 +110,7 @@ public:
 	void updateAutoOnScreenControlVisible();
 	void setPhysicalControlsPresent(bool present);
 	void setFastForwardActive(bool active);
+	void setRewindActive(bool active);
 
 protected:
 	static constexpr bool HAS_USE_RENDER_TIME = Config::envIsLinux
@@ -123,6 +128,9 @@ protected:
 	bool physicalControlsPresent = false;
 	Base::Window::FrameTimeSource winFrameTimeSrc{};
 	uint8_t targetFastForwardSpeed = 0;
+	bool rewindActive = false;
+	uint8_t framesSinceFramePacingStats = 0;
+	FramePacingTrace framePacingTrace{};
 
 	void initViews(ViewAttachParams attach);
 	void onFocusChange(uint in);
@@ -134,6 +142,7 @@ protected:
 	void moveOnFrame(Base::Window &from, Base::Window &to);
 	void startEmulation();
 	void pauseEmulation();
+	void updateFramePacingStats();
 	void configureAppForEmulation(bool running);
 	void configureWindowForEmulation(Base::Window &win, bool running);
 	void startViewportAnimation(Base::Window &win);
@@ -153,6 +162,7 @@ extern DelegateFunc<void ()> onUpdateInputDevices;
 extern FS::PathString lastLoadPath;
 extern EmuVideo emuVideo;
 extern EmuAudio emuAudio;
+extern EmuInputMovie emuInputMovie;
 extern RecentGameList recentGameList;
 static constexpr const char *strftimeFormat = "%x  %r";
 
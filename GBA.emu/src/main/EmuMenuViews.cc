@@ -69,6 +69,36 @@ public:
 	{}
 };
 
+class CustomVideoOptionView : public VideoOptionView
+{
+	TextMenuItem lcdRenderingItem[3]
+	{
+		{"Per Line", [](){ setRendering(LCD_RENDER_PER_LINE); }},
+		{"Per Frame", [](){ setRendering(LCD_RENDER_PER_FRAME); }},
+		{"Per Frame, Threaded", [](){ setRendering(LCD_RENDER_THREADED); }},
+	};
+
+	MultiChoiceMenuItem lcdRendering
+	{
+		"LCD Rendering",
+		optionLCDRendering,
+		lcdRenderingItem
+	};
+
+	static void setRendering(uint val)
+	{
+		optionLCDRendering = val;
+		setLCDRendering(val);
+	}
+
+public:
+	CustomVideoOptionView(ViewAttachParams attach): VideoOptionView{attach, true}
+	{
+		loadStockItems();
+		item.emplace_back(&lcdRendering);
+	}
+};
+
 class CustomSystemActionsView : public EmuSystemActionsView
 {
 	TextMenuItem options
@@ -96,6 +126,7 @@ std::unique_ptr<View> EmuApp::makeCustomView(ViewAttachParams attach, ViewID id)
 	switch(id)
 	{
 		case ViewID::SYSTEM_ACTIONS: return std::make_unique<CustomSystemActionsView>(attach);
+		case ViewID::VIDEO_OPTIONS: return std::make_unique<CustomVideoOptionView>(attach);
 		case ViewID::EDIT_CHEATS: return std::make_unique<EmuEditCheatListView>(attach);
 		case ViewID::LIST_CHEATS: return std::make_unique<EmuCheatsView>(attach);
 		default: return nullptr;
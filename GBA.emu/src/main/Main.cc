@@ -39,6 +39,9 @@ bool detectedRtcGame = 0;
 const char *EmuSystem::creditsViewStr = CREDITS_INFO_STRING "(c) 2012-2021\nRobert Broglia\nwww.explusalpha.com\n\nPortions (c) the\nVBA-m Team\nvba-m.com";
 bool EmuSystem::hasBundledGames = true;
 bool EmuSystem::hasCheats = true;
+bool EmuSystem::hasRunAhead = true;
+bool EmuSystem::hasRewind = true;
+bool EmuSystem::hasMemoryStates = true;
 
 EmuSystem::NameFilterFunc EmuSystem::defaultFsFilter =
 	[](const char *name)
@@ -109,6 +112,31 @@ EmuSystem::Error EmuSystem::loadState(const char *path)
 		return makeFileReadError();
 }
 
+EmuSystem::Error EmuSystem::saveState(IG::ByteBuffer &buff)
+{
+	buff.resize(std::max(buff.capacity(), (size_t)0x100000));
+	while(true)
+	{
+		if(auto size = CPUWriteMemStateUncompressed(gGba, (char*)buff.data(), buff.size());
+			size)
+		{
+			buff.resize(size);
+			return {};
+		}
+		if(buff.size() >= 0x1000000)
+			return makeFileWriteError();
+		buff.resize(buff.size() * 2);
+	}
+}
+
+EmuSystem::Error EmuSystem::loadState(IG::ConstBufferView buff)
+{
+	if(CPUReadMemState(gGba, (char*)buff.data(), buff.size()))
+		return {};
+	else
+		return makeFileReadError();
+}
+
 void EmuSystem::saveBackupMem()
 {
 	if(gameIsRunning())
@@ -167,7 +195,8 @@ static EmuSystem::Error applyGamePatches(const char *patchDir, const char *romNa
 
 EmuSystem::Error EmuSystem::loadGame(IO &io, EmuSystemCreateParams, OnLoadProgressDelegate)
 {
-	int size = CPULoadRomWithIO(gGba, io);
+	auto mappedSize = mapGameFile(io, gGba.mem.rom, sizeof(gGba.mem.rom));
+	int size = CPULoadRomWithIO(gGba, io, mappedSize);
 	if(!size)
 	{
 		return makeFileReadError();
@@ -3,10 +3,13 @@
 #include <emuframework/Option.hh>
 
 static const uint RTC_EMU_AUTO = 0, RTC_EMU_OFF = 1, RTC_EMU_ON = 2;
+static const uint LCD_RENDER_PER_LINE = 0, LCD_RENDER_PER_FRAME = 1, LCD_RENDER_THREADED = 2;
 
 extern Byte1Option optionRtcEmulation;
+extern Byte1Option optionLCDRendering;
 extern bool detectedRtcGame;
 
 void setRTC(uint mode);
+void setLCDRendering(uint mode);
 void readCheatFile();
 void writeCheatFile();
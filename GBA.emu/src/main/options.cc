@@ -17,10 +17,11 @@
 #include "internal.hh"
 #include <vbam/gba/GBA.h>
 #include <vbam/gba/RTC.h>
+#include <vbam/gba/FrameRenderer.h>
 
 enum
 {
-	CFGKEY_RTC_EMULATION = 256
+	CFGKEY_RTC_EMULATION = 256, CFGKEY_LCD_RENDERING = 257
 };
 
 const char *EmuSystem::configFilename = "GbaEmu.config";
@@ -31,6 +32,7 @@ const AspectRatioInfo EmuSystem::aspectRatioInfo[]
 };
 const uint EmuSystem::aspectRatioInfos = std::size(EmuSystem::aspectRatioInfo);
 Byte1Option optionRtcEmulation(CFGKEY_RTC_EMULATION, RTC_EMU_AUTO, 0, optionIsValidWithMax<2>);
+Byte1Option optionLCDRendering(CFGKEY_LCD_RENDERING, LCD_RENDER_PER_LINE, 0, optionIsValidWithMax<2>);
 
 bool EmuSystem::resetSessionOptions()
 {
@@ -54,6 +56,32 @@ void EmuSystem::writeSessionConfig(IO &io)
 	optionRtcEmulation.writeWithKeyIfNotDefault(io);
 }
 
+bool EmuSystem::readConfig(IO &io, uint key, uint readSize)
+{
+	switch(key)
+	{
+		default: return 0;
+		bcase CFGKEY_LCD_RENDERING: optionLCDRendering.readFromIO(io, readSize);
+	}
+	return 1;
+}
+
+void EmuSystem::writeConfig(IO &io)
+{
+	optionLCDRendering.writeWithKeyIfNotDefault(io);
+}
+
+EmuSystem::Error EmuSystem::onOptionsLoaded()
+{
+	setLCDRendering(optionLCDRendering);
+	return {};
+}
+
+void setLCDRendering(uint mode)
+{
+	lcdFrameRenderer.setEnabled(gGba.lcd, mode != LCD_RENDER_PER_LINE, mode == LCD_RENDER_THREADED);
+}
+
 void setRTC(uint mode)
 {
 	if(detectedRtcGame && mode == RTC_EMU_AUTO)
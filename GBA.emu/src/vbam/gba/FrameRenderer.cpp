@@ -0,0 +1,235 @@
+#include "FrameRenderer.h"
+#include "GBAGfx.h"
+#include <string.h>
+
+LCDFrameRenderer lcdFrameRenderer;
+
+LCDFrameRenderer::~LCDFrameRenderer()
+{
+	stopThread();
+}
+
+void LCDFrameRenderer::setEnabled(GBALCD &lcd, bool on, bool threaded)
+{
+	if(on && !isEnabled())
+	{
+		logMsg("enabling batched LCD rendering");
+		// the shadow carries the render state forward from here, change flags are passed per line
+		shadow = std::make_unique<GBALCD>(lcd);
+		shadow->gfxBG2Changed = 0;
+		shadow->gfxBG3Changed = 0;
+		lines = std::make_unique<Line[]>(MAX_LINES);
+		ioMem = std::make_unique<GBAMem::IoMem>();
+		writes.reserve(0x4000);
+		pendingClear = 0;
+		windowDirty = true;
+		logging = true;
+	}
+	else if(!on && isEnabled())
+	{
+		logMsg("disabling batched LCD rendering");
+		stopThread();
+		renderPending();
+		// hand the render state back to the per line renderer
+		memcpy(lcd.line0, shadow->line0, sizeof(lcd.line0));
+		memcpy(lcd.line1, shadow->line1, sizeof(lcd.line1));
+		memcpy(lcd.line2, shadow->line2, sizeof(lcd.line2));
+		memcpy(lcd.line3, shadow->line3, sizeof(lcd.line3));
+		memcpy(lcd.lineOBJ, shadow->lineOBJ, sizeof(lcd.lineOBJ));
+		memcpy(lcd.lineOBJWin, shadow->lineOBJWin, sizeof(lcd.lineOBJWin));
+		memcpy(lcd.lineOBJpixleft, shadow->lineOBJpixleft, sizeof(lcd.lineOBJpixleft));
+		if(pendingClear & 0x0100) gfxClearArray(lcd.line0);
+		if(pendingClear & 0x0200) gfxClearArray(lcd.line1);
+		if(pendingClear & 0x0400) gfxClearArray(lcd.line2);
+		if(pendingClear & 0x0800) gfxClearArray(lcd.line3);
+		lcd.gfxBG2Changed |= shadow->gfxBG2Changed;
+		lcd.gfxBG3Changed |= shadow->gfxBG3Changed;
+		lcd.gfxBG2X = shadow->gfxBG2X;
+		lcd.gfxBG2Y = shadow->gfxBG2Y;
+		lcd.gfxBG3X = shadow->gfxBG3X;
+		lcd.gfxBG3Y = shadow->gfxBG3Y;
+		lcd.gfxLastVCOUNT = shadow->gfxLastVCOUNT;
+		shadow.reset();
+		lines.reset();
+		ioMem.reset();
+		writes = {};
+		logging = false;
+	}
+	if(on && threaded && !thread.joinable())
+	{
+		quit = false;
+		thread = std::thread([this](){ threadMain(); });
+	}
+	else if(!(on && threaded))
+	{
+		stopThread();
+	}
+}
+
+void LCDFrameRenderer::commitLine(GBASys &gba)
+{
+	auto &lcd = gba.lcd;
+	if(!logging)
+		syncShadow(lcd);
+	if(UNLIKELY(lineCount == MAX_LINES))
+		renderPending();
+	auto &l = lines[lineCount];
+	l.renderLine = lcd.renderLine;
+	l.lineMix = lcd.lineMix;
+	l.writesEnd = writes.size();
+	l.layerEnable = lcd.layerEnable;
+	l.bg2Changed = lcd.gfxBG2Changed;
+	l.bg3Changed = lcd.gfxBG3Changed;
+	lcd.gfxBG2Changed = 0;
+	lcd.gfxBG3Changed = 0;
+	l.clearLines = pendingClear;
+	pendingClear = 0;
+	l.windowChanged = windowDirty;
+	if(windowDirty)
+	{
+		memcpy(l.inWin0, lcd.gfxInWin0, sizeof(l.inWin0));
+		memcpy(l.inWin1, lcd.gfxInWin1, sizeof(l.inWin1));
+		windowDirty = false;
+	}
+	memcpy(l.regs, gba.mem.ioMem.b, sizeof(l.regs));
+	lineCount++;
+	if(thread.joinable())
+		queueThread();
+}
+
+void LCDFrameRenderer::endFrame()
+{
+	if(!lineCount)
+	{
+		// nothing drawn this frame, resync video memory when the next line is
+		writes.clear();
+		appliedWrites = 0;
+		logging = false;
+		return;
+	}
+	renderPending();
+}
+
+void LCDFrameRenderer::invalidate()
+{
+	if(!isEnabled())
+		return;
+	renderPending();
+	writes.clear();
+	appliedWrites = 0;
+	logging = false;
+}
+
+void LCDFrameRenderer::logWrite(VideoMem mem, const u8 *base, u32 offset, uint size)
+{
+	// the worker reads the log in place, so it can't be reallocated under it
+	if(UNLIKELY(writes.size() == writes.capacity()))
+		waitForThread();
+	MemWrite w{offset, 0, mem, (u8)size};
+	memcpy(&w.value, &base[offset], size);
+	writes.push_back(w);
+}
+
+void LCDFrameRenderer::applyWrites(u32 end)
+{
+	auto &lcd = *shadow;
+	for(; appliedWrites < end; appliedWrites++)
+	{
+		auto &w = writes[appliedWrites];
+		u8 *base = w.mem == VRAM ? lcd.vram : w.mem == PALETTE ? lcd.paletteRAM : lcd.oam;
+		memcpy(&base[w.offset], &w.value, w.size);
+	}
+}
+
+void LCDFrameRenderer::renderLines(uint start, uint end)
+{
+	auto &lcd = *shadow;
+	for(uint i = start; i < end; i++)
+	{
+		auto &l = lines[i];
+		applyWrites(l.writesEnd);
+		if(l.clearLines & 0x0100) gfxClearArray(lcd.line0);
+		if(l.clearLines & 0x0200) gfxClearArray(lcd.line1);
+		if(l.clearLines & 0x0400) gfxClearArray(lcd.line2);
+		if(l.clearLines & 0x0800) gfxClearArray(lcd.line3);
+		if(l.windowChanged)
+		{
+			memcpy(lcd.gfxInWin0, l.inWin0, sizeof(l.inWin0));
+			memcpy(lcd.gfxInWin1, l.inWin1, sizeof(l.inWin1));
+		}
+		lcd.layerEnable = l.layerEnable;
+		lcd.gfxBG2Changed |= l.bg2Changed;
+		lcd.gfxBG3Changed |= l.bg3Changed;
+		memcpy(ioMem->b, l.regs, sizeof(l.regs));
+		l.renderLine(l.lineMix, lcd, *ioMem);
+	}
+}
+
+void LCDFrameRenderer::renderPending()
+{
+	waitForThread();
+	renderLines(queuedLines, lineCount);
+	lineCount = queuedLines = 0;
+	writes.erase(writes.begin(), writes.begin() + appliedWrites);
+	appliedWrites = 0;
+}
+
+void LCDFrameRenderer::syncShadow(const GBALCD &lcd)
+{
+	memcpy(shadow->paletteRAM, lcd.paletteRAM, sizeof(lcd.paletteRAM));
+	memcpy(shadow->vram, lcd.vram, sizeof(lcd.vram));
+	memcpy(shadow->oam, lcd.oam, sizeof(lcd.oam));
+	windowDirty = true;
+	logging = true;
+}
+
+void LCDFrameRenderer::queueThread()
+{
+	if(lineCount - queuedLines < THREAD_MIN_LINES || busy)
+		return;
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		threadStart = queuedLines;
+		threadEnd = lineCount;
+		busy = true;
+	}
+	queuedLines = lineCount;
+	cond.notify_all();
+}
+
+void LCDFrameRenderer::waitForThread()
+{
+	if(!busy)
+		return;
+	std::unique_lock<std::mutex> lock(mutex);
+	cond.wait(lock, [this](){ return !busy; });
+}
+
+void LCDFrameRenderer::stopThread()
+{
+	if(!thread.joinable())
+		return;
+	waitForThread();
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		quit = true;
+	}
+	cond.notify_all();
+	thread.join();
+}
+
+void LCDFrameRenderer::threadMain()
+{
+	std::unique_lock<std::mutex> lock(mutex);
+	for(;;)
+	{
+		cond.wait(lock, [this](){ return busy || quit; });
+		if(quit)
+			return;
+		lock.unlock();
+		renderLines(threadStart, threadEnd);
+		lock.lock();
+		busy = false;
+		cond.notify_all();
+	}
+}
@@ -0,0 +1,111 @@
+#ifndef FRAMERENDERER_H
+#define FRAMERENDERER_H
+
+#include "GBA.h"
+#include "GBAcpu.h"
+#include <memory>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+
+// Batched LCD rendering: instead of calling renderLine at every HBlank, each visible
+// line logs the render inputs that can change between lines (the LCD registers, the
+// render function, layer & window state, and palette/VRAM/OAM writes since the last
+// line) and the whole frame is drawn from a private copy of the LCD state once the
+// last line is reached, optionally overlapped with the CPU on a worker thread.
+// Replaying the log in order draws exactly what the per line renderer would have.
+
+class LCDFrameRenderer
+{
+public:
+	static const uint MAX_LINES = 160;
+	static const uint THREAD_MIN_LINES = 16;
+
+	enum VideoMem : u8 { PALETTE, VRAM, OAM };
+
+	~LCDFrameRenderer();
+	void setEnabled(GBALCD &lcd, bool on, bool threaded);
+	bool isEnabled() const { return (bool)shadow; }
+
+	// logs the current line in place of calling lcd.renderLine
+	void commitLine(GBASys &gba);
+
+	// draws any lines not yet drawn, call before the frame is presented
+	void endFrame();
+
+	// for changes to video memory not made through CPUWrite*()
+	void invalidate();
+
+	// line buffers CPUUpdateRenderBuffers() cleared, by their layerEnable bits
+	void clearLines(uint layers) { pendingClear |= layers; }
+
+	// gfxInWin0/1 were recomputed
+	void windowChanged() { windowDirty = true; }
+
+	// call after CPUWrite*() stores size bytes at base[offset]
+	void write(VideoMem mem, const u8 *base, u32 offset, uint size)
+	{
+		if(UNLIKELY(logging))
+			logWrite(mem, base, offset, size);
+	}
+
+private:
+	struct MemWrite
+	{
+		u32 offset;
+		u32 value;
+		VideoMem mem;
+		u8 size;
+	};
+
+	struct Line
+	{
+		GBALCD::RenderLineFunc renderLine;
+		MixColorType *lineMix;
+		u32 writesEnd;
+		uint layerEnable;
+		int bg2Changed;
+		int bg3Changed;
+		u16 clearLines;
+		bool windowChanged;
+		u16 regs[0x58 / 2]; // DISPCNT - COLY
+		bool inWin0[240];
+		bool inWin1[240];
+	};
+
+	std::unique_ptr<GBALCD> shadow;
+	std::unique_ptr<Line[]> lines;
+	std::unique_ptr<GBAMem::IoMem> ioMem;
+	std::vector<MemWrite> writes;
+	uint lineCount = 0;
+	uint queuedLines = 0;
+	u32 appliedWrites = 0;
+	uint pendingClear = 0;
+	bool windowDirty = true;
+	// writes are only logged while the shadow copy of video memory is current
+	bool logging = false;
+
+	std::thread thread;
+	std::mutex mutex;
+	std::condition_variable cond;
+	std::atomic<bool> busy{false};
+	bool quit = false;
+	uint threadStart = 0;
+	uint threadEnd = 0;
+
+	void logWrite(VideoMem mem, const u8 *base, u32 offset, uint size);
+	void renderLines(uint start, uint end);
+	void renderPending();
+	void applyWrites(u32 end);
+	void syncShadow(const GBALCD &lcd);
+	void queueThread();
+	void waitForThread();
+	void stopThread();
+	void threadMain();
+};
+
+extern LCDFrameRenderer lcdFrameRenderer;
+
+#endif // FRAMERENDERER_H
@@ -688,6 +688,7 @@ static void CPUUpdateWindow0(GBASys &gba)
     	gba.lcd.gfxInWin0[i] = (i >= x00 || i < x01);
     }
   }
+  lcdFrameRenderer.windowChanged();
 }
 
 static void CPUUpdateWindow1(GBASys &gba)
@@ -704,6 +705,7 @@ static void CPUUpdateWindow1(GBASys &gba)
     	gba.lcd.gfxInWin1[i] = (i >= x00 || i < x01);
     }
   }
+  lcdFrameRenderer.windowChanged();
 }
 
 static void CPUUpdateRenderBuffers(GBASys &gba, bool force)
@@ -720,6 +722,7 @@ static void CPUUpdateRenderBuffers(GBASys &gba, bool force)
   if(!(gba.lcd.layerEnable & 0x0800) || force) {
   	gfxClearArray(gba.lcd.line3);
   }
+  lcdFrameRenderer.clearLines(force ? 0x0F00 : ~gba.lcd.layerEnable & 0x0F00);
 }
 
 static bool CPUWriteState(GBASys &gba, gzFile gzFile)
@@ -803,6 +806,33 @@ bool CPUWriteMemState(GBASys &gba, char *memory, int available)
   return res;
 }
 
+int CPUWriteMemStateUncompressed(GBASys &gba, char *memory, int available)
+{
+  gzFile gzFile = utilMemGzOpen(memory, available, "w0");
+
+  if(gzFile == NULL) {
+    return 0;
+  }
+
+  bool res = CPUWriteState(gba, gzFile);
+
+  // leave room for the data deflate still buffers until the final flush
+  long pos = utilGzMemTell(gzFile)+8+0x20000;
+
+  if(pos >= (available))
+    res = false;
+
+  utilGzClose(gzFile);
+
+  if(!res)
+    return 0;
+
+  // stream size is recorded after the 8 byte header on close
+  int size;
+  memcpy(&size, memory+4, sizeof(size));
+  return size + 8;
+}
+
 static bool CPUReadState(GBASys &gba, gzFile gzFile)
 {
   int version = utilReadInt(gzFile);
@@ -973,6 +1003,7 @@ static bool CPUReadState(GBASys &gba, gzFile gzFile)
     gbaSaveType = 3;
 
   systemSaveUpdateCounter = SYSTEM_SAVE_NOT_UPDATED;
+  lcdFrameRenderer.invalidate();
   if(gba.cpu.armState) {
   	gba.cpu.ARM_PREFETCH();
   } else {
@@ -1467,6 +1498,8 @@ static void postLoadRomSetup(GBASys &gba)
 
   memset(gba.mem.ioMem.b, 0, sizeof(gba.mem.ioMem));
 
+  lcdFrameRenderer.invalidate();
+
   gba.lcd.reset();
 
   flashInit();
@@ -1511,11 +1544,13 @@ int CPULoadRom(GBASys &gba, const char *szFile)
   return romSize;
 }
 
-int CPULoadRomWithIO(GBASys &gba, IO &io)
+int CPULoadRomWithIO(GBASys &gba, IO &io, u32 mappedSize)
 {
 	preLoadRomSetup(gba);
-	u8 *whereToLoad = gba.mem.rom;
-	romSize = io.read(whereToLoad, romSize);
+	// the first mappedSize bytes are already mapped in from the file
+	u8 *whereToLoad = gba.mem.rom + mappedSize;
+	auto bytesRead = io.read(whereToLoad, romSize - mappedSize);
+	romSize = mappedSize + (bytesRead > 0 ? bytesRead : 0);
   postLoadRomSetup(gba);
   return romSize;
 }
@@ -3029,6 +3064,7 @@ void CPUReset(GBASys &gba)
       }
   }
   rtcReset();
+  lcdFrameRenderer.invalidate();
   // clean io memory
   memset(gba.mem.ioMem.b, 0, 0x400);
   // clean OAM, palette, picture, & vram
@@ -3213,6 +3249,7 @@ void CPULoop(GBASys &gba, EmuSystemTask *task, EmuVideo *video, EmuAudio *audio)
 {
 	auto cpu = gba.cpu;
 	auto &holdState = cpu.holdState;
+	const bool useFrameRenderer = lcdFrameRenderer.isEnabled();
 	auto &armIrqEnable = cpu.armIrqEnable;
 #ifdef VBAM_USE_SWITICKS
 	auto &SWITicks = cpu.SWITicks;
@@ -3422,7 +3459,10 @@ void CPULoop(GBASys &gba, EmuSystemTask *task, EmuVideo *video, EmuAudio *audio)
             	{
             	}*/
 
-              (*gba.lcd.renderLine)(gba.lcd.lineMix, gba.lcd, ioMem);
+              if(useFrameRenderer)
+              	lcdFrameRenderer.commitLine(gba);
+              else
+              	(*gba.lcd.renderLine)(gba.lcd.lineMix, gba.lcd, ioMem);
               /*switch(systemColorDepth) {
 				#ifdef SUPPORT_PIX_16BIT
                 case 16:
@@ -3462,6 +3502,10 @@ void CPULoop(GBASys &gba, EmuSystemTask *task, EmuVideo *video, EmuAudio *audio)
 				#endif
               }*/
             }
+            if(ioMem.VCOUNT == 159 && useFrameRenderer)
+            {
+            	lcdFrameRenderer.endFrame();
+            }
             if(ioMem.VCOUNT == 159 && likely(video))
             {
             	systemDrawScreen(task, *video);
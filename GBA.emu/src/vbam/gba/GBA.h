@@ -205,7 +205,8 @@ struct GBAMem
 	IoMem ioMem;
 	u8 internalRAM[0x8000] __attribute__ ((aligned(4))) {0};
 	u8 workRAM[0x40000] __attribute__ ((aligned(4))) {0};
-	u8 rom[0x2000000] __attribute__ ((aligned(4)))
+	// page aligned so the game file can be mapped over it
+	u8 rom[0x2000000] __attribute__ ((aligned(0x4000)))
 #ifndef __clang__
 	{0}
 #endif
@@ -1026,9 +1027,10 @@ extern void CPUUpdateRender(GBASys &gba);
 extern bool CPUReadMemState(GBASys &gba, char *, int);
 extern bool CPUReadState(GBASys &gba, const char *);
 extern bool CPUWriteMemState(GBASys &gba, char *, int);
+extern int CPUWriteMemStateUncompressed(GBASys &gba, char *, int);
 extern bool CPUWriteState(GBASys &gba, const char *);
 extern int CPULoadRom(GBASys &gba, const char *);
-extern int CPULoadRomWithIO(GBASys &gba, IO &);
+extern int CPULoadRomWithIO(GBASys &gba, IO &, u32 mappedSize = 0);
 extern void doMirroring(GBASys &gba, bool);
 extern void CPUUpdateRegister(ARM7TDMI &cpu, u32, u16);
 extern void applyTimer(ARM7TDMI &cpu);
@@ -8,6 +8,7 @@
 #include "agbprint.h"
 #include "GBAcpu.h"
 #include "GBALink.h"
+#include "FrameRenderer.h"
 
 static const u32  objTilesAddress [3] = {0x010000, 0x014000, 0x014000};
 
@@ -627,6 +628,7 @@ static inline void CPUWriteMemory(ARM7TDMI &cpu, u32 address, u32 value)
     else
 #endif
       WRITE32LE(((u32 *)&paletteRAM[address & 0x3FC]), value);
+    lcdFrameRenderer.write(LCDFrameRenderer::PALETTE, paletteRAM, address & 0x3FC, 4);
     break;
   case 0x06:
     address = (address & 0x1fffc);
@@ -642,6 +644,7 @@ static inline void CPUWriteMemory(ARM7TDMI &cpu, u32 address, u32 value)
 #endif
 
       WRITE32LE(((u32 *)&vram[address]), value);
+    lcdFrameRenderer.write(LCDFrameRenderer::VRAM, vram, address, 4);
     break;
   case 0x07:
 #ifdef BKPT_SUPPORT
@@ -652,6 +655,7 @@ static inline void CPUWriteMemory(ARM7TDMI &cpu, u32 address, u32 value)
 #endif
       WRITE32LE(((u32 *)&oam[address & 0x3fc]), value);
       //oamUpdated = 1;
+    lcdFrameRenderer.write(LCDFrameRenderer::OAM, oam, address & 0x3fc, 4);
     break;
   case 0x0D:
     if(cpuEEPROMEnabled) {
@@ -727,6 +731,7 @@ static inline void CPUWriteHalfWord(ARM7TDMI &cpu, u32 address, u16 value)
     else
 #endif
       WRITE16LE(((u16 *)&paletteRAM[address & 0x3fe]), value);
+    lcdFrameRenderer.write(LCDFrameRenderer::PALETTE, paletteRAM, address & 0x3fe, 2);
     break;
   case 6:
     address = (address & 0x1fffe);
@@ -741,6 +746,7 @@ static inline void CPUWriteHalfWord(ARM7TDMI &cpu, u32 address, u16 value)
     else
 #endif
       WRITE16LE(((u16 *)&vram[address]), value);
+    lcdFrameRenderer.write(LCDFrameRenderer::VRAM, vram, address, 2);
     break;
   case 7:
 #ifdef BKPT_SUPPORT
@@ -751,6 +757,7 @@ static inline void CPUWriteHalfWord(ARM7TDMI &cpu, u32 address, u16 value)
 #endif
       WRITE16LE(((u16 *)&oam[address & 0x3fe]), value);
       //oamUpdated = 1;
+    lcdFrameRenderer.write(LCDFrameRenderer::OAM, oam, address & 0x3fe, 2);
     break;
   case 8:
   case 9:
@@ -882,6 +889,7 @@ static inline void CPUWriteByte(ARM7TDMI &cpu, u32 address, u8 b)
   case 5:
     // no need to switch
   	*((uint16a *)&cpu.gba->lcd.paletteRAM[address & 0x3FE]) = (b << 8) | b;
+    lcdFrameRenderer.write(LCDFrameRenderer::PALETTE, paletteRAM, address & 0x3FE, 2);
     break;
   case 6:
     address = (address & 0x1fffe);
@@ -900,6 +908,7 @@ static inline void CPUWriteByte(ARM7TDMI &cpu, u32 address, u8 b)
       else
 #endif
       	*((uint16a *)&vram[address]) = (b << 8) | b;
+      lcdFrameRenderer.write(LCDFrameRenderer::VRAM, vram, address, 2);
     }
     break;
   case 7:
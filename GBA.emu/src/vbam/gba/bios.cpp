@@ -883,6 +883,7 @@ void BIOS_RegisterRamReset(ARM7TDMI &cpu, u32 flags)
       memset(cpu.gba->mem.internalRAM, 0, 0x7e00); // don't clear 0x7e00-0x7fff
     }
     cpu.gba->lcd.registerRamReset(flags);
+    lcdFrameRenderer.invalidate();
     /*if(flags & 0x04) {
       // clear palette RAM
       memset(paletteRAM, 0, 0x400);
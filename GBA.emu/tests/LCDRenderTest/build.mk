@@ -0,0 +1,32 @@
+ifndef inc_main
+inc_main := 1
+
+include $(IMAGINE_PATH)/make/imagineAppBase.mk
+
+VPATH += $(projectPath)/../../src
+
+CPPFLAGS += -DHAVE_ZLIB_H \
+-DFINAL_VERSION \
+-DC_CORE \
+-DNO_PNG \
+-DNO_LINK \
+-DNO_DEBUGGER \
+-DBLIP_BUFFER_FAST=1 \
+-I$(projectPath)/../../src \
+-I$(projectPath)/../../src/vbam
+
+include $(projectPath)/../../vbamSrc.mk
+
+SRC += main/main.cc \
+$(addprefix vbam/,$(vbamSrc))
+
+include $(IMAGINE_PATH)/make/package/imagine.mk
+include $(IMAGINE_PATH)/make/package/zlib.mk
+
+ifndef target
+target := LCDRenderTest
+endif
+
+include $(IMAGINE_PATH)/make/imagineAppTarget.mk
+
+endif
@@ -0,0 +1,352 @@
+/*  This file is part of GBA.emu.
+
+	GBA.emu is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	GBA.emu is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with GBA.emu.  If not, see <http://www.gnu.org/licenses/> */
+
+#define LOGTAG "main"
+#include <imagine/base/Base.hh>
+#include <imagine/io/FileIO.hh>
+#include <imagine/io/BufferMapIO.hh>
+#include <imagine/logger/logger.h>
+#include <vbam/gba/GBA.h>
+#include <vbam/gba/FrameRenderer.h>
+#include <vbam/Util.h>
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <vector>
+#include <unistd.h>
+#include <sys/wait.h>
+
+// Runs each game with the per line LCD renderer, then the batched per frame renderer,
+// then the batched renderer on its worker thread, and checks every presented frame's
+// hash matches the per line run, then reports the average time per frame of each.
+// Every third frame is run without video like with frame skip, which drops the
+// batched renderer's write log. Without ROM arguments, generated stress ROMs are used:
+// an ARM loop of random ALU ops and stores to the LCD registers, palette, VRAM and
+// OAM, so video state changes many times on every line.
+// Returns non-zero if any frame mismatches.
+// Usage: lcdrendertest [--frames N] [ROM path]...
+
+int systemSaveUpdateCounter = SYSTEM_SAVE_NOT_UPDATED;
+SystemColorMap systemColorMap;
+int systemColorDepth = 16;
+int systemRedShift = 11;
+int systemGreenShift = 6;
+int systemBlueShift = 0;
+void (*dbgOutput)(const char *, u32) = [](const char *, u32){};
+
+#ifndef NDEBUG
+void systemMessage(int num, const char *msg, ...) {}
+#endif
+int systemGetSensorX() { return 0; }
+int systemGetSensorY() { return 0; }
+bool systemCanChangeSoundQuality() { return false; }
+void systemOnWriteDataToSoundBuffer(EmuAudio *audio, const u16 *finalWave, int length) {}
+void CPULoop(GBASys &gba, EmuSystemTask *task, EmuVideo *video, EmuAudio *audio);
+
+enum class RenderMode { PER_LINE, PER_FRAME, THREADED };
+
+static std::vector<uint64_t> *frameHashes{};
+
+void systemDrawScreen(EmuSystemTask *task, EmuVideo &video)
+{
+	// FNV-1a over the frame
+	uint64_t hash = 0xcbf29ce484222325;
+	auto pix = (const uint8_t*)gGba.lcd.pix;
+	for(size_t i = 0; i < 240 * 160 * sizeof(gGba.lcd.pix[0]); i++)
+	{
+		hash ^= pix[i];
+		hash *= 0x100000001b3;
+	}
+	frameHashes->push_back(hash);
+}
+
+static std::vector<uint8_t> makeStressROM(unsigned seed)
+{
+	// r0 = LCD registers, r1 = palette, r2 = BG VRAM (moving), r3 = OAM, r12 = OBJ VRAM,
+	// r4-r11 hold random values
+	std::mt19937 rng(seed);
+	std::vector<uint32_t> code;
+	const unsigned insns = 0x3000 + rng() % 0x3000;
+	while(code.size() < insns)
+	{
+		unsigned r = rng() % 100;
+		uint32_t v = 4 + rng() % 8;
+		if(r < 30)
+		{
+			// sub/add/eor/mov/bic/orr with an immediate
+			static const uint32_t ops[]{0x2, 0x4, 0x1, 0xD, 0xE, 0xC};
+			uint32_t op = ops[rng() % 6];
+			uint32_t src = 4 + rng() % 8;
+			code.push_back(0xE2000000 | (op << 21) | (src << 16) | (v << 12) | ((rng() % 16) << 8) | (rng() & 0xFF));
+		}
+		else if(r < 45)
+		{
+			// LCD register 0x00-0x56, skipping DISPSTAT & VCOUNT
+			uint32_t off = (rng() % (0x58 / 2)) * 2;
+			if(off == 4 || off == 6)
+				off = 0x50;
+			if(off < 4)
+			{
+				// DISPCNT with a valid BG mode, mostly without forced blank:
+				// mov r13, #lo; orr r13, r13, #hi << 8; strh r13, [r0]
+				uint32_t lo = (rng() & 0xF8) | (rng() % 6);
+				if(rng() % 4)
+					lo &= ~0x80;
+				code.push_back(0xE3A0D000 | lo);
+				code.push_back(0xE38DDC00 | (rng() & 0xFF));
+				code.push_back(0xE1C0D0B0);
+				continue;
+			}
+			if(rng() % 2)
+				code.push_back(0xE1C000B0 | (v << 12) | ((off >> 4) << 8) | (off & 0xF)); // strh
+			else
+				code.push_back(0xE5800000 | (v << 12) | (off & ~3)); // str
+		}
+		else if(r < 60)
+		{
+			// palette
+			uint32_t off = rng() % 0x400;
+			if(rng() % 3 == 0)
+				code.push_back(0xE5C10000 | (v << 12) | off); // strb
+			else
+				code.push_back(0xE5810000 | (v << 12) | (off & ~3)); // str
+		}
+		else if(r < 80)
+		{
+			// BG or OBJ VRAM
+			uint32_t base = rng() % 3 ? 2 : 12;
+			uint32_t off = rng() % 0x1000;
+			switch(rng() % 3)
+			{
+				case 0: code.push_back(0xE5C00000 | (base << 16) | (v << 12) | off); break; // strb
+				case 1: code.push_back(0xE5800000 | (base << 16) | (v << 12) | (off & ~3)); break; // str
+				default: code.push_back(0xE1C000B0 | (base << 16) | (v << 12) | (((off & 0xFE) >> 4) << 8) | (off & 0xE)); // strh
+			}
+		}
+		else if(r < 90)
+		{
+			// OAM
+			uint32_t off = rng() % 0x400;
+			if(rng() % 2)
+				code.push_back(0xE5830000 | (v << 12) | (off & ~3)); // str
+			else
+				code.push_back(0xE1C300B0 | (v << 12) | (((off & 0xFE) >> 4) << 8) | (off & 0xE)); // strh
+		}
+		else
+		{
+			// move the BG VRAM base: add r2, r2, #0x400 * n; bic r2, r2, #0xFE0000
+			code.push_back(0xE2822B00 | (1 + rng() % 8));
+			code.push_back(0xE3C228FE);
+		}
+	}
+	// b to the start
+	int32_t offset = (0 - (int32_t)(code.size() * 4 + 8)) >> 2;
+	code.push_back(0xEA000000 | (offset & 0xFFFFFF));
+	std::vector<uint8_t> rom(code.size() * 4);
+	memcpy(rom.data(), code.data(), rom.size());
+	return rom;
+}
+
+static double runGame(const std::vector<uint8_t> &rom, bool isStressROM, unsigned frames,
+	RenderMode mode, std::vector<uint64_t> &hashes)
+{
+	BufferMapIO io;
+	io.open(rom.data(), rom.size());
+	if(!CPULoadRomWithIO(gGba, io))
+	{
+		fprintf(stderr, "error loading ROM\n");
+		exit(1);
+	}
+	CPUInit(gGba, 0, 0);
+	CPUReset(gGba);
+	if(isStressROM)
+	{
+		// start in ARM state at the ROM with the register setup the generated code expects
+		std::mt19937 rng(rom.size());
+		auto &cpu = gGba.cpu;
+		cpu.reg[0].I = 0x04000000;
+		cpu.reg[1].I = 0x05000000;
+		cpu.reg[2].I = 0x06000000;
+		cpu.reg[3].I = 0x07000000;
+		cpu.reg[12].I = 0x06010000;
+		for(int i = 4; i < 12; i++)
+			cpu.reg[i].I = rng();
+		cpu.armState = 1;
+		cpu.armNextPC = 0x08000000;
+		cpu.reg[15].I = cpu.armNextPC + 4;
+		cpu.ARM_PREFETCH();
+	}
+	lcdFrameRenderer.setEnabled(gGba.lcd, mode != RenderMode::PER_LINE, mode == RenderMode::THREADED);
+	hashes.clear();
+	frameHashes = &hashes;
+	// only the pointer is checked, the test's systemDrawScreen() doesn't use the video
+	auto video = (EmuVideo*)&hashes;
+	auto start = std::chrono::steady_clock::now();
+	for(unsigned i = 0; i < frames; i++)
+	{
+		CPULoop(gGba, nullptr, i % 3 == 1 ? nullptr : video, nullptr);
+	}
+	auto time = std::chrono::steady_clock::now() - start;
+	frameHashes = {};
+	lcdFrameRenderer.setEnabled(gGba.lcd, false, false);
+	return std::chrono::duration<double, std::milli>(time).count() / frames;
+}
+
+static bool readAll(int fd, void *buff, size_t size)
+{
+	auto data = (char*)buff;
+	while(size)
+	{
+		auto bytesRead = read(fd, data, size);
+		if(bytesRead <= 0)
+			return false;
+		data += bytesRead;
+		size -= bytesRead;
+	}
+	return true;
+}
+
+static double runGameInChild(const std::vector<uint8_t> &rom, bool isStressROM, unsigned frames,
+	RenderMode mode, std::vector<uint64_t> &hashes)
+{
+	// every run starts from a fork of the same process so no core or renderer
+	// state carries over between the runs being compared
+	int fds[2];
+	if(pipe(fds) == -1)
+	{
+		perror("pipe");
+		exit(1);
+	}
+	auto pid = fork();
+	if(pid == -1)
+	{
+		perror("fork");
+		exit(1);
+	}
+	if(!pid)
+	{
+		close(fds[0]);
+		double time = runGame(rom, isStressROM, frames, mode, hashes);
+		uint32_t count = hashes.size();
+		if(write(fds[1], &time, sizeof(time)) != sizeof(time) ||
+			write(fds[1], &count, sizeof(count)) != sizeof(count) ||
+			write(fds[1], hashes.data(), count * sizeof(uint64_t)) != (ssize_t)(count * sizeof(uint64_t)))
+			_exit(1);
+		_exit(0);
+	}
+	close(fds[1]);
+	double time{};
+	uint32_t count{};
+	bool success = readAll(fds[0], &time, sizeof(time)) && readAll(fds[0], &count, sizeof(count));
+	if(success)
+	{
+		hashes.resize(count);
+		success = readAll(fds[0], hashes.data(), count * sizeof(uint64_t));
+	}
+	close(fds[0]);
+	int status;
+	waitpid(pid, &status, 0);
+	if(!success || !WIFEXITED(status) || WEXITSTATUS(status))
+	{
+		fprintf(stderr, "run in mode %d failed\n", (int)mode);
+		exit(1);
+	}
+	return time;
+}
+
+static bool runTest(const char *name, const std::vector<uint8_t> &rom, bool isStressROM, unsigned frames)
+{
+	std::vector<uint64_t> lineHashes, frameHashes, threadedHashes;
+	double lineTime = runGameInChild(rom, isStressROM, frames, RenderMode::PER_LINE, lineHashes);
+	double frameTime = runGameInChild(rom, isStressROM, frames, RenderMode::PER_FRAME, frameHashes);
+	double threadedTime = runGameInChild(rom, isStressROM, frames, RenderMode::THREADED, threadedHashes);
+	auto countMismatches = [&](const std::vector<uint64_t> &hashes)
+		{
+			if(hashes.size() != lineHashes.size())
+				return (unsigned)std::max(hashes.size(), lineHashes.size());
+			unsigned mismatches = 0;
+			for(size_t i = 0; i < hashes.size(); i++)
+				mismatches += hashes[i] != lineHashes[i];
+			return mismatches;
+		};
+	unsigned frameMismatches = countMismatches(frameHashes);
+	unsigned threadedMismatches = countMismatches(threadedHashes);
+	printf("%-20s %4zu frames  line:%7.3fms  frame:%7.3fms  threaded:%7.3fms  ",
+		name, lineHashes.size(), lineTime, frameTime, threadedTime);
+	if(frameMismatches || threadedMismatches)
+		printf("MISMATCH in %u per frame, %u threaded\n", frameMismatches, threadedMismatches);
+	else
+		printf("all frames match\n");
+	return !frameMismatches && !threadedMismatches;
+}
+
+static std::vector<uint8_t> readFile(const char *path)
+{
+	std::vector<uint8_t> data;
+	FileIO io;
+	if(io.open(path, IO::AccessHint::ALL))
+		return data;
+	data.resize(std::min(io.size(), (size_t)sizeof(gGba.mem.rom)));
+	if(io.read(data.data(), data.size()) != (ssize_t)data.size())
+		data.clear();
+	return data;
+}
+
+namespace Base
+{
+
+int runHeadless(int argc, char** argv)
+{
+	unsigned frames = 600;
+	std::vector<const char*> romPaths;
+	for(int i = 1; i < argc; i++)
+	{
+		if(!strcmp(argv[i], "--frames") && i + 1 < argc)
+			frames = std::max(strtoul(argv[++i], nullptr, 10), 1ul);
+		else
+			romPaths.push_back(argv[i]);
+	}
+	utilUpdateSystemColorMaps(0);
+	bool pass = true;
+	if(romPaths.empty())
+	{
+		for(unsigned seed : {1, 2, 3, 4, 5, 6, 7, 8})
+		{
+			char name[32];
+			snprintf(name, sizeof(name), "stress seed %u", seed);
+			pass &= runTest(name, makeStressROM(seed), true, frames);
+		}
+	}
+	for(auto path : romPaths)
+	{
+		auto rom = readFile(path);
+		if(rom.empty())
+		{
+			fprintf(stderr, "error reading %s\n", path);
+			return 1;
+		}
+		auto name = strrchr(path, '/');
+		pass &= runTest(name ? name + 1 : path, rom, false, frames);
+	}
+	printf("%s\n", pass ? "batched rendering matches per line" : "BATCHED RENDERING MISMATCH");
+	return pass ? 0 : 1;
+}
+
+void onInit(int argc, char** argv) {}
+
+}
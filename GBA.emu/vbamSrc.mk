@@ -0,0 +1,32 @@
+# VBA-M core sources, relative to src/vbam
+vbamSrc := gba/GBA-thumb.cpp \
+gba/bios.cpp \
+gba/Globals.cpp \
+gba/Cheats.cpp \
+gba/Mode0.cpp \
+gba/CheatSearch.cpp \
+gba/Mode1.cpp \
+gba/Mode2.cpp \
+gba/Mode3.cpp \
+gba/Mode4.cpp \
+gba/Mode5.cpp \
+gba/EEprom.cpp \
+gba/Flash.cpp \
+gba/GBA-arm.cpp \
+gba/FrameRenderer.cpp \
+gba/GBA.cpp \
+gba/gbafilter.cpp \
+gba/RTC.cpp \
+gba/Sound.cpp \
+gba/Sram.cpp \
+common/memgzio.c \
+common/Patch.cpp \
+Util.cpp
+#gba/remote.cpp gba/GBASockClient.cpp gba/GBALink.cpp gba/agbprint.cpp
+#gba/armdis.cpp gba/elf.cpp
+
+vbamSrc += apu/Gb_Apu.cpp \
+apu/Gb_Oscs.cpp \
+apu/Blip_Buffer.cpp \
+apu/Multi_Buffer.cpp \
+apu/Gb_Apu_State.cpp
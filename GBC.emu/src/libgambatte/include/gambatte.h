@@ -23,6 +23,7 @@
 #include "inputgetter.h"
 #include "loadres.h"
 #include <cstddef>
+#include <iosfwd>
 #include <string>
 #include <imagine/util/DelegateFunc.hh>
 
@@ -154,6 +155,19 @@ public:
 	  */
 	bool loadState(std::string const &filepath);
 
+	/**
+	  * Saves emulator state to the stream 'file'.
+	  * @return success
+	  */
+	bool saveState(gambatte::uint_least32_t const *videoBuf, std::ptrdiff_t pitch,
+	               std::ostream &file);
+
+	/**
+	  * Loads emulator state from the stream 'file'.
+	  * @return success
+	  */
+	bool loadState(std::istream &file);
+
 	/**
 	  * Selects which state slot to save state to or load state from.
 	  * There are 10 such slots, numbered from 0 to 9 (periodically extended for all n).
@@ -161,6 +161,20 @@ bool GB::loadState(std::string const &filepath) {
 	return false;
 }
 
+bool GB::loadState(std::istream &file) {
+	if (p_->cpu.loaded()) {
+		SaveState state = SaveState();
+		p_->cpu.setStatePtrs(state);
+
+		if (StateSaver::loadState(state, file)) {
+			p_->cpu.loadState(state);
+			return true;
+		}
+	}
+
+	return false;
+}
+
 bool GB::saveState(gambatte::uint_least32_t const *videoBuf, std::ptrdiff_t pitch) {
 	if (saveState(videoBuf, pitch, statePath(p_->cpu.saveBasePath(), p_->stateNo))) {
 		#ifndef GAMBATTE_NO_OSD
@@ -195,6 +209,18 @@ bool GB::saveState(gambatte::uint_least32_t const *videoBuf, std::ptrdiff_t pitc
 	return false;
 }
 
+bool GB::saveState(gambatte::uint_least32_t const *videoBuf, std::ptrdiff_t pitch,
+                   std::ostream &file) {
+	if (p_->cpu.loaded()) {
+		SaveState state;
+		p_->cpu.setStatePtrs(state);
+		p_->cpu.saveState(state);
+		return StateSaver::saveState(state, videoBuf, pitch, file);
+	}
+
+	return false;
+}
+
 void GB::selectState(int n) {
 	n -= (n / 10) * 10;
 	p_->stateNo = n < 0 ? n + 10 : n;
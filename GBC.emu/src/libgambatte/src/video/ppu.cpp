@@ -219,6 +219,13 @@ namespace M2 {
 }
 */
 
+namespace M3Loop {
+namespace QuietLine {
+	bool isQuiet(PPUPriv const &p);
+	void f0(PPUPriv &p);
+}
+}
+
 int loadTileDataByte0(PPUPriv const &p) {
 	unsigned const yoffset = p.winDrawState & win_draw_started
 		? p.winYPos
@@ -256,6 +263,9 @@ namespace M3Start {
 		} else
 			p.winDrawState = 0;
 
+		if (ppuQuietLineFastPath && M3Loop::QuietLine::isQuiet(p))
+			return M3Loop::QuietLine::f0(p);
+
 		p.nextCallPtr = &f1_;
 		f1(p);
 	}
@@ -1223,6 +1233,179 @@ namespace Tile {
 	}
 }
 
+// A line with no sprites and no window start, whose mode 3 ends within the cycles
+// to run, can't see a mid-line register or memory write. Such lines are drawn a
+// tile at a time, then the fetcher registers are left as the states above would
+// leave them, which depends on where the window x position split the unrolled loop.
+namespace QuietLine {
+	int cycles(PPUPriv const &p) {
+		return xpos_end + p.scx % tile_len - p.cgb;
+	}
+
+	bool isQuiet(PPUPriv const &p) {
+		unsigned const ly = p.lyCounter.ly();
+		return p.winDrawState == 0
+		    && !((p.weMaster || (p.wy2 == ly && lcdcWinEn(p))) && p.wx < lcd_hres + 7)
+		    && p.spriteMapper.numSprites(ly) == 0
+		    && p.cycles >= cycles(p) + tile_len;
+	}
+
+	unsigned char const * bgTileMapLine(PPUPriv const &p) {
+		return p.vram + tile_map_size / lcdc_bgtmsel * (p.lcdc & lcdc_bgtmsel)
+			+ tile_map_len / tile_len * ((p.scy + p.lyCounter.ly()) & (0x100 - tile_len))
+			+ tile_map_begin;
+	}
+
+	unsigned loadTilewordDmg(unsigned char const *const tileDataLine,
+			int const tileIndexSign, unsigned char const *const tileMapLine, unsigned const tileMapXpos) {
+		unsigned const tno = tileMapLine[tileMapXpos % tile_map_len];
+		int const ts = tile_size;
+		return expand_lut[(tileDataLine + ts * tno - 2 * ts * (tno & tileIndexSign))[0]]
+		     + expand_lut[(tileDataLine + ts * tno - 2 * ts * (tno & tileIndexSign))[1]] * 2;
+	}
+
+	unsigned loadTilewordCgb(PPUPriv const &p, unsigned const tdoffset,
+			unsigned char const *const tileMapLine, unsigned const tileMapXpos) {
+		unsigned const tno     = tileMapLine[tileMapXpos % tile_map_len                 ];
+		unsigned const nattrib = tileMapLine[tileMapXpos % tile_map_len + vram_bank_size];
+		unsigned const tdo = tdoffset & ~(tno << 5);
+		unsigned char const *const td = p.vram + tno * tile_size
+			+ (nattrib & attr_yflip ? tdo ^ tile_line_size * (tile_len - 1) : tdo)
+			+ vram_bank_size / attr_tdbank * (nattrib & attr_tdbank);
+		unsigned short const *const explut = expand_lut + (0x100 / attr_xflip * nattrib & 0x100);
+		return explut[td[0]] + explut[td[1]] * 2;
+	}
+
+	// the tile word doFullTilesUnrolled loads for a tile map column
+	unsigned loadTileword(PPUPriv const &p, unsigned char const *const tileMapLine, unsigned const tileMapXpos) {
+		unsigned const tileline = (p.scy + p.lyCounter.ly()) % tile_len;
+		if (p.cgb) {
+			unsigned const tdoffset = tileline * tile_line_size
+				+ tile_pattern_table_size / lcdc_tdsel * (~p.lcdc & lcdc_tdsel);
+			return loadTilewordCgb(p, tdoffset, tileMapLine, tileMapXpos);
+		}
+
+		int const tileIndexSign = p.lcdc & lcdc_tdsel ? 0 : tile_pattern_table_size / tile_size / 2;
+		return loadTilewordDmg(p.vram + 2 * tile_size * tileIndexSign + tileline * tile_line_size,
+		                       tileIndexSign, tileMapLine, tileMapXpos);
+	}
+
+	void plotTile(uint_least32_t *const dst, unsigned const tileword, unsigned long const *const bgPalette) {
+		dst[0] = bgPalette[ tileword & tile_bpp_mask                                 ];
+		dst[1] = bgPalette[(tileword & tile_bpp_mask << 1 * tile_bpp) >> 1 * tile_bpp];
+		dst[2] = bgPalette[(tileword & tile_bpp_mask << 2 * tile_bpp) >> 2 * tile_bpp];
+		dst[3] = bgPalette[(tileword & tile_bpp_mask << 3 * tile_bpp) >> 3 * tile_bpp];
+		dst[4] = bgPalette[(tileword & tile_bpp_mask << 4 * tile_bpp) >> 4 * tile_bpp];
+		dst[5] = bgPalette[(tileword & tile_bpp_mask << 5 * tile_bpp) >> 5 * tile_bpp];
+		dst[6] = bgPalette[(tileword & tile_bpp_mask << 6 * tile_bpp) >> 6 * tile_bpp];
+		dst[7] = bgPalette[ tileword                                  >> 7 * tile_bpp];
+	}
+
+	void drawLine(PPUPriv const &p, unsigned char const *const tileMapLine) {
+		int const xoffset = p.scx % tile_len;
+		uint_least32_t prebuf[lcd_hres + tile_len];
+		uint_least32_t *const dbufline = p.framebuf.fbline();
+		uint_least32_t *dst = xoffset ? prebuf : dbufline;
+		uint_least32_t *const dstend = dst + xoffset + lcd_hres;
+		unsigned tileMapXpos = p.scx / tile_len;
+		unsigned const tileline = (p.scy + p.lyCounter.ly()) % tile_len;
+
+		if (p.cgb) {
+			unsigned const tdoffset = tileline * tile_line_size
+				+ tile_pattern_table_size / lcdc_tdsel * (~p.lcdc & lcdc_tdsel);
+
+			do {
+				unsigned const nattrib = tileMapLine[tileMapXpos % tile_map_len + vram_bank_size];
+				plotTile(dst, loadTilewordCgb(p, tdoffset, tileMapLine, tileMapXpos),
+				         p.bgPalette + (nattrib & attr_cgbpalno) * num_palette_entries);
+				dst += tile_len;
+				++tileMapXpos;
+			} while (dst < dstend);
+		} else if (lcdcBgEn(p)) {
+			int const tileIndexSign = p.lcdc & lcdc_tdsel ? 0 : tile_pattern_table_size / tile_size / 2;
+			unsigned char const *const tileDataLine = p.vram + 2 * tile_size * tileIndexSign
+				+ tileline * tile_line_size;
+
+			do {
+				plotTile(dst, loadTilewordDmg(tileDataLine, tileIndexSign, tileMapLine, tileMapXpos),
+				         p.bgPalette);
+				dst += tile_len;
+				++tileMapXpos;
+			} while (dst < dstend);
+		} else {
+			std::fill_n(dbufline, 1 * lcd_hres, p.bgPalette[0]);
+			return;
+		}
+
+		if (xoffset)
+			std::memcpy(dbufline, prebuf + xoffset, lcd_hres * sizeof *dbufline);
+	}
+
+	void f0(PPUPriv &p) {
+		unsigned char const *const tileMapLine = bgTileMapLine(p);
+		drawLine(p, tileMapLine);
+
+		// M3Start, and the first tile when scx isn't tile aligned
+		int const xoffset = p.scx % tile_len;
+		p.endx = tile_len - xoffset;
+		if (xoffset) {
+			p.reg1    = tileMapLine[p.scx / tile_len                 ];
+			p.nattrib = tileMapLine[p.scx / tile_len + vram_bank_size];
+			p.reg0 = loadTileDataByte0(p);
+			p.ntileword = (expand_lut + (0x100 / attr_xflip * p.nattrib & 0x100))[p.reg0]
+			            + (expand_lut + (0x100 / attr_xflip * p.nattrib & 0x100))[loadTileDataByte1(p)] * 2;
+		}
+
+		p.spriteList[0].spx = 0xFF;
+		p.nextSprite = 0;
+
+		// Tile::f0 at each tile start, unrolled up to the window x position,
+		// after which one tile is done pixel by pixel
+		int xpos = p.endx % tile_len;
+		for (;;) {
+			int const xend = p.wx < xpos || p.wx >= xpos_end
+				? lcd_hres + 1
+				: static_cast<int>(p.wx) - 7;
+			if (xpos < xend) {
+				xpos += (xend - xpos + tile_len - 1) & -tile_len;
+
+				unsigned const tileMapXpos = (p.scx + xpos + 1u - p.cgb) / tile_len - 1;
+				p.ntileword = loadTileword(p, tileMapLine, tileMapXpos);
+				if (p.cgb)
+					p.nattrib = tileMapLine[tileMapXpos % tile_map_len + vram_bank_size];
+
+				if (xpos == xpos_end)
+					break;
+			}
+
+			p.tileword = p.ntileword;
+			p.attrib = p.nattrib;
+			p.endx = std::min(xpos_end, xpos + tile_len);
+
+			unsigned const tileMapXpos = (p.scx + xpos + 1u - p.cgb) / tile_len;
+			p.reg1    = tileMapLine[tileMapXpos % tile_map_len                 ];
+			p.nattrib = tileMapLine[tileMapXpos % tile_map_len + vram_bank_size];
+
+			int const n = p.endx - xpos;
+			if (n > 2)
+				p.reg0 = loadTileDataByte0(p);
+			if (n > 4) {
+				p.ntileword = (expand_lut + (0x100 / attr_xflip * p.nattrib & 0x100))[p.reg0]
+				            + (expand_lut + (0x100 / attr_xflip * p.nattrib & 0x100))[loadTileDataByte1(p)] * 2;
+			}
+
+			p.tileword >>= n * tile_bpp;
+			xpos = p.endx;
+			if (xpos == xpos_end)
+				break;
+		}
+
+		p.xpos = xpos_end;
+		p.cycles -= cycles(p);
+		xposEnd(p);
+	}
+}
+
 } // namespace M3Loop
 
 namespace M2_Ly0 {
@@ -1530,6 +1713,8 @@ namespace M2_LyNon0 {
 
 } // anon namespace
 
+bool gambatte::ppuQuietLineFastPath = true;
+
 PPUPriv::PPUPriv(NextM0Time &nextM0Time, unsigned char const *const oamram, unsigned char const *const vram)
 : spriteList()
 , spwordList()
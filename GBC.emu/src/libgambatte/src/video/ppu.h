@@ -52,6 +52,10 @@ private:
 
 struct PPUPriv;
 
+// When set (the default), lines without sprites or a window start are drawn a tile
+// at a time. Clearing it runs every line through the per pixel fetcher for A/B checks.
+extern bool ppuQuietLineFastPath;
+
 struct PPUState {
 	void (*f)(PPUPriv &v);
 	unsigned (*predictCyclesUntilXpos_f)(PPUPriv const &v, int targetxpos, unsigned cycles);
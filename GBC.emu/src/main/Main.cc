@@ -26,6 +26,8 @@
 #include <main/Cheats.hh>
 #include <main/Palette.hh>
 #include "internal.hh"
+#include <istream>
+#include <ostream>
 
 const char *EmuSystem::creditsViewStr = CREDITS_INFO_STRING "(c) 2011-2021\nRobert Broglia\nwww.explusalpha.com\n\n(c) 2011\nthe Gambatte Team\ngambatte.sourceforge.net";
 gambatte::GB gbEmu;
@@ -37,6 +39,9 @@ alignas(8) static uint_least32_t frameBuffer[gambatte::lcd_hres * gambatte::lcd_
 static const IG::Pixmap frameBufferPix{{{gambatte::lcd_hres, gambatte::lcd_vres}, IG::PIXEL_RGBA8888}, frameBuffer};
 static const GBPalette *gameBuiltinPalette{};
 bool EmuSystem::hasCheats = true;
+bool EmuSystem::hasRunAhead = true;
+bool EmuSystem::hasRewind = true;
+bool EmuSystem::hasMemoryStates = true;
 EmuSystem::NameFilterFunc EmuSystem::defaultFsFilter =
 	[](const char *name)
 	{
@@ -145,6 +150,63 @@ EmuSystem::Error EmuSystem::loadState(const char *path)
 		return {};
 }
 
+// stream buffers letting gambatte's state serializer work directly on memory
+class ByteBufferStreamBuf : public std::streambuf
+{
+public:
+	ByteBufferStreamBuf(IG::ByteBuffer &buff): buff{buff} {}
+
+protected:
+	IG::ByteBuffer &buff;
+
+	std::streamsize xsputn(const char *s, std::streamsize n) final
+	{
+		buff.append(s, n);
+		return n;
+	}
+
+	int_type overflow(int_type c) final
+	{
+		if(!traits_type::eq_int_type(c, traits_type::eof()))
+		{
+			char ch = traits_type::to_char_type(c);
+			buff.append(&ch, 1);
+		}
+		return traits_type::not_eof(c);
+	}
+};
+
+class ConstBufferStreamBuf : public std::streambuf
+{
+public:
+	ConstBufferStreamBuf(const char *data, size_t size)
+	{
+		auto ptr = const_cast<char*>(data);
+		setg(ptr, ptr, ptr + size);
+	}
+};
+
+EmuSystem::Error EmuSystem::saveState(IG::ByteBuffer &buff)
+{
+	buff.clear();
+	ByteBufferStreamBuf streamBuf{buff};
+	std::ostream stream{&streamBuf};
+	if(!gbEmu.saveState(nullptr, 0, stream))
+		return makeFileWriteError();
+	else
+		return {};
+}
+
+EmuSystem::Error EmuSystem::loadState(IG::ConstBufferView buff)
+{
+	ConstBufferStreamBuf streamBuf{buff.data(), buff.size()};
+	std::istream stream{&streamBuf};
+	if(!gbEmu.loadState(stream))
+		return makeFileReadError();
+	else
+		return {};
+}
+
 void EmuSystem::saveBackupMem()
 {
 	logMsg("saving battery");
@@ -0,0 +1,33 @@
+ifndef inc_main
+inc_main := 1
+
+include $(IMAGINE_PATH)/make/imagineAppBase.mk
+
+VPATH += $(projectPath)/../../src
+
+CPPFLAGS += -DHAVE_STDINT_H \
+-DGAMBATTE_NO_OSD \
+-I$(projectPath)/../../src/libgambatte/include \
+-I$(projectPath)/../../src/common \
+-iquote $(projectPath)/../../src/libgambatte/src
+
+libgambatteVideoSrc := src/video.cpp \
+src/interruptrequester.cpp \
+src/video/ly_counter.cpp \
+src/video/lyc_irq.cpp \
+src/video/next_m0_time.cpp \
+src/video/ppu.cpp \
+src/video/sprite_mapper.cpp
+
+SRC += main/main.cc \
+$(addprefix libgambatte/,$(libgambatteVideoSrc))
+
+include $(IMAGINE_PATH)/make/package/imagine.mk
+
+ifndef target
+target := PPUFastPathTest
+endif
+
+include $(IMAGINE_PATH)/make/imagineAppTarget.mk
+
+endif
@@ -0,0 +1,330 @@
+/*  This file is part of GBC.emu.
+
+	GBC.emu is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	GBC.emu is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with GBC.emu.  If not, see <http://www.gnu.org/licenses/> */
+
+#include <imagine/base/Base.hh>
+#include "video.h"
+#include "savestate.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <vector>
+
+// Drives the LCD with each scenario's register, VRAM and OAM writes twice, first with
+// the PPU's quiet line fast path, then with every line going through the per pixel
+// fetcher, and checks the PPU state and frame buffer hash after every step match.
+// Frame scenarios only change state between whole frame updates, with sprites kept
+// off screen, so most lines take the fast path. They cover the cases it has to hand
+// back to the per pixel fetcher: a window starting mid line, a fine scroll leaving a
+// partial tile at the end of the line, and DMG with the BG disabled. Random scenarios
+// write at random times, including mid line, with some sprites on screen.
+// Reports the average time spent in LCD updates per frame of each run.
+// Returns non-zero if any step mismatches.
+// Usage: ppufastpathtest [--frames N] [--steps N]
+
+using namespace gambatte;
+
+enum
+{
+	WINDOW_SPLIT = 1 << 0,
+	SCX_TAIL = 1 << 1,
+	BG_OFF = 1 << 2,
+};
+
+enum class Writes { FRAME, SPARSE, DENSE };
+
+struct Scenario
+{
+	const char *name;
+	bool cgb;
+	Writes writes;
+	unsigned flags;
+	unsigned seed;
+};
+
+static unsigned char vram[0x4000];
+static unsigned char ioamhram[0x200];
+static uint_least32_t frameBuff[160 * 144];
+
+struct Hash
+{
+	// FNV-1a
+	uint64_t val = 0xcbf29ce484222325;
+
+	void add(const void *data, size_t size)
+	{
+		auto bytes = (const uint8_t*)data;
+		for(size_t i = 0; i < size; i++)
+		{
+			val ^= bytes[i];
+			val *= 0x100000001b3;
+		}
+	}
+
+	template<class T>
+	void addVal(T v) { add(&v, sizeof(v)); }
+};
+
+static uint64_t stateHash(LCD &lcd, unsigned long cc, bool withFrame)
+{
+	SaveState state;
+	std::memset(&state.ppu, 0, sizeof(state.ppu));
+	lcd.setStatePtrs(state);
+	lcd.saveState(state);
+	auto &p = state.ppu;
+	Hash h;
+	h.addVal(p.videoCycles); h.addVal(p.enableDisplayM0Time); h.addVal(p.lastM0Time); h.addVal(p.nextM0Irq);
+	h.addVal(p.tileword); h.addVal(p.ntileword);
+	h.add(p.spAttribList, sizeof(p.spAttribList)); h.add(p.spByte0List, sizeof(p.spByte0List));
+	h.add(p.spByte1List, sizeof(p.spByte1List));
+	h.addVal(p.winYPos); h.addVal(p.xpos); h.addVal(p.endx); h.addVal(p.reg0); h.addVal(p.reg1);
+	h.addVal(p.attrib); h.addVal(p.nattrib); h.addVal(p.state); h.addVal(p.nextSprite);
+	h.addVal(p.currentSprite); h.addVal(p.lyc); h.addVal(p.m0lyc); h.addVal(p.oldWy);
+	h.addVal(p.winDrawState); h.addVal(p.wscx); h.addVal(p.weMaster); h.addVal(p.pendingLcdstatIrq);
+	h.addVal(lcd.getStat(0, cc)); h.addVal(lcd.vramReadable(cc)); h.addVal(lcd.oamReadable(cc));
+	if(withFrame)
+		h.add(frameBuff, sizeof(frameBuff));
+	return h.val;
+}
+
+static unsigned scenarioLcdc(const Scenario &s, std::mt19937 &rng)
+{
+	unsigned lcdc = 0x80 | (rng() & 0x7F);
+	if(s.flags & WINDOW_SPLIT)
+		lcdc |= 0x20;
+	else if(s.writes == Writes::FRAME)
+		lcdc &= ~0x20;
+	if(s.flags & BG_OFF)
+		lcdc &= ~0x01;
+	else if(s.writes == Writes::FRAME)
+		lcdc |= 0x01;
+	return lcdc;
+}
+
+static unsigned scenarioScx(const Scenario &s, std::mt19937 &rng)
+{
+	if(s.flags & SCX_TAIL)
+		return (rng() & 0xF8) | (1 + rng() % 7);
+	return s.writes == Writes::FRAME ? rng() & 0xF8 : rng() & 0xFF;
+}
+
+static void frameWrites(const Scenario &s, LCD &lcd, unsigned &lcdc, std::mt19937 &rng, unsigned long cc)
+{
+	if(s.flags & WINDOW_SPLIT)
+	{
+		// window start anywhere on screen, including past the first and last tile
+		lcd.wxChange(7 + rng() % 160, cc);
+		lcd.wyChange(rng() % 144, cc);
+	}
+	lcd.scxChange(scenarioScx(s, rng), cc);
+	lcd.scyChange(rng() & 0xFF, cc);
+	if(rng() % 4 == 0)
+	{
+		lcdc = scenarioLcdc(s, rng);
+		lcd.lcdcChange(lcdc, cc);
+	}
+	for(unsigned i = 0; i < 16; i++)
+	{
+		lcd.vramChange(cc);
+		vram[rng() & (s.cgb ? 0x3FFF : 0x1FFF)] = rng();
+	}
+	if(s.cgb)
+		lcd.cgbBgColorChange(rng() % 64, rng() & 0xFF, cc);
+	else
+		lcd.dmgBgPaletteChange(rng() & 0xFF, cc);
+}
+
+static void randomWrite(const Scenario &s, LCD &lcd, unsigned &lcdc, std::mt19937 &rng, unsigned long cc)
+{
+	switch(rng() % 14)
+	{
+		case 0: lcd.scxChange(rng() & 0xFF, cc); break;
+		case 1: lcd.scyChange(rng() & 0xFF, cc); break;
+		case 2: lcd.wxChange(rng() % 2 ? 160 + rng() % 96 : rng() & 0xFF, cc); break;
+		case 3: lcd.wyChange(rng() & 0xFF, cc); break;
+		case 4:
+			lcdc = (lcdc & 0x80) | (rng() & 0x7F);
+			lcd.lcdcChange(lcdc, cc);
+			break;
+		case 5:
+			lcd.vramChange(cc);
+			vram[rng() & (s.cgb ? 0x3FFF : 0x1FFF)] = rng();
+			break;
+		case 6:
+		{
+			unsigned i = rng() % 0xA0;
+			lcd.oamChange(cc);
+			ioamhram[i] = (i & 3) == 0 && rng() % 2 ? 160 + rng() % 96 : rng();
+			break;
+		}
+		case 7:
+			if(s.cgb)
+				lcd.cgbBgColorChange(rng() % 64, rng() & 0xFF, cc);
+			else
+				lcd.dmgBgPaletteChange(rng() & 0xFF, cc);
+			break;
+		case 8: lcd.lycRegChange(rng() % 154, cc); break;
+		case 9: lcd.lcdstatChange(rng() & 0x78, cc); break;
+		default: lcd.update(cc); break;
+	}
+}
+
+static double runScenario(const Scenario &s, unsigned steps, bool fastPath, std::vector<uint64_t> &hashes)
+{
+	ppuQuietLineFastPath = fastPath;
+	std::mt19937 rng(s.seed);
+	for(auto &v : vram)
+		v = rng();
+	if(!s.cgb)
+		std::fill(vram + 0x2000, vram + 0x4000, 0);
+	for(unsigned i = 0; i < 0xA0; i++)
+		ioamhram[i] = rng();
+	// frame scenarios keep every sprite off screen, the others about three quarters
+	for(unsigned i = 0; i < 40; i++)
+	{
+		if(s.writes == Writes::FRAME || rng() % 4)
+			ioamhram[i * 4] = 160 + rng() % 96;
+	}
+	InterruptRequester intreq;
+	LCD lcd(ioamhram, vram, VideoInterruptRequester(intreq));
+	lcd.reset(ioamhram, vram, s.cgb);
+	lcd.setVideoBuffer(frameBuff, 160);
+	std::fill(std::begin(frameBuff), std::end(frameBuff), 0);
+	unsigned long cc = 0x100;
+	if(s.cgb)
+	{
+		for(unsigned i = 0; i < 64; i++)
+		{
+			lcd.cgbBgColorChange(i, rng() & 0xFF, cc);
+			lcd.cgbSpColorChange(i, rng() & 0xFF, cc);
+		}
+	}
+	else
+	{
+		lcd.dmgBgPaletteChange(rng() & 0xFF, cc);
+		lcd.dmgSpPalette1Change(rng() & 0xFF, cc);
+		lcd.dmgSpPalette2Change(rng() & 0xFF, cc);
+	}
+	lcd.scxChange(scenarioScx(s, rng), cc);
+	lcd.scyChange(rng() & 0xFF, cc);
+	if(s.flags & WINDOW_SPLIT)
+		lcd.wxChange(7 + rng() % 160, cc);
+	else
+		lcd.wxChange(rng() % 3 ? 167 + rng() % 89 : rng() & 0xFF, cc);
+	lcd.wyChange(rng() % 144, cc);
+	unsigned lcdc = scenarioLcdc(s, rng);
+	lcd.lcdcChange(lcdc, cc);
+	hashes.clear();
+	hashes.reserve(steps);
+	unsigned long startCc = cc;
+	std::chrono::steady_clock::duration updateTime{};
+	for(unsigned i = 0; i < steps; i++)
+	{
+		switch(s.writes)
+		{
+			case Writes::FRAME: cc += 70224 + rng() % 16; break;
+			case Writes::SPARSE: cc += rng() % 2 ? rng() % 4000 : rng() % 500; break;
+			case Writes::DENSE: cc += rng() % 2 ? rng() % 460 : rng() % 40; break;
+		}
+		// only the PPU's catch up to the write time is timed
+		auto start = std::chrono::steady_clock::now();
+		lcd.update(cc);
+		updateTime += std::chrono::steady_clock::now() - start;
+		if(s.writes == Writes::FRAME)
+			frameWrites(s, lcd, lcdc, rng, cc);
+		else
+			randomWrite(s, lcd, lcdc, rng, cc);
+		hashes.push_back(stateHash(lcd, cc, s.writes == Writes::FRAME || i % 64 == 0));
+	}
+	lcd.update(cc);
+	hashes.push_back(stateHash(lcd, cc, true));
+	double frames = std::max((cc - startCc) / 70224., 1.);
+	return std::chrono::duration<double, std::milli>(updateTime).count() / frames;
+}
+
+static bool runTest(const Scenario &s, unsigned steps)
+{
+	std::vector<uint64_t> fastHashes, pixelHashes;
+	double fastTime = runScenario(s, steps, true, fastHashes);
+	double pixelTime = runScenario(s, steps, false, pixelHashes);
+	ppuQuietLineFastPath = true;
+	auto mismatch = std::mismatch(fastHashes.begin(), fastHashes.end(), pixelHashes.begin());
+	printf("%-24s %5zu steps  per pixel:%7.3fms  fast:%7.3fms  ",
+		s.name, fastHashes.size(), pixelTime, fastTime);
+	if(mismatch.first != fastHashes.end())
+	{
+		printf("MISMATCH from step %zu\n", (size_t)(mismatch.first - fastHashes.begin()));
+		return false;
+	}
+	printf("all steps match\n");
+	return true;
+}
+
+namespace Base
+{
+
+int runHeadless(int argc, char** argv)
+{
+	unsigned frames = 600;
+	unsigned steps = 3000;
+	for(int i = 1; i < argc; i++)
+	{
+		if(!strcmp(argv[i], "--frames") && i + 1 < argc)
+			frames = std::max(strtoul(argv[++i], nullptr, 10), 1ul);
+		else if(!strcmp(argv[i], "--steps") && i + 1 < argc)
+			steps = std::max(strtoul(argv[++i], nullptr, 10), 1ul);
+		else
+		{
+			fprintf(stderr, "unknown argument %s\n", argv[i]);
+			return 1;
+		}
+	}
+	const Scenario frameScenarios[]
+	{
+		{"quiet DMG", false, Writes::FRAME, 0, 1},
+		{"quiet CGB", true, Writes::FRAME, 0, 2},
+		{"window x split DMG", false, Writes::FRAME, WINDOW_SPLIT, 3},
+		{"window x split CGB", true, Writes::FRAME, WINDOW_SPLIT, 4},
+		{"scx tail tile DMG", false, Writes::FRAME, SCX_TAIL, 5},
+		{"scx tail tile CGB", true, Writes::FRAME, SCX_TAIL, 6},
+		{"BG off DMG", false, Writes::FRAME, BG_OFF, 7},
+		{"BG off + scx tail DMG", false, Writes::FRAME, BG_OFF | SCX_TAIL, 8},
+		{"window + scx tail CGB", true, Writes::FRAME, WINDOW_SPLIT | SCX_TAIL, 9},
+	};
+	bool pass = true;
+	for(auto &s : frameScenarios)
+	{
+		pass &= runTest(s, frames);
+	}
+	for(unsigned seed = 1; seed <= 8; seed++)
+	{
+		char name[32];
+		bool cgb = seed & 1;
+		auto writes = seed <= 4 ? Writes::SPARSE : Writes::DENSE;
+		snprintf(name, sizeof(name), "%s seed %u %s", writes == Writes::SPARSE ? "sparse" : "dense",
+			seed, cgb ? "CGB" : "DMG");
+		pass &= runTest({name, cgb, writes, 0, 100 + seed}, steps);
+	}
+	printf("%s\n", pass ? "fast path matches per pixel" : "FAST PATH MISMATCH");
+	return pass ? 0 : 1;
+}
+
+void onInit(int argc, char** argv) {}
+
+}
+
+uint_least32_t gbcToRgb32(unsigned const bgr15) { return bgr15 * 0x10001u; }
@@ -44,6 +44,10 @@
 
 /* Function prototypes */
 EmuSystem::Error state_load(const unsigned char *buffer);
+EmuSystem::Error state_loadUncompressed(const unsigned char *buffer, unsigned long size);
+// buffer must hold at least compressBound(STATE_SIZE) + 4 bytes, returns 0 on error
 int state_save(unsigned char *buffer);
+// state must hold at least STATE_SIZE bytes, returns the bytes written
+int state_saveUncompressed(unsigned char *state);
 
 #endif
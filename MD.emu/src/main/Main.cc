@@ -35,10 +35,14 @@
 #endif
 #include <fileio/fileio.h>
 #include "Cheats.hh"
+#include <zlib.h>
 
 const char *EmuSystem::creditsViewStr = CREDITS_INFO_STRING "(c) 2011-2021\nRobert Broglia\nwww.explusalpha.com\n\nPortions (c) the\nGenesis Plus Team\ncgfm2.emuviews.com";
 bool EmuSystem::hasCheats = true;
 bool EmuSystem::hasPALVideoSystem = true;
+bool EmuSystem::hasRunAhead = true;
+bool EmuSystem::hasRewind = true;
+bool EmuSystem::hasMemoryStates = true;
 t_config config{};
 bool config_ym2413_enabled = true;
 int8 mdInputPortDev[2]{-1, -1};
@@ -121,15 +125,31 @@ static FS::PathString sprintBRAMSaveFilename()
 	return FS::makePathStringPrintf("%s/%s.brm", EmuSystem::savePath(), EmuSystem::gameName().data());
 }
 
-static const uint maxSaveStateSize = STATE_SIZE+4;
+static const uint maxSaveStateSize = compressBound(STATE_SIZE)+4;
 
-static EmuSystem::Error saveMDState(const char *path)
+EmuSystem::Error EmuSystem::saveState(IG::ByteBuffer &buff)
+{
+	// in-memory states skip compression since they're written every frame by rewind/run-ahead
+	buff.resize(STATE_SIZE);
+	int size = state_saveUncompressed(buff.data());
+	buff.resize(size);
+	return {};
+}
+
+EmuSystem::Error EmuSystem::loadState(IG::ConstBufferView buff)
+{
+	return state_loadUncompressed((const uint8_t*)buff.data(), buff.size());
+}
+
+EmuSystem::Error EmuSystem::saveState(const char *path)
 {
 	auto stateData = std::make_unique<uint8_t[]>(maxSaveStateSize);
 	if(!stateData)
 		return EmuSystem::makeError("Out of memory");
 	logMsg("saving state data");
 	int size = state_save(stateData.get());
+	if(!size)
+		return EmuSystem::makeError("Error compressing state");
 	logMsg("writing to file");
 	std::error_code ec;
 	if(FileUtils::writeToPath(path, stateData.get(), size, &ec) == -1)
@@ -140,36 +160,20 @@ static EmuSystem::Error saveMDState(const char *path)
 	return {};
 }
 
-static EmuSystem::Error loadMDState(const char *path)
+EmuSystem::Error EmuSystem::loadState(const char *path)
 {
 	FileIO f;
 	if(auto ec = f.open(path, IO::AccessHint::ALL);
 		ec)
 	{
-		EmuSystem::makeError(std::error_code{ec});
+		return EmuSystem::makeError(std::error_code{ec});
 	}
 	auto stateData = (const uint8_t *)f.mmapConst();
-	if(!stateData)
+	if(!stateData || f.size() < 4)
 	{
 		return EmuSystem::makeFileReadError();
 	}
-	if(auto err = state_load(stateData);
-		err)
-	{
-		return err;
-	}
-	//sound_restore();
-	return {};
-}
-
-EmuSystem::Error EmuSystem::saveState(const char *path)
-{
-	return saveMDState(path);
-}
-
-EmuSystem::Error EmuSystem::loadState(const char *path)
-{
-	return loadMDState(path);
+	return state_load(stateData);
 }
 
 void EmuSystem::saveBackupMem() // for manually saving when not closing game
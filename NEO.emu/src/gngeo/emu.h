@@ -69,6 +69,7 @@ typedef struct {
     //Uint8 nb_joy;
     Uint8 raster;
     Uint8 debug;
+    Uint8 sprite_cache_size; /* MB of sprite rom kept decompressed, 0 to keep all of it */
     //Uint8 rom_type;
     //Uint8 special_bios;
     Uint8 extra_xor;
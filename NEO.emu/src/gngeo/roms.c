@@ -15,6 +15,11 @@
 #include <strings.h>
 #include <string.h>
 #include <stdbool.h>
+#ifdef HAVE_MMAP
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
 #include "roms.h"
 #include "emu.h"
 #include "memory.h"
@@ -942,6 +947,13 @@ static int allocate_region(ROM_REGION *r, Uint32 size, int region) {
 
 static void free_region(ROM_REGION *r) {
 	DEBUG_LOG("Free Region %p %p %d", r, r->p, r->size);
+#ifdef HAVE_MMAP
+	if (r->mapped) {
+		uintptr_t base = (uintptr_t) r->p & ~(sysconf(_SC_PAGESIZE) - 1);
+		munmap((void*) base, r->size + ((uintptr_t) r->p - base));
+		r->mapped = 0;
+	} else
+#endif
 	if (r->p)
 		free(r->p);
 	r->size = 0;
@@ -1600,6 +1612,17 @@ int dr_load_game(char *name, char romerror[1024]) {
 
 #if defined(HAVE_LIBZ)//&& defined (HAVE_MMAP)
 
+/* Bump the version when the dump layout or anything done to the roms before
+ * they're dumped changes, older dumps are then rebuilt instead of loaded */
+#define GNO_ID "gnodmpv2"
+
+#define GNO_REGION_RAW 0
+#define GNO_REGION_BLOCKS 1 /* zlib compressed blocks, read through the sprite cache */
+#define GNO_REGION_MAPPED 2 /* raw, page aligned so it can be mapped in place */
+
+/* Covers 4KB and 16KB pages */
+#define GNO_ALIGN 0x4000
+
 static int dump_region(FILE *gno, const ROM_REGION *rom, Uint8 id, Uint8 type,
 		Uint32 block_size, uint verbose) {
 	if (rom->p == NULL)
@@ -1607,9 +1630,14 @@ static int dump_region(FILE *gno, const ROM_REGION *rom, Uint8 id, Uint8 type,
 	fwrite(&rom->size, sizeof (Uint32), 1, gno);
 	fwrite(&id, sizeof (Uint8), 1, gno);
 	fwrite(&type, sizeof (Uint8), 1, gno);
-	if (type == 0) {
+	if (type == GNO_REGION_RAW) {
 		if(verbose) logMsg("Dump %d %08x", id, rom->size);
 		fwrite(rom->p, rom->size, 1, gno);
+	} else if (type == GNO_REGION_MAPPED) {
+		long pad = -ftell(gno) & (GNO_ALIGN - 1);
+		if(verbose) logMsg("Dump %d %08x aligned by %ld", id, rom->size, pad);
+		fseek(gno, pad, SEEK_CUR);
+		fwrite(rom->p, rom->size, 1, gno);
 	} else {
 		Uint32 nb_block = rom->size / block_size;
 		Uint32 *block_offset;
@@ -1666,15 +1694,20 @@ static int dump_region(FILE *gno, const ROM_REGION *rom, Uint8 id, Uint8 type,
 	return true;
 }
 
-int dr_save_gno(GAME_ROMS *r, char *filename) {
+int dr_save_gno(GAME_ROMS *r, char *filename, Uint32 key) {
 	FILE *gno;
-	char *fid = "gnodmpv1";
+	char *fid = GNO_ID;
 	char fname[9];
+	char tmpname[strlen(filename) + 5];
 	Uint8 nb_sec = 0;
 	int i;
+	int ok;
 
+	/* Written under another name first so a dump cut short is never
+	 * mistaken for a good one, and a mapped dump is never truncated */
+	sprintf(tmpname, "%s.tmp", filename);
 	gn_init_pbar(PBAR_ACTION_SAVEGNO, 4);
-	gno = fopen(filename, "wb");
+	gno = fopen(tmpname, "wb");
 	if (!gno)
 		return false;
 
@@ -1711,6 +1744,7 @@ int dr_save_gno(GAME_ROMS *r, char *filename) {
 
 	/* Header information */
 	fwrite(fid, 8, 1, gno);
+	fwrite(&key, sizeof (Uint32), 1, gno);
 	snprintf(fname, 9, "%-8s", r->info.name);
 	fwrite(fname, 8, 1, gno);
 	fwrite(&r->info.flags, sizeof (Uint32), 1, gno);
@@ -1720,9 +1754,9 @@ int dr_save_gno(GAME_ROMS *r, char *filename) {
 	dump_region(gno, &r->cpu_m68k, REGION_MAIN_CPU_CARTRIDGE, 0, 0, 0);
 	dump_region(gno, &r->cpu_z80, REGION_AUDIO_CPU_CARTRIDGE, 0, 0, 0);
 	gn_update_pbar(1);
-	dump_region(gno, &r->adpcma, REGION_AUDIO_DATA_1, 0, 0, 0);
+	dump_region(gno, &r->adpcma, REGION_AUDIO_DATA_1, GNO_REGION_MAPPED, 0, 0);
 	if (r->adpcma.p != r->adpcmb.p)
-		dump_region(gno, &r->adpcmb, REGION_AUDIO_DATA_2, 0, 0, 0);
+		dump_region(gno, &r->adpcmb, REGION_AUDIO_DATA_2, GNO_REGION_MAPPED, 0, 0);
 	gn_update_pbar(2);
 	dump_region(gno, &r->game_sfix, REGION_FIXED_LAYER_CARTRIDGE, 0, 0, 0);
 	dump_region(gno, &r->spr_usage, REGION_SPR_USAGE, 0, 0, 0);
@@ -1734,27 +1768,61 @@ int dr_save_gno(GAME_ROMS *r, char *filename) {
 		dump_region(gno, &r->bios_sfix, REGION_FIXED_LAYER_BIOS, 0, 0, 0);
 	}
 	gn_update_pbar(3);
-	/* TODO, there is a bug in the loading routine, only one compressed (type 1)
-	 * region can be present at the end of the file */
-	dump_region(gno, &r->tiles, REGION_SPRITES, 1, 4096, 0);
+	/* Sprites are paged in from the mapping as they're drawn, or decompressed
+	 * into the sprite cache when its size is limited */
+	if (conf.sprite_cache_size)
+		dump_region(gno, &r->tiles, REGION_SPRITES, GNO_REGION_BLOCKS, 4096, 0);
+	else
+		dump_region(gno, &r->tiles, REGION_SPRITES, GNO_REGION_MAPPED, 0, 0);
+
+	ok = !ferror(gno);
+	if (fclose(gno) != 0)
+		ok = false;
+	if (!ok || rename(tmpname, filename) != 0) {
+		logMsg("Error writing %s", filename);
+		remove(tmpname);
+		return false;
+	}
+	return true;
+}
 
+#ifdef HAVE_MMAP
+/* Compressed sprite banks, when the sprite cache reads them through a mapping */
+static ROM_REGION sprite_store;
 
-	fclose(gno);
+static int map_region(ROM_REGION *r, FILE *gno, long offset, Uint32 size) {
+	struct stat st;
+	long delta = offset & (sysconf(_SC_PAGESIZE) - 1);
+	void *p;
+
+	if (fstat(fileno(gno), &st) != 0 || st.st_size < offset + (long) size)
+		return false;
+	/* Private and writable, so any patching of the roms only copies the pages touched */
+	p = mmap(NULL, size + delta, PROT_READ | PROT_WRITE, MAP_PRIVATE,
+			fileno(gno), offset - delta);
+	if (p == MAP_FAILED)
+		return false;
+	r->p = (Uint8*) p + delta;
+	r->size = size;
+	r->mapped = 1;
 	return true;
 }
+#endif
 
 int read_region(FILE *gno, GAME_ROMS *roms) {
 	Uint32 size;
 	Uint8 lid, type;
 	ROM_REGION *r = NULL;
 	size_t totread = 0;
-	Uint32 cache_size[] = {64, 32, 24, 16, 8, 6, 4, 2, 1, 0};
+	Uint32 cache_size[] = {128, 64, 32, 24, 16, 8, 6, 4, 2, 1, 0};
 	int i = 0;
 
 	/* Read region header */
 	totread = fread(&size, sizeof (Uint32), 1, gno);
 	totread += fread(&lid, sizeof (Uint8), 1, gno);
 	totread += fread(&type, sizeof (Uint8), 1, gno);
+	if (totread != 3)
+		return false;
 
 	switch (lid) {
 		case REGION_MAIN_CPU_CARTRIDGE:
@@ -1793,37 +1861,71 @@ int read_region(FILE *gno, GAME_ROMS *roms) {
 	}
 
 	logMsg("Read region %d %08X type %d\n", lid, size, type);
-	if (type == 0) {
+	if (type == GNO_REGION_RAW) {
 		/* TODO: Support ADPCM streaming for platform with less that 64MB of Mem */
 		allocate_region(r, size, lid);
 		logMsg("Load %d %08x\n", lid, r->size);
-		totread += fread(r->p, r->size, 1, gno);
-	} else {
+		if (fread(r->p, r->size, 1, gno) != 1)
+			return false;
+	} else if (type == GNO_REGION_MAPPED) {
+		long offset = ftell(gno);
+		offset += -offset & (GNO_ALIGN - 1);
+#ifdef HAVE_MMAP
+		if (!map_region(r, gno, offset, size))
+#endif
+		{
+			logMsg("Can't map region %d, reading it", lid);
+			allocate_region(r, size, lid);
+			if (fseek(gno, offset, SEEK_SET) != 0 || fread(r->p, r->size, 1, gno) != 1)
+				return false;
+		}
+		if (fseek(gno, offset + size, SEEK_SET) != 0)
+			return false;
+	} else if (r == &roms->tiles) {
+		GFX_CACHE *gcache = &memory.vid.spr_cache;
 		Uint32 nb_block, block_size;
 		Uint32 cmp_size;
-		totread += fread(&block_size, sizeof (Uint32), 1, gno);
+		long blocks_offset, blocks_size;
+		if (fread(&block_size, sizeof (Uint32), 1, gno) != 1 || !block_size)
+			return false;
 		nb_block = size / block_size;
 
 		logMsg("Region size=%08X\n", size);
 		r->size = size;
 
 
-		memory.vid.spr_cache.offset = malloc(sizeof (Uint32) * nb_block);
-		totread += fread(memory.vid.spr_cache.offset, sizeof (Uint32), nb_block, gno);
-		memory.vid.spr_cache.gno = gno;
+		gcache->offset = malloc(sizeof (Uint32) * nb_block);
+		totread += fread(gcache->offset, sizeof (Uint32), nb_block, gno);
+		gcache->gno = gno;
 
-		totread += fread(&cmp_size, sizeof (Uint32), 1, gno);
+		if (fread(&cmp_size, sizeof (Uint32), 1, gno) != 1)
+			return false;
 
-		fseek(gno, cmp_size, SEEK_CUR);
+		/* Each bank is preceded by its compressed size */
+		blocks_offset = ftell(gno);
+		blocks_size = cmp_size + nb_block * sizeof (Uint32);
+#ifdef HAVE_MMAP
+		if (map_region(&sprite_store, gno, blocks_offset, blocks_size)) {
+			gcache->store = sprite_store.p;
+			gcache->store_offset = blocks_offset;
+			gcache->store_size = sprite_store.size;
+		}
+#endif
+		fseek(gno, blocks_offset + blocks_size, SEEK_SET);
 
-		/* TODO: Find the best cache size dynamically! */
+		/* Start from the configured size, smaller if it can't be allocated */
 		for (i = 0; cache_size[i] != 0; i++) {
+			if (conf.sprite_cache_size && cache_size[i] > conf.sprite_cache_size)
+				continue;
 			if (init_sprite_cache(cache_size[i]*1024 * 1024, block_size) == 0) {
 				logMsg("Cache size=%dMB\n", cache_size[i]);
 				break;
 			}
 		}
-	}
+		if (!gcache->data)
+			return false;
+	} else
+		return false;
 	return true;
 }
 
@@ -1851,11 +1953,12 @@ int dr_open_gno(char *filename, char romerror[1024]) {
 	}
 
 	totread += fread(fid, 8, 1, gno);
-	if (strncmp(fid, "gnodmpv1", 8) != 0) {
+	if (strncmp(fid, GNO_ID, 8) != 0) {
 		fclose(gno);
 		sprintf(romerror, "Invalid GNO file");
 		return false;
 	}
+	fseek(gno, sizeof (Uint32), SEEK_CUR); /* key, checked by dr_check_gno() */
 	totread += fread(name, 8, 1, gno);
 	a = strchr(name, ' ');
 	if (a) a[0] = 0;
@@ -1867,7 +1970,12 @@ int dr_open_gno(char *filename, char romerror[1024]) {
 	gn_init_pbar(PBAR_ACTION_LOADGNO, nb_sec);
 	for (i = 0; i < nb_sec; i++) {
 		gn_update_pbar(i);
-		read_region(gno, r);
+		if (!read_region(gno, r)) {
+			gn_terminate_pbar();
+			fclose(gno);
+			sprintf(romerror, "Error reading %s", filename);
+			return false;
+		}
 	}
 	gn_terminate_pbar();
 
@@ -1875,7 +1983,9 @@ int dr_open_gno(char *filename, char romerror[1024]) {
 		r->adpcmb.p = r->adpcma.p;
 		r->adpcmb.size = r->adpcma.size;
 	}
-	//fclose(gno);
+	/* Mappings stay valid after closing, the sprite cache keeps reading from the file */
+	if (!memory.vid.spr_cache.data)
+		fclose(gno);
 
 	memory.fix_game_usage = r->gfix_usage.p;
 	/*	memory.pen_usage = malloc((r->tiles.size >> 11) * sizeof(Uint32));
@@ -1909,17 +2019,56 @@ char *dr_gno_romname(char *filename) {
 		return NULL;
 
 	totread += fread(fid, 8, 1, gno);
-	if (strncmp(fid, "gnodmpv1", 8) != 0) {
+	if (strncmp(fid, GNO_ID, 8) != 0) {
 		fclose(gno);
 		logMsg("Invalid GNO file");
 		return NULL;
 	}
 
+	fseek(gno, sizeof (Uint32), SEEK_CUR);
 	totread += fread(name, 8, 1, gno);
 	fclose(gno);
 	return strdup(name);
 }
 
+/* True if filename is a dump in the current format made from the roms key identifies */
+int dr_check_gno(char *filename, Uint32 key) {
+	FILE *gno;
+	char fid[8];
+	Uint32 gnokey;
+	int ok;
+
+	gno = fopen(filename, "rb");
+	if (!gno)
+		return false;
+	ok = fread(fid, 8, 1, gno) == 1 && strncmp(fid, GNO_ID, 8) == 0
+			&& fread(&gnokey, sizeof (Uint32), 1, gno) == 1 && gnokey == key;
+	fclose(gno);
+	return ok;
+}
+
+/* Identifies the contents of a rom set and its parent from the CRC32s their
+ * archives record, without decompressing anything, along with how the
+ * sprites are stored in its dump, returns 0 if the rom set can't be opened */
+Uint32 dr_rom_set_hash(char *rom_path, ROM_DEF *drv) {
+	struct PKZIP *pz;
+	Uint8 compressed_sprites = conf.sprite_cache_size != 0;
+	Uint32 hash = crc32(0, (const Bytef*) GNO_ID, 8);
+
+	hash = crc32(hash, &compressed_sprites, 1);
+	pz = open_rom_zip(rom_path, drv->name);
+	if (!pz)
+		return 0;
+	hash = gn_zip_crc_hash(pz, hash);
+	gn_close_zip(pz);
+	pz = open_rom_zip(rom_path, drv->parent);
+	if (pz) {
+		hash = gn_zip_crc_hash(pz, hash);
+		gn_close_zip(pz);
+	}
+	return hash;
+}
+
 
 #else
 
@@ -1927,9 +2076,17 @@ static int dump_region(FILE *gno, ROM_REGION *rom, Uint8 id, Uint8 type, Uint32
 	return TRUE;
 }
 
-int dr_save_gno(GAME_ROMS *r, char *filename) {
+int dr_save_gno(GAME_ROMS *r, char *filename, Uint32 key) {
 	return TRUE;
 }
+
+int dr_check_gno(char *filename, Uint32 key) {
+	return FALSE;
+}
+
+Uint32 dr_rom_set_hash(char *rom_path, ROM_DEF *drv) {
+	return 0;
+}
 #endif
 
 void dr_free_roms(GAME_ROMS *r) {
@@ -1943,6 +2100,12 @@ void dr_free_roms(GAME_ROMS *r) {
 		fclose(memory.vid.spr_cache.gno);
 		free_sprite_cache();
 		free(memory.vid.spr_cache.offset);
+		memory.vid.spr_cache.offset = NULL;
+#if defined(HAVE_LIBZ) && defined(HAVE_MMAP)
+		free_region(&sprite_store);
+#endif
+		memory.vid.spr_cache.store = NULL;
+		memory.vid.spr_cache.store_size = 0;
 	}
 	free_region(&r->game_sfix);
 
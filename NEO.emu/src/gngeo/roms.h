@@ -50,6 +50,7 @@ typedef struct GAME_INFO {
 typedef struct ROM_REGION {
 	Uint8* p;
 	Uint32 size;
+	Uint8 mapped; /* p points into a private mapping of a .gno file */
 }ROM_REGION;
 
 
@@ -75,10 +76,12 @@ typedef struct GAME_ROMS {
 
 int dr_load_roms(GAME_ROMS *r,char *rom_path,char *name, char romerror[1024]);
 void dr_free_roms(GAME_ROMS *r);
-int dr_save_gno(GAME_ROMS *r,char *filename);
+int dr_save_gno(GAME_ROMS *r,char *filename,Uint32 key);
 int dr_load_game(char *zip, char romerror[1024]);
 ROM_DEF *dr_check_zip(const char *filename);
 char *dr_gno_romname(char *filename);
 int dr_open_gno(char *filename, char romerror[1024]);
+int dr_check_gno(char *filename,Uint32 key);
+Uint32 dr_rom_set_hash(char *rom_path,ROM_DEF *drv);
 
 #endif
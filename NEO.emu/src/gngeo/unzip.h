@@ -57,6 +57,7 @@ struct ZFILE *gn_unzip_fopen(struct PKZIP *zf,const char *filename,uint32_t file
 struct PKZIP *gn_open_zip(const char *file);
 uint8_t *gn_unzip_file_malloc(struct PKZIP *zf,const char *filename,uint32_t file_crc,unsigned int *outlen);
 void gn_close_zip(struct PKZIP *zf);
+uint32_t gn_zip_crc_hash(struct PKZIP *zf,uint32_t hash);
 int gn_strictROMChecking();
 
 #endif /* UNZIP_H_ */
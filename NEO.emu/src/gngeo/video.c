@@ -23,6 +23,7 @@
 #include <string.h>
 #include <stdlib.h>
 #include <zlib.h>
+#include <time.h>
 #include "video.h"
 #include "memory.h"
 #include "emu.h"
@@ -126,14 +127,26 @@ static Uint16 fix_addr[40][32];
 static Uint8 fix_shift[40];
 
 
+static void reset_sprite_cache_lru(GFX_CACHE *gcache) {
+	int i;
+	for (i = 0; i < gcache->max_slot; i++) {
+		gcache->usage[i] = -1;
+		gcache->prev[i] = i - 1;
+		gcache->next[i] = i + 1;
+	}
+	gcache->next[gcache->max_slot - 1] = -1;
+	gcache->head = 0;
+	gcache->tail = gcache->max_slot - 1;
+	gcache->hits = gcache->misses = 0;
+	gcache->stall_ns = gcache->max_stall_ns = 0;
+}
+
 int init_sprite_cache(Uint32 size, Uint32 bsize) {
 	GFX_CACHE *gcache = &memory.vid.spr_cache;
-	int i;
 
 	if (gcache->data != NULL) { /* We allready have a cache, just reset it */
 		memset(gcache->ptr, 0, gcache->total_bank * sizeof (Uint8*));
-		for (i = 0; i < gcache->max_slot; i++)
-			gcache->usage[i] = -1;
+		reset_sprite_cache_lru(gcache);
 		return 0;
 	}
 
@@ -141,6 +154,11 @@ int init_sprite_cache(Uint32 size, Uint32 bsize) {
 	gcache->slot_size = bsize;
 	logMsg("gfx_size=%08x\n", memory.rom.tiles.size);
 	gcache->total_bank = memory.rom.tiles.size / gcache->slot_size;
+	/* No point holding more than the whole rom */
+	if (size > gcache->total_bank * bsize)
+		size = gcache->total_bank * bsize;
+	if (size < bsize)
+		return 1;
 	gcache->ptr = malloc(gcache->total_bank * sizeof (Uint8*));
 	if (gcache->ptr == NULL)
 		return 1;
@@ -151,6 +169,7 @@ int init_sprite_cache(Uint32 size, Uint32 bsize) {
 	gcache->data = malloc(gcache->size);
 	if (gcache->data == NULL) {
 		free(gcache->ptr);
+		gcache->ptr = NULL;
 		return 1;
 	}
 	logMsg("INIT CACHE %p\n", gcache->data);
@@ -160,9 +179,10 @@ int init_sprite_cache(Uint32 size, Uint32 bsize) {
 	gcache->max_slot = size / gcache->slot_size;
 	//gcache->slot_size=0x4000000/TOTAL_GFX_BANK;
 	logMsg("Allocating %08x for gfx cache (%d %d slot)\n", gcache->size, gcache->max_slot, gcache->slot_size);
-	gcache->usage = malloc(gcache->max_slot * sizeof (Uint32));
-	for (i = 0; i < gcache->max_slot; i++)
-		gcache->usage[i] = -1;
+	gcache->usage = malloc(gcache->max_slot * sizeof (int));
+	gcache->prev = malloc(gcache->max_slot * sizeof (int));
+	gcache->next = malloc(gcache->max_slot * sizeof (int));
+	reset_sprite_cache_lru(gcache);
 	//printf("inbuf size= %d\n",compressBound(bsize));
 #ifdef WIZ
 	gcache->in_buf = malloc(bsize + 1024);
@@ -172,8 +192,20 @@ int init_sprite_cache(Uint32 size, Uint32 bsize) {
 	return 0;
 }
 
+void log_sprite_cache_stats(void) {
+	GFX_CACHE *gcache = &memory.vid.spr_cache;
+	uint64_t lookups = gcache->hits + gcache->misses;
+	if (!gcache->data || !lookups)
+		return;
+	logMsg("sprite cache %dKB: %llu hits %llu misses (%.2f%% hit rate), stalled %lluus total %lluus max",
+			gcache->size >> 10, (unsigned long long) gcache->hits, (unsigned long long) gcache->misses,
+			gcache->hits * 100. / lookups,
+			(unsigned long long) (gcache->stall_ns / 1000), (unsigned long long) (gcache->max_stall_ns / 1000));
+}
+
 void free_sprite_cache(void) {
 	GFX_CACHE *gcache = &memory.vid.spr_cache;
+	log_sprite_cache_stats();
 	if (gcache->data) {
 		free(gcache->data);
 		gcache->data = NULL;
@@ -186,47 +218,104 @@ void free_sprite_cache(void) {
 		free(gcache->usage);
 		gcache->usage = NULL;
 	}
+	if (gcache->prev) {
+		free(gcache->prev);
+		gcache->prev = NULL;
+	}
+	if (gcache->next) {
+		free(gcache->next);
+		gcache->next = NULL;
+	}
 	if (gcache->in_buf) {
 		free(gcache->in_buf);
 		gcache->in_buf = NULL;
 	}
 }
 
-Uint8 *get_cached_sprite_ptr(Uint32 tileno) {
-	GFX_CACHE *gcache = &memory.vid.spr_cache;
-	static int pos = 0;
-	static int init = 1;
-	int tile_sh = ~((gcache->slot_size >> 7) - 1);
+static void touch_sprite_cache_slot(GFX_CACHE *gcache, int slot) {
+	if (slot == gcache->head)
+		return;
+	/* unlink */
+	gcache->next[gcache->prev[slot]] = gcache->next[slot];
+	if (slot == gcache->tail)
+		gcache->tail = gcache->prev[slot];
+	else
+		gcache->prev[gcache->next[slot]] = gcache->prev[slot];
+	/* and make it the most recently used */
+	gcache->prev[slot] = -1;
+	gcache->next[slot] = gcache->head;
+	gcache->prev[gcache->head] = slot;
+	gcache->head = slot;
+}
 
-	int bank = ((tileno & tile_sh) / (gcache->slot_size >> 7));
-	int a;
-	int r;
-	Uint32 cmp_size;
-	uLongf dst_size;
+static uint64_t monotonic_ns(void) {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t) ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
 
-	if (gcache->ptr[bank]) {
-		/* The bank is present in the cache */
-		return gcache->ptr[bank];
+static Uint8 *load_sprite_bank(GFX_CACHE *gcache, int bank) {
+	uint64_t start = monotonic_ns(), stall;
+	/* Replace the least recently used bank */
+	int a = gcache->tail;
+	Uint8 *dst = gcache->data + a * gcache->slot_size;
+	const Uint8 *src = NULL;
+	Uint32 cmp_size = 0;
+	uLongf dst_size = gcache->slot_size;
+
+	if (gcache->store) {
+		/* The offset and size come from the .gno, keep them inside the mapping */
+		Uint32 pos = gcache->offset[bank] - gcache->store_offset;
+		if (gcache->offset[bank] >= gcache->store_offset
+				&& gcache->store_size >= sizeof (Uint32)
+				&& pos <= gcache->store_size - sizeof (Uint32)) {
+			src = gcache->store + pos;
+			memcpy(&cmp_size, src, sizeof (Uint32));
+			src += sizeof (Uint32);
+			if (cmp_size > gcache->store_size - pos - sizeof (Uint32)
+					|| cmp_size > compressBound(gcache->slot_size))
+				cmp_size = 0;
+		}
+	} else {
+		src = gcache->in_buf;
+		fseek(gcache->gno, gcache->offset[bank], SEEK_SET);
+		if (fread(&cmp_size, sizeof (Uint32), 1, gcache->gno) != 1
+				|| cmp_size > compressBound(gcache->slot_size)
+				|| fread(gcache->in_buf, cmp_size, 1, gcache->gno) != 1)
+			cmp_size = 0;
+	}
+	if (!cmp_size || uncompress(dst, &dst_size, src, cmp_size) != Z_OK) {
+		logMsg("Error reading sprite bank %d", bank);
+		memset(dst, 0, gcache->slot_size);
 	}
-	/* We have to find a slot for this bank */
-	a = pos;
-	pos++;
-	if (pos >= gcache->max_slot) pos = 0;
-	//printf("Offset for bank is %d\n",gcache->offset[bank]);
-
-	fseek(gcache->gno, gcache->offset[bank], SEEK_SET);
-	r = fread(&cmp_size, sizeof (Uint32), 1, gcache->gno);
-	r = fread(gcache->in_buf, cmp_size, 1, gcache->gno);
-	dst_size = gcache->slot_size;
-	r = uncompress(gcache->data + a * gcache->slot_size, &dst_size, gcache->in_buf, cmp_size);
-
-	gcache->ptr[bank] = gcache->data + a * gcache->slot_size;
 
 	if (gcache->usage[a] != -1) {
 		gcache->ptr[gcache->usage[a]] = 0;
 	}
 	gcache->usage[a] = bank;
-	return gcache->ptr[bank];
+	gcache->ptr[bank] = dst;
+	touch_sprite_cache_slot(gcache, a);
+
+	stall = monotonic_ns() - start;
+	gcache->misses++;
+	gcache->stall_ns += stall;
+	if (stall > gcache->max_stall_ns)
+		gcache->max_stall_ns = stall;
+	return dst;
+}
+
+Uint8 *get_cached_sprite_ptr(Uint32 tileno) {
+	GFX_CACHE *gcache = &memory.vid.spr_cache;
+	int bank = tileno / (gcache->slot_size >> 7);
+	Uint8 *ptr = gcache->ptr[bank];
+
+	if (ptr) {
+		/* The bank is present in the cache */
+		gcache->hits++;
+		touch_sprite_cache_slot(gcache, (ptr - gcache->data) / gcache->slot_size);
+		return ptr;
+	}
+	return load_sprite_bank(gcache, bank);
 }
 
 static void fix_value_init(void) {
@@ -36,9 +36,17 @@ typedef struct gfx_cache {
 	int max_slot; /* Maximal numer of bank that can be cached (depend on cache size) */
 	int slot_size;
 	int *usage;   /* contain index to the banks in used order */
+	int *prev, *next; /* slots from most (head) to least (tail) recently used */
+	int head, tail;
 	FILE *gno;
     Uint32 *offset;
     Uint8* in_buf;
+    Uint8 *store; /* mapping of the compressed banks, read from gno when NULL */
+    Uint32 store_offset; /* file offset of store */
+    Uint32 store_size;
+    /* For sizing the cache, a miss stalls the frame while its bank is decompressed */
+    uint64_t hits, misses;
+    uint64_t stall_ns, max_stall_ns;
 }GFX_CACHE;
 
 typedef struct VIDEO {
@@ -81,5 +89,6 @@ void draw_screen(void *emuTaskPtr, void *emuVideoPtr);
 // void show_cache(void);
 int init_sprite_cache(Uint32 size,Uint32 bsize);
 void free_sprite_cache(void);
+void log_sprite_cache_stats(void);
 
 #endif
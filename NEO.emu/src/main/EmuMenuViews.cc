@@ -139,6 +139,32 @@ private:
 		}
 	};
 
+	TextMenuItem spriteCacheItem[5]
+	{
+		{"Off", [](){ optionSpriteCacheSize = 0; }},
+		{"16MB", [](){ optionSpriteCacheSize = 16; }},
+		{"32MB", [](){ optionSpriteCacheSize = 32; }},
+		{"64MB", [](){ optionSpriteCacheSize = 64; }},
+		{"128MB", [](){ optionSpriteCacheSize = 128; }},
+	};
+
+	MultiChoiceMenuItem spriteCache
+	{
+		"Sprite Cache Size",
+		[]()
+		{
+			switch(optionSpriteCacheSize)
+			{
+				default: return 0;
+				case 16: return 1;
+				case 32: return 2;
+				case 64: return 3;
+				case 128: return 4;
+			}
+		}(),
+		spriteCacheItem
+	};
+
 	BoolMenuItem strictROMChecking
 	{
 		"Strict ROM Checking",
@@ -156,6 +182,7 @@ public:
 		item.emplace_back(&bios);
 		item.emplace_back(&region);
 		item.emplace_back(&createAndUseCache);
+		item.emplace_back(&spriteCache);
 		item.emplace_back(&strictROMChecking);
 	}
 };
@@ -291,9 +291,15 @@ EmuSystem::Error EmuSystem::loadGame(IO &, EmuSystemCreateParams, OnLoadProgress
 	logMsg("rom set %s, %s", drv->name, drv->longname);
 	FS::PathString gnoFilename{};
 	string_printf(gnoFilename, "%s/%s.gno", EmuSystem::savePath(), drv->name);
-	if(optionCreateAndUseCache && FS::exists(gnoFilename))
+	conf.sprite_cache_size = optionSpriteCacheSize;
+	uint32_t romSetKey = optionCreateAndUseCache ? dr_rom_set_hash(CF_STR(cf_get_item_by_name("rompath")), drv) : 0;
+	// a 0 key means the rom set couldn't be identified, so the .gno can't be matched to it
+	bool useCache = optionCreateAndUseCache && romSetKey;
+	if(optionCreateAndUseCache && !romSetKey)
+		logWarn("can't identify rom set %s, not using %s", drv->name, gnoFilename.data());
+	if(useCache && dr_check_gno(gnoFilename.data(), romSetKey))
 	{
-		logMsg("loading .gno file");
+		logMsg("loading .gno file, key:0x%X", romSetKey);
 		char errorStr[1024];
 		if(!init_game(gnoFilename.data(), errorStr))
 		{
@@ -308,13 +314,13 @@ EmuSystem::Error EmuSystem::loadGame(IO &, EmuSystemCreateParams, OnLoadProgress
 			return makeError("%s", errorStr);
 		}
 
-		if(optionCreateAndUseCache && !FS::exists(gnoFilename))
+		if(useCache)
 		{
-			logMsg("%s doesn't exist, creating", gnoFilename.data());
+			logMsg("%s missing or out of date, creating", gnoFilename.data());
 			#ifdef USE_GENERATOR68K
 			bool swappedBIOS = swapCPUMemForDump();
 			#endif
-			dr_save_gno(&memory.rom, gnoFilename.data());
+			dr_save_gno(&memory.rom, gnoFilename.data(), romSetKey);
 			#ifdef USE_GENERATOR68K
 			reverseSwapCPUMemForDump(swappedBIOS);
 			#endif
@@ -388,6 +394,17 @@ FS::FileString EmuSystem::fullGameNameForPath(const char *path)
 	return FS::makeFileString(drv->longname);
 }
 
+void EmuSystem::printBenchmarkStats()
+{
+	auto &gcache = memory.vid.spr_cache;
+	if(!gcache.data)
+		return;
+	printf(",\"spriteCacheKB\":%u,\"spriteCacheHits\":%llu,\"spriteCacheMisses\":%llu,"
+		"\"spriteCacheStallUs\":%llu,\"spriteCacheMaxStallUs\":%llu",
+		gcache.size >> 10, (unsigned long long)gcache.hits, (unsigned long long)gcache.misses,
+		(unsigned long long)(gcache.stall_ns / 1000), (unsigned long long)(gcache.max_stall_ns / 1000));
+}
+
 void EmuApp::onCustomizeNavView(EmuApp::NavView &view)
 {
 	const Gfx::LGradientStopDesc navViewGrad[] =
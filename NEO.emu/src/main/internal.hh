@@ -18,6 +18,7 @@ extern Byte1Option optionMVSCountry;
 extern Byte1Option optionTimerInt;
 extern Byte1Option optionCreateAndUseCache;
 extern Byte1Option optionStrictROMChecking;
+extern Byte1Option optionSpriteCacheSize;
 CLINK CONFIG conf;
 
 void setTimerIntOption();
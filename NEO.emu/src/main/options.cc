@@ -15,6 +15,7 @@
 
 #include <emuframework/EmuApp.hh>
 #include "internal.hh"
+#include <unistd.h>
 
 extern "C"
 {
@@ -27,7 +28,8 @@ enum
 	CFGKEY_LIST_ALL_GAMES = 275, CFGKEY_BIOS_TYPE = 276,
 	CFGKEY_MVS_COUNTRY = 277, CFGKEY_TIMER_INT = 278,
 	CFGKEY_CREATE_USE_CACHE = 279,
-	CFGKEY_NEOGEOKEY_TEST_SWITCH = 280, CFGKEY_STRICT_ROM_CHECKING = 281
+	CFGKEY_NEOGEOKEY_TEST_SWITCH = 280, CFGKEY_STRICT_ROM_CHECKING = 281,
+	CFGKEY_SPRITE_CACHE_SIZE = 282
 };
 
 static bool systemEnumIsValid(uint8_t val)
@@ -40,6 +42,11 @@ static bool countryEnumIsValid(uint8_t val)
 	return val < CTY_MAX;
 }
 
+static bool spriteCacheSizeIsValid(uint8_t val)
+{
+	return val <= 128;
+}
+
 const char *EmuSystem::configFilename = "NeoEmu.config";
 const AspectRatioInfo EmuSystem::aspectRatioInfo[]
 {
@@ -52,8 +59,9 @@ Byte1Option optionListAllGames{CFGKEY_LIST_ALL_GAMES, 0};
 Byte1Option optionBIOSType{CFGKEY_BIOS_TYPE, SYS_UNIBIOS, 0, systemEnumIsValid};
 Byte1Option optionMVSCountry{CFGKEY_MVS_COUNTRY, CTY_USA, 0, countryEnumIsValid};
 Byte1Option optionTimerInt{CFGKEY_TIMER_INT, 2};
-Byte1Option optionCreateAndUseCache{CFGKEY_CREATE_USE_CACHE, 0};
+Byte1Option optionCreateAndUseCache{CFGKEY_CREATE_USE_CACHE, 1};
 Byte1Option optionStrictROMChecking{CFGKEY_STRICT_ROM_CHECKING, 0};
+Byte1Option optionSpriteCacheSize{CFGKEY_SPRITE_CACHE_SIZE, 0, 0, spriteCacheSizeIsValid};
 
 void setTimerIntOption()
 {
@@ -78,6 +86,10 @@ void EmuSystem::initOptions()
 {
 	EmuApp::setDefaultVControlsButtonSpacing(100);
 	EmuApp::setDefaultVControlsButtonStagger(5);
+	// big sets don't fit alongside everything else on devices with 2GB or less
+	auto physMem = (uint64_t)sysconf(_SC_PHYS_PAGES) * sysconf(_SC_PAGESIZE);
+	if(physMem && physMem <= 2048u * 1024 * 1024)
+		optionSpriteCacheSize.initDefault(32);
 }
 
 EmuSystem::Error EmuSystem::onOptionsLoaded()
@@ -119,6 +131,7 @@ bool EmuSystem::readConfig(IO &io, uint key, uint readSize)
 		bcase CFGKEY_MVS_COUNTRY: optionMVSCountry.readFromIO(io, readSize);
 		bcase CFGKEY_CREATE_USE_CACHE: optionCreateAndUseCache.readFromIO(io, readSize);
 		bcase CFGKEY_STRICT_ROM_CHECKING: optionStrictROMChecking.readFromIO(io, readSize);
+		bcase CFGKEY_SPRITE_CACHE_SIZE: optionSpriteCacheSize.readFromIO(io, readSize);
 	}
 	return 1;
 }
@@ -130,4 +143,5 @@ void EmuSystem::writeConfig(IO &io)
 	optionMVSCountry.writeWithKeyIfNotDefault(io);
 	optionCreateAndUseCache.writeWithKeyIfNotDefault(io);
 	optionStrictROMChecking.writeWithKeyIfNotDefault(io);
+	optionSpriteCacheSize.writeWithKeyIfNotDefault(io);
 }
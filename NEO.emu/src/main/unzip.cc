@@ -19,23 +19,60 @@
 #include <imagine/logger/logger.h>
 #include <imagine/util/string.h>
 #include <cstdlib>
+#include <zlib.h>
 
 extern "C"
 {
 	#include <gngeo/unzip.h>
 }
 
-struct PKZIP : public FS::ArchiveIterator {};
+struct PKZIP
+{
+	std::shared_ptr<const FS::ArchiveIndex> index;
+	// when the archive can't be indexed
+	FS::ArchiveIterator arch;
+};
 
 struct ZFILE
 {
+	BufferMapIO mapIO;
 	ArchiveIO io;
 	FS::ArchiveIterator *arch;
+
+	IO &entryIO() { return mapIO ? (IO&)mapIO : (IO&)io; }
 };
 
+static bool entryMatches(const char *name, uint32_t crc, const char *filename, uint32_t fileCRC)
+{
+	int loadByName = fileCRC == (uint32_t)-1 || !gn_strictROMChecking();
+	return (loadByName && (string_equal(name, filename))) || crc == fileCRC;
+}
+
 ZFILE *gn_unzip_fopen(PKZIP *archPtr, const char *filename, uint32_t fileCRC)
 {
-	auto &arch = *archPtr;
+	if(archPtr->index)
+	{
+		for(auto &entry : archPtr->index->entries())
+		{
+			if(entry.type() == FS::file_type::directory)
+			{
+				continue;
+			}
+			if(entryMatches(entry.name.c_str(), entry.crc32, filename, fileCRC))
+			{
+				auto io = archPtr->index->open(entry);
+				if(!io)
+				{
+					logErr("error reading archive entry file:%s", entry.name.c_str());
+					return nullptr;
+				}
+				return new ZFILE{std::move(io), {}, nullptr};
+			}
+		}
+		logMsg("file:%s crc32:0x%X not found in archive", filename, fileCRC);
+		return nullptr;
+	}
+	auto &arch = archPtr->arch;
 	arch.rewind();
 	for(auto &entry : arch)
 	{
@@ -46,11 +83,10 @@ ZFILE *gn_unzip_fopen(PKZIP *archPtr, const char *filename, uint32_t fileCRC)
 		auto name = entry.name();
 		auto crc = entry.crc32();
 		//logMsg("archive file entry:%s crc32:0x%X", name, crc);
-		int loadByName = fileCRC == (uint32_t)-1 || !gn_strictROMChecking();
-		if((loadByName && (string_equal(name, filename))) || crc == fileCRC)
+		if(entryMatches(name, crc, filename, fileCRC))
 		{
 			//logMsg("opened archive entry file:%s crc32:0x%X", name, crc);
-			return new ZFILE{entry.moveIO(), archPtr};
+			return new ZFILE{{}, entry.moveIO(), &arch};
 		}
 	}
 	logMsg("file:%s crc32:0x%X not found in archive", filename, fileCRC);
@@ -60,26 +96,33 @@ ZFILE *gn_unzip_fopen(PKZIP *archPtr, const char *filename, uint32_t fileCRC)
 void gn_unzip_fclose(ZFILE *z)
 {
 	//logMsg("done with archive entry");
-	*z->arch = z->io.releaseArchive();
+	if(z->arch)
+		*z->arch = z->io.releaseArchive();
 	delete z;
 }
 
 int gn_unzip_fread(ZFILE *z, uint8_t *data, unsigned int size)
 {
 	//logMsg("reading %u bytes to %p", size, data);
-	return z->io.read(data, size);
+	return z->entryIO().read(data, size);
 }
 
 PKZIP *gn_open_zip(const char *path)
 {
+	// zips are read through their central directory, other formats in order
+	if(auto index = FS::archiveIndex(path);
+		index)
+	{
+		return new PKZIP{index, {}};
+	}
 	std::error_code ec{};
-	auto arch = std::make_unique<FS::ArchiveIterator>(path, ec);
+	FS::ArchiveIterator arch{path, ec};
 	if(ec)
 	{
 		logErr("error opening archive:%s", path);
 		return nullptr;
 	}
-	return static_cast<PKZIP*>(arch.release());
+	return new PKZIP{{}, std::move(arch)};
 }
 
 void gn_close_zip(PKZIP *archPtr)
@@ -87,6 +130,40 @@ void gn_close_zip(PKZIP *archPtr)
 	delete archPtr;
 }
 
+static uint32_t hashEntry(uint32_t hash, const char *name, uint32_t crc)
+{
+	hash = crc32(hash, (const Bytef*)name, strlen(name));
+	return crc32(hash, (const Bytef*)&crc, sizeof(crc));
+}
+
+uint32_t gn_zip_crc_hash(PKZIP *archPtr, uint32_t hash)
+{
+	// only reads the entry headers, the recorded CRC32s stand in for the contents
+	if(archPtr->index)
+	{
+		for(auto &entry : archPtr->index->entries())
+		{
+			if(entry.type() == FS::file_type::directory)
+			{
+				continue;
+			}
+			hash = hashEntry(hash, entry.name.c_str(), entry.crc32);
+		}
+		return hash;
+	}
+	auto &arch = archPtr->arch;
+	arch.rewind();
+	for(auto &entry : arch)
+	{
+		if(entry.type() == FS::file_type::directory)
+		{
+			continue;
+		}
+		hash = hashEntry(hash, entry.name(), entry.crc32());
+	}
+	return hash;
+}
+
 uint8_t *gn_unzip_file_malloc(PKZIP *archPtr, const char *filename, uint32_t fileCRC, unsigned int *outlen)
 {
 	auto z = gn_unzip_fopen(archPtr, filename, fileCRC);
@@ -95,7 +172,7 @@ uint8_t *gn_unzip_file_malloc(PKZIP *archPtr, const char *filename, uint32_t fil
 		return nullptr;
 	}
 	auto closeZ = IG::scopeGuard([&](){ gn_unzip_fclose(z); });
-	unsigned int size = z->io.size();
+	unsigned int size = z->entryIO().size();
 	auto buff = (uint8_t*)malloc(size);
 	if(gn_unzip_fread(z, buff, size) != (int)size)
 	{
@@ -39,6 +39,9 @@ const char *EmuSystem::creditsViewStr = CREDITS_INFO_STRING "(c) 2011-2021\nRobe
 bool EmuSystem::hasCheats = true;
 bool EmuSystem::hasPALVideoSystem = true;
 bool EmuSystem::hasResetModes = true;
+bool EmuSystem::hasRunAhead = true;
+bool EmuSystem::hasRewind = true;
+bool EmuSystem::hasMemoryStates = true;
 uint fceuCheats = 0;
 ESI nesInputPortDev[2]{SI_UNSET, SI_UNSET};
 uint autoDetectedRegion = 0;
@@ -147,6 +150,28 @@ EmuSystem::Error EmuSystem::loadState(const char *path)
 		return {};
 }
 
+EmuSystem::Error EmuSystem::saveState(IG::ByteBuffer &buff)
+{
+	static std::vector<u8> stateVec;
+	EMUFILE_MEMORY stateFile{&stateVec};
+	stateFile.truncate(0);
+	if(!FCEUSS_SaveMS(&stateFile, 0)) // 0 = uncompressed
+		return EmuSystem::makeFileWriteError();
+	buff.assign(stateVec.data(), stateFile.size());
+	return {};
+}
+
+EmuSystem::Error EmuSystem::loadState(IG::ConstBufferView buff)
+{
+	BufferMapIO io{};
+	io.open(buff.data(), buff.size());
+	EmuFileIO stateFile{io};
+	if(!FCEUSS_LoadFP(&stateFile, SSLOADPARAM_NOBACKUP))
+		return EmuSystem::makeFileReadError();
+	else
+		return {};
+}
+
 void EmuSystem::saveBackupMem() // for manually saving when not closing game
 {
 	if(gameIsRunning())
@@ -418,7 +443,7 @@ void FCEUPPU_FrameReady(EmuSystemTask *task, EmuVideo *video, uint8 *buf)
 	auto pix = img.pixmap();
 	IG::Pixmap ppuPix{{{256, 256}, IG::PIXEL_FMT_I8}, buf};
 	auto ppuPixRegion = ppuPix.subView({0, 8}, {256, 224});
-	pix.writeTransformed([](uint8 p){ return nativeCol[p]; }, ppuPixRegion);
+	pix.writePaletted(ppuPixRegion, nativeCol);
 	img.endFrame();
 }
 
@@ -56,6 +56,7 @@ mednafen/cdrom/recover-raw.cpp \
 mednafen/cdrom/CDAccess.cpp \
 mednafen/cdrom/CDAccess_Image.cpp \
 mednafen/cdrom/CDAccess_CCD.cpp \
+mednafen/cdrom/CDAccess_CHD.cpp \
 mednafen/cdrom/CDUtility.cpp \
 mednafen/cdrom/l-ec.cpp \
 mednafen/cdrom/scsicd.cpp \
@@ -79,6 +80,7 @@ include $(EMUFRAMEWORK_PATH)/package/emuframework.mk
 include $(IMAGINE_PATH)/make/package/libvorbis.mk
 include $(IMAGINE_PATH)/make/package/libsndfile.mk
 include $(IMAGINE_PATH)/make/package/zlib.mk
+include $(IMAGINE_PATH)/make/package/liblzma.mk
 
 include $(IMAGINE_PATH)/make/imagineAppTarget.mk
 
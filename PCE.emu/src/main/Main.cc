@@ -27,6 +27,7 @@
 #include <mednafen/pce_fast/vdc.h>
 #include <mednafen/pce_fast/pcecd_drive.h>
 #include <mednafen/MemoryStream.h>
+#include <mednafen/state.h>
 
 const char *EmuSystem::creditsViewStr = CREDITS_INFO_STRING "(c) 2011-2021\nRobert Broglia\nwww.explusalpha.com\n\nPortions (c) the\nMednafen Team\nmednafen.sourceforge.net";
 FS::PathString sysCardPath{};
@@ -66,7 +67,7 @@ bool hasHuCardExtension(const char *name)
 
 static bool hasCDExtension(const char *name)
 {
-	return string_hasDotExtension(name, "toc") || string_hasDotExtension(name, "cue") || string_hasDotExtension(name, "ccd");
+	return string_hasDotExtension(name, "toc") || string_hasDotExtension(name, "cue") || string_hasDotExtension(name, "ccd") || string_hasDotExtension(name, "chd");
 }
 
 static bool hasPCEWithCDExtension(const char *name)
@@ -92,6 +93,9 @@ EmuSystem::Error EmuSystem::onOptionsLoaded()
 
 EmuSystem::NameFilterFunc EmuSystem::defaultFsFilter = hasPCEWithCDExtension;
 EmuSystem::NameFilterFunc EmuSystem::defaultBenchmarkFsFilter = hasHuCardExtension;
+bool EmuSystem::hasRunAhead = true;
+bool EmuSystem::hasRewind = true;
+bool EmuSystem::hasMemoryStates = true;
 
 void EmuSystem::saveBackupMem() // for manually saving when not closing game
 {
@@ -427,6 +431,36 @@ EmuSystem::Error EmuSystem::loadState(const char *path)
 		return {};
 }
 
+EmuSystem::Error EmuSystem::saveState(IG::ByteBuffer &buff)
+{
+	try
+	{
+		MemoryStream st{std::max(buff.capacity(), (size_t)65536)};
+		MDFNSS_SaveSM(&st);
+		buff.assign(st.map(), st.size());
+		return {};
+	}
+	catch(std::exception &e)
+	{
+		return EmuSystem::makeError("%s", e.what());
+	}
+}
+
+EmuSystem::Error EmuSystem::loadState(IG::ConstBufferView buff)
+{
+	try
+	{
+		MemoryStream st{buff.size(), -1};
+		memcpy(st.map(), buff.data(), buff.size());
+		MDFNSS_LoadSM(&st);
+		return {};
+	}
+	catch(std::exception &e)
+	{
+		return EmuSystem::makeError("%s", e.what());
+	}
+}
+
 void EmuApp::onCustomizeNavView(EmuApp::NavView &view)
 {
 	const Gfx::LGradientStopDesc navViewGrad[] =
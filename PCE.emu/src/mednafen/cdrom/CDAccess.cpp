@@ -23,6 +23,7 @@
 #include "CDAccess.h"
 #include "CDAccess_Image.h"
 #include "CDAccess_CCD.h"
+#include "CDAccess_CHD.h"
 
 namespace Mednafen
 {
@@ -48,6 +49,9 @@ CDAccess* CDAccess_Open(VirtualFS* vfs, const std::string& path, bool image_memc
   ret = new CDAccess_CCD(vfs, path, image_memcache);
  else
  #endif
+ if(path.size() >= 4 && !MDFN_strazicmp(path.c_str() + path.size() - 4, ".chd"))
+  ret = new CDAccess_CHD(vfs, path, image_memcache);
+ else
   ret = new CDAccess_Image(vfs, path, image_memcache);
 
  return ret;
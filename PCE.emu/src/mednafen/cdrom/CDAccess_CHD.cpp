@@ -0,0 +1,1519 @@
+/******************************************************************************/
+/* Mednafen - Multi-system Emulator                                           */
+/******************************************************************************/
+/* CDAccess_CHD.cpp:
+**
+** This program is free software; you can redistribute it and/or
+** modify it under the terms of the GNU General Public License
+** as published by the Free Software Foundation; either version 2
+** of the License, or (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software Foundation, Inc.,
+** 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+*/
+
+/*
+ Notes:
+
+	Only version 5 files without a parent are supported.  Hunks may use the zlib, lzma, cdzl, cdlz and
+	cdfl codecs; cdzs(zstd) and the non-CD codecs aren't.
+
+	Each track's frames are padded out to a multiple of 4 in the image, and audio is stored big-endian.
+
+	Pregaps with a PGTYPE starting with 'V' are stored in the image and counted in FRAMES, others are
+	synthesized, the same as INDEX 00 vs PREGAP in a CUE sheet.
+*/
+
+#include <mednafen/mednafen.h>
+#include <mednafen/general.h>
+#include <mednafen/MemoryStream.h>
+
+#include "CDAccess_CHD.h"
+#include <trio/trio.h>
+
+#include <zlib.h>
+#include <lzma.h>
+
+namespace Mednafen
+{
+
+using namespace CDUtility;
+
+// Disk-image(rip) track/sector formats
+enum
+{
+ DI_FORMAT_AUDIO       = 0x00,
+ DI_FORMAT_MODE1       = 0x01,
+ DI_FORMAT_MODE1_RAW   = 0x02,
+ DI_FORMAT_MODE2       = 0x03,
+ DI_FORMAT_MODE2_FORM1 = 0x04,
+ DI_FORMAT_MODE2_FORM2 = 0x05,
+ DI_FORMAT_MODE2_RAW   = 0x06,
+ DI_FORMAT_CDI_RAW     = 0x07,
+ _DI_FORMAT_COUNT
+};
+
+static const struct
+{
+ const char* name;
+ uint8 format;
+} CHD_TrackTypes[] =
+{
+ { "MODE1", DI_FORMAT_MODE1 },
+ { "MODE1_RAW", DI_FORMAT_MODE1_RAW },
+ { "MODE2", DI_FORMAT_MODE2 },
+ { "MODE2_FORM1", DI_FORMAT_MODE2_FORM1 },
+ { "MODE2_FORM2", DI_FORMAT_MODE2_FORM2 },
+ { "MODE2_FORM_MIX", DI_FORMAT_MODE2 },
+ { "MODE2_RAW", DI_FORMAT_MODE2_RAW },
+ { "AUDIO", DI_FORMAT_AUDIO },
+};
+
+static constexpr uint32 MakeTag(char a, char b, char c, char d)
+{
+ return ((uint32)(uint8)a << 24) | ((uint32)(uint8)b << 16) | ((uint32)(uint8)c << 8) | (uint8)d;
+}
+
+enum : uint32
+{
+ CHD_CODEC_NONE = 0,
+ CHD_CODEC_ZLIB = MakeTag('z', 'l', 'i', 'b'),
+ CHD_CODEC_LZMA = MakeTag('l', 'z', 'm', 'a'),
+ CHD_CODEC_CDZL = MakeTag('c', 'd', 'z', 'l'),
+ CHD_CODEC_CDLZ = MakeTag('c', 'd', 'l', 'z'),
+ CHD_CODEC_CDFL = MakeTag('c', 'd', 'f', 'l'),
+};
+
+enum : uint32
+{
+ CHD_META_CDROM_TRACK = MakeTag('C', 'H', 'T', 'R'),
+ CHD_META_CDROM_TRACK2 = MakeTag('C', 'H', 'T', '2'),
+ CHD_META_CDROM_OLD = MakeTag('C', 'H', 'C', 'D'),
+ CHD_META_GDROM_TRACK = MakeTag('C', 'H', 'G', 'D'),
+};
+
+// Hunk map entry types
+enum
+{
+ COMPRESSION_TYPE_0 = 0,	// Codecs 0-3 from the header
+ COMPRESSION_TYPE_1 = 1,
+ COMPRESSION_TYPE_2 = 2,
+ COMPRESSION_TYPE_3 = 3,
+ COMPRESSION_NONE = 4,
+ COMPRESSION_SELF = 5,		// Same data as an earlier hunk
+ COMPRESSION_PARENT = 6,
+ // Only in the compressed map:
+ COMPRESSION_RLE_SMALL = 7,
+ COMPRESSION_RLE_LARGE = 8,
+ COMPRESSION_SELF_0 = 9,
+ COMPRESSION_SELF_1 = 10,
+ COMPRESSION_PARENT_SELF = 11,
+ COMPRESSION_PARENT_0 = 12,
+ COMPRESSION_PARENT_1 = 13
+};
+
+static const uint32 CHD_V5_HEADER_SIZE = 124;
+static const uint32 CD_FRAME_SIZE = 2352 + 96;
+static const uint32 CD_TRACK_PADDING = 4;
+static const uint32 MaxCacheBytes = 4 * 1024 * 1024;
+static const uint32 ReadAheadHunks = 4;
+static const uint8 CD_SyncHeader[12] = { 0x00, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0x00 };
+
+static uint16 CHD_CRC16(const uint8* data, size_t len)
+{
+ uint16 crc = 0xFFFF;
+
+ while(len--)
+ {
+  crc ^= *data++ << 8;
+
+  for(unsigned b = 0; b < 8; b++)
+   crc = (crc & 0x8000) ? ((crc << 1) ^ 0x1021) : (crc << 1);
+ }
+
+ return crc;
+}
+
+//
+// MSB-first bit reader used by the hunk map and FLAC; reads past the end return zero bits.
+//
+class CHD_BitReader
+{
+ public:
+
+ CHD_BitReader(const uint8* data, size_t size) : data(data), size(size) { }
+
+ INLINE uint32 peek(unsigned n)
+ {
+  if(bits < n)
+   fill();
+
+  return n ? (uint32)(buffer >> (64 - n)) : 0;
+ }
+
+ INLINE void remove(unsigned n)
+ {
+  buffer <<= n;
+  bits -= n;
+ }
+
+ INLINE uint32 read(unsigned n)
+ {
+  const uint32 ret = peek(n);
+
+  remove(n);
+
+  return ret;
+ }
+
+ INLINE int32 read_signed(unsigned n)
+ {
+  if(!n)
+   return 0;
+
+  return (int32)(read(n) << (32 - n)) >> (32 - n);
+ }
+
+ // Counts 0 bits up to and including the next 1 bit.
+ INLINE uint32 read_unary(void)
+ {
+  uint32 ret = 0;
+
+  for(;;)
+  {
+   if(!bits)
+   {
+    fill();
+
+    if(pos > size + 8)	// Corrupt data, stop before running forever.
+     return ret;
+   }
+
+   if(buffer)
+   {
+    const unsigned zeros = __builtin_clzll(buffer);
+
+    if(zeros < bits)
+    {
+     buffer = (buffer << zeros) << 1;
+     bits -= zeros + 1;
+     return ret + zeros;
+    }
+   }
+
+   ret += bits;
+   buffer = 0;
+   bits = 0;
+  }
+ }
+
+ INLINE void align(void)
+ {
+  remove(bits & 7);
+ }
+
+ // Byte offset of the next unread bit, rounded up.
+ INLINE size_t offset(void) const
+ {
+  return pos - bits / 8;
+ }
+
+ INLINE bool overflow(void) const
+ {
+  return offset() > size;
+ }
+
+ private:
+
+ INLINE void fill(void)
+ {
+  while(bits <= 56)
+  {
+   const uint64 b = (pos < size) ? data[pos] : 0;
+
+   buffer |= b << (56 - bits);
+   bits += 8;
+   pos++;
+  }
+ }
+
+ const uint8* data;
+ size_t size;
+ size_t pos = 0;
+ uint64 buffer = 0;
+ unsigned bits = 0;
+};
+
+//
+// Decodes the FLAC frames written by the cdfl codec: 16-bit stereo with no stream header.
+//
+class CHD_FLACDecoder
+{
+ public:
+
+ // Writes sample_count stereo samples to dest as big-endian pairs, returns the number of bytes used from src.
+ size_t DecodeCD(const uint8* src, size_t src_len, uint8* dest, uint32 sample_count)
+ {
+  CHD_BitReader br(src, src_len);
+  uint32 done = 0;
+
+  while(done < sample_count)
+  {
+   if(br.read(15) != 0x7FFC)
+    throw MDFN_Error(0, _("FLAC frame sync not found."));
+
+   br.read(1);	// Blocking strategy
+
+   const unsigned bs_code = br.read(4);
+   const unsigned sr_code = br.read(4);
+   const unsigned chan_code = br.read(4);
+   const unsigned bps_code = br.read(3);
+   br.read(1);
+
+   // UTF-8 style coded frame/sample number
+   {
+    const uint32 first = br.read(8);
+    unsigned extra = 0;
+
+    if(first & 0x80)
+    {
+     while(extra < 7 && (first & (0x40 >> extra)))
+      extra++;
+
+     if(!extra || extra > 6)
+      throw MDFN_Error(0, _("Bad FLAC frame number."));
+    }
+
+    for(unsigned i = 0; i < extra; i++)
+     br.read(8);
+   }
+
+   uint32 block_size;
+
+   if(bs_code == 1)
+    block_size = 192;
+   else if(bs_code >= 2 && bs_code <= 5)
+    block_size = 576 << (bs_code - 2);
+   else if(bs_code == 6)
+    block_size = br.read(8) + 1;
+   else if(bs_code == 7)
+    block_size = br.read(16) + 1;
+   else if(bs_code >= 8)
+    block_size = 256 << (bs_code - 8);
+   else
+    throw MDFN_Error(0, _("Bad FLAC block size."));
+
+   if(sr_code == 12)
+    br.read(8);
+   else if(sr_code == 13 || sr_code == 14)
+    br.read(16);
+
+   br.read(8);	// CRC-8
+
+   if((bps_code != 0 && bps_code != 4) || chan_code == 0 || (chan_code > 1 && chan_code < 8) || chan_code > 10)
+    throw MDFN_Error(0, _("FLAC frame isn't 16-bit stereo."));
+
+   for(unsigned ch = 0; ch < 2; ch++)
+   {
+    if(samples[ch].size() < block_size)
+     samples[ch].resize(block_size);
+   }
+
+   for(unsigned ch = 0; ch < 2; ch++)
+   {
+    // The side channel has one extra bit.
+    const bool side = (chan_code == 8 && ch == 1) || (chan_code == 9 && ch == 0) || (chan_code == 10 && ch == 1);
+
+    DecodeSubframe(br, 16 + side, block_size, samples[ch].data());
+   }
+
+   int32* l = samples[0].data();
+   int32* r = samples[1].data();
+
+   switch(chan_code)
+   {
+    case 8:	// left/side
+	for(uint32 i = 0; i < block_size; i++)
+	 r[i] = (int32)((int64)l[i] - r[i]);
+	break;
+
+    case 9:	// side/right
+	for(uint32 i = 0; i < block_size; i++)
+	 l[i] = (int32)((int64)l[i] + r[i]);
+	break;
+
+    case 10:	// mid/side
+	for(uint32 i = 0; i < block_size; i++)
+	{
+	 const int64 mid = ((int64)l[i] * 2) | (r[i] & 1);
+	 const int64 side = r[i];
+
+	 l[i] = (int32)((mid + side) >> 1);
+	 r[i] = (int32)((mid - side) >> 1);
+	}
+	break;
+   }
+
+   br.align();
+   br.read(16);	// CRC-16
+
+   if(br.overflow())
+    throw MDFN_Error(0, _("FLAC data truncated."));
+
+   const uint32 count = std::min<uint32>(block_size, sample_count - done);
+
+   for(uint32 i = 0; i < count; i++)
+   {
+    MDFN_en16msb(dest + 0, l[i]);
+    MDFN_en16msb(dest + 2, r[i]);
+    dest += 4;
+   }
+
+   done += count;
+  }
+
+  return br.offset();
+ }
+
+ private:
+
+ void DecodeSubframe(CHD_BitReader& br, unsigned bps, uint32 block_size, int32* out)
+ {
+  if(br.read(1))
+   throw MDFN_Error(0, _("Bad FLAC subframe."));
+
+  const unsigned type = br.read(6);
+  unsigned wasted = 0;
+
+  if(br.read(1))
+  {
+   wasted = br.read_unary() + 1;
+
+   if(wasted >= bps)
+    throw MDFN_Error(0, _("Bad FLAC subframe."));
+
+   bps -= wasted;
+  }
+
+  if(type == 0)	// Constant
+  {
+   const int32 v = br.read_signed(bps);
+
+   for(uint32 i = 0; i < block_size; i++)
+    out[i] = v;
+  }
+  else if(type == 1)	// Verbatim
+  {
+   for(uint32 i = 0; i < block_size; i++)
+    out[i] = br.read_signed(bps);
+  }
+  else if(type >= 8 && type <= 12)	// Fixed predictor
+  {
+   const unsigned order = type - 8;
+
+   if(order > block_size)
+    throw MDFN_Error(0, _("Bad FLAC subframe."));
+
+   for(unsigned i = 0; i < order; i++)
+    out[i] = br.read_signed(bps);
+
+   DecodeResidual(br, order, block_size, out);
+
+   switch(order)
+   {
+    case 1:
+	for(uint32 i = 1; i < block_size; i++)
+	 out[i] = (int32)((int64)out[i] + out[i - 1]);
+	break;
+
+    case 2:
+	for(uint32 i = 2; i < block_size; i++)
+	 out[i] = (int32)(out[i] + 2 * (int64)out[i - 1] - out[i - 2]);
+	break;
+
+    case 3:
+	for(uint32 i = 3; i < block_size; i++)
+	 out[i] = (int32)(out[i] + 3 * ((int64)out[i - 1] - out[i - 2]) + out[i - 3]);
+	break;
+
+    case 4:
+	for(uint32 i = 4; i < block_size; i++)
+	 out[i] = (int32)(out[i] + 4 * ((int64)out[i - 1] + out[i - 3]) - 6 * (int64)out[i - 2] - out[i - 4]);
+	break;
+   }
+  }
+  else if(type >= 32)	// LPC
+  {
+   const unsigned order = type - 31;
+   int32 coefs[32];
+
+   if(order > block_size)
+    throw MDFN_Error(0, _("Bad FLAC subframe."));
+
+   for(unsigned i = 0; i < order; i++)
+    out[i] = br.read_signed(bps);
+
+   const unsigned precision = br.read(4) + 1;
+   const int shift = br.read_signed(5);
+
+   if(precision == 16 || shift < 0)
+    throw MDFN_Error(0, _("Bad FLAC subframe."));
+
+   for(unsigned i = 0; i < order; i++)
+    coefs[i] = br.read_signed(precision);
+
+   DecodeResidual(br, order, block_size, out);
+
+   for(uint32 i = order; i < block_size; i++)
+   {
+    int64 sum = 0;
+
+    for(unsigned j = 0; j < order; j++)
+     sum += (int64)coefs[j] * out[i - 1 - j];
+
+    out[i] = (int32)(out[i] + (sum >> shift));
+   }
+  }
+  else
+   throw MDFN_Error(0, _("Bad FLAC subframe."));
+
+  if(wasted)
+  {
+   for(uint32 i = 0; i < block_size; i++)
+    out[i] = (uint32)out[i] << wasted;
+  }
+ }
+
+ void DecodeResidual(CHD_BitReader& br, unsigned order, uint32 block_size, int32* out)
+ {
+  const unsigned method = br.read(2);
+
+  if(method > 1)
+   throw MDFN_Error(0, _("Bad FLAC residual."));
+
+  const unsigned param_bits = method ? 5 : 4;
+  const unsigned escape = method ? 31 : 15;
+  const unsigned partition_order = br.read(4);
+  const uint32 partition_size = block_size >> partition_order;
+
+  if((partition_size << partition_order) != block_size || partition_size < order)
+   throw MDFN_Error(0, _("Bad FLAC residual."));
+
+  uint32 i = order;
+
+  for(uint32 p = 0; p < (1U << partition_order); p++)
+  {
+   const uint32 end = (p + 1) * partition_size;
+   const unsigned param = br.read(param_bits);
+
+   if(param == escape)
+   {
+    const unsigned raw_bits = br.read(5);
+
+    for(; i < end; i++)
+     out[i] = br.read_signed(raw_bits);
+   }
+   else
+   {
+    for(; i < end; i++)
+    {
+     const uint32 v = (br.read_unary() << param) | br.read(param);
+
+     out[i] = (int32)(v >> 1) ^ -(int32)(v & 1);
+    }
+   }
+  }
+ }
+
+ std::vector<int32> samples[2];
+};
+
+struct CDAccess_CHD::Decompressors
+{
+ Decompressors()
+ {
+  if(inflateInit2(&zs, -MAX_WBITS) != Z_OK)
+   throw MDFN_Error(0, _("Error initializing zlib."));
+ }
+
+ ~Decompressors()
+ {
+  inflateEnd(&zs);
+  lzma_end(&ls);
+ }
+
+ void Inflate(const uint8* src, uint32 src_len, uint8* dest, uint32 dest_len)
+ {
+  inflateReset(&zs);
+  zs.next_in = (Bytef*)src;
+  zs.avail_in = src_len;
+  zs.next_out = dest;
+  zs.avail_out = dest_len;
+
+  const int zr = inflate(&zs, Z_FINISH);
+
+  if((zr != Z_STREAM_END && zr != Z_OK && zr != Z_BUF_ERROR) || zs.total_out != dest_len)
+   throw MDFN_Error(0, _("CHD hunk zlib data is corrupt."));
+ }
+
+ // Raw LZMA without an end marker, as chdman's encoder(level 9, lc=3, lp=0, pb=2) writes it.
+ void Unlzma(const uint8* src, uint32 src_len, uint8* dest, uint32 dest_len)
+ {
+  lzma_options_lzma opts = {};
+  // Every match lies within the hunk, so its size is dictionary enough.
+  opts.dict_size = std::max<uint32>(dest_len, LZMA_DICT_SIZE_MIN);
+  opts.lc = 3;
+  opts.lp = 0;
+  opts.pb = 2;
+
+  const lzma_filter filters[2] = { { LZMA_FILTER_LZMA1, &opts }, { LZMA_VLI_UNKNOWN, nullptr } };
+
+  // Re-initializing the same filter chain reuses the previous allocations.
+  if(lzma_raw_decoder(&ls, filters) != LZMA_OK)
+   throw MDFN_Error(0, _("Error initializing LZMA decoder."));
+
+  ls.next_in = src;
+  ls.avail_in = src_len;
+  ls.next_out = dest;
+  ls.avail_out = dest_len;
+
+  const lzma_ret lr = lzma_code(&ls, LZMA_RUN);
+
+  if((lr != LZMA_OK && lr != LZMA_STREAM_END) || ls.avail_out)
+   throw MDFN_Error(0, _("CHD hunk LZMA data is corrupt."));
+ }
+
+ z_stream zs = {};
+ lzma_stream ls = LZMA_STREAM_INIT;
+ CHD_FLACDecoder flac;
+};
+
+CDAccess_CHD::CDAccess_CHD(VirtualFS* vfs, const std::string& path, bool image_memcache)
+{
+ Load(vfs, path, image_memcache);
+}
+
+CDAccess_CHD::~CDAccess_CHD()
+{
+
+}
+
+void CDAccess_CHD::Load(VirtualFS* vfs, const std::string& path, bool image_memcache)
+{
+ if(image_memcache)
+ {
+  img_stream.reset(new MemoryStream(vfs->open(path, VirtualFS::MODE_READ)));
+ }
+ else
+ {
+  img_stream.reset(vfs->open(path, VirtualFS::MODE_READ));
+  img_stream->require_fast_seekable();
+ }
+
+ img_size = img_stream->size();
+
+ // Read compressed hunks in place when the image is memory mapped.
+ img_map = img_stream->map();
+
+ if(img_map && img_stream->map_size() != img_size)
+  img_map = nullptr;
+
+ ReadHeader();
+
+ decomp.reset(new Decompressors());
+ cd_buf.reset(new uint8[hunk_bytes]);
+
+ hunk_cache.resize(std::min<uint32>(16, std::max<uint32>(2, MaxCacheBytes / hunk_bytes)));
+
+ for(auto& ce : hunk_cache)
+ {
+  ce.hunk = ~0U;
+  ce.last_used = 0;
+  ce.data.reset(new uint8[hunk_bytes]);
+ }
+}
+
+const uint8* CDAccess_CHD::ReadImage(uint64 offset, uint32 length)
+{
+ if(offset > img_size || length > img_size - offset)
+  throw MDFN_Error(0, _("CHD data offset out of range."));
+
+ if(img_map)
+  return img_map + offset;
+
+ if(comp_buf.size() < length)
+  comp_buf.resize(length);
+
+ if(img_stream->readAtPos(comp_buf.data(), length, offset) != length)
+  throw MDFN_Error(0, _("Error reading CHD data."));
+
+ return comp_buf.data();
+}
+
+void CDAccess_CHD::ReadHeader(void)
+{
+ uint8 header[CHD_V5_HEADER_SIZE];
+
+ if(img_stream->readAtPos(header, 16, 0) != 16 || memcmp(header, "MComprHD", 8))
+  throw MDFN_Error(0, _("Not a CHD file."));
+
+ const uint32 version = MDFN_de32msb(&header[12]);
+
+ if(version != 5)
+  throw MDFN_Error(0, _("CHD version %u isn't supported, convert it with a newer chdman."), version);
+
+ if(MDFN_de32msb(&header[8]) < CHD_V5_HEADER_SIZE || img_stream->readAtPos(header, CHD_V5_HEADER_SIZE, 0) != CHD_V5_HEADER_SIZE)
+  throw MDFN_Error(0, _("CHD header is truncated."));
+
+ for(unsigned i = 0; i < 4; i++)
+ {
+  compressors[i] = MDFN_de32msb(&header[16 + i * 4]);
+
+  switch(compressors[i])
+  {
+   case CHD_CODEC_NONE:
+   case CHD_CODEC_ZLIB:
+   case CHD_CODEC_LZMA:
+   case CHD_CODEC_CDZL:
+   case CHD_CODEC_CDLZ:
+   case CHD_CODEC_CDFL:
+	break;
+
+   default:
+	throw MDFN_Error(0, _("Unsupported CHD compression codec: %c%c%c%c"), (int)(uint8)(compressors[i] >> 24), (int)(uint8)(compressors[i] >> 16), (int)(uint8)(compressors[i] >> 8), (int)(uint8)compressors[i]);
+  }
+ }
+
+ const uint64 logical_bytes = MDFN_de64msb(&header[32]);
+ const uint64 map_offset = MDFN_de64msb(&header[40]);
+ const uint64 meta_offset = MDFN_de64msb(&header[48]);
+ const uint32 unit_bytes = MDFN_de32msb(&header[60]);
+
+ hunk_bytes = MDFN_de32msb(&header[56]);
+
+ for(unsigned i = 0; i < 20; i++)
+ {
+  if(header[104 + i])
+   throw MDFN_Error(0, _("CHD files with a parent aren't supported."));
+ }
+
+ if(unit_bytes != CD_FRAME_SIZE || !hunk_bytes || (hunk_bytes % CD_FRAME_SIZE) || hunk_bytes > 0x800000)
+  throw MDFN_Error(0, _("CHD file isn't a CD image."));
+
+ if(((logical_bytes + hunk_bytes - 1) / hunk_bytes) > 0x7FFFFFFF / (hunk_bytes / CD_FRAME_SIZE))
+  throw MDFN_Error(0, _("CHD image is too large."));
+
+ frames_per_hunk = hunk_bytes / CD_FRAME_SIZE;
+ hunk_count = (logical_bytes + hunk_bytes - 1) / hunk_bytes;
+
+ ReadMap(map_offset);
+ ReadTracks(meta_offset);
+}
+
+void CDAccess_CHD::ReadMap(uint64 map_offset)
+{
+ hunk_map.resize(hunk_count);
+
+ //
+ // Uncompressed images have a plain table of hunk numbers, 0 for a hunk of zeros.
+ //
+ if(compressors[0] == CHD_CODEC_NONE)
+ {
+  const uint8* raw_map = ReadImage(map_offset, hunk_count * 4);
+
+  for(uint32 hunk = 0; hunk < hunk_count; hunk++)
+  {
+   HunkMapEntry& e = hunk_map[hunk];
+
+   e.type = COMPRESSION_NONE;
+   e.offset = (uint64)MDFN_de32msb(&raw_map[hunk * 4]) * hunk_bytes;
+   e.length = e.offset ? hunk_bytes : 0;
+  }
+  return;
+ }
+
+ //
+ // Compressed map: a Huffman coded list of entry types with run-length encoding, followed by
+ // bit-packed lengths, offsets and CRCs for the types that need them.
+ //
+ const uint8* map_header = ReadImage(map_offset, 16);
+ const uint32 map_bytes = MDFN_de32msb(&map_header[0]);
+ const uint64 first_offset = ((uint64)MDFN_de16msb(&map_header[4]) << 32) | MDFN_de32msb(&map_header[6]);
+ const uint16 map_crc = MDFN_de16msb(&map_header[10]);
+ const unsigned length_bits = map_header[12];
+ const unsigned self_bits = map_header[13];
+ const unsigned parent_bits = map_header[14];
+
+ if(length_bits > 32 || self_bits > 32 || parent_bits > 32)
+  throw MDFN_Error(0, _("CHD hunk map is corrupt."));
+
+ CHD_BitReader br(ReadImage(map_offset + 16, map_bytes), map_bytes);
+ std::vector<uint8> types(hunk_count);
+
+ //
+ // Import the Huffman tree(16 codes, up to 8 bits), with its own RLE for the code lengths.
+ //
+ {
+  static const unsigned num_codes = 16;
+  static const unsigned max_bits = 8;
+  uint8 code_bits[num_codes];
+  uint32 codes[num_codes];
+  uint16 lookup[1 << max_bits];
+  unsigned cur = 0;
+
+  while(cur < num_codes)
+  {
+   unsigned nbits = br.read(4);
+
+   if(nbits != 1)
+    code_bits[cur++] = nbits;
+   else
+   {
+    nbits = br.read(4);
+
+    if(nbits == 1)
+     code_bits[cur++] = nbits;
+    else
+    {
+     unsigned repcount = br.read(4) + 3;
+
+     if(cur + repcount > num_codes)
+      throw MDFN_Error(0, _("CHD hunk map is corrupt."));
+
+     while(repcount--)
+      code_bits[cur++] = nbits;
+    }
+   }
+  }
+
+  // Canonical codes, assigned from the longest length down.
+  uint32 histogram[33] = { 0 };
+
+  for(unsigned i = 0; i < num_codes; i++)
+  {
+   if(code_bits[i] > max_bits)
+    throw MDFN_Error(0, _("CHD hunk map is corrupt."));
+
+   histogram[code_bits[i]]++;
+  }
+
+  uint32 start = 0;
+
+  for(unsigned len = 32; len > 0; len--)
+  {
+   const uint32 next = (start + histogram[len]) >> 1;
+
+   if(len != 1 && next * 2 != (start + histogram[len]))
+    throw MDFN_Error(0, _("CHD hunk map is corrupt."));
+
+   histogram[len] = start;
+   start = next;
+  }
+
+  memset(lookup, 0, sizeof(lookup));
+
+  for(unsigned i = 0; i < num_codes; i++)
+  {
+   if(!code_bits[i])
+    continue;
+
+   codes[i] = histogram[code_bits[i]]++;
+
+   const unsigned shift = max_bits - code_bits[i];
+
+   for(uint32 j = codes[i] << shift; j < ((codes[i] + 1) << shift); j++)
+    lookup[j] = (i << 5) | code_bits[i];
+  }
+
+  auto decode = [&]()
+  {
+   const uint16 v = lookup[br.peek(max_bits)];
+
+   br.remove(v & 0x1F);
+
+   return v >> 5;
+  };
+
+  uint8 last_type = 0;
+  uint32 repcount = 0;
+
+  for(uint32 hunk = 0; hunk < hunk_count; hunk++)
+  {
+   if(repcount)
+   {
+    types[hunk] = last_type;
+    repcount--;
+    continue;
+   }
+
+   const unsigned v = decode();
+
+   if(v == COMPRESSION_RLE_SMALL)
+   {
+    types[hunk] = last_type;
+    repcount = 2 + decode();
+   }
+   else if(v == COMPRESSION_RLE_LARGE)
+   {
+    types[hunk] = last_type;
+    repcount = 2 + 16 + (decode() << 4);
+    repcount += decode();
+   }
+   else
+    types[hunk] = last_type = v;
+  }
+ }
+
+ uint64 cur_offset = first_offset;
+ uint64 last_self = 0;
+ std::vector<uint8> raw_map(hunk_count * 12);
+
+ for(uint32 hunk = 0; hunk < hunk_count; hunk++)
+ {
+  HunkMapEntry& e = hunk_map[hunk];
+  uint8* raw = &raw_map[hunk * 12];
+  uint16 crc = 0;
+
+  e.type = types[hunk];
+  e.offset = cur_offset;
+  e.length = 0;
+
+  switch(types[hunk])
+  {
+   case COMPRESSION_TYPE_0:
+   case COMPRESSION_TYPE_1:
+   case COMPRESSION_TYPE_2:
+   case COMPRESSION_TYPE_3:
+	e.length = br.read(length_bits);
+	cur_offset += e.length;
+	crc = br.read(16);
+
+	if(compressors[e.type] == CHD_CODEC_NONE)
+	 throw MDFN_Error(0, _("CHD hunk map is corrupt."));
+	break;
+
+   case COMPRESSION_NONE:
+	e.length = hunk_bytes;
+	cur_offset += e.length;
+	crc = br.read(16);
+	break;
+
+   case COMPRESSION_SELF:
+	e.offset = last_self = br.read(self_bits);
+	break;
+
+   case COMPRESSION_SELF_1:
+	last_self++;
+   case COMPRESSION_SELF_0:
+	e.type = COMPRESSION_SELF;
+	e.offset = last_self;
+	break;
+
+   case COMPRESSION_PARENT:
+   case COMPRESSION_PARENT_SELF:
+   case COMPRESSION_PARENT_0:
+   case COMPRESSION_PARENT_1:
+	throw MDFN_Error(0, _("CHD files with a parent aren't supported."));
+
+   default:
+	throw MDFN_Error(0, _("CHD hunk map is corrupt."));
+  }
+
+  if(e.type == COMPRESSION_SELF && e.offset >= hunk)
+   throw MDFN_Error(0, _("CHD hunk map is corrupt."));
+
+  raw[0] = e.type;
+  MDFN_en24msb(&raw[1], e.length);
+  MDFN_en16msb(&raw[4], e.offset >> 32);
+  MDFN_en32msb(&raw[6], e.offset);
+  MDFN_en16msb(&raw[10], crc);
+ }
+
+ if(br.overflow() || CHD_CRC16(raw_map.data(), raw_map.size()) != map_crc)
+  throw MDFN_Error(0, _("CHD hunk map is corrupt."));
+}
+
+void CDAccess_CHD::ReadTracks(uint64 meta_offset)
+{
+ struct CHDTrackMetadata
+ {
+  bool valid;
+  char type[32];
+  char subtype[32];
+  char pgtype[32];
+  int frames, pregap, postgap;
+ } mt[100] = {};
+ unsigned entries = 0;
+
+ while(meta_offset)
+ {
+  if(++entries > 1000)
+   throw MDFN_Error(0, _("CHD metadata is corrupt."));
+
+  uint8 mh[16];
+
+  memcpy(mh, ReadImage(meta_offset, 16), 16);
+
+  const uint32 tag = MDFN_de32msb(&mh[0]);
+  const uint32 length = MDFN_de24msb(&mh[5]);
+
+  if(tag == CHD_META_GDROM_TRACK)
+   throw MDFN_Error(0, _("CHD GD-ROM images aren't supported."));
+  else if(tag == CHD_META_CDROM_OLD)
+   throw MDFN_Error(0, _("CHD binary CD metadata isn't supported, convert it with a newer chdman."));
+  else if(tag == CHD_META_CDROM_TRACK || tag == CHD_META_CDROM_TRACK2)
+  {
+   std::string md((const char*)ReadImage(meta_offset + 16, length), length);
+   int track = 0;
+   char pgsub[32] = { 0 };
+   CHDTrackMetadata m = {};
+
+   if(tag == CHD_META_CDROM_TRACK2)
+   {
+    if(trio_sscanf(md.c_str(), "TRACK:%d TYPE:%31s SUBTYPE:%31s FRAMES:%d PREGAP:%d PGTYPE:%31s PGSUB:%31s POSTGAP:%d", &track, m.type, m.subtype, &m.frames, &m.pregap, m.pgtype, pgsub, &m.postgap) != 8)
+     throw MDFN_Error(0, _("Malformed CHD track metadata: %s"), md.c_str());
+   }
+   else
+   {
+    if(trio_sscanf(md.c_str(), "TRACK:%d TYPE:%31s SUBTYPE:%31s FRAMES:%d", &track, m.type, m.subtype, &m.frames) != 4)
+     throw MDFN_Error(0, _("Malformed CHD track metadata: %s"), md.c_str());
+   }
+
+   if(track < 1 || track > 99 || mt[track].valid)
+    throw MDFN_Error(0, _("Bad CHD track number: %d"), track);
+
+   if(m.frames <= 0 || m.pregap < 0 || m.postgap < 0 || (m.pgtype[0] == 'V' && m.pregap > m.frames))
+    throw MDFN_Error(0, _("Malformed CHD track metadata: %s"), md.c_str());
+
+   m.valid = true;
+   mt[track] = m;
+   NumTracks++;
+  }
+
+  meta_offset = MDFN_de64msb(&mh[8]);
+ }
+
+ if(!NumTracks)
+  throw MDFN_Error(0, _("CHD file has no CD track metadata."));
+
+ FirstTrack = 1;
+ LastTrack = NumTracks;
+ disc_type = DISC_TYPE_CDDA_OR_M1;
+
+ int32 RunningLBA = -150;
+ uint64 FileFrame = 0;
+
+ for(int32 x = FirstTrack; x <= LastTrack; x++)
+ {
+  CHDTrack& t = Tracks[x];
+  bool format_found = false;
+
+  if(!mt[x].valid)
+   throw MDFN_Error(0, _("Missing track %u."), x);
+
+  for(const auto& tt : CHD_TrackTypes)
+  {
+   if(!strcmp(mt[x].type, tt.name))
+   {
+    t.DIFormat = tt.format;
+    format_found = true;
+    break;
+   }
+  }
+
+  if(!format_found)
+   throw MDFN_Error(0, _("Unsupported CHD track type: %s"), mt[x].type);
+
+  t.HasSubchannel = !strcmp(mt[x].subtype, "RW") || !strcmp(mt[x].subtype, "RW_RAW");
+
+  if(t.DIFormat == DI_FORMAT_AUDIO)
+   t.subq_control = 0;
+  else
+   t.subq_control = SUBQ_CTRLF_DATA;
+
+  if(t.DIFormat != DI_FORMAT_AUDIO && t.DIFormat != DI_FORMAT_MODE1 && t.DIFormat != DI_FORMAT_MODE1_RAW)
+   disc_type = DISC_TYPE_CD_XA;
+
+  const bool pregap_in_image = (mt[x].pgtype[0] == 'V');
+
+  t.pregap_dv = pregap_in_image ? mt[x].pregap : 0;
+  t.pregap = (pregap_in_image ? 0 : mt[x].pregap) + ((x == FirstTrack) ? 150 : 0);
+  t.postgap = mt[x].postgap;
+  t.sectors = mt[x].frames - t.pregap_dv;
+
+  RunningLBA += t.pregap + t.pregap_dv;
+  t.LBA = RunningLBA;
+  RunningLBA += t.sectors + t.postgap;
+
+  t.FileFrame = FileFrame + t.pregap_dv;
+  FileFrame += (mt[x].frames + CD_TRACK_PADDING - 1) / CD_TRACK_PADDING * CD_TRACK_PADDING;
+
+  if(FileFrame > (uint64)hunk_count * frames_per_hunk || RunningLBA > 450000)
+   throw MDFN_Error(0, _("CHD track metadata doesn't match the image size."));
+ }
+
+ total_sectors = RunningLBA;
+
+ GenerateTOC();
+}
+
+void CDAccess_CHD::GenerateTOC(void)
+{
+ toc.Clear();
+
+ toc.first_track = FirstTrack;
+ toc.last_track = LastTrack;
+ toc.disc_type = disc_type;
+
+ for(int32 i = FirstTrack; i <= LastTrack; i++)
+ {
+  toc.tracks[i].lba = Tracks[i].LBA;
+  toc.tracks[i].adr = ADR_CURPOS;
+  toc.tracks[i].control = Tracks[i].subq_control;
+  toc.tracks[i].valid = true;
+ }
+
+ toc.tracks[100].lba = total_sectors;
+ toc.tracks[100].adr = ADR_CURPOS;
+ toc.tracks[100].control = Tracks[LastTrack].subq_control;
+ toc.tracks[100].valid = true;
+}
+
+void CDAccess_CHD::Read_TOC(TOC *rtoc)
+{
+ *rtoc = toc;
+}
+
+void CDAccess_CHD::DecompressCD(uint32 codec, const uint8* src, uint32 src_len, uint8* dest)
+{
+ const uint32 frames = frames_per_hunk;
+ uint8* const data = cd_buf.get();
+ uint8* const sub = data + frames * 2352;
+ const uint8* ecc_flags = nullptr;
+
+ if(codec == CHD_CODEC_CDFL)
+ {
+  // FLAC for the sector data, then zlib for the subchannel data.
+  const size_t flac_len = decomp->flac.DecodeCD(src, src_len, data, frames * 588);
+
+  if(flac_len > src_len)
+   throw MDFN_Error(0, _("CHD hunk FLAC data is corrupt."));
+
+  decomp->Inflate(src + flac_len, src_len - flac_len, sub, frames * 96);
+ }
+ else
+ {
+  // A bit per frame for sectors whose sync header and ECC were removed, the compressed
+  // sector data length, the sector data and then the subchannel data.
+  const uint32 ecc_bytes = (frames + 7) / 8;
+  const uint32 header_bytes = ecc_bytes + ((hunk_bytes < 65536) ? 2 : 3);
+
+  if(src_len < header_bytes)
+   throw MDFN_Error(0, _("CHD hunk is corrupt."));
+
+  const uint32 data_len = (hunk_bytes < 65536) ? MDFN_de16msb(&src[ecc_bytes]) : MDFN_de24msb(&src[ecc_bytes]);
+
+  if(data_len > src_len - header_bytes)
+   throw MDFN_Error(0, _("CHD hunk is corrupt."));
+
+  if(codec == CHD_CODEC_CDLZ)
+   decomp->Unlzma(src + header_bytes, data_len, data, frames * 2352);
+  else
+   decomp->Inflate(src + header_bytes, data_len, data, frames * 2352);
+
+  decomp->Inflate(src + header_bytes + data_len, src_len - header_bytes - data_len, sub, frames * 96);
+
+  ecc_flags = src;
+ }
+
+ for(uint32 f = 0; f < frames; f++)
+ {
+  uint8* sector = dest + f * CD_FRAME_SIZE;
+
+  memcpy(sector, data + f * 2352, 2352);
+  memcpy(sector + 2352, sub + f * 96, 96);
+
+  if(ecc_flags && (ecc_flags[f >> 3] & (1 << (f & 7))))
+  {
+   memcpy(sector, CD_SyncHeader, sizeof(CD_SyncHeader));
+   encode_mode1_ecc(sector);
+  }
+ }
+}
+
+void CDAccess_CHD::DecompressHunk(uint32 hunk, uint8* dest, unsigned depth)
+{
+ const HunkMapEntry& e = hunk_map[hunk];
+
+ switch(e.type)
+ {
+  case COMPRESSION_TYPE_0:
+  case COMPRESSION_TYPE_1:
+  case COMPRESSION_TYPE_2:
+  case COMPRESSION_TYPE_3:
+  {
+   const uint32 codec = compressors[e.type];
+   const uint8* src = ReadImage(e.offset, e.length);
+
+   if(codec == CHD_CODEC_ZLIB)
+    decomp->Inflate(src, e.length, dest, hunk_bytes);
+   else if(codec == CHD_CODEC_LZMA)
+    decomp->Unlzma(src, e.length, dest, hunk_bytes);
+   else
+    DecompressCD(codec, src, e.length, dest);
+  }
+  break;
+
+  case COMPRESSION_NONE:
+	if(e.length)
+	 memcpy(dest, ReadImage(e.offset, hunk_bytes), hunk_bytes);
+	else
+	 memset(dest, 0, hunk_bytes);
+	break;
+
+  case COMPRESSION_SELF:
+	for(const auto& ce : hunk_cache)
+	{
+	 if(ce.hunk == e.offset)
+	 {
+	  memcpy(dest, ce.data.get(), hunk_bytes);
+	  return;
+	 }
+	}
+
+	if(depth >= 16)
+	 throw MDFN_Error(0, _("CHD hunk map is corrupt."));
+
+	DecompressHunk(e.offset, dest, depth + 1);
+	break;
+ }
+}
+
+void CDAccess_CHD::AdviseHunks(uint32 hunk, uint32 count)
+{
+ uint64 start = ~(uint64)0;
+ uint64 end = 0;
+
+ for(uint32 h = hunk; h < hunk_count && h < hunk + count; h++)
+ {
+  const HunkMapEntry& e = hunk_map[h];
+
+  if(e.type <= COMPRESSION_NONE && e.length)
+  {
+   start = std::min<uint64>(start, e.offset);
+   end = std::max<uint64>(end, e.offset + e.length);
+  }
+ }
+
+ if(start < end)
+  img_stream->advise(start, end - start, IO::Advice::WILLNEED);
+}
+
+const uint8* CDAccess_CHD::GetHunk(uint32 hunk)
+{
+ if(hunk >= hunk_count)
+  throw MDFN_Error(0, _("CHD hunk %u out of range."), hunk);
+
+ HunkCacheEntry* victim = &hunk_cache[0];
+
+ cache_clock++;
+
+ for(auto& ce : hunk_cache)
+ {
+  if(ce.hunk == hunk)
+  {
+   ce.last_used = cache_clock;
+   last_hunk = hunk;
+   return ce.data.get();
+  }
+
+  if(ce.last_used < victim->last_used)
+   victim = &ce;
+ }
+
+ //
+ // Sequential reads(streaming video and audio) will want the following hunks next, so have their
+ // compressed data read in while this one decompresses.
+ //
+ if(hunk == last_hunk + 1)
+  AdviseHunks(hunk + 1, ReadAheadHunks);
+
+ last_hunk = hunk;
+
+ victim->hunk = ~0U;
+ DecompressHunk(hunk, victim->data.get(), 0);
+ victim->hunk = hunk;
+ victim->last_used = cache_clock;
+
+ return victim->data.get();
+}
+
+int32 CDAccess_CHD::FindTrack(int32 lba) const noexcept
+{
+ for(int32 track = FirstTrack; track <= LastTrack; track++)
+ {
+  const CHDTrack& t = Tracks[track];
+
+  if(lba >= (t.LBA - t.pregap_dv - t.pregap) && lba < (t.LBA + t.sectors + t.postgap))
+   return track;
+ }
+
+ return -1;
+}
+
+int CDAccess_CHD::Read_Raw_Sector(uint8 *buf, int32 lba)
+{
+ //
+ // Leadout synthesis
+ //
+ if(lba >= total_sectors)
+ {
+  uint8 data_synth_mode = (disc_type == DISC_TYPE_CD_XA ? 0x02 : 0x01);
+
+  switch(Tracks[LastTrack].DIFormat)
+  {
+   case DI_FORMAT_AUDIO:
+	break;
+
+   case DI_FORMAT_MODE1_RAW:
+   case DI_FORMAT_MODE1:
+	data_synth_mode = 0x01;
+	break;
+
+   default:
+	data_synth_mode = 0x02;
+	break;
+  }
+
+  synth_leadout_sector_lba(data_synth_mode, toc, lba, buf);
+  return -1;
+ }
+
+ memset(buf + 2352, 0, 96);
+ const int32 track = MakeSubPQ(lba, buf + 2352);
+ const CHDTrack* ct = &Tracks[track];
+
+ //
+ // Handle pregap and postgap reading
+ //
+ if(lba < (ct->LBA - ct->pregap_dv) || lba >= (ct->LBA + ct->sectors))
+ {
+  const CHDTrack* et = ct;
+
+  if((lba - ct->LBA) < -150)
+  {
+   if((ct->subq_control & SUBQ_CTRLF_DATA) && (FirstTrack < track) && !(Tracks[track - 1].subq_control & SUBQ_CTRLF_DATA))
+    et = &Tracks[track - 1];
+  }
+
+  memset(buf, 0, 2352);
+  switch(et->DIFormat)
+  {
+   case DI_FORMAT_AUDIO:
+	break;
+
+   case DI_FORMAT_MODE1_RAW:
+   case DI_FORMAT_MODE1:
+	encode_mode1_sector(lba + 150, buf);
+	break;
+
+   default:
+	buf[12 +  6] = 0x20;
+	buf[12 + 10] = 0x20;
+	encode_mode2_form2_sector(lba + 150, buf);
+	break;
+  }
+
+  return ct->DIFormat;
+ }
+
+ const uint32 frame = ct->FileFrame + (lba - ct->LBA);
+ const uint8* src;
+
+ try
+ {
+  src = GetHunk(frame / frames_per_hunk) + (frame % frames_per_hunk) * CD_FRAME_SIZE;
+ }
+ catch(std::exception& e)
+ {
+  MDFN_printf("Error reading sector %d: %s\n", lba, e.what());
+  memset(buf, 0, 2352 + 96);
+  return -1;
+ }
+
+ switch(ct->DIFormat)
+ {
+  case DI_FORMAT_AUDIO:
+	memcpy(buf, src, 2352);
+	Endian_A16_Swap(buf, 588 * 2);
+	break;
+
+  case DI_FORMAT_MODE1:
+	memcpy(buf + 12 + 3 + 1, src, 2048);
+	encode_mode1_sector(lba + 150, buf);
+	break;
+
+  case DI_FORMAT_MODE1_RAW:
+  case DI_FORMAT_MODE2_RAW:
+	memcpy(buf, src, 2352);
+	break;
+
+  case DI_FORMAT_MODE2:
+	memcpy(buf + 16, src, 2336);
+	encode_mode2_sector(lba + 150, buf);
+	break;
+
+  case DI_FORMAT_MODE2_FORM1:
+	memcpy(buf + 24, src, 2048);
+	break;
+
+  case DI_FORMAT_MODE2_FORM2:
+	memcpy(buf + 24, src, 2324);
+	break;
+ }
+
+ if(ct->HasSubchannel)
+  memcpy(buf + 2352, src + 2352, 96);
+
+ return ct->DIFormat;
+}
+
+int CDAccess_CHD::Read_Sector(uint8 *buf, int32 lba, uint32 size)
+{
+ uint8 data[2352 + 96]{};
+ int format = Read_Raw_Sector(data, lba);
+ switch(format)
+ {
+  case DI_FORMAT_AUDIO:
+  case DI_FORMAT_CDI_RAW:
+	memcpy(buf, data, size);
+	break;
+
+  case DI_FORMAT_MODE1:
+  case DI_FORMAT_MODE1_RAW:
+	memcpy(buf, data + 12 + 3 + 1, size);
+	break;
+
+  case DI_FORMAT_MODE2:
+  case DI_FORMAT_MODE2_RAW:
+	memcpy(buf, data + 16, size);
+	break;
+
+  case DI_FORMAT_MODE2_FORM1:
+  case DI_FORMAT_MODE2_FORM2:
+	memcpy(buf, data + 24, size);
+	break;
+ }
+ return format;
+}
+
+void CDAccess_CHD::HintReadSector(int32 lba, int32 count)
+{
+ const int32 track = FindTrack(lba);
+
+ if(track < 0)
+  return;
+
+ const CHDTrack& t = Tracks[track];
+
+ if(lba < (t.LBA - t.pregap_dv) || lba >= (t.LBA + t.sectors))
+  return;
+
+ const uint32 frame = t.FileFrame + (lba - t.LBA);
+
+ AdviseHunks(frame / frames_per_hunk, (frame % frames_per_hunk + count + frames_per_hunk - 1) / frames_per_hunk);
+}
+
+bool CDAccess_CHD::Fast_Read_Raw_PW_TSRE(uint8* pwbuf, int32 lba) const noexcept
+{
+ int32 track;
+
+ if(lba >= total_sectors)
+ {
+  subpw_synth_leadout_lba(toc, lba, pwbuf);
+  return(true);
+ }
+
+ memset(pwbuf, 0, 96);
+ try
+ {
+  track = MakeSubPQ(lba, pwbuf);
+ }
+ catch(...)
+ {
+  return(false);
+ }
+
+ //
+ // Stored subchannel data has to come from the (compressed) image.
+ //
+ if(Tracks[track].HasSubchannel && lba >= (Tracks[track].LBA - Tracks[track].pregap_dv) && (lba < Tracks[track].LBA + Tracks[track].sectors))
+  return(false);
+
+ return(true);
+}
+
+//
+// Note: this function makes use of the current contents(as in |=) in SubPWBuf.
+//
+int32 CDAccess_CHD::MakeSubPQ(int32 lba, uint8 *SubPWBuf) const
+{
+ uint8 buf[0xC];
+ const int32 track = FindTrack(lba);
+ uint32 lba_relative;
+ uint8 pause_or = 0x00;
+
+ if(track < 0)
+  throw(MDFN_Error(0, _("Could not find track for sector %u!"), lba));
+
+ if(lba < Tracks[track].LBA)
+  lba_relative = Tracks[track].LBA - 1 - lba;
+ else
+  lba_relative = lba - Tracks[track].LBA;
+
+ uint8 adr = 0x1; // Q channel data encodes position
+ uint8 control = Tracks[track].subq_control;
+
+ // Handle pause(D7 of interleaved subchannel byte) bit, should be set to 1 when in pregap or postgap.
+ if((lba < Tracks[track].LBA) || (lba >= Tracks[track].LBA + Tracks[track].sectors))
+  pause_or = 0x80;
+
+ // Handle pregap between audio->data track
+ {
+  int32 pg_offset = (int32)lba - Tracks[track].LBA;
+
+  if(pg_offset < -150)
+  {
+   if((Tracks[track].subq_control & SUBQ_CTRLF_DATA) && (FirstTrack < track) && !(Tracks[track - 1].subq_control & SUBQ_CTRLF_DATA))
+    control = Tracks[track - 1].subq_control;
+  }
+ }
+
+ memset(buf, 0, 0xC);
+ buf[0] = (adr << 0) | (control << 4);
+ buf[1] = U8_to_BCD(track);
+ buf[2] = U8_to_BCD(lba >= Tracks[track].LBA ? 1 : 0);
+
+ // Track relative MSF address
+ ABA_to_AMSF_BCD(lba_relative, &buf[3], &buf[4], &buf[5]);
+
+ buf[6] = 0;
+
+ // Absolute MSF address
+ ABA_to_AMSF_BCD(LBA_to_ABA(lba), &buf[7], &buf[8], &buf[9]);
+
+ subq_generate_checksum(buf);
+
+ for(int i = 0; i < 96; i++)
+  SubPWBuf[i] |= (((buf[i >> 3] >> (7 - (i & 0x7))) & 1) ? 0x40 : 0x00) | pause_or;
+
+ return track;
+}
+
+}
@@ -0,0 +1,129 @@
+/******************************************************************************/
+/* Mednafen - Multi-system Emulator                                           */
+/******************************************************************************/
+/* CDAccess_CHD.h:
+**
+** This program is free software; you can redistribute it and/or
+** modify it under the terms of the GNU General Public License
+** as published by the Free Software Foundation; either version 2
+** of the License, or (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software Foundation, Inc.,
+** 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+*/
+
+#ifndef __MDFN_CDROM_CDACCESS_CHD_H
+#define __MDFN_CDROM_CDACCESS_CHD_H
+
+#include "CDAccess.h"
+
+#include <vector>
+
+namespace Mednafen
+{
+
+//
+// MAME compressed hunks of data(CHD) version 5 CD images, as written by "chdman createcd".
+//
+// Sectors are stored in "hunks" of several frames each, compressed independently; decompressed
+// hunks are kept in a small LRU cache so consecutive sector reads only decompress each hunk once.
+//
+class CDAccess_CHD final: public CDAccess
+{
+ public:
+
+ CDAccess_CHD(VirtualFS* vfs, const std::string& path, bool image_memcache);
+ ~CDAccess_CHD() final;
+
+ int Read_Raw_Sector(uint8 *buf, int32 lba) final;
+
+ bool Fast_Read_Raw_PW_TSRE(uint8* pwbuf, int32 lba) const noexcept final;
+
+ void Read_TOC(CDUtility::TOC *toc) final;
+
+ void HintReadSector(int32 lba, int32 count) final;
+
+ int Read_Sector(uint8 *buf, int32 lba, uint32 size) final;
+
+ private:
+
+ struct CHDTrack
+ {
+  int32 LBA;
+  int32 pregap;		// Not in the image, synthesized.
+  int32 pregap_dv;	// In the image, before LBA.
+  int32 postgap;
+  int32 sectors;	// Not including pregap sectors!
+  uint32 FileFrame;	// Frame in the image holding LBA.
+  uint8 DIFormat;
+  uint8 subq_control;
+  bool HasSubchannel;
+ };
+
+ struct HunkMapEntry
+ {
+  uint64 offset;
+  uint32 length;
+  uint8 type;
+ };
+
+ struct HunkCacheEntry
+ {
+  uint32 hunk;
+  uint64 last_used;
+  std::unique_ptr<uint8[]> data;
+ };
+
+ struct Decompressors;
+
+ std::unique_ptr<Stream> img_stream;
+ const uint8* img_map = nullptr;
+ uint64 img_size = 0;
+
+ uint32 compressors[4]{};
+ uint32 hunk_bytes = 0;
+ uint32 hunk_count = 0;
+ uint32 frames_per_hunk = 0;
+ std::vector<HunkMapEntry> hunk_map;
+
+ std::vector<HunkCacheEntry> hunk_cache;
+ uint64 cache_clock = 0;
+ uint32 last_hunk = ~0U;
+ std::vector<uint8> comp_buf;
+ std::unique_ptr<uint8[]> cd_buf;
+ std::unique_ptr<Decompressors> decomp;
+
+ int32 NumTracks = 0;
+ int32 FirstTrack = 0;
+ int32 LastTrack = 0;
+ int32 total_sectors = 0;
+ uint8 disc_type = 0;
+ CHDTrack Tracks[100]{};
+ CDUtility::TOC toc{};
+
+ void Load(VirtualFS* vfs, const std::string& path, bool image_memcache);
+ void ReadHeader(void);
+ void ReadMap(uint64 map_offset);
+ void ReadTracks(uint64 meta_offset);
+ void GenerateTOC(void);
+
+ const uint8* ReadImage(uint64 offset, uint32 length);
+ const uint8* GetHunk(uint32 hunk);
+ void DecompressHunk(uint32 hunk, uint8* dest, unsigned depth);
+ void DecompressCD(uint32 codec, const uint8* src, uint32 src_len, uint8* dest);
+ void AdviseHunks(uint32 hunk, uint32 count);
+
+ int32 FindTrack(int32 lba) const noexcept;
+
+ // MakeSubPQ will OR the simulated P and Q subchannel data into SubPWBuf.
+ int32 MakeSubPQ(int32 lba, uint8 *SubPWBuf) const;
+};
+
+}
+#endif
@@ -80,6 +80,13 @@ void encode_mode1_sector(uint32 aba, uint8 *sector_data)
  lec_encode_mode1_sector(aba, sector_data);
 }
 
+void encode_mode1_ecc(uint8 *sector_data)
+{
+ CDUtility_Init();
+
+ lec_encode_mode1_ecc(sector_data);
+}
+
 void encode_mode2_sector(uint32 aba, uint8 *sector_data)
 {
  CDUtility_Init();
@@ -184,6 +184,9 @@ namespace CDUtility
  void encode_mode2_form1_sector(uint32 aba, uint8 *sector_data);	// 2048+8 bytes of user data at offset 16
  void encode_mode2_form2_sector(uint32 aba, uint8 *sector_data);	// 2324+8 bytes of user data at offset 16
 
+ // Regenerates only the P and Q ECC bytes of a mode 1 sector, keeping its header and EDC.
+ void encode_mode1_ecc(uint8 *sector_data);
+
 
  // User data area pre-pause(MSF 00:00:00 through 00:01:74), lba -150 through -1
  // out_buf must be able to contain 2352+96 bytes.
@@ -48,6 +48,12 @@ void lec_encode_mode0_sector(u_int32_t adr, u_int8_t *sector);
  */
 void lec_encode_mode1_sector(u_int32_t adr, u_int8_t *sector);
 
+/* Calculates the P and Q parities of a MODE 1 sector, leaving the
+ * header, user data and EDC as they are.
+ * 'sector' must be 2352 byte wide
+ */
+void lec_encode_mode1_ecc(u_int8_t *sector);
+
 /* Encodes a MODE 2 sector.
  * 'adr' is the current physical sector address
  * 'sector' must be 2352 byte wide containing 2336 bytes user data at
@@ -0,0 +1,53 @@
+ifndef inc_main
+inc_main := 1
+
+include $(IMAGINE_PATH)/make/imagineAppBase.mk
+
+VPATH += $(projectPath)/../../src
+
+CPPFLAGS += -DHAVE_CONFIG_H \
+-I$(projectPath)/../../src \
+-I$(projectPath)/../../src/include
+
+CXXFLAGS_WARN += -Wno-register
+
+SRC += main/main.cc \
+common/CDImpl.cc \
+common/StreamImpl.cc \
+mednafen/endian.cpp \
+mednafen/general.cpp \
+mednafen/error.cpp \
+mednafen/MemoryStream.cpp \
+mednafen/NativeVFS.cpp \
+mednafen/Stream.cpp \
+mednafen/VirtualFS.cpp \
+mednafen/cdrom/CDAFReader.cpp \
+mednafen/cdrom/CDAFReader_SF.cpp \
+mednafen/cdrom/CDAFReader_Vorbis.cpp \
+mednafen/cdrom/galois.cpp \
+mednafen/cdrom/recover-raw.cpp \
+mednafen/cdrom/CDAccess.cpp \
+mednafen/cdrom/CDAccess_Image.cpp \
+mednafen/cdrom/CDAccess_CCD.cpp \
+mednafen/cdrom/CDAccess_CHD.cpp \
+mednafen/cdrom/CDUtility.cpp \
+mednafen/cdrom/l-ec.cpp \
+mednafen/cdrom/lec.cpp \
+mednafen/cdrom/crc32.cpp \
+mednafen/string/string.cpp \
+mednafen/hash/crc.cpp \
+mednafen/hash/md5.cpp
+
+include $(IMAGINE_PATH)/make/package/imagine.mk
+include $(IMAGINE_PATH)/make/package/libvorbis.mk
+include $(IMAGINE_PATH)/make/package/libsndfile.mk
+include $(IMAGINE_PATH)/make/package/zlib.mk
+include $(IMAGINE_PATH)/make/package/liblzma.mk
+
+ifndef target
+target := CHDTest
+endif
+
+include $(IMAGINE_PATH)/make/imagineAppTarget.mk
+
+endif
@@ -0,0 +1 @@
+cxxExceptions := 1
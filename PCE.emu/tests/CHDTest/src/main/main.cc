@@ -0,0 +1,184 @@
+/*  This file is part of PCE.emu.
+
+	PCE.emu is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	PCE.emu is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with PCE.emu.  If not, see <http://www.gnu.org/licenses/> */
+
+#define LOGTAG "main"
+#include <imagine/base/Base.hh>
+#include <imagine/logger/logger.h>
+#include <imagine/util/string.h>
+#include <mednafen/mednafen.h>
+#include <mednafen/NativeVFS.h>
+#include <mednafen/cdrom/CDAccess.h>
+#include <mednafen/cdrom/CDUtility.h>
+#include <algorithm>
+#include <chrono>
+#include <memory>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+// Opens a CHD and the BIN/CUE (or CCD) it was made from, checks their TOCs match, then
+// reads every sector from the pregap of track 1 to the lead-out through both and
+// compares them. The full 2448 bytes are compared, except for sectors where the CHD
+// stores its own subchannel data, which a CUE sheet can't hold, so only the 2352 main
+// bytes are compared there.
+// Then reports sequential read throughput of both images.
+// Returns non-zero if anything differs.
+// Usage: chdtest [--passes N] <image.chd> <image.cue>
+
+namespace Mednafen
+{
+
+NativeVFS NVFS;
+
+bool MDFN_GetSettingB(const char *name)
+{
+	if(string_equal("cdrom.lec_eval", name))
+		return 1;
+	if(string_equal("filesys.untrusted_fip_check", name))
+		return 0;
+	bug_unreachable("unhandled settingB %s", name);
+	return 0;
+}
+
+// keep the image loaders' informational output out of the results
+#ifndef NDEBUG
+void MDFN_printf(const char *format, ...) noexcept {}
+void MDFN_Notify(MDFN_NoticeType t, const char* format, ...) noexcept {}
+#endif
+void MDFN_indent(int indent) {}
+
+}
+
+using namespace Mednafen;
+using namespace Mednafen::CDUtility;
+
+static bool compareTOC(const TOC &chd, const TOC &ref)
+{
+	bool match = true;
+	if(chd.first_track != ref.first_track || chd.last_track != ref.last_track || chd.disc_type != ref.disc_type)
+	{
+		printf("TOC tracks %d-%d type %d, expected %d-%d type %d\n",
+			chd.first_track, chd.last_track, chd.disc_type, ref.first_track, ref.last_track, ref.disc_type);
+		match = false;
+	}
+	for(int t = ref.first_track; t <= ref.last_track; t++)
+	{
+		auto &a = chd.tracks[t];
+		auto &b = ref.tracks[t];
+		if(a.lba != b.lba || a.control != b.control || a.adr != b.adr)
+		{
+			printf("TOC track %d lba %u control %u, expected lba %u control %u\n", t, a.lba, a.control, b.lba, b.control);
+			match = false;
+		}
+	}
+	if(chd.tracks[100].lba != ref.tracks[100].lba)
+	{
+		printf("TOC lead-out %u, expected %u\n", chd.tracks[100].lba, ref.tracks[100].lba);
+		match = false;
+	}
+	return match;
+}
+
+static unsigned compareSectors(CDAccess &chd, CDAccess &ref, int32 leadOut)
+{
+	unsigned mismatches = 0, subOnlyMain = 0;
+	for(int32 lba = -150; lba < leadOut; lba++)
+	{
+		uint8 chdBuff[2448], refBuff[2448], pw[96];
+		int chdFormat = chd.Read_Raw_Sector(chdBuff, lba);
+		int refFormat = ref.Read_Raw_Sector(refBuff, lba);
+		// the CHD can't synthesize the subchannel if it stores it
+		bool hasSubData = !chd.Fast_Read_Raw_PW_TSRE(pw, lba);
+		subOnlyMain += hasSubData;
+		size_t compareBytes = hasSubData ? 2352 : 2448;
+		if(chdFormat != refFormat || memcmp(chdBuff, refBuff, compareBytes))
+		{
+			if(mismatches < 10)
+			{
+				size_t i = 0;
+				while(i < compareBytes && chdBuff[i] == refBuff[i])
+					i++;
+				printf("LBA %d differs: format %d vs %d, first at byte %zu\n", lba, chdFormat, refFormat, i);
+			}
+			mismatches++;
+		}
+	}
+	printf("compared %d sectors (%u with stored subchannel, main data only), %u differ\n",
+		leadOut + 150, subOnlyMain, mismatches);
+	return mismatches;
+}
+
+static double readThroughput(CDAccess &cd, int32 leadOut, unsigned passes)
+{
+	uint8 buff[2448];
+	auto start = std::chrono::steady_clock::now();
+	for(unsigned p = 0; p < passes; p++)
+	{
+		for(int32 lba = 0; lba < leadOut; lba++)
+		{
+			cd.Read_Raw_Sector(buff, lba);
+		}
+	}
+	std::chrono::duration<double> time = std::chrono::steady_clock::now() - start;
+	return (double)leadOut * passes / time.count();
+}
+
+namespace Base
+{
+
+int runHeadless(int argc, char** argv)
+{
+	unsigned passes = 4;
+	const char *paths[2]{};
+	unsigned pathCount = 0;
+	for(int i = 1; i < argc; i++)
+	{
+		if(!strcmp(argv[i], "--passes") && i + 1 < argc)
+			passes = std::max(strtoul(argv[++i], nullptr, 10), 1ul);
+		else if(pathCount < 2)
+			paths[pathCount++] = argv[i];
+	}
+	if(pathCount != 2)
+	{
+		fprintf(stderr, "usage: chdtest [--passes N] <image.chd> <image.cue>\n");
+		return 1;
+	}
+	try
+	{
+		std::unique_ptr<CDAccess> chd{CDAccess_Open(&NVFS, paths[0], false)};
+		std::unique_ptr<CDAccess> ref{CDAccess_Open(&NVFS, paths[1], false)};
+		TOC chdTOC, refTOC;
+		chd->Read_TOC(&chdTOC);
+		ref->Read_TOC(&refTOC);
+		bool pass = compareTOC(chdTOC, refTOC);
+		int32 leadOut = refTOC.tracks[100].lba;
+		pass &= !compareSectors(*chd, *ref, leadOut);
+		double chdRate = readThroughput(*chd, leadOut, passes);
+		double refRate = readThroughput(*ref, leadOut, passes);
+		printf("sequential read: CHD %.0f sectors/s (%.0fx CD speed), %s %.0f sectors/s (%.0fx)\n",
+			chdRate, chdRate / 75, strrchr(paths[1], '.') ? strrchr(paths[1], '.') + 1 : "reference", refRate, refRate / 75);
+		printf("%s\n", pass ? "CHD matches" : "CHD MISMATCH");
+		return pass ? 0 : 1;
+	}
+	catch(std::exception &e)
+	{
+		fprintf(stderr, "error: %s\n", e.what());
+		return 1;
+	}
+}
+
+void onInit(int argc, char** argv) {}
+
+}
@@ -53,45 +53,12 @@ else ifeq ($(ARCH), x86)
  yabause/sh2_dynarec/sh2_dynarec.c
 endif
 
-SRC += yabause/bios.c \
-yabause/cdbase.c \
-yabause/cheat.c \
-yabause/coffelf.c \
-yabause/cs0.c \
-yabause/cs1.c \
-yabause/cs2.c \
-yabause/debug.c \
-yabause/error.c \
-yabause/memory.c \
-yabause/m68kcore.c \
-yabause/m68kd.c \
-yabause/movie.c \
-yabause/netlink.c \
-yabause/peripheral.c \
-yabause/profile.c \
-yabause/scu.c \
-yabause/sh2core.c \
-yabause/sh2d.c \
-yabause/sh2idle.c \
-yabause/sh2int.c \
-yabause/sh2trace.c \
-yabause/smpc.c \
-yabause/snddummy.c \
-yabause/titan/titan.c \
-yabause/vdp1.c \
-yabause/vdp2.c \
-yabause/vdp2debug.c \
-yabause/vidshared.c \
-yabause/vidsoft.c \
-yabause/yabause.c \
-yabause/scsp.c \
-yabause/japmodem.c
+include $(projectPath)/yabauseSrc.mk
+
+SRC += $(addprefix yabause/,$(yabauseSrc))
 
 #SRC += yabause/c68k/c68kexec.c yabause/c68k/c68k.c yabause/m68kc68k.c
 #CPPFLAGS += -DHAVE_C68K=1
-SRC += yabause/q68/q68.c \
-yabause/q68/q68-core.c \
-yabause/m68kq68.c
 CPPFLAGS += -DHAVE_Q68=1
 # TODO: -DQ68_USE_JIT=1
 
@@ -18,6 +18,11 @@
 #include <emuframework/EmuMainMenuView.hh>
 #include "internal.hh"
 
+extern "C"
+{
+	#include <yabause/vidsoft.h>
+}
+
 static constexpr uint MAX_SH2_CORES = 4;
 
 class CustomSystemOptionView : public SystemOptionView
@@ -87,10 +92,42 @@ public:
 	}
 };
 
+class CustomVideoOptionView : public VideoOptionView
+{
+	TextMenuItem renderThreadsItem[4]
+	{
+		{"1", [](){ setRenderThreads(1); }},
+		{"2", [](){ setRenderThreads(2); }},
+		{"3", [](){ setRenderThreads(3); }},
+		{"4", [](){ setRenderThreads(4); }},
+	};
+
+	MultiChoiceMenuItem renderThreads
+	{
+		"Render Threads",
+		optionRenderThreads - 1,
+		renderThreadsItem
+	};
+
+	static void setRenderThreads(uint8_t val)
+	{
+		optionRenderThreads = val;
+		VIDSoftSetNumLayerThreads(val);
+	}
+
+public:
+	CustomVideoOptionView(ViewAttachParams attach): VideoOptionView{attach, true}
+	{
+		loadStockItems();
+		item.emplace_back(&renderThreads);
+	}
+};
+
 std::unique_ptr<View> EmuApp::makeCustomView(ViewAttachParams attach, ViewID id)
 {
 	switch(id)
 	{
+		case ViewID::VIDEO_OPTIONS: return std::make_unique<CustomVideoOptionView>(attach);
 		case ViewID::SYSTEM_OPTIONS: return std::make_unique<CustomSystemOptionView>(attach);
 		default: return nullptr;
 	}
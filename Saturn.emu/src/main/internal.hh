@@ -15,6 +15,7 @@ static const uint gamepadKeys = 23;
 }
 
 extern Byte1Option optionSH2Core;
+extern Byte1Option optionRenderThreads;
 extern FS::PathString biosPath;
 extern SH2Interface_struct *SH2CoreList[];
 extern uint SH2Cores;
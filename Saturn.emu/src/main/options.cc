@@ -19,11 +19,13 @@
 extern "C"
 {
 	#include <yabause/sh2int.h>
+	#include <yabause/vidsoft.h>
 }
 
 enum
 {
-	CFGKEY_BIOS_PATH = 279, CFGKEY_SH2_CORE = 280
+	CFGKEY_BIOS_PATH = 279, CFGKEY_SH2_CORE = 280,
+	CFGKEY_RENDER_THREADS = 281
 };
 
 SH2Interface_struct *SH2CoreList[]
@@ -53,6 +55,7 @@ static bool OptionSH2CoreIsValid(uint8_t val)
 const char *EmuSystem::configFilename = "SaturnEmu.config";
 static PathOption optionBiosPath{CFGKEY_BIOS_PATH, biosPath, ""};
 Byte1Option optionSH2Core{CFGKEY_SH2_CORE, (uint8_t)defaultSH2CoreID, false, OptionSH2CoreIsValid};
+Byte1Option optionRenderThreads{CFGKEY_RENDER_THREADS, 1, false, optionIsValidWithMinMax<1, 4>};
 const AspectRatioInfo EmuSystem::aspectRatioInfo[] =
 {
 		{"4:3 (Original)", 4, 3},
@@ -75,6 +78,7 @@ void EmuSystem::initOptions()
 EmuSystem::Error EmuSystem::onOptionsLoaded()
 {
 	yinit.sh2coretype = optionSH2Core;
+	VIDSoftSetNumLayerThreads(optionRenderThreads);
 	return {};
 }
 
@@ -85,6 +89,7 @@ bool EmuSystem::readConfig(IO &io, uint key, uint readSize)
 		default: return 0;
 		bcase CFGKEY_BIOS_PATH: optionBiosPath.readFromIO(io, readSize);
 		bcase CFGKEY_SH2_CORE: optionSH2Core.readFromIO(io, readSize);
+		bcase CFGKEY_RENDER_THREADS: optionRenderThreads.readFromIO(io, readSize);
 	}
 	return 1;
 }
@@ -93,4 +98,5 @@ void EmuSystem::writeConfig(IO &io)
 {
 	optionBiosPath.writeToIO(io);
 	optionSH2Core.writeWithKeyIfNotDefault(io);
+	optionRenderThreads.writeWithKeyIfNotDefault(io);
 }
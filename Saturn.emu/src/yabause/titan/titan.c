@@ -20,6 +20,7 @@
 #include "titan.h"
 
 #include <stdlib.h>
+#include <string.h>
 
 /* private */
 typedef u32 (*TitanBlendFunc)(u32 top, u32 bottom);
@@ -294,11 +295,16 @@ void TitanPutShadow(int priority, s32 x, s32 y)
 }
 
 void TitanRender(pixel_t * dispbuffer)
+{
+   TitanRenderLines(dispbuffer, 0, tt_context.vdp2height);
+}
+
+void TitanRenderLines(pixel_t * dispbuffer, s32 ystart, s32 yend)
 {
    u32 dot;
    int i;
 
-   for (i = 0; i < (tt_context.vdp2width * tt_context.vdp2height); i++)
+   for (i = ystart * tt_context.vdp2width; i < (tt_context.vdp2width * yend); i++)
    {
       dot = TitanDigPixel(7, i);
       if (dot)
@@ -308,6 +314,62 @@ void TitanRender(pixel_t * dispbuffer)
    }
 }
 
+int TitanLayerInit(TitanLayer * layer)
+{
+   if ((layer->color = (u32 *)malloc(sizeof(u32) * 704 * 512)) == NULL)
+      return -1;
+   if ((layer->priority = (u8 *)calloc(sizeof(u8), 704 * 512)) == NULL)
+      return -1;
+   memset(layer->used, 0, sizeof(layer->used));
+   return 0;
+}
+
+void TitanLayerDeInit(TitanLayer * layer)
+{
+   free(layer->color);
+   free(layer->priority);
+   layer->color = NULL;
+   layer->priority = NULL;
+}
+
+/* a layer only ever draws over its own line screen, so it gets a private copy */
+void TitanLayerPutLineHLine(TitanLayer * layer, s32 y, u32 color)
+{
+   layer->linescreen[y] = color;
+}
+
+void TitanLayerPutPixel(TitanLayer * layer, int priority, s32 x, s32 y, u32 color, int linescreen)
+{
+   if (priority == 0) return;
+
+   {
+      int pos = (y * tt_context.vdp2width) + x;
+      if (linescreen)
+         color = TitanBlendPixelsTop(color, linescreen > 1 ? layer->linescreen[y] : tt_context.linescreen[linescreen][y]);
+      layer->color[pos] = color;
+      layer->priority[pos] = priority;
+      layer->used[y] = 1;
+   }
+}
+
+void TitanLayerMergeLine(TitanLayer * layer, s32 y)
+{
+   int i;
+   int pos = y * tt_context.vdp2width;
+
+   if (! layer->used[y]) return;
+
+   for (i = 0; i < tt_context.vdp2width; i++, pos++)
+   {
+      if (layer->priority[pos])
+      {
+         TitanPutPixel(layer->priority[pos], i, y, layer->color[pos], 0);
+         layer->priority[pos] = 0;
+      }
+   }
+   layer->used[y] = 0;
+}
+
 #ifdef WORDS_BIGENDIAN
 void TitanWriteColor(pixel_t * dispbuffer, s32 bufwidth, s32 x, s32 y, u32 color)
 {
@@ -44,6 +44,26 @@ void TitanPutHLine(int priority, s32 x, s32 y, s32 width, u32 color);
 void TitanPutShadow(int priority, s32 x, s32 y);
 
 void TitanRender(pixel_t * dispbuffer);
+void TitanRenderLines(pixel_t * dispbuffer, s32 ystart, s32 yend);
+
+/* A layer drawn into its own buffer, so several can be drawn at once, then
+   merged into the priority buffers in the order they would have been drawn.
+   Each pixel of a layer must be put at most once. */
+typedef struct
+{
+   u32 * color;
+   u8 * priority;
+   u32 linescreen[512];
+   u8 used[512];
+} TitanLayer;
+
+int TitanLayerInit(TitanLayer * layer);
+void TitanLayerDeInit(TitanLayer * layer);
+
+void TitanLayerPutLineHLine(TitanLayer * layer, s32 y, u32 color);
+void TitanLayerPutPixel(TitanLayer * layer, int priority, s32 x, s32 y, u32 color, int linescreen);
+
+void TitanLayerMergeLine(TitanLayer * layer, s32 y);
 
 void TitanWriteColor(pixel_t * dispbuffer, s32 bufwidth, s32 x, s32 y, u32 color);
 
@@ -402,6 +402,10 @@ void Vdp2ReadRotationTableFP(int which, vdp2rotationparameterfp_struct *paramete
    parameter->ky = (signed) ((i & 0x00FFFFFF) | (i & 0x00800000 ? 0xFF800000 : 0x00000000));
    addr += 4;
 
+   // set by the coefficient reads, which may not happen before they're used
+   parameter->msb = 0;
+   parameter->linescreen = 0;
+
    if (parameter->coefenab)
    {
       // Read in coefficient values
@@ -743,6 +743,9 @@ static INLINE void Vdp2ReadCoefficient(vdp2rotationparameter_struct *parameter,
 
 static INLINE void Vdp2ReadCoefficientFP(vdp2rotationparameterfp_struct *parameter, u32 addr)
 {
+   // the table wraps around VDP2 RAM
+   addr &= 0x7FFFF & ~(parameter->coefdatasize - 1);
+
    switch (parameter->coefmode)
    {
       case 0: // coefficient for kx and ky
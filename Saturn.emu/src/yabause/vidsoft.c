@@ -38,6 +38,7 @@
 
 #include <stdlib.h>
 #include <limits.h>
+#include <pthread.h>
 
 #if defined(__APPLE__)
 // malloc pointers always 16-byte aligned
@@ -162,6 +163,31 @@ static int outputheight;
 #endif
 static int resxratio;
 static int resyratio;
+static int mosaic_table[16][1024];
+
+// With more than one layer thread, each VDP2 screen is drawn into its own
+// TitanLayer on the pool, then the layers are merged in the order the single
+// threaded path draws them, so the output doesn't depend on thread timing
+#define VIDSOFT_MAX_LAYER_THREADS 4
+
+static struct
+{
+   int numthreads;
+   pthread_t thread[VIDSOFT_MAX_LAYER_THREADS];
+   pthread_mutex_t mutex;
+   pthread_cond_t start;
+   pthread_cond_t done;
+   void (*func)(int);
+   int next;
+   int count;
+   int remaining;
+   int generation;
+   int quit;
+} layerpool = { 1, {0}, PTHREAD_MUTEX_INITIALIZER, PTHREAD_COND_INITIALIZER, PTHREAD_COND_INITIALIZER };
+
+static TitanLayer layerbuffer[5];
+static void (*layerdraw[5])(TitanLayer *);
+static int numlayers;
 
 typedef struct { s16 x; s16 y; } vdp1vertex;
 
@@ -642,7 +668,17 @@ static u8 FASTCALL GetAlpha(vdp2draw_struct * info, u32 color)
 
 //////////////////////////////////////////////////////////////////////////////
 
-static void FASTCALL Vdp2DrawScroll(vdp2draw_struct *info)
+static INLINE void Vdp2PutPixel(vdp2draw_struct *info, TitanLayer *layer, s32 x, s32 y, u32 color)
+{
+   if (layer)
+      TitanLayerPutPixel(layer, info->priority, x, y, color, info->linescreen);
+   else
+      TitanPutPixel(info->priority, x, y, color, info->linescreen);
+}
+
+//////////////////////////////////////////////////////////////////////////////
+
+static void FASTCALL Vdp2DrawScroll(vdp2draw_struct *info, TitanLayer *layer)
 {
    int i, j;
    int x, y;
@@ -667,22 +703,8 @@ static void FASTCALL Vdp2DrawScroll(vdp2draw_struct *info)
    ReadLineWindowData(&info->islinewindow, info->wctl, &linewnd0addr, &linewnd1addr);
    /* color calculation window: in => no color calc, out => color calc */
    ReadWindowData(Vdp2Regs->WCTLD >> 8, colorcalcwindow);
-   {
-	   static int tables_initialized = 0;
-	   static int mosaic_table[16][1024];
-	   if(!tables_initialized)
-	   {
-		   tables_initialized = 1;
-			for(i=0;i<16;i++)
-			{
-				int m = i+1;
-				for(j=0;j<1024;j++)
-					mosaic_table[i][j] = j/m*m;
-			}
-	   }
-	   mosaic_x = mosaic_table[info->mosaicxmask-1];
-	   mosaic_y = mosaic_table[info->mosaicymask-1];
-   }
+   mosaic_x = mosaic_table[info->mosaicxmask-1];
+   mosaic_y = mosaic_table[info->mosaicymask-1];
 
    for (j = 0; j < vdp2height; j++)
    {
@@ -786,7 +808,7 @@ static void FASTCALL Vdp2DrawScroll(vdp2draw_struct *info)
             else
                alpha = GetAlpha(info, color);
 
-            TitanPutPixel(info->priority, i, j, info->PostPixelFetchCalc(info, COLSAT2YAB32(alpha, color)), info->linescreen);
+            Vdp2PutPixel(info, layer, i, j, info->PostPixelFetchCalc(info, COLSAT2YAB32(alpha, color)));
          }
       }
    }    
@@ -794,7 +816,7 @@ static void FASTCALL Vdp2DrawScroll(vdp2draw_struct *info)
 
 //////////////////////////////////////////////////////////////////////////////
 
-static void FASTCALL Vdp2DrawRotationFP(vdp2draw_struct *info, vdp2rotationparameterfp_struct *parameter)
+static void FASTCALL Vdp2DrawRotationFP(vdp2draw_struct *info, vdp2rotationparameterfp_struct *parameter, TitanLayer *layer)
 {
    int i, j;
    int x, y;
@@ -861,7 +883,7 @@ static void FASTCALL Vdp2DrawRotationFP(vdp2draw_struct *info, vdp2rotationparam
                   continue;
                }
 
-               TitanPutPixel(info->priority, i, j, info->PostPixelFetchCalc(info, COLSAT2YAB32(GetAlpha(info, color), color)), info->linescreen);
+               Vdp2PutPixel(info, layer, i, j, info->PostPixelFetchCalc(info, COLSAT2YAB32(GetAlpha(info, color), color)));
             }
             xmul += p->deltaXst;
             ymul += p->deltaYst;
@@ -956,7 +978,10 @@ static void FASTCALL Vdp2DrawRotationFP(vdp2draw_struct *info, vdp2rotationparam
             lineColorAddr = (T1ReadWord(Vdp2Ram, lineAddr) & 0x780) | p->linescreen;
             lineColor = Vdp2ColorRamGetColor(lineColorAddr);
             lineAddr += lineInc;
-            TitanPutLineHLine(info->linescreen, j, COLSAT2YAB32(0x3F, lineColor));
+            if (layer)
+               TitanLayerPutLineHLine(layer, j, COLSAT2YAB32(0x3F, lineColor));
+            else
+               TitanPutLineHLine(info->linescreen, j, COLSAT2YAB32(0x3F, lineColor));
          }
 
          info->LoadLineParams(info, j);
@@ -1059,7 +1084,7 @@ static void FASTCALL Vdp2DrawRotationFP(vdp2draw_struct *info, vdp2rotationparam
                continue;
             }
 
-            TitanPutPixel(info->priority, i, j, info->PostPixelFetchCalc(info, COLSAT2YAB32(GetAlpha(info, color), color)), info->linescreen);
+            Vdp2PutPixel(info, layer, i, j, info->PostPixelFetchCalc(info, COLSAT2YAB32(GetAlpha(info, color), color)));
          }
          xmul += p->deltaXst;
          ymul += p->deltaYst;
@@ -1084,7 +1109,7 @@ static void FASTCALL Vdp2DrawRotationFP(vdp2draw_struct *info, vdp2rotationparam
       return;
    }
 
-   Vdp2DrawScroll(info);
+   Vdp2DrawScroll(info, layer);
 }
 
 //////////////////////////////////////////////////////////////////////////////
@@ -1187,7 +1212,7 @@ static void LoadLineParamsNBG0(vdp2draw_struct * info, int line)
 
 //////////////////////////////////////////////////////////////////////////////
 
-static void Vdp2DrawNBG0(void)
+static void Vdp2DrawNBG0(TitanLayer *layer)
 {
    vdp2draw_struct info;
    vdp2rotationparameterfp_struct parameter[2];
@@ -1312,12 +1337,12 @@ static void Vdp2DrawNBG0(void)
    if (info.enable == 1)
    {
       // NBG0 draw
-      Vdp2DrawScroll(&info);
+      Vdp2DrawScroll(&info, layer);
    }
    else
    {
       // RBG1 draw
-      Vdp2DrawRotationFP(&info, parameter);
+      Vdp2DrawRotationFP(&info, parameter, layer);
    }
 }
 
@@ -1335,7 +1360,7 @@ static void LoadLineParamsNBG1(vdp2draw_struct * info, int line)
 
 //////////////////////////////////////////////////////////////////////////////
 
-static void Vdp2DrawNBG1(void)
+static void Vdp2DrawNBG1(TitanLayer *layer)
 {
    vdp2draw_struct info;
 
@@ -1419,7 +1444,7 @@ static void Vdp2DrawNBG1(void)
 
    info.LoadLineParams = (void (*)(void *, int)) LoadLineParamsNBG1;
 
-   Vdp2DrawScroll(&info);
+   Vdp2DrawScroll(&info, layer);
 }
 
 //////////////////////////////////////////////////////////////////////////////
@@ -1436,7 +1461,7 @@ static void LoadLineParamsNBG2(vdp2draw_struct * info, int line)
 
 //////////////////////////////////////////////////////////////////////////////
 
-static void Vdp2DrawNBG2(void)
+static void Vdp2DrawNBG2(TitanLayer *layer)
 {
    vdp2draw_struct info;
 
@@ -1486,7 +1511,7 @@ static void Vdp2DrawNBG2(void)
 
    info.LoadLineParams = (void (*)(void *, int)) LoadLineParamsNBG2;
 
-   Vdp2DrawScroll(&info);
+   Vdp2DrawScroll(&info, layer);
 }
 
 //////////////////////////////////////////////////////////////////////////////
@@ -1503,7 +1528,7 @@ static void LoadLineParamsNBG3(vdp2draw_struct * info, int line)
 
 //////////////////////////////////////////////////////////////////////////////
 
-static void Vdp2DrawNBG3(void)
+static void Vdp2DrawNBG3(TitanLayer *layer)
 {
    vdp2draw_struct info;
 
@@ -1555,7 +1580,7 @@ static void Vdp2DrawNBG3(void)
 
    info.LoadLineParams = (void (*)(void *, int)) LoadLineParamsNBG3;
 
-   Vdp2DrawScroll(&info);
+   Vdp2DrawScroll(&info, layer);
 }
 
 //////////////////////////////////////////////////////////////////////////////
@@ -1572,7 +1597,7 @@ static void LoadLineParamsRBG0(vdp2draw_struct * info, int line)
 
 //////////////////////////////////////////////////////////////////////////////
 
-static void Vdp2DrawRBG0(void)
+static void Vdp2DrawRBG0(TitanLayer *layer)
 {
    vdp2draw_struct info;
    vdp2rotationparameterfp_struct parameter[2];
@@ -1676,7 +1701,7 @@ static void Vdp2DrawRBG0(void)
 
    info.LoadLineParams = (void (*)(void *, int)) LoadLineParamsRBG0;
 
-   Vdp2DrawRotationFP(&info, parameter);
+   Vdp2DrawRotationFP(&info, parameter, layer);
 }
 
 //////////////////////////////////////////////////////////////////////////////
@@ -1694,9 +1719,15 @@ static void LoadLineParamsSprite(vdp2draw_struct * info, int line)
 
 int VIDSoftInit(void)
 {
+   int i, j;
+
    if (TitanInit() == -1)
       return -1;
 
+   for (i = 0; i < 16; i++)
+      for (j = 0; j < 1024; j++)
+         mosaic_table[i][j] = j / (i + 1) * (i + 1);
+
    if ((dispbuffer = (pixel_t *)memalign(8, sizeof(pixel_t) * 704 * 512)) == NULL)
       return -1;
 
@@ -2819,6 +2850,156 @@ int VIDSoftVdp2Reset(void)
 
 //////////////////////////////////////////////////////////////////////////////
 
+static void LayerPoolWork(void)
+{
+   pthread_mutex_lock(&layerpool.mutex);
+   while (layerpool.next < layerpool.count)
+   {
+      void (*func)(int) = layerpool.func;
+      int i = layerpool.next++;
+
+      pthread_mutex_unlock(&layerpool.mutex);
+      func(i);
+      pthread_mutex_lock(&layerpool.mutex);
+      if (--layerpool.remaining == 0)
+         pthread_cond_signal(&layerpool.done);
+   }
+   pthread_mutex_unlock(&layerpool.mutex);
+}
+
+//////////////////////////////////////////////////////////////////////////////
+
+static void *LayerPoolThread(UNUSED void *arg)
+{
+   int generation;
+
+   pthread_mutex_lock(&layerpool.mutex);
+   generation = layerpool.generation;
+   for (;;)
+   {
+      while (layerpool.generation == generation && !layerpool.quit)
+         pthread_cond_wait(&layerpool.start, &layerpool.mutex);
+      if (layerpool.quit)
+         break;
+      generation = layerpool.generation;
+      pthread_mutex_unlock(&layerpool.mutex);
+      LayerPoolWork();
+      pthread_mutex_lock(&layerpool.mutex);
+   }
+   pthread_mutex_unlock(&layerpool.mutex);
+   return NULL;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+
+// Runs func(0) to func(count - 1) on the pool and the calling thread, returns
+// once they've all finished
+static void LayerPoolRun(void (*func)(int), int count)
+{
+   pthread_mutex_lock(&layerpool.mutex);
+   layerpool.func = func;
+   layerpool.next = 0;
+   layerpool.count = count;
+   layerpool.remaining = count;
+   layerpool.generation++;
+   pthread_cond_broadcast(&layerpool.start);
+   pthread_mutex_unlock(&layerpool.mutex);
+
+   LayerPoolWork();
+
+   pthread_mutex_lock(&layerpool.mutex);
+   while (layerpool.remaining)
+      pthread_cond_wait(&layerpool.done, &layerpool.mutex);
+   pthread_mutex_unlock(&layerpool.mutex);
+}
+
+//////////////////////////////////////////////////////////////////////////////
+
+static void LayerPoolStop(void)
+{
+   int i;
+
+   pthread_mutex_lock(&layerpool.mutex);
+   layerpool.quit = 1;
+   pthread_cond_broadcast(&layerpool.start);
+   pthread_mutex_unlock(&layerpool.mutex);
+   for (i = 0; i < layerpool.numthreads - 1; i++)
+      pthread_join(layerpool.thread[i], NULL);
+   layerpool.quit = 0;
+
+   for (i = 0; i < 5; i++)
+      TitanLayerDeInit(&layerbuffer[i]);
+   layerpool.numthreads = 1;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+
+void VIDSoftSetNumLayerThreads(int num)
+{
+   int i;
+
+   if (num < 1)
+      num = 1;
+   else if (num > VIDSOFT_MAX_LAYER_THREADS)
+      num = VIDSOFT_MAX_LAYER_THREADS;
+   if (num == layerpool.numthreads)
+      return;
+
+   if (layerpool.numthreads > 1)
+      LayerPoolStop();
+   if (num == 1)
+      return;
+
+   for (i = 0; i < 5; i++)
+   {
+      if (TitanLayerInit(&layerbuffer[i]) == -1)
+      {
+         LayerPoolStop();
+         return;
+      }
+   }
+   for (i = 0; i < num - 1; i++)
+   {
+      if (pthread_create(&layerpool.thread[i], NULL, LayerPoolThread, NULL) != 0)
+      {
+         layerpool.numthreads = i + 1;
+         LayerPoolStop();
+         return;
+      }
+   }
+   layerpool.numthreads = num;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+
+static void DrawLayerTask(int i)
+{
+   layerdraw[i](&layerbuffer[i]);
+}
+
+//////////////////////////////////////////////////////////////////////////////
+
+static void MergeLayersTask(int band)
+{
+   int start = vdp2height * band / layerpool.numthreads;
+   int end = vdp2height * (band + 1) / layerpool.numthreads;
+   int i, j;
+
+   for (j = start; j < end; j++)
+      for (i = 0; i < numlayers; i++)
+         TitanLayerMergeLine(&layerbuffer[i], j);
+}
+
+//////////////////////////////////////////////////////////////////////////////
+
+static void RenderTask(int band)
+{
+   TitanRenderLines(dispbuffer, vdp2height * band / layerpool.numthreads,
+                    vdp2height * (band + 1) / layerpool.numthreads);
+}
+
+//////////////////////////////////////////////////////////////////////////////
+
 void VIDSoftVdp2DrawStart(void)
 {
    int titanblendmode = TITAN_BLEND_TOP;
@@ -3075,7 +3256,10 @@ void VIDSoftVdp2DrawEnd(void)
          }
       }
    }
-   TitanRender(dispbuffer);
+   if (layerpool.numthreads > 1)
+      LayerPoolRun(RenderTask, layerpool.numthreads);
+   else
+      TitanRender(dispbuffer);
 
    VIDSoftVdp1SwapFrameBuffer();
 
@@ -3112,18 +3296,30 @@ void VIDSoftVdp2DrawScreens(void)
    VIDSoftVdp2SetPriorityNBG3((Vdp2Regs->PRINB >> 8) & 0x7);
    VIDSoftVdp2SetPriorityRBG0(Vdp2Regs->PRIR & 0x7);
 
+   numlayers = 0;
    for (i = 7; i > 0; i--)
    {   
       if (nbg3priority == i)
-         Vdp2DrawNBG3();
+         layerdraw[numlayers++] = Vdp2DrawNBG3;
       if (nbg2priority == i)
-         Vdp2DrawNBG2();
+         layerdraw[numlayers++] = Vdp2DrawNBG2;
       if (nbg1priority == i)
-         Vdp2DrawNBG1();
+         layerdraw[numlayers++] = Vdp2DrawNBG1;
       if (nbg0priority == i)
-         Vdp2DrawNBG0();
+         layerdraw[numlayers++] = Vdp2DrawNBG0;
       if (rbg0priority == i)
-         Vdp2DrawRBG0();
+         layerdraw[numlayers++] = Vdp2DrawRBG0;
+   }
+
+   if (layerpool.numthreads > 1)
+   {
+      LayerPoolRun(DrawLayerTask, numlayers);
+      LayerPoolRun(MergeLayersTask, layerpool.numthreads);
+   }
+   else
+   {
+      for (i = 0; i < numlayers; i++)
+         layerdraw[i](NULL);
    }
 }
 
@@ -3140,19 +3336,19 @@ void VIDSoftVdp2DrawScreen(int screen)
    switch(screen)
    {
       case 0:
-         Vdp2DrawNBG0();
+         Vdp2DrawNBG0(NULL);
          break;
       case 1:
-         Vdp2DrawNBG1();
+         Vdp2DrawNBG1(NULL);
          break;
       case 2:
-         Vdp2DrawNBG2();
+         Vdp2DrawNBG2(NULL);
          break;
       case 3:
-         Vdp2DrawNBG3();
+         Vdp2DrawNBG3(NULL);
          break;
       case 4:
-         Vdp2DrawRBG0();
+         Vdp2DrawRBG0(NULL);
          break;
    }
 }
@@ -30,4 +30,7 @@ extern VideoInterface_struct VIDSoft;
 
 void VIDSoftVdp2DrawScreen(int screen);
 
+// Draws the VDP2 screens on num threads, including the emulation thread
+void VIDSoftSetNumLayerThreads(int num);
+
 #endif
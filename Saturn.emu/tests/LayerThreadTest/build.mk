@@ -0,0 +1,31 @@
+ifndef inc_main
+inc_main := 1
+
+ccNoStrictAliasing := 1
+
+include $(IMAGINE_PATH)/make/imagineAppBase.mk
+
+VPATH += $(projectPath)/../../src
+
+CPPFLAGS += -I$(projectPath)/../../src \
+-DHAVE_SYS_TIME_H=1 \
+-DHAVE_GETTIMEOFDAY=1 \
+-DHAVE_STDINT_H=1 \
+-DVERSION=\"0.9.10\" \
+-DHAVE_STRCASECMP=1 \
+-DHAVE_Q68=1
+
+include $(projectPath)/../../yabauseSrc.mk
+
+SRC += main/main.cc \
+$(addprefix yabause/,$(yabauseSrc))
+
+include $(IMAGINE_PATH)/make/package/imagine.mk
+
+ifndef target
+target := LayerThreadTest
+endif
+
+include $(IMAGINE_PATH)/make/imagineAppTarget.mk
+
+endif
@@ -0,0 +1,7 @@
+metadata_name = Layer Thread Test
+metadata_pkgName = LayerThreadTest
+metadata_exec = layerthreadtest
+metadata_id = com.explusalpha.$(metadata_pkgName)
+metadata_vendor = Robert Broglia
+metadata_version = 1.0.0
+metadata_noIcon = 1
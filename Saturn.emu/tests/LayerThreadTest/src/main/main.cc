@@ -0,0 +1,211 @@
+/*  This file is part of Saturn.emu.
+
+	Saturn.emu is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	Saturn.emu is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with Saturn.emu.  If not, see <http://www.gnu.org/licenses/> */
+
+#define LOGTAG "main"
+#include <imagine/base/Base.hh>
+#include <imagine/logger/logger.h>
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+extern "C"
+{
+	#include <yabause/yabause.h>
+	#include <yabause/sh2core.h>
+	#include <yabause/peripheral.h>
+	#include <yabause/cdbase.h>
+	#include <yabause/scsp.h>
+	#include <yabause/m68kcore.h>
+	#include <yabause/vdp1.h>
+	#include <yabause/vdp2.h>
+	#include <yabause/vidsoft.h>
+
+	extern u8 *vdp1framebuffer[2];
+}
+
+// Fills VDP2 registers, VRAM, color RAM and the VDP1 framebuffer with random data, draws
+// a frame with the serial VDP2 renderer, then with 2-4 layer threads, and checks the
+// output matches pixel for pixel. Per line register copies randomly change the line
+// color and color offset settings. Then reports frames per second of the VDP2 pass for
+// 1-4 threads on random registers and on a typical 2D setup of 4 tiled scroll screens.
+// Returns non-zero if any frame mismatches.
+// Usage: layerthreadtest [--seeds N] [--frames N]
+
+CLINK SH2Interface_struct *SH2CoreList[]{nullptr};
+CLINK PerInterface_struct *PERCoreList[]{nullptr};
+CLINK CDInterface *CDCoreList[]{nullptr};
+CLINK SoundInterface_struct *SNDCoreList[]{nullptr};
+CLINK VideoInterface_struct *VIDCoreList[]{&VIDSoft, nullptr};
+CLINK M68K_struct *M68KCoreList[]{nullptr};
+CLINK void DisplayMessage(const char* str) {}
+CLINK int OSDInit(int coreid) { return 0; }
+CLINK void OSDPushMessage(int msgtype, int ttl, const char * message, ...) {}
+CLINK int OSDDisplayMessages(pixel_t *buffer, int w, int h) { return 0; }
+CLINK void YuiSwapBuffers() {}
+CLINK void YuiSetVideoAttribute(int type, int val) {}
+CLINK int YuiSetVideoMode(int width, int height, int bpp, int fullscreen) { return 0; }
+CLINK void YuiErrorMsg(const char *string) { fprintf(stderr, "%s\n", string); }
+CLINK int OSDUseBuffer() { return 0; }
+CLINK int OSDChangeCore(int coreid) { return 0; }
+
+enum class Setup { RANDOM, SCROLL_2D };
+
+static uint64_t rngState;
+
+static uint32_t rng()
+{
+	// xorshift64
+	rngState ^= rngState << 13;
+	rngState ^= rngState >> 7;
+	rngState ^= rngState << 17;
+	return rngState;
+}
+
+static void setupVDP(unsigned seed, Setup setup)
+{
+	rngState = seed * 0x9E3779B97F4A7C15ull + 1;
+	for(unsigned i = 0; i < 0x80000; i++)
+		Vdp2Ram[i] = rng();
+	for(unsigned i = 0; i < 0x1000; i++)
+		Vdp2ColorRam[i] = rng();
+	for(unsigned i = 0; i < 0x40000; i++)
+		vdp1framebuffer[0][i] = vdp1framebuffer[1][i] = (rng() & 3) ? 0 : rng();
+	auto regs = (u16*)Vdp2Regs;
+	for(unsigned i = 0; i < sizeof(Vdp2) / 2; i++)
+		regs[i] = rng();
+	Vdp2Internal.ColorMode = rng() % 3;
+	Vdp1Regs->TVMR = 0;
+	if(setup == Setup::RANDOM)
+	{
+		Vdp2Regs->TVMD = 0x8000 | (rng() & 0x1F7);
+	}
+	else
+	{
+		// 320x224, NBG0-3 as tiled scroll screens with distinct priorities
+		Vdp2Regs->TVMD = 0x8000;
+		Vdp2Regs->BGON = 0x000F;
+		Vdp2Regs->CHCTLA = 0x1010;
+		Vdp2Regs->CHCTLB = 0x0011;
+		Vdp2Regs->PRINA = 0x0304;
+		Vdp2Regs->PRINB = 0x0102;
+		Vdp2Regs->SCRCTL = 0;
+		Vdp2Regs->MZCTL = 0;
+		Vdp2Regs->WCTLA = Vdp2Regs->WCTLB = Vdp2Regs->WCTLC = Vdp2Regs->WCTLD = 0;
+		Vdp2Regs->LNCLEN = 0;
+		Vdp2Regs->CCCTL = 0x0003;
+		Vdp2Regs->SFCCMD = 0;
+		Vdp2Regs->SFPRMD = 0;
+		Vdp2Regs->ZMXN0.all = Vdp2Regs->ZMYN0.all = Vdp2Regs->ZMXN1.all = Vdp2Regs->ZMYN1.all = 0x10000;
+	}
+	for(unsigned i = 0; i < 270; i++)
+	{
+		*Vdp2RestoreRegs(i) = *Vdp2Regs;
+		if(setup == Setup::RANDOM && !(rng() & 7))
+		{
+			Vdp2RestoreRegs(i)->CLOFEN = rng();
+			Vdp2RestoreRegs(i)->COAR = rng();
+		}
+	}
+}
+
+static void drawFrame()
+{
+	VIDSoft.Vdp2DrawStart();
+	VIDSoft.Vdp2DrawScreens();
+	VIDSoft.Vdp2DrawEnd();
+}
+
+static std::vector<pixel_t> renderSeed(unsigned seed, int threads)
+{
+	VIDSoftSetNumLayerThreads(threads);
+	memset(dispbuffer, 0, 704 * 512 * sizeof(pixel_t));
+	// the first frame leaves state from the previous seed behind, like the
+	// previous line's mosaic and window data, so only the second is compared
+	setupVDP(seed, Setup::RANDOM);
+	drawFrame();
+	setupVDP(seed, Setup::RANDOM);
+	drawFrame();
+	int width, height;
+	VIDSoft.GetGlSize(&width, &height);
+	return {dispbuffer, dispbuffer + width * height};
+}
+
+static double measureFPS(Setup setup, int threads, unsigned frames)
+{
+	VIDSoftSetNumLayerThreads(threads);
+	setupVDP(1234, setup);
+	drawFrame();
+	auto start = std::chrono::steady_clock::now();
+	for(unsigned i = 0; i < frames; i++)
+	{
+		drawFrame();
+	}
+	std::chrono::duration<double> time = std::chrono::steady_clock::now() - start;
+	return frames / time.count();
+}
+
+namespace Base
+{
+
+int runHeadless(int argc, char** argv)
+{
+	unsigned seeds = 200, frames = 100;
+	for(int i = 1; i < argc; i++)
+	{
+		if(!strcmp(argv[i], "--seeds") && i + 1 < argc)
+			seeds = strtoul(argv[++i], nullptr, 10);
+		else if(!strcmp(argv[i], "--frames") && i + 1 < argc)
+			frames = std::max(strtoul(argv[++i], nullptr, 10), 1ul);
+	}
+	Vdp1Init();
+	Vdp2Init();
+	VIDCore = &VIDSoft;
+	VIDSoft.Init();
+	Vdp1External.disptoggle = 1;
+	Vdp2External.disptoggle = 0xFF;
+	unsigned mismatches = 0;
+	for(unsigned seed = 0; seed < seeds; seed++)
+	{
+		auto serial = renderSeed(seed, 1);
+		for(int threads = 2; threads <= 4; threads++)
+		{
+			auto threaded = renderSeed(seed, threads);
+			if(threaded != serial)
+			{
+				auto diff = std::mismatch(serial.begin(), serial.end(), threaded.begin(), threaded.end());
+				printf("seed %u with %d threads differs from pixel %zu\n", seed, threads, diff.first - serial.begin());
+				mismatches++;
+			}
+		}
+	}
+	printf("%u register sets, %u mismatches\n", seeds, mismatches);
+	for(auto [setup, name] : {std::pair{Setup::SCROLL_2D, "4 scroll screens 320x224"}, {Setup::RANDOM, "random registers"}})
+	{
+		for(int threads = 1; threads <= 4; threads++)
+		{
+			printf("%s, %d threads: %.1f fps\n", name, threads, measureFPS(setup, threads, frames));
+		}
+	}
+	VIDSoftSetNumLayerThreads(1);
+	printf("%s\n", mismatches ? "LAYER THREAD MISMATCH" : "threaded layers match serial");
+	return mismatches ? 1 : 0;
+}
+
+void onInit(int argc, char** argv) {}
+
+}
@@ -0,0 +1,37 @@
+# Yabause core sources without the SH2 dynarec, relative to src/yabause
+yabauseSrc := bios.c \
+cdbase.c \
+cheat.c \
+coffelf.c \
+cs0.c \
+cs1.c \
+cs2.c \
+debug.c \
+error.c \
+memory.c \
+m68kcore.c \
+m68kd.c \
+movie.c \
+netlink.c \
+peripheral.c \
+profile.c \
+scu.c \
+sh2core.c \
+sh2d.c \
+sh2idle.c \
+sh2int.c \
+sh2trace.c \
+smpc.c \
+snddummy.c \
+titan/titan.c \
+vdp1.c \
+vdp2.c \
+vdp2debug.c \
+vidshared.c \
+vidsoft.c \
+yabause.c \
+scsp.c \
+japmodem.c \
+q68/q68.c \
+q68/q68-core.c \
+m68kq68.c
@@ -18,56 +18,7 @@ CPPFLAGS += \
 
 CXXFLAGS_WARN += -Wno-register
 
-snes9xSrc := \
-bsx.cpp \
-bml.cpp \
-c4.cpp \
-c4emu.cpp \
-cheats.cpp \
-cheats2.cpp \
-clip.cpp \
-controls.cpp \
-cpu.cpp \
-cpuexec.cpp \
-cpuops.cpp \
-dma.cpp \
-dsp.cpp \
-dsp1.cpp \
-dsp2.cpp \
-dsp3.cpp \
-dsp4.cpp \
-fxemu.cpp \
-fxinst.cpp \
-gfx.cpp \
-globals.cpp \
-loadzip.cpp \
-memmap.cpp \
-msu1.cpp \
-movie.cpp \
-obc1.cpp \
-ppu.cpp \
-stream.cpp \
-sa1.cpp \
-sa1cpu.cpp \
-sdd1.cpp \
-sdd1emu.cpp \
-seta.cpp \
-seta010.cpp \
-seta011.cpp \
-seta018.cpp \
-sha256.cpp \
-snapshot.cpp \
-spc7110.cpp \
-srtc.cpp \
-tile.cpp \
-tileimpl-h2x1.cpp \
-tileimpl-n1x1.cpp \
-tileimpl-n2x1.cpp \
-apu/apu.cpp \
-apu/bapu/dsp/sdsp.cpp \
-apu/bapu/smp/smp.cpp \
-apu/bapu/smp/smp_state.cpp
-# conffile.cpp crosshairs.cpp logger.cpp screenshot.cpp snes9x.cpp
+include $(projectPath)/snes9xSrc.mk
 
 SRC += \
 main/Main.cc \
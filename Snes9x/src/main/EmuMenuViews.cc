@@ -2,6 +2,7 @@
 #include <apu/apu.h>
 #include <apu/bapu/snes/snes.hpp>
 #include <ppu.h>
+#include <gfx.h>
 #endif
 #include <emuframework/EmuApp.hh>
 #include <emuframework/OptionView.hh>
@@ -45,6 +46,27 @@ public:
 		item.emplace_back(&dspInterpolation);
 	}
 };
+
+class CustomVideoOptionView : public VideoOptionView
+{
+	BoolMenuItem threadedRendering
+	{
+		"Threaded Rendering",
+		(bool)optionThreadedRendering,
+		[this](BoolMenuItem &item, View &, Input::Event e)
+		{
+			optionThreadedRendering = item.flipBoolValue(*this);
+			S9xSetThreadedRendering(optionThreadedRendering);
+		}
+	};
+
+public:
+	CustomVideoOptionView(ViewAttachParams attach): VideoOptionView{attach, true}
+	{
+		loadStockItems();
+		item.emplace_back(&threadedRendering);
+	}
+};
 #endif
 
 class ConsoleOptionView : public TableView
@@ -252,6 +274,7 @@ std::unique_ptr<View> EmuApp::makeCustomView(ViewAttachParams attach, ViewID id)
 	switch(id)
 	{
 		#ifndef SNES9X_VERSION_1_4
+		case ViewID::VIDEO_OPTIONS: return std::make_unique<CustomVideoOptionView>(attach);
 		case ViewID::AUDIO_OPTIONS: return std::make_unique<CustomAudioOptionView>(attach);
 		#endif
 		case ViewID::SYSTEM_ACTIONS: return std::make_unique<CustomSystemActionsView>(attach);
@@ -28,6 +28,11 @@ static uint heightChangeFrames = heightChangeFrameDelay;
 bool EmuSystem::hasCheats = true;
 bool EmuSystem::hasPALVideoSystem = true;
 bool EmuSystem::hasResetModes = true;
+#ifndef SNES9X_VERSION_1_4 // 1.43 has no in-memory states
+bool EmuSystem::hasRunAhead = true;
+bool EmuSystem::hasRewind = true;
+bool EmuSystem::hasMemoryStates = true;
+#endif
 
 EmuSystem::NameFilterFunc EmuSystem::defaultFsFilter =
 	[](const char *name)
@@ -142,6 +147,32 @@ EmuSystem::Error EmuSystem::loadState(const char *path)
 		return EmuSystem::makeFileReadError();
 }
 
+#ifndef SNES9X_VERSION_1_4
+static uint32 freezeSize{};
+
+EmuSystem::Error EmuSystem::saveState(IG::ByteBuffer &buff)
+{
+	if(!freezeSize)
+		freezeSize = S9xFreezeSize(); // fixed for the lifetime of the loaded game
+	buff.resize(freezeSize);
+	if(!S9xFreezeGameMem(buff.data(), buff.size()))
+		return EmuSystem::makeFileWriteError();
+	else
+		return {};
+}
+
+EmuSystem::Error EmuSystem::loadState(IG::ConstBufferView buff)
+{
+	if(S9xUnfreezeGameMem((const uint8*)buff.data(), buff.size()) == SUCCESS)
+	{
+		IPPU.RenderThisFrame = TRUE;
+		return {};
+	}
+	else
+		return EmuSystem::makeFileReadError();
+}
+#endif
+
 void EmuSystem::saveBackupMem() // for manually saving when not closing game
 {
 	if(gameIsRunning())
@@ -169,6 +200,9 @@ void S9xAutoSaveSRAM (void)
 void EmuSystem::closeSystem()
 {
 	saveBackupMem();
+	#ifndef SNES9X_VERSION_1_4
+	freezeSize = 0;
+	#endif
 }
 
 bool EmuSystem::vidSysIsPAL() { return Settings.PAL; }
@@ -285,6 +319,29 @@ void EmuSystem::runFrame(EmuSystemTask *task, EmuVideo *video, EmuAudio *audio)
 	#endif
 }
 
+void EmuSystem::writeFrameTrace(IO &io)
+{
+	// VRAM traffic for TileDecodeBench, each frame is a 16-bit count of changed
+	// 16 byte blocks (one 2bpp tile) followed by their 16-bit index & contents
+	static uint8 lastVRAM[0x10000];
+	uint16 changed = 0;
+	iterateTimes(0x1000, i)
+	{
+		if(memcmp(&Memory.VRAM[i * 16], &lastVRAM[i * 16], 16))
+			changed++;
+	}
+	io.write(&changed, sizeof(changed));
+	iterateTimes(0x1000, i)
+	{
+		if(!memcmp(&Memory.VRAM[i * 16], &lastVRAM[i * 16], 16))
+			continue;
+		uint16 block = i;
+		io.write(&block, sizeof(block));
+		io.write(&Memory.VRAM[i * 16], 16);
+		memcpy(&lastVRAM[i * 16], &Memory.VRAM[i * 16], 16);
+	}
+}
+
 void EmuApp::onCustomizeNavView(EmuApp::NavView &view)
 {
 	const Gfx::LGradientStopDesc navViewGrad[] =
@@ -25,6 +25,7 @@ extern Byte1Option optionBlockInvalidVRAMAccess;
 extern Byte1Option optionSeparateEchoBuffer;
 extern Byte1Option optionSuperFXClockMultiplier;
 extern Byte1Option optionAudioDSPInterpolation;
+extern Byte1Option optionThreadedRendering;
 #endif
 extern int snesInputPort;
 extern uint doubleClickFrames, rightClickFrames;
@@ -3,6 +3,7 @@
 #include <apu/bapu/snes/snes.hpp>
 #include <ppu.h>
 #include <fxemu.h>
+#include <gfx.h>
 #endif
 #include <emuframework/EmuApp.hh>
 #include "internal.hh"
@@ -13,7 +14,7 @@ enum
 	CFGKEY_MULTITAP = 276, CFGKEY_BLOCK_INVALID_VRAM_ACCESS = 277,
 	CFGKEY_VIDEO_SYSTEM = 278, CFGKEY_INPUT_PORT = 279,
 	CFGKEY_AUDIO_DSP_INTERPOLATON = 280, CFGKEY_SEPARATE_ECHO_BUFFER = 281,
-	CFGKEY_SUPERFX_CLOCK_MULTIPLIER = 282
+	CFGKEY_SUPERFX_CLOCK_MULTIPLIER = 282, CFGKEY_THREADED_RENDERING = 283
 };
 
 #ifdef SNES9X_VERSION_1_4
@@ -32,6 +33,7 @@ Byte1Option optionBlockInvalidVRAMAccess{CFGKEY_BLOCK_INVALID_VRAM_ACCESS, 1};
 Byte1Option optionSeparateEchoBuffer{CFGKEY_SEPARATE_ECHO_BUFFER, 0};
 Byte1Option optionSuperFXClockMultiplier{CFGKEY_SUPERFX_CLOCK_MULTIPLIER, 100, false, optionIsValidWithMinMax<5, 250>};
 Byte1Option optionAudioDSPInterpolation{CFGKEY_AUDIO_DSP_INTERPOLATON, DSP_INTERPOLATION_GAUSSIAN, false, optionIsValidWithMax<4>};
+Byte1Option optionThreadedRendering{CFGKEY_THREADED_RENDERING, 0};
 #endif
 const AspectRatioInfo EmuSystem::aspectRatioInfo[] =
 {
@@ -68,6 +70,7 @@ EmuSystem::Error EmuSystem::onOptionsLoaded()
 {
 	#ifndef SNES9X_VERSION_1_4
 	SNES::dsp.spc_dsp.interpolation = optionAudioDSPInterpolation;
+	S9xSetThreadedRendering(optionThreadedRendering);
 	#endif
 	return {};
 }
@@ -79,6 +82,7 @@ bool EmuSystem::readConfig(IO &io, uint key, uint readSize)
 		default: return false;
 		#ifndef SNES9X_VERSION_1_4
 		bcase CFGKEY_AUDIO_DSP_INTERPOLATON: optionAudioDSPInterpolation.readFromIO(io, readSize);
+		bcase CFGKEY_THREADED_RENDERING: optionThreadedRendering.readFromIO(io, readSize);
 		#endif
 	}
 	return true;
@@ -88,6 +92,7 @@ void EmuSystem::writeConfig(IO &io)
 {
 	#ifndef SNES9X_VERSION_1_4
 	optionAudioDSPInterpolation.writeWithKeyIfNotDefault(io);
+	optionThreadedRendering.writeWithKeyIfNotDefault(io);
 	#endif
 }
 
@@ -14,6 +14,11 @@
 #include "screenshot.h"
 #include "font.h"
 #include "display.h"
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <algorithm>
 
 extern struct SCheatData		Cheat;
 
@@ -23,6 +28,8 @@ static int	font_width = 8, font_height = 9;
 void (*S9xCustomDisplayString) (const char *, int, int, bool, int) = NULL;
 
 static void SetupOBJ (void);
+static void RenderLines (uint32, uint32);
+static void QueueRenderThread (void);
 static void DrawOBJS (int);
 static void DisplayTime (void);
 static void DisplayFrameRate (void);
@@ -39,6 +46,130 @@ static inline void RenderScreen (bool8);
 static uint16 get_crosshair_color (uint8);
 static void S9xDisplayStringType (const char *, int, int, bool, int);
 
+// Threaded rendering: RenderLine() passes the lines finished so far to a worker thread
+// while the CPU keeps running, so most of the frame is drawn by the time it ends.
+// Lines [IPPU.PreviousLine, IPPU.RenderedLine) are drawn early with the same state
+// S9xUpdateScreen() would have used, since register writes that change it either flush
+// (which waits for the worker first) or call S9xInvalidateRenderedLines().
+#define RENDER_THREAD_MIN_LINES	16
+
+static struct SRenderThread
+{
+	std::thread				thread;
+	std::mutex				mutex;
+	std::condition_variable	cond;
+	std::atomic<bool>		busy{false};
+	bool					quit = false;
+	uint32					StartY = 0;
+	uint32					EndY = 0;
+
+	~SRenderThread () { S9xSetThreadedRendering(FALSE); }
+}	RenderThread;
+
+// GFX.EndY of the last flush, the worker's batches also set GFX.EndY
+static uint32	FlushEndY = 0;
+
+// Set when lines drawn ahead were thrown away, nothing more is drawn ahead until the
+// next flush since the write that invalidated them usually repeats every few lines
+static bool8	DrawAheadInvalidated = FALSE;
+
+static void RenderThreadMain (void)
+{
+	std::unique_lock<std::mutex> lock(RenderThread.mutex);
+
+	for (;;)
+	{
+		RenderThread.cond.wait(lock, [] { return RenderThread.busy || RenderThread.quit; });
+		if (RenderThread.quit)
+			return;
+
+		lock.unlock();
+
+		if (IPPU.OBJChanged || IPPU.InterlaceOBJ)
+			SetupOBJ();
+
+		RenderLines(RenderThread.StartY, RenderThread.EndY);
+
+		lock.lock();
+		RenderThread.busy = false;
+		RenderThread.cond.notify_all();
+	}
+}
+
+void S9xSetThreadedRendering (bool8 on)
+{
+	if (!on == !RenderThread.thread.joinable())
+		return;
+
+	if (on)
+	{
+		RenderThread.quit = false;
+		RenderThread.thread = std::thread(RenderThreadMain);
+	}
+	else
+	{
+		S9xWaitForRenderThread();
+		{
+			std::lock_guard<std::mutex> lock(RenderThread.mutex);
+			RenderThread.quit = true;
+		}
+		RenderThread.cond.notify_all();
+		RenderThread.thread.join();
+	}
+}
+
+void S9xWaitForRenderThread (void)
+{
+	if (!RenderThread.busy)
+		return;
+
+	std::unique_lock<std::mutex> lock(RenderThread.mutex);
+	RenderThread.cond.wait(lock, [] { return !RenderThread.busy; });
+}
+
+void S9xInvalidateRenderedLines (void)
+{
+	// Lines drawn ahead used state that inline rendering would only see after this
+	// write, clear their depth so the next flush draws them again from the backdrop
+	S9xWaitForRenderThread();
+
+	uint32	offset = IPPU.PreviousLine * GFX.PPL;
+	uint32	size = (IPPU.RenderedLine - IPPU.PreviousLine) * GFX.PPL;
+	memset(GFX.ZBuffer + offset, 0, size);
+	memset(GFX.SubZBuffer + offset, 0, size);
+
+	IPPU.RenderedLine = 0;
+	DrawAheadInvalidated = TRUE;
+}
+
+static void QueueRenderThread (void)
+{
+	int	startY = std::max(IPPU.PreviousLine, IPPU.RenderedLine);
+
+	if (IPPU.CurrentLine - startY < RENDER_THREAD_MIN_LINES || RenderThread.busy || DrawAheadInvalidated)
+		return;
+
+	// Mosaic blocks are aligned to the first line of each batch and interlaced fields
+	// draw over the previous one's depth buffer, so those are only drawn on a flush
+	if (GFX.DoInterlace || (PPU.Mosaic > 1 && (PPU.BGMosaic[0] || PPU.BGMosaic[1] || PPU.BGMosaic[2] || PPU.BGMosaic[3])))
+		return;
+
+	int	endY = std::min(IPPU.CurrentLine - 1, PPU.ScreenHeight - 1);
+	if (startY > endY)
+		return;
+
+	IPPU.RenderedLine = endY + 1;
+
+	{
+		std::lock_guard<std::mutex> lock(RenderThread.mutex);
+		RenderThread.StartY = startY;
+		RenderThread.EndY = endY;
+		RenderThread.busy = true;
+	}
+
+	RenderThread.cond.notify_all();
+}
+
 #define TILE_PLUS(t, x)	(((t) & 0xfc00) | ((t + x) & 0x3ff))
 
 
@@ -181,6 +312,8 @@ void S9xStartScreenRefresh (void)
 		PPU.MosaicStart = 0;
 		PPU.RecomputeClipWindows = TRUE;
 		IPPU.PreviousLine = IPPU.CurrentLine = 0;
+		IPPU.RenderedLine = 0;
+		DrawAheadInvalidated = FALSE;
 	}
 
 	if (++IPPU.FrameCount % Memory.ROMFramesPerSecond == 0)
@@ -298,6 +431,9 @@ void RenderLine (uint8 C)
 		}
 
 		IPPU.CurrentLine = C + 1;
+
+		if (RenderThread.thread.joinable())
+			QueueRenderThread();
 	}
 	else
 	{
@@ -439,15 +575,32 @@ static inline void RenderScreen (bool8 sub)
 
 void S9xUpdateScreen (void)
 {
+	S9xWaitForRenderThread();
+
 	if (IPPU.OBJChanged || IPPU.InterlaceOBJ)
 		SetupOBJ();
 
 	// XXX: Check ForceBlank? Or anything else?
-	PPU.RangeTimeOver |= GFX.OBJLines[GFX.EndY].RTOFlags;
+	PPU.RangeTimeOver |= GFX.OBJLines[FlushEndY].RTOFlags;
+
+	// skip any lines the render thread already drew
+	uint32	startY = std::max(IPPU.PreviousLine, IPPU.RenderedLine);
+	uint32	endY = IPPU.CurrentLine - 1;
+	if (endY >= PPU.ScreenHeight)
+		endY = PPU.ScreenHeight - 1;
 
-	GFX.StartY = IPPU.PreviousLine;
-	if ((GFX.EndY = IPPU.CurrentLine - 1) >= PPU.ScreenHeight)
-		GFX.EndY = PPU.ScreenHeight - 1;
+	FlushEndY = endY;
+	RenderLines(startY, endY);
+
+	IPPU.PreviousLine = IPPU.CurrentLine;
+	IPPU.RenderedLine = 0;
+	DrawAheadInvalidated = FALSE;
+}
+
+static void RenderLines (uint32 startY, uint32 endY)
+{
+	GFX.StartY = startY;
+	GFX.EndY = endY;
 
 	if (!PPU.ForcedBlanking)
 	{
@@ -534,8 +687,6 @@ void S9xUpdateScreen (void)
 			for (int x = 0; x < IPPU.RenderedScreenWidth; x++)
 				GFX.S[x] = black;
 	}
-
-	IPPU.PreviousLine = IPPU.CurrentLine;
 }
 
 static void SetupOBJ (void)
@@ -210,6 +210,8 @@ void S9xDisplayChar (uint16 *, uint8);
 void S9xGraphicsScreenResize (void);
 // called automatically unless Settings.AutoDisplayMessages is false
 void S9xDisplayMessages (uint16 *, int, int, int, int);
+// draw lines on a worker thread while emulation continues, output is the same either way
+void S9xSetThreadedRendering (bool8);
 
 // external port interface which must be implemented or initialised for each port
 bool8 S9xGraphicsInit (void);
@@ -894,6 +894,19 @@ static void S9xDeinterleaveGD24 (int size, uint8 *base)
 
 // allocation and deallocation
 
+// Cache line aligned so each tile's 64 bytes are a single line, must be free()able
+static uint8 *AllocTileCache (size_t size)
+{
+#ifdef __WIN32__
+	return (uint8 *) malloc(size);
+#else
+	void	*p;
+	if (posix_memalign(&p, 64, size))
+		return NULL;
+	return (uint8 *) p;
+#endif
+}
+
 bool8 CMemory::Init (void)
 {
     RAM	 = (uint8 *) malloc(0x20000);
@@ -901,13 +914,13 @@ bool8 CMemory::Init (void)
     VRAM = (uint8 *) malloc(0x10000);
     ROM  = (uint8 *) malloc(MAX_ROM_SIZE + 0x200 + 0x8000);
 
-	IPPU.TileCache[TILE_2BIT]       = (uint8 *) malloc(MAX_2BIT_TILES * 64);
-	IPPU.TileCache[TILE_4BIT]       = (uint8 *) malloc(MAX_4BIT_TILES * 64);
-	IPPU.TileCache[TILE_8BIT]       = (uint8 *) malloc(MAX_8BIT_TILES * 64);
-	IPPU.TileCache[TILE_2BIT_EVEN]  = (uint8 *) malloc(MAX_2BIT_TILES * 64);
-	IPPU.TileCache[TILE_2BIT_ODD]   = (uint8 *) malloc(MAX_2BIT_TILES * 64);
-	IPPU.TileCache[TILE_4BIT_EVEN]  = (uint8 *) malloc(MAX_4BIT_TILES * 64);
-	IPPU.TileCache[TILE_4BIT_ODD]   = (uint8 *) malloc(MAX_4BIT_TILES * 64);
+	IPPU.TileCache[TILE_2BIT]       = AllocTileCache(MAX_2BIT_TILES * 64);
+	IPPU.TileCache[TILE_4BIT]       = AllocTileCache(MAX_4BIT_TILES * 64);
+	IPPU.TileCache[TILE_8BIT]       = AllocTileCache(MAX_8BIT_TILES * 64);
+	IPPU.TileCache[TILE_2BIT_EVEN]  = AllocTileCache(MAX_2BIT_TILES * 64);
+	IPPU.TileCache[TILE_2BIT_ODD]   = AllocTileCache(MAX_2BIT_TILES * 64);
+	IPPU.TileCache[TILE_4BIT_EVEN]  = AllocTileCache(MAX_4BIT_TILES * 64);
+	IPPU.TileCache[TILE_4BIT_ODD]   = AllocTileCache(MAX_4BIT_TILES * 64);
 
 	IPPU.TileCached[TILE_2BIT]      = (uint8 *) malloc(MAX_2BIT_TILES);
 	IPPU.TileCached[TILE_4BIT]      = (uint8 *) malloc(MAX_4BIT_TILES);
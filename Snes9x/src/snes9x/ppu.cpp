@@ -251,6 +251,11 @@ void S9xSetPPU (uint8 Byte, uint16 Address)
 	else
 	if (Address <= 0x2183)
 	{
+		// Everything else the renderer reads is changed here, scroll and Mode 7
+		// registers are latched per line by RenderLine() and VRAM writes invalidate
+		if (Address < 0x2134 && !(Address >= 0x210d && Address <= 0x2119) && !(Address >= 0x211b && Address <= 0x2121))
+			S9xWaitForRenderThread();
+
 		switch (Address)
 		{
 			case 0x2100: // INIDISP
@@ -284,6 +289,7 @@ void S9xSetPPU (uint8 Byte, uint16 Address)
 						tmp = (PPU.OAMAddr & 0xfe) >> 1;
 					if ((PPU.OAMFlip & 1) || PPU.FirstSprite != tmp)
 					{
+						INVALIDATE_REDRAW();
 						PPU.FirstSprite = tmp;
 						IPPU.OBJChanged = TRUE;
 					}
@@ -312,6 +318,7 @@ void S9xSetPPU (uint8 Byte, uint16 Address)
 				PPU.SavedOAMAddr = PPU.OAMAddr;
 				if (PPU.OAMPriorityRotation && PPU.FirstSprite != (PPU.OAMAddr >> 1))
 				{
+					INVALIDATE_REDRAW();
 					PPU.FirstSprite = (PPU.OAMAddr & 0xfe) >> 1;
 					IPPU.OBJChanged = TRUE;
 				#ifdef DEBUGGER
@@ -328,6 +335,7 @@ void S9xSetPPU (uint8 Byte, uint16 Address)
 				{
 					if (PPU.FirstSprite != (PPU.OAMAddr >> 1))
 					{
+						INVALIDATE_REDRAW();
 						PPU.FirstSprite = (PPU.OAMAddr & 0xfe) >> 1;
 						IPPU.OBJChanged = TRUE;
 					#ifdef DEBUGGER
@@ -339,6 +347,7 @@ void S9xSetPPU (uint8 Byte, uint16 Address)
 				{
 					if (PPU.FirstSprite != 0)
 					{
+						INVALIDATE_REDRAW();
 						PPU.FirstSprite = 0;
 						IPPU.OBJChanged = TRUE;
 					#ifdef DEBUGGER
@@ -1080,6 +1089,7 @@ uint8 S9xGetPPU (uint16 Address)
 						PPU.OAMAddr = (PPU.OAMAddr + 1) & 0x1ff;
 						if (PPU.OAMPriorityRotation && PPU.FirstSprite != (PPU.OAMAddr >> 1))
 						{
+							INVALIDATE_REDRAW();
 							PPU.FirstSprite = (PPU.OAMAddr & 0xfe) >> 1;
 							IPPU.OBJChanged = TRUE;
 						#ifdef DEBUGGER
@@ -1098,6 +1108,7 @@ uint8 S9xGetPPU (uint16 Address)
 						++PPU.OAMAddr;
 						if (PPU.OAMPriorityRotation && PPU.FirstSprite != (PPU.OAMAddr >> 1))
 						{
+							INVALIDATE_REDRAW();
 							PPU.FirstSprite = (PPU.OAMAddr & 0xfe) >> 1;
 							IPPU.OBJChanged = TRUE;
 						#ifdef DEBUGGER
@@ -1902,6 +1913,7 @@ void S9xSoftResetPPU (void)
 	IPPU.DoubleHeightPixels = FALSE;
 	IPPU.CurrentLine = 0;
 	IPPU.PreviousLine = 0;
+	IPPU.RenderedLine = 0;
 	IPPU.XB = NULL;
 	for (int c = 0; c < 256; c++)
 		IPPU.ScreenColors[c] = c;
@@ -48,6 +48,7 @@ struct InternalPPU
 	bool8	DoubleHeightPixels;
 	int		CurrentLine;
 	int		PreviousLine;
+	int		RenderedLine;
 	const uint8	*XB;
 	uint32	Red[256];
 	uint32	Green[256];
@@ -241,6 +242,16 @@ static inline void FLUSH_REDRAW (void)
 		S9xUpdateScreen();
 }
 
+void S9xWaitForRenderThread (void);
+void S9xInvalidateRenderedLines (void);
+// For writes that affect rendering without flushing first: lines the render
+// thread drew ahead of the last flush must be drawn again with the new state
+static inline void INVALIDATE_REDRAW (void)
+{
+	if (IPPU.RenderedLine > IPPU.PreviousLine)
+		S9xInvalidateRenderedLines();
+}
+
 static inline void S9xUpdateVRAMReadBuffer()
 {
 	if (PPU.VMA.FullGraphicCount)
@@ -369,6 +380,8 @@ static inline void REGISTER_2118 (uint8 Byte)
 	if(CHECK_INBLANK1(PPU, CPU))
 		return;
 
+	INVALIDATE_REDRAW();
+
 	uint32	address;
 
 	if (PPU.VMA.FullGraphicCount)
@@ -407,6 +420,8 @@ static inline void REGISTER_2118_tile (uint8 Byte)
 	if(CHECK_INBLANK1(PPU, CPU))
 		return;
 
+	INVALIDATE_REDRAW();
+
 	uint32 rem = PPU.VMA.Address & PPU.VMA.Mask1;
 	uint32 address = (((PPU.VMA.Address & ~PPU.VMA.Mask1) + (rem >> PPU.VMA.Shift) + ((rem & (PPU.VMA.FullGraphicCount - 1)) << 3)) << 1) & 0xffff;
 
@@ -433,6 +448,8 @@ static inline void REGISTER_2118_linear (uint8 Byte)
 	if(CHECK_INBLANK1(PPU, CPU))
 		return;
 
+	INVALIDATE_REDRAW();
+
 	uint32	address;
 
 	Memory.VRAM[address = (PPU.VMA.Address << 1) & 0xffff] = Byte;
@@ -484,6 +501,8 @@ static inline void REGISTER_2119 (uint8 Byte)
 {
 	if(CHECK_INBLANK2(PPU, CPU))
 		return;
+
+	INVALIDATE_REDRAW();
 	uint32	address;
 
 	if (PPU.VMA.FullGraphicCount)
@@ -522,6 +541,8 @@ static inline void REGISTER_2119_tile (uint8 Byte)
 	if(CHECK_INBLANK2(PPU, CPU))
 		return;
 
+	INVALIDATE_REDRAW();
+
 	uint32 rem = PPU.VMA.Address & PPU.VMA.Mask1;
 	uint32 address = ((((PPU.VMA.Address & ~PPU.VMA.Mask1) + (rem >> PPU.VMA.Shift) + ((rem & (PPU.VMA.FullGraphicCount - 1)) << 3)) << 1) + 1) & 0xffff;
 
@@ -548,6 +569,8 @@ static inline void REGISTER_2119_linear (uint8 Byte)
 	if(CHECK_INBLANK2(PPU, CPU))
 		return;
 
+	INVALIDATE_REDRAW();
+
 	uint32	address;
 
 	Memory.VRAM[address = ((PPU.VMA.Address << 1) + 1) & 0xffff] = Byte;
@@ -5,6 +5,7 @@
 \*****************************************************************************/
 
 #include "tileimpl.h"
+#include "tiledecode.h"
 
 using namespace TileImpl;
 
@@ -26,6 +27,9 @@ namespace {
 
 	uint8 ConvertTile2 (uint8 *pCache, uint32 TileAddr, uint32)
 	{
+	#ifdef S9X_TILE_DECODE_SIMD
+		return (S9xDecodeTile<2>(&Memory.VRAM[TileAddr], pCache) ? TRUE : BLANK_TILE);
+	#else
 		uint8	*tp      = &Memory.VRAM[TileAddr];
 		uint32			*p       = (uint32 *) pCache;
 		uint32			non_zero = 0;
@@ -45,10 +49,14 @@ namespace {
 		}
 
 		return (non_zero ? TRUE : BLANK_TILE);
+	#endif
 	}
 
 	uint8 ConvertTile4 (uint8 *pCache, uint32 TileAddr, uint32)
 	{
+	#ifdef S9X_TILE_DECODE_SIMD
+		return (S9xDecodeTile<4>(&Memory.VRAM[TileAddr], pCache) ? TRUE : BLANK_TILE);
+	#else
 		uint8	*tp      = &Memory.VRAM[TileAddr];
 		uint32			*p       = (uint32 *) pCache;
 		uint32			non_zero = 0;
@@ -70,10 +78,14 @@ namespace {
 		}
 
 		return (non_zero ? TRUE : BLANK_TILE);
+	#endif
 	}
 
 	uint8 ConvertTile8 (uint8 *pCache, uint32 TileAddr, uint32)
 	{
+	#ifdef S9X_TILE_DECODE_SIMD
+		return (S9xDecodeTile<8>(&Memory.VRAM[TileAddr], pCache) ? TRUE : BLANK_TILE);
+	#else
 		uint8	*tp      = &Memory.VRAM[TileAddr];
 		uint32			*p       = (uint32 *) pCache;
 		uint32			non_zero = 0;
@@ -99,6 +111,7 @@ namespace {
 		}
 
 		return (non_zero ? TRUE : BLANK_TILE);
+	#endif
 	}
 
 	#undef DOBIT
@@ -0,0 +1,106 @@
+/*****************************************************************************\
+     Snes9x - Portable Super Nintendo Entertainment System (TM) emulator.
+                This file is licensed under the Snes9x License.
+   For further information, consult the LICENSE file in the root directory.
+\*****************************************************************************/
+
+#ifndef _TILEDECODE_H_
+#define _TILEDECODE_H_
+
+#include "port.h"
+
+// SIMD versions of ConvertTile2/4/8(). A tile is 8 rows with the bytes of 2 bitplanes
+// interleaved per row, and each further pair of planes 16 bytes on. They decode into
+// the 64 byte tile cache format, one colour index byte per pixel from left to right,
+// and return whether any pixel is non-zero. Planes are added highest first, shifting
+// the pixels decoded so far up a bit each time.
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#define S9X_TILE_DECODE_SIMD
+
+// Adds one plane to rows[i], which holds rows 2i & 2i+1. x2 has the plane's byte for
+// rows 0-7 repeated twice in each 16-bit lane.
+static alwaysinline void S9xDecodeTilePlane (__m128i rows[4], __m128i x2)
+{
+	const __m128i	bitMask = _mm_set_epi8(1, 2, 4, 8, 16, 32, 64, -128, 1, 2, 4, 8, 16, 32, 64, -128);
+	__m128i	x4Lo = _mm_unpacklo_epi16(x2, x2);
+	__m128i	x4Hi = _mm_unpackhi_epi16(x2, x2);
+	__m128i	x8[4] =
+	{
+		_mm_unpacklo_epi32(x4Lo, x4Lo),
+		_mm_unpackhi_epi32(x4Lo, x4Lo),
+		_mm_unpacklo_epi32(x4Hi, x4Hi),
+		_mm_unpackhi_epi32(x4Hi, x4Hi)
+	};
+
+	for (int i = 0; i < 4; i++)
+	{
+		// 0xff where the pixel's bit is set, subtracting it adds 1
+		__m128i	bit = _mm_cmpeq_epi8(_mm_and_si128(x8[i], bitMask), bitMask);
+		rows[i] = _mm_sub_epi8(_mm_add_epi8(rows[i], rows[i]), bit);
+	}
+}
+
+template<int PLANES>
+static alwaysinline bool S9xDecodeTile (const uint8 *tp, uint8 *out)
+{
+	const __m128i	lowBytes = _mm_set1_epi16(0x00ff);
+	__m128i	rows[4] = { _mm_setzero_si128(), _mm_setzero_si128(), _mm_setzero_si128(), _mm_setzero_si128() };
+
+	for (int pair = PLANES / 2 - 1; pair >= 0; pair--)
+	{
+		__m128i	v = _mm_loadu_si128((const __m128i *) (tp + pair * 16));
+		S9xDecodeTilePlane(rows, _mm_or_si128(_mm_srli_epi16(v, 8), _mm_andnot_si128(lowBytes, v)));
+		S9xDecodeTilePlane(rows, _mm_or_si128(_mm_and_si128(v, lowBytes), _mm_slli_epi16(v, 8)));
+	}
+
+	for (int i = 0; i < 4; i++)
+		_mm_storeu_si128((__m128i *) (out + i * 16), rows[i]);
+
+	__m128i	any = _mm_or_si128(_mm_or_si128(rows[0], rows[1]), _mm_or_si128(rows[2], rows[3]));
+	return _mm_movemask_epi8(_mm_cmpeq_epi8(any, _mm_setzero_si128())) != 0xffff;
+}
+
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#define S9X_TILE_DECODE_SIMD
+
+// Adds one plane to rows[i], which holds rows 2i & 2i+1
+static alwaysinline void S9xDecodeTilePlane (uint8x16_t rows[4], uint8x8_t plane)
+{
+	const uint8x16_t	bitMask = { 0x80, 0x40, 0x20, 0x10, 8, 4, 2, 1, 0x80, 0x40, 0x20, 0x10, 8, 4, 2, 1 };
+	uint8x16_t	x8[4] =
+	{
+		vcombine_u8(vdup_lane_u8(plane, 0), vdup_lane_u8(plane, 1)),
+		vcombine_u8(vdup_lane_u8(plane, 2), vdup_lane_u8(plane, 3)),
+		vcombine_u8(vdup_lane_u8(plane, 4), vdup_lane_u8(plane, 5)),
+		vcombine_u8(vdup_lane_u8(plane, 6), vdup_lane_u8(plane, 7))
+	};
+
+	for (int i = 0; i < 4; i++)
+		rows[i] = vsubq_u8(vaddq_u8(rows[i], rows[i]), vtstq_u8(x8[i], bitMask));
+}
+
+template<int PLANES>
+static alwaysinline bool S9xDecodeTile (const uint8 *tp, uint8 *out)
+{
+	uint8x16_t	rows[4] = { vdupq_n_u8(0), vdupq_n_u8(0), vdupq_n_u8(0), vdupq_n_u8(0) };
+
+	for (int pair = PLANES / 2 - 1; pair >= 0; pair--)
+	{
+		uint8x8x2_t	planes = vld2_u8(tp + pair * 16);
+		S9xDecodeTilePlane(rows, planes.val[1]);
+		S9xDecodeTilePlane(rows, planes.val[0]);
+	}
+
+	for (int i = 0; i < 4; i++)
+		vst1q_u8(out + i * 16, rows[i]);
+
+	uint64x2_t	any = vreinterpretq_u64_u8(vorrq_u8(vorrq_u8(rows[0], rows[1]), vorrq_u8(rows[2], rows[3])));
+	return (vgetq_lane_u64(any, 0) | vgetq_lane_u64(any, 1)) != 0;
+}
+
+#endif
+
+#endif
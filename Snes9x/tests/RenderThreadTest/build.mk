@@ -0,0 +1,34 @@
+ifndef inc_main
+inc_main := 1
+
+include $(IMAGINE_PATH)/make/imagineAppBase.mk
+
+VPATH += $(projectPath)/../../src
+
+CPPFLAGS += \
+-I$(projectPath)/../../src \
+-I$(projectPath)/../../src/snes9x \
+-I$(projectPath)/../../src/snes9x/apu/bapu \
+-DHAVE_STRINGS_H \
+-DHAVE_STDINT_H \
+-DRIGHTSHIFT_IS_SAR \
+-DZLIB \
+-DPIXEL_FORMAT=RGB565
+
+CXXFLAGS_WARN += -Wno-register
+
+include $(projectPath)/../../snes9xSrc.mk
+
+SRC += main/main.cc \
+$(addprefix snes9x/,$(snes9xSrc))
+
+include $(IMAGINE_PATH)/make/package/imagine.mk
+include $(IMAGINE_PATH)/make/package/zlib.mk
+
+ifndef target
+target := RenderThreadTest
+endif
+
+include $(IMAGINE_PATH)/make/imagineAppTarget.mk
+
+endif
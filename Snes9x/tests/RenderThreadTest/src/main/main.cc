@@ -0,0 +1,400 @@
+#define LOGTAG "main"
+#include <imagine/base/Base.hh>
+#include <imagine/logger/logger.h>
+#include <snes9x.h>
+#include <memmap.h>
+#include <gfx.h>
+#include <ppu.h>
+#include <cpuexec.h>
+#include <controls.h>
+#include <display.h>
+#include <apu/apu.h>
+#include <logger.h>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+#include <unistd.h>
+#include <sys/wait.h>
+
+// Runs each game twice, once rendering inline and once with S9xSetThreadedRendering(),
+// and checks every frame's output hash matches, then reports the average time per
+// frame of both runs. Without ROM arguments, generated stress ROMs are used: a 65816
+// loop that fills video memory with random data, then keeps writing random values
+// to PPU registers and video memory at random points throughout the frame, see
+// StressType for the variants covering flushes, invalidation and lines drawn ahead.
+// SETINI ($2133) is only read since interlaced Mode 7 mosaic draws past the end of
+// the screen buffer even when rendering inline.
+// Returns non-zero if any frame mismatches.
+// Usage: renderthreadtest [--frames N] [ROM path]...
+
+// LoROM program at $8000, seed at $FFF0, (register, value) init pairs at $FF80
+static const uint8 stressProgram[]
+{
+	0x78, // SEI
+	0x18, // CLC
+	0xFB, // XCE
+	0xC2, 0x30, // REP #$30
+	0xA2, 0xFF, 0x1F, // LDX #$1FFF
+	0x9A, // TXS
+	0xA9, 0x00, 0x00, // LDA #$0000
+	0x5B, // TCD
+	0xAF, 0xF0, 0xFF, 0x00, // LDA $00FFF0
+	0x85, 0x00, // STA $00
+	0xE2, 0x30, // SEP #$30
+	0xA9, 0x80, // LDA #$80
+	0x8D, 0x00, 0x21, // STA $2100
+	0xA2, 0x00, // LDX #$00
+	// init:
+	0xBF, 0x80, 0xFF, 0x00, // LDA $00FF80,X
+	0xC9, 0xFF, // CMP #$FF
+	0xF0, 0x0C, // BEQ fill
+	0xA8, // TAY
+	0xBF, 0x81, 0xFF, 0x00, // LDA $00FF81,X
+	0x99, 0x00, 0x21, // STA $2100,Y
+	0xE8, // INX
+	0xE8, // INX
+	0x80, 0xEC, // BRA init
+	// fill: stream 64KB of random data through all the ports during forced blank
+	0xC2, 0x10, // REP #$10
+	0xA2, 0x00, 0x80, // LDX #$8000
+	// fillloop:
+	0x20, 0x76, 0x80, // JSR lfsr
+	0x8D, 0x18, 0x21, // STA $2118
+	0xEB, // XBA
+	0x8D, 0x19, 0x21, // STA $2119
+	0x8D, 0x22, 0x21, // STA $2122
+	0x8D, 0x04, 0x21, // STA $2104
+	0xCA, // DEX
+	0xD0, 0xED, // BNE fillloop
+	0xE2, 0x10, // SEP #$10
+	0xA9, 0x0F, // LDA #$0F
+	0x8D, 0x00, 0x21, // STA $2100
+	// loop:
+	0x20, 0x76, 0x80, // JSR lfsr
+	0x8D, 0x18, 0x21, // STA $2118
+	0xEB, // XBA
+	0x8D, 0x19, 0x21, // STA $2119
+	0x8D, 0x22, 0x21, // STA $2122
+	0x8D, 0x04, 0x21, // STA $2104
+	0xA5, 0x00, // LDA $00
+	0x29, 0x3F, // AND #$3F (register mask)
+	0xF0, 0xEA, // BEQ loop
+	0xAA, // TAX
+	0xE0, 0x33, // CPX #$33
+	0xB0, 0x07, // BCS read
+	0xA5, 0x01, // LDA $01
+	0x9D, 0x00, 0x21, // STA $2100,X (register base)
+	0x80, 0xDE, // BRA loop
+	// read:
+	0xBD, 0x00, 0x21, // LDA $2100,X
+	0x80, 0xD9, // BRA loop
+	// lfsr: step the 16-bit LFSR in $00, returns it in A & B
+	0xC2, 0x20, // REP #$20
+	0xA5, 0x00, // LDA $00
+	0x4A, // LSR A
+	0x90, 0x03, // BCC noxor
+	0x49, 0x00, 0xB4, // EOR #$B400
+	// noxor:
+	0x85, 0x00, // STA $00
+	0xE2, 0x20, // SEP #$20
+	0x60, // RTS
+};
+
+// operand offsets in stressProgram, each data port store can be pointed at WRAM instead
+static constexpr unsigned dataPortOffset[]{83, 87, 90, 93};
+static constexpr unsigned registerMaskOffset = 98;
+static constexpr unsigned registerBaseOffset = 109;
+
+// mode 1, BG1-3 & sprites on the main screen, BG tile maps and character data spread over VRAM
+static const uint8 stressInitRegs[]
+{
+	0x05, 0x01, 0x07, 0x00, 0x08, 0x08, 0x09, 0x10,
+	0x0B, 0x42, 0x0C, 0x06, 0x01, 0x03, 0x2C, 0x17,
+	0xFF,
+};
+
+enum class StressType
+{
+	// random PPU register writes and VRAM/CGRAM/OAM data, flushes on most writes
+	ALL_REGISTERS,
+	// BG scroll registers and VRAM data, lines drawn ahead are invalidated
+	SCROLL_VRAM,
+	// BG scroll registers only, latched per line so lines drawn ahead are kept
+	SCROLL,
+};
+
+static std::vector<uint8> makeStressROM(uint16 seed, StressType type)
+{
+	std::vector<uint8> rom(0x8000);
+	memcpy(rom.data(), stressProgram, sizeof(stressProgram));
+	if(type != StressType::ALL_REGISTERS)
+	{
+		// BG1-4 scroll registers $210E-$2114
+		rom[registerMaskOffset] = 0x07;
+		rom[registerBaseOffset] = 0x0D;
+		// CGRAM & OAM data go to WRAM $0010, VRAM data too unless requested
+		for(auto i = type == StressType::SCROLL ? 0u : 2u; i < std::size(dataPortOffset); i++)
+		{
+			rom[dataPortOffset[i]] = 0x10;
+			rom[dataPortOffset[i] + 1] = 0x00;
+		}
+	}
+	memcpy(&rom[0x7F80], stressInitRegs, sizeof(stressInitRegs));
+	memcpy(&rom[0x7FC0], "RENDER THREAD TEST   ", 21);
+	rom[0x7FD5] = 0x20; // LoROM
+	rom[0x7FD7] = 0x05; // 32KB
+	rom[0x7FD9] = 0x01; // NTSC
+	rom[0x7FF0] = seed & 0xFF;
+	rom[0x7FF1] = seed >> 8;
+	rom[0x7FFC] = 0x00; // reset vector $8000
+	rom[0x7FFD] = 0x80;
+	// checksum fields are still 0, complement + checksum always add 0x1FE
+	uint16 sum = 0x1FE;
+	for(auto b : rom)
+		sum += b;
+	rom[0x7FDC] = ~sum & 0xFF;
+	rom[0x7FDD] = ~sum >> 8;
+	rom[0x7FDE] = sum & 0xFF;
+	rom[0x7FDF] = sum >> 8;
+	return rom;
+}
+
+static std::vector<uint64> *frameHashes{};
+
+static uint64 hashFrame(int width, int height)
+{
+	// FNV-1a over the visible pixels
+	uint64 hash = 0xcbf29ce484222325;
+	for(int y = 0; y < height; y++)
+	{
+		auto line = (const uint8*)&GFX.Screen[y * GFX.RealPPL];
+		for(int i = 0; i < width * 2; i++)
+		{
+			hash ^= line[i];
+			hash *= 0x100000001b3;
+		}
+	}
+	return hash;
+}
+
+static double runGame(const uint8 *rom, uint32 size, unsigned frames, bool threaded, std::vector<uint64> &hashes)
+{
+	S9xSetThreadedRendering(threaded);
+	if(!Memory.LoadROMMem(rom, size))
+	{
+		fprintf(stderr, "error loading ROM\n");
+		exit(1);
+	}
+	IPPU.RenderThisFrame = TRUE;
+	hashes.clear();
+	frameHashes = &hashes;
+	auto start = std::chrono::steady_clock::now();
+	while(hashes.size() < frames)
+	{
+		S9xMainLoop();
+	}
+	auto time = std::chrono::steady_clock::now() - start;
+	frameHashes = {};
+	S9xSetThreadedRendering(false);
+	return std::chrono::duration<double, std::milli>(time).count() / frames;
+}
+
+static bool readAll(int fd, void *buff, size_t size)
+{
+	auto data = (char*)buff;
+	while(size)
+	{
+		auto bytesRead = read(fd, data, size);
+		if(bytesRead <= 0)
+			return false;
+		data += bytesRead;
+		size -= bytesRead;
+	}
+	return true;
+}
+
+static double runGameInChild(const uint8 *rom, uint32 size, unsigned frames, bool threaded, std::vector<uint64> &hashes)
+{
+	// S9xReset() keeps some renderer state from the previous game, like the sprite line
+	// data in GFX and the IPPU clip windows, so every run starts from a fork of the
+	// freshly initialized process to make both runs see identical state
+	int fds[2];
+	if(pipe(fds) == -1)
+	{
+		perror("pipe");
+		exit(1);
+	}
+	auto pid = fork();
+	if(pid == -1)
+	{
+		perror("fork");
+		exit(1);
+	}
+	if(!pid)
+	{
+		close(fds[0]);
+		double time = runGame(rom, size, frames, threaded, hashes);
+		if(write(fds[1], &time, sizeof(time)) != sizeof(time) ||
+			write(fds[1], hashes.data(), frames * sizeof(uint64)) != (ssize_t)(frames * sizeof(uint64)))
+			_exit(1);
+		_exit(0);
+	}
+	close(fds[1]);
+	double time{};
+	hashes.resize(frames);
+	bool success = readAll(fds[0], &time, sizeof(time)) && readAll(fds[0], hashes.data(), frames * sizeof(uint64));
+	close(fds[0]);
+	int status;
+	waitpid(pid, &status, 0);
+	if(!success || !WIFEXITED(status) || WEXITSTATUS(status))
+	{
+		fprintf(stderr, "%s run failed\n", threaded ? "threaded" : "inline");
+		exit(1);
+	}
+	return time;
+}
+
+static bool runTest(const char *name, const uint8 *rom, uint32 size, unsigned frames)
+{
+	std::vector<uint64> inlineHashes, threadedHashes;
+	double inlineTime = runGameInChild(rom, size, frames, false, inlineHashes);
+	double threadedTime = runGameInChild(rom, size, frames, true, threadedHashes);
+	unsigned mismatches = 0, firstMismatch = 0;
+	for(unsigned i = 0; i < frames; i++)
+	{
+		if(inlineHashes[i] != threadedHashes[i] && !mismatches++)
+			firstMismatch = i;
+	}
+	printf("%-24s %5u frames  inline:%7.3fms  threaded:%7.3fms  ", name, frames, inlineTime, threadedTime);
+	if(mismatches)
+		printf("MISMATCH in %u frames, first at %u\n", mismatches, firstMismatch);
+	else
+		printf("all frames match\n");
+	return !mismatches;
+}
+
+static std::vector<uint8> readFile(const char *path)
+{
+	std::vector<uint8> data;
+	auto file = fopen(path, "rb");
+	if(!file)
+		return data;
+	fseek(file, 0, SEEK_END);
+	data.resize(ftell(file));
+	fseek(file, 0, SEEK_SET);
+	if(fread(data.data(), 1, data.size(), file) != data.size())
+		data.clear();
+	fclose(file);
+	return data;
+}
+
+bool8 S9xDeinitUpdate(int width, int height)
+{
+	if(frameHashes)
+		frameHashes->push_back(hashFrame(width, height));
+	// the port clears the depth buffers after presenting, see Snes9x's Main.cc
+	memset(GFX.ZBuffer, 0, GFX.ScreenSize);
+	memset(GFX.SubZBuffer, 0, GFX.ScreenSize);
+	return TRUE;
+}
+
+bool8 S9xInitUpdate() { return TRUE; }
+bool8 S9xContinueUpdate(int width, int height) { return TRUE; }
+void S9xSyncSpeed() {}
+bool8 S9xOpenSoundDevice() { return TRUE; }
+void S9xMessage(int, int, const char *) {}
+void S9xHandlePortCommand(s9xcommand_t cmd, int16 data1, int16 data2) {}
+bool S9xPollButton(uint32 id, bool *pressed) { return false; }
+bool S9xPollPointer(uint32 id, int16 *x, int16 *y) { return false; }
+bool S9xPollAxis(uint32 id, int16 *value) { return false; }
+const char *S9xGetCrosshair(int idx) { return nullptr; }
+const char *S9xGetDirectory(enum s9x_getdirtype dirtype) { return "."; }
+const char *S9xGetFilename(const char *ex, enum s9x_getdirtype dirtype) { return ex; }
+const char *S9xGetFilenameInc(const char *ex, enum s9x_getdirtype dirtype) { return ex; }
+const char *S9xBasename(const char *f) { return f; }
+void S9xAutoSaveSRAM() {}
+void S9xToggleSoundChannel(int c) {}
+void S9xSetPalette() {}
+bool8 S9xLoadSDD1Data() { return FALSE; }
+bool8 S9xOpenSnapshotFile(const char *filename, bool8 read_only, STREAM *file) { return FALSE; }
+void S9xCloseSnapshotFile(STREAM file) {}
+void S9xResetLogger() {}
+void S9xPrintf(const char *msg, ...) {}
+void S9xPrintfError(const char *msg, ...) {}
+void _splitpath(const char *path, char *drive, char *dir, char *fname, char *ext) { *drive = *dir = *fname = *ext = 0; }
+void _makepath(char *path, const char *, const char *dir, const char *fname, const char *ext) { *path = 0; }
+
+uint16 SSettings::DisplayColor = 0;
+uint32 SSettings::SkipFrames = 0;
+uint32 SSettings::TurboSkipFrames = 0;
+const char *SGFX::InfoString{};
+uint32 SGFX::InfoStringTimeout = 0;
+char SGFX::FrameDisplayString[256]{};
+
+namespace Base
+{
+
+int runHeadless(int argc, char** argv)
+{
+	unsigned frames = 600;
+	std::vector<const char*> romPaths;
+	for(int i = 1; i < argc; i++)
+	{
+		if(!strcmp(argv[i], "--frames") && i + 1 < argc)
+			frames = std::max(strtoul(argv[++i], nullptr, 10), 1ul);
+		else
+			romPaths.push_back(argv[i]);
+	}
+	static uint16 screenBuff[512*478] __attribute__ ((aligned (8)));
+	GFX.Screen = screenBuff;
+	Memory.Init();
+	S9xGraphicsInit();
+	S9xInitAPU();
+	Settings.SoundPlaybackRate = 48000;
+	S9xInitSound(0);
+	S9xUnmapAllControls();
+	S9xSetSamplesAvailableCallback([](void *)
+		{
+			static uint8 samples[8192 * 2];
+			int count = std::min(S9xGetSampleCount(), (int)sizeof(samples) / 2);
+			S9xMixSamples(samples, count);
+		}, nullptr);
+	bool pass = true;
+	if(romPaths.empty())
+	{
+		// like the port's option to allow invalid VRAM access, otherwise VRAM writes
+		// during the frame are dropped and never invalidate lines drawn ahead
+		PPU.BlockInvalidVRAMAccess = false;
+		for(uint16 seed : {0x1234, 0xACE1, 0x7F01, 0x0BAD})
+		{
+			for(auto [type, typeName] : {std::pair{StressType::ALL_REGISTERS, "registers"},
+				{StressType::SCROLL_VRAM, "scroll+vram"}, {StressType::SCROLL, "scroll"}})
+			{
+				char name[64];
+				snprintf(name, sizeof(name), "%s seed %04X", typeName, seed);
+				auto rom = makeStressROM(seed, type);
+				pass &= runTest(name, rom.data(), rom.size(), frames);
+			}
+		}
+		PPU.BlockInvalidVRAMAccess = true;
+	}
+	for(auto path : romPaths)
+	{
+		auto rom = readFile(path);
+		if(rom.empty())
+		{
+			fprintf(stderr, "error reading %s\n", path);
+			return 1;
+		}
+		auto name = strrchr(path, '/');
+		pass &= runTest(name ? name + 1 : path, rom.data(), rom.size(), frames);
+	}
+	printf("%s\n", pass ? "threaded rendering matches inline" : "THREADED RENDERING MISMATCH");
+	return pass ? 0 : 1;
+}
+
+void onInit(int argc, char** argv) {}
+
+}
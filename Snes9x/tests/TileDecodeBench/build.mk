@@ -0,0 +1,23 @@
+ifndef inc_main
+inc_main := 1
+
+include $(IMAGINE_PATH)/make/imagineAppBase.mk
+
+CPPFLAGS += \
+-I$(projectPath)/../../src/snes9x \
+-DHAVE_STRINGS_H \
+-DHAVE_STDINT_H \
+-DRIGHTSHIFT_IS_SAR \
+-DPIXEL_FORMAT=RGB565
+
+SRC += main/main.cc
+
+include $(IMAGINE_PATH)/make/package/imagine.mk
+
+ifndef target
+target := TileDecodeBench
+endif
+
+include $(IMAGINE_PATH)/make/imagineAppTarget.mk
+
+endif
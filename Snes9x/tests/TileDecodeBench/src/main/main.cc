@@ -0,0 +1,236 @@
+#define LOGTAG "main"
+#include <imagine/base/Base.hh>
+#include <imagine/time/Time.hh>
+#include <imagine/logger/logger.h>
+#include <imagine/util/algorithm.h>
+#include <tiledecode.h>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+// Replays VRAM traffic through the tile cache decoders, timing the original table based
+// ConvertTile2/4/8() loops kept below as the reference against S9xDecodeTile(), and
+// checks both decode every invalidated tile the same. Each frame decodes the tiles its
+// VRAM writes invalidated, like the renderer does the first time it draws them.
+// Traces come from Snes9x's headless benchmark with --trace, without one a synthetic
+// trace of DMA sized bursts to random addresses is used.
+// Returns non-zero if any tile mismatches.
+// Usage: tiledecodebench [trace file]
+
+struct TraceFrame
+{
+	struct Block
+	{
+		uint16 index;
+		uint8 data[16];
+	};
+	std::vector<Block> blocks;
+};
+
+static uint32 pixbit[8][16];
+
+static void initPixbit()
+{
+	for(int i = 0; i < 16; i++)
+	{
+		uint32 b = 0;
+		#ifdef LSB_FIRST
+		if(i & 8) b |= 1;
+		if(i & 4) b |= 1 << 8;
+		if(i & 2) b |= 1 << 16;
+		if(i & 1) b |= 1 << 24;
+		#else
+		if(i & 8) b |= 1 << 24;
+		if(i & 4) b |= 1 << 16;
+		if(i & 2) b |= 1 << 8;
+		if(i & 1) b |= 1;
+		#endif
+		for(int bitshift = 0; bitshift < 8; bitshift++)
+			pixbit[bitshift][i] = b << bitshift;
+	}
+}
+
+template<int PLANES>
+static bool referenceDecodeTile(const uint8 *tp, uint8 *out)
+{
+	auto p = (uint32*)out;
+	uint32 nonZero = 0;
+	for(int line = 8; line != 0; line--, tp += 2)
+	{
+		uint32 p1 = 0, p2 = 0;
+		for(int i = 0; i < PLANES; i++)
+		{
+			if(uint8 pix = tp[(i >> 1) * 16 + (i & 1)];
+				pix)
+			{
+				p1 |= pixbit[i][pix >> 4];
+				p2 |= pixbit[i][pix & 0xf];
+			}
+		}
+		*p++ = p1;
+		*p++ = p2;
+		nonZero |= p1 | p2;
+	}
+	return nonZero;
+}
+
+static std::vector<TraceFrame> loadTrace(const char *path)
+{
+	std::vector<TraceFrame> frames;
+	auto file = fopen(path, "rb");
+	if(!file)
+	{
+		fprintf(stderr, "can't open %s\n", path);
+		return frames;
+	}
+	uint16 count;
+	while(fread(&count, sizeof(count), 1, file) == 1)
+	{
+		auto &frame = frames.emplace_back();
+		frame.blocks.resize(count);
+		for(auto &b : frame.blocks)
+		{
+			if(fread(&b.index, sizeof(b.index), 1, file) != 1 || fread(b.data, sizeof(b.data), 1, file) != 1)
+			{
+				fprintf(stderr, "truncated trace frame %zu\n", frames.size() - 1);
+				frames.pop_back();
+				fclose(file);
+				return frames;
+			}
+			b.index &= 0xfff;
+		}
+	}
+	fclose(file);
+	return frames;
+}
+
+static std::vector<TraceFrame> makeSyntheticTrace(uint32_t frameCount)
+{
+	std::vector<TraceFrame> frames(frameCount);
+	for(auto &frame : frames)
+	{
+		// a few transfers per frame of 512 bytes to 4KB, about what fits in vblank
+		iterateTimes(1 + rand() % 3, t)
+		{
+			uint32_t start = rand() % 0x1000;
+			uint32_t blocks = 32 + rand() % 225;
+			iterateTimes(blocks, i)
+			{
+				TraceFrame::Block b{uint16((start + i) & 0xfff)};
+				for(auto &d : b.data)
+				{
+					// mostly sparse graphics, with fully blank blocks mixed in
+					d = rand() % 4 ? rand() : 0;
+				}
+				frame.blocks.push_back(b);
+			}
+		}
+	}
+	return frames;
+}
+
+struct DepthResult
+{
+	IG::Time refTime{};
+	IG::Time simdTime{};
+	uint32_t tiles{};
+	bool matches = true;
+};
+
+template<int PLANES>
+static void decodeDirty(const uint8 *vram, std::vector<uint16> &dirty, DepthResult &result)
+{
+	constexpr uint32_t tileBytes = PLANES * 8;
+	alignas(64) static uint8 refCache[0x10000 / tileBytes][64];
+	alignas(64) static uint8 simdCache[0x10000 / tileBytes][64];
+	static bool refNonZero[0x10000 / tileBytes], simdNonZero[0x10000 / tileBytes];
+	result.tiles += dirty.size();
+	result.refTime += IG::timeFunc([&]()
+		{
+			for(auto tile : dirty)
+				refNonZero[tile] = referenceDecodeTile<PLANES>(&vram[tile * tileBytes], refCache[tile]);
+		});
+	#ifdef S9X_TILE_DECODE_SIMD
+	result.simdTime += IG::timeFunc([&]()
+		{
+			for(auto tile : dirty)
+				simdNonZero[tile] = S9xDecodeTile<PLANES>(&vram[tile * tileBytes], simdCache[tile]);
+		});
+	for(auto tile : dirty)
+	{
+		if(refNonZero[tile] != simdNonZero[tile] || memcmp(refCache[tile], simdCache[tile], 64))
+			result.matches = false;
+	}
+	#endif
+	dirty.clear();
+}
+
+static void printResult(const char *name, const DepthResult &r)
+{
+	auto toNSecs = [](IG::Time t){ return std::chrono::duration_cast<std::chrono::duration<double, std::nano>>(t).count(); };
+	double tiles = std::max(r.tiles, 1u);
+	#ifdef S9X_TILE_DECODE_SIMD
+	printf("%-4s %s %7u tiles  reference:%6.2fns  simd:%6.2fns per tile  %5.2fx\n",
+		r.matches ? "PASS" : "FAIL", name, r.tiles, toNSecs(r.refTime) / tiles, toNSecs(r.simdTime) / tiles,
+		toNSecs(r.refTime) / toNSecs(r.simdTime));
+	#else
+	printf("%s %7u tiles  reference:%6.2fns per tile, no SIMD decoder on this target\n",
+		name, r.tiles, toNSecs(r.refTime) / tiles);
+	#endif
+}
+
+namespace Base
+{
+
+int runHeadless(int argc, char** argv)
+{
+	initPixbit();
+	auto frames = argc > 1 ? loadTrace(argv[1]) : makeSyntheticTrace(3600);
+	if(frames.empty())
+	{
+		fprintf(stderr, "no trace frames\n");
+		return 1;
+	}
+	alignas(64) static uint8 vram[0x10000];
+	std::vector<uint16> dirty2, dirty4, dirty8;
+	static bool isDirty2[0x1000], isDirty4[0x800], isDirty8[0x400];
+	DepthResult result2, result4, result8;
+	size_t blocks = 0;
+	for(auto &frame : frames)
+	{
+		for(auto &b : frame.blocks)
+		{
+			memcpy(&vram[b.index * 16], b.data, 16);
+			auto markDirty = [](auto &isDirty, auto &dirty, uint16 tile)
+				{
+					if(!isDirty[tile])
+					{
+						isDirty[tile] = true;
+						dirty.push_back(tile);
+					}
+				};
+			markDirty(isDirty2, dirty2, b.index);
+			markDirty(isDirty4, dirty4, b.index >> 1);
+			markDirty(isDirty8, dirty8, b.index >> 2);
+		}
+		blocks += frame.blocks.size();
+		for(auto t : dirty2) isDirty2[t] = false;
+		for(auto t : dirty4) isDirty4[t] = false;
+		for(auto t : dirty8) isDirty8[t] = false;
+		decodeDirty<2>(vram, dirty2, result2);
+		decodeDirty<4>(vram, dirty4, result4);
+		decodeDirty<8>(vram, dirty8, result8);
+	}
+	printf("%zu frames, %zu VRAM blocks written\n", frames.size(), blocks);
+	printResult("2bpp", result2);
+	printResult("4bpp", result4);
+	printResult("8bpp", result8);
+	bool pass = result2.matches && result4.matches && result8.matches;
+	printf("%s\n", pass ? "all tiles match" : "TILE MISMATCH");
+	return pass ? 0 : 1;
+}
+
+void onInit(int argc, char** argv) {}
+
+}
@@ -0,0 +1,69 @@
+#pragma once
+
+/*  This file is part of Imagine.
+
+	Imagine is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	Imagine is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with Imagine.  If not, see <http://www.gnu.org/licenses/> */
+
+#include <imagine/audio/Format.hh>
+#include <memory>
+
+namespace IG::Audio
+{
+
+enum class ResamplerQuality : uint8_t
+{
+	LOW,    // 8 taps, 64 phases
+	MEDIUM, // 16 taps, 128 phases
+	HIGH,   // 32 taps, 256 phases
+};
+
+// Polyphase Kaiser-windowed sinc resampler for 16-bit or float samples.
+// The ratio is given per call and may change freely between calls, a short
+// history of previous input is kept so the output stays continuous. Output
+// always lags the input by DELAY_FRAMES, including at a 1:1 ratio where the
+// samples are only delayed, so switching ratios never skips or repeats audio.
+class Resampler
+{
+public:
+	static constexpr uint32_t MAX_TAPS = 128;
+	static constexpr uint32_t DELAY_FRAMES = MAX_TAPS / 2;
+
+	constexpr Resampler() {}
+	void setFormat(Format format);
+	void setQuality(ResamplerQuality quality);
+	ResamplerQuality quality() const { return quality_; }
+	void reset();
+	// converts srcFrames of input into exactly destFrames of output
+	void resample(void *dest, uint32_t destFrames, const void *src, uint32_t srcFrames);
+
+protected:
+	std::unique_ptr<float[]> coeff{};
+	std::unique_ptr<float[]> work{};
+	float tableStep = 0;
+	uint32_t workFrames = 0;
+	uint32_t taps = 0;
+	uint32_t phases = 0;
+	SampleFormat sample{};
+	uint8_t channels = 0;
+	ResamplerQuality quality_ = ResamplerQuality::MEDIUM;
+
+	void makeTable(float step);
+	float *channelData(uint32_t ch) const;
+	void loadInput(const void *src, uint32_t srcFrames);
+	void saveHistory(uint32_t srcFrames);
+	void updateHistory(const void *src, uint32_t srcFrames);
+	void delay(void *dest, uint32_t frames);
+};
+
+}
@@ -130,6 +130,10 @@ void setOnSystemOrientationChanged(SystemOrientationChangedDelegate del);
 // Called on app startup
 [[gnu::cold]] void onInit(int argc, char** argv);
 
+// Optionally defined by the app to run without connecting to the window system,
+// replaces onInit() and the event loop, return value is the process exit code
+[[gnu::weak, gnu::cold]] int runHeadless(int argc, char** argv);
+
 Screen &mainScreen();
 Window &mainWindow();
 
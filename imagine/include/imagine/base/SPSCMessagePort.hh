@@ -0,0 +1,245 @@
+#pragma once
+
+/*  This file is part of Imagine.
+
+	Imagine is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	Imagine is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with Imagine.  If not, see <http://www.gnu.org/licenses/> */
+
+#include <imagine/config/defs.hh>
+#include <imagine/base/CustomEvent.hh>
+#include <imagine/thread/Semaphore.hh>
+#include <imagine/util/DelegateFunc.hh>
+#include <imagine/util/typeTraits.hh>
+#include <atomic>
+#include <array>
+#include <thread>
+#include <utility>
+
+namespace Base
+{
+
+// Message port for exactly one sending and one receiving thread. Messages go through
+// a lock-free ring and the receiver's event loop is only signaled when it has drained
+// the ring and parked, so a busy receiver costs the sender no syscalls.
+// Same interface as PipeMessagePort minus the extra data functions. The port must
+// stay at the same address while attached.
+template<class MsgType, uint32_t CAPACITY = 8>
+class SPSCMessagePort
+{
+public:
+	static_assert(CAPACITY && !(CAPACITY & (CAPACITY - 1)), "capacity must be a power of 2");
+
+	class Messages
+	{
+	public:
+		class Iterator
+		{
+		public:
+			constexpr Iterator(SPSCMessagePort *port): port{port}
+			{
+				if(!port)
+					return;
+				this->operator++();
+			}
+
+			Iterator operator++()
+			{
+				if(!port->pop(msg))
+				{
+					// end of messages
+					port = nullptr;
+				}
+				return *this;
+			}
+
+			bool operator!=(const Iterator &rhs) const
+			{
+				return port != rhs.port;
+			}
+
+			const MsgType &operator*() const
+			{
+				return msg;
+			}
+
+		private:
+			SPSCMessagePort *port;
+			MsgType msg{};
+		};
+
+		constexpr Messages(SPSCMessagePort &port): port{port} {}
+
+		Iterator begin() { return Iterator{&port}; }
+		Iterator end() { return Iterator{nullptr}; }
+
+	protected:
+		SPSCMessagePort &port;
+	};
+
+	using DispatchDelegate = DelegateFunc2<sizeof(uintptr_t)*4, bool(Messages &)>;
+
+	struct NullInit{};
+
+	SPSCMessagePort(const char *debugLabel = nullptr):
+		wakeEvent{debugLabel}
+	{}
+
+	explicit constexpr SPSCMessagePort(NullInit) {}
+
+	template<class Func>
+	void attach(Func &&func)
+	{
+		attach(EventLoop::forThread(), std::forward<Func>(func));
+	}
+
+	template<class Func>
+	void attach(EventLoop loop, Func &&func)
+	{
+		callback =
+			[=](Messages &msgs) -> bool
+			{
+				constexpr auto returnsVoid = std::is_same_v<void, decltype(func(msgs))>;
+				if constexpr(returnsVoid)
+				{
+					func(msgs);
+					return true;
+				}
+				else
+				{
+					return func(msgs);
+				}
+			};
+		wakeEvent.attach(loop,
+			PollEventDelegate
+			{
+				[this](int fd, int)
+				{
+					wakeEvent.cancel();
+					return dispatch();
+				}
+			});
+		// start out parked, also covers re-attaching after a callback returned false
+		receiverParked.store(true, std::memory_order_relaxed);
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		if(!isEmpty() && receiverParked.exchange(false, std::memory_order_relaxed))
+			wakeEvent.notify();
+	}
+
+	void detach()
+	{
+		wakeEvent.detach();
+	}
+
+	bool send(MsgType msg)
+	{
+		auto tail = tailIdx.load(std::memory_order_relaxed);
+		while(tail - headIdx.load(std::memory_order_acquire) == CAPACITY)
+		{
+			// full, only happens if the receiver stalls so no need for anything fancier
+			std::this_thread::yield();
+		}
+		slot[tail & (CAPACITY - 1)] = msg;
+		tailIdx.store(tail + 1, std::memory_order_release);
+		// pairs with the fence in dispatch() so either the receiver sees the new
+		// message when re-checking or we see it parked and wake it
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		if(receiverParked.load(std::memory_order_relaxed) &&
+			receiverParked.exchange(false, std::memory_order_relaxed))
+		{
+			wakeEvent.notify();
+		}
+		return true;
+	}
+
+	bool send(MsgType msg, bool awaitReply)
+	{
+		if(awaitReply)
+		{
+			IG::Semaphore sem{0};
+			if constexpr(std::is_invocable_v<decltype(&MsgType::setReplySemaphore), MsgType, IG::Semaphore*>)
+			{
+				msg.setReplySemaphore(&sem);
+			}
+			else
+			{
+				static_assert(IG::dependentFalseValue<MsgType>, "Called send() overload with MsgType missing setReplySemaphore()");
+			}
+			send(msg);
+			sem.wait();
+			return true;
+		}
+		else
+		{
+			return send(msg);
+		}
+	}
+
+	void clear()
+	{
+		MsgType msg;
+		while(pop(msg)) {}
+	}
+
+	void dispatchMessages()
+	{
+		if(callback)
+			dispatch();
+	}
+
+	explicit operator bool() const { return (bool)wakeEvent; }
+
+protected:
+	static constexpr size_t CACHE_LINE_SIZE = 64;
+
+	// indices only ever increase, wrapping is handled by the unsigned subtraction
+	alignas(CACHE_LINE_SIZE) std::atomic_uint32_t tailIdx{};
+	alignas(CACHE_LINE_SIZE) std::atomic_uint32_t headIdx{};
+	std::atomic_bool receiverParked{true};
+	alignas(CACHE_LINE_SIZE) std::array<MsgType, CAPACITY> slot{};
+	CustomEvent wakeEvent{CustomEvent::NullInit{}};
+	DispatchDelegate callback{};
+
+	bool isEmpty() const
+	{
+		return headIdx.load(std::memory_order_relaxed) == tailIdx.load(std::memory_order_acquire);
+	}
+
+	bool pop(MsgType &msg)
+	{
+		auto head = headIdx.load(std::memory_order_relaxed);
+		if(head == tailIdx.load(std::memory_order_acquire))
+			return false;
+		msg = slot[head & (CAPACITY - 1)];
+		headIdx.store(head + 1, std::memory_order_release);
+		return true;
+	}
+
+	bool dispatch()
+	{
+		while(true)
+		{
+			receiverParked.store(false, std::memory_order_relaxed);
+			Messages msgs{*this};
+			if(!callback(msgs))
+				return false;
+			receiverParked.store(true, std::memory_order_relaxed);
+			std::atomic_thread_fence(std::memory_order_seq_cst);
+			if(isEmpty())
+				return true;
+			// a message arrived after the callback finished iterating, the sender
+			// may or may not have signaled the event but handling it now is cheaper
+		}
+	}
+};
+
+}
@@ -17,9 +17,12 @@
 
 #include <imagine/config/defs.hh>
 #include <imagine/io/ArchiveIO.hh>
+#include <imagine/io/BufferMapIO.hh>
 #include <system_error>
 #include <compare>
 #include <memory>
+#include <string>
+#include <vector>
 
 namespace FS
 {
@@ -58,6 +61,44 @@ static ArchiveIterator end(const ArchiveIterator &)
 	return {};
 }
 
+// Random access to the files in a zip archive from its central directory, without
+// stepping through the entries before them like ArchiveIterator
+class ArchiveIndex
+{
+public:
+	struct Entry
+	{
+		std::string name;
+		uint64_t headerOffset;
+		uint64_t compressedSize;
+		uint64_t size;
+		uint32_t crc32;
+		uint16_t method;
+
+		FS::file_type type() const;
+		bool isCompressed() const;
+	};
+
+	ArchiveIndex(const char *path, IO &io, std::error_code &ec);
+	const std::vector<Entry> &entries() const { return entries_; }
+	const Entry *find(const char *name) const;
+	const Entry *findCRC(uint32_t crc) const;
+	// the entry's contents, a view of the mapped archive if stored uncompressed,
+	// otherwise inflated in one pass and checked against its CRC32 (mapped stored
+	// entries aren't checked), empty on error or compression methods other than deflate
+	BufferMapIO open(const Entry &entry, std::error_code *ecOut = nullptr) const;
+
+private:
+	PathString path{};
+	std::vector<Entry> entries_{};
+
+	bool readDirectory(IO &io);
+};
+
+// Returns the index of the zip archive at path, kept until the file changes so reopening
+// the same archive doesn't read it again, null if it can't be indexed (not a zip, encrypted, etc.)
+std::shared_ptr<const ArchiveIndex> archiveIndex(const char *path);
+
 ArchiveIO fileFromArchive(const char *archivePath, const char *filePath);
 static ArchiveIO fileFromArchive(PathString archivePath, PathString filePath)
 {
@@ -112,6 +112,12 @@ public:
 	void writeConverted(Pixmap pixmap, WP destPos);
 	void clear(WP pos, WP size);
 	void clear();
+	// expands 8-bit palette indices through a 256 entry palette, the
+	// destination pixel size must match the palette entry size
+	void writePaletted(Pixmap pixmap, const uint16_t *palette);
+	void writePaletted(Pixmap pixmap, const uint32_t *palette);
+	void writePaletted(Pixmap pixmap, const uint16_t *palette, WP destPos);
+	void writePaletted(Pixmap pixmap, const uint32_t *palette, WP destPos);
 
 	template <class Func>
 	static constexpr bool checkTransformFunc()
@@ -0,0 +1,119 @@
+#pragma once
+
+/*  This file is part of Imagine.
+
+	Imagine is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	Imagine is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with Imagine.  If not, see <http://www.gnu.org/licenses/> */
+
+#include <imagine/util/BufferView.hh>
+#include <memory>
+#include <cstring>
+#include <cstdint>
+#include <algorithm>
+#include <utility>
+
+namespace IG
+{
+
+// Growable byte storage that keeps its allocation across clear()/resize() so
+// repeatedly serializing into the same buffer doesn't touch the allocator.
+// Newly exposed bytes are left uninitialized.
+class ByteBuffer
+{
+public:
+	constexpr ByteBuffer() {}
+
+	ByteBuffer(size_t size)
+	{
+		resize(size);
+	}
+
+	ByteBuffer(ByteBuffer &&o)
+	{
+		*this = std::move(o);
+	}
+
+	ByteBuffer &operator=(ByteBuffer &&o)
+	{
+		buff = std::move(o.buff);
+		size_ = std::exchange(o.size_, 0);
+		capacity_ = std::exchange(o.capacity_, 0);
+		return *this;
+	}
+
+	uint8_t *data() { return buff.get(); }
+	const uint8_t *data() const { return buff.get(); }
+	size_t size() const { return size_; }
+	size_t capacity() const { return capacity_; }
+	bool empty() const { return !size_; }
+	uint8_t *begin() { return data(); }
+	uint8_t *end() { return data() + size_; }
+	const uint8_t *begin() const { return data(); }
+	const uint8_t *end() const { return data() + size_; }
+	uint8_t &operator[](size_t idx) { return buff[idx]; }
+	const uint8_t &operator[](size_t idx) const { return buff[idx]; }
+
+	void reserve(size_t newCapacity)
+	{
+		if(newCapacity <= capacity_)
+			return;
+		std::unique_ptr<uint8_t[]> newBuff{new uint8_t[newCapacity]};
+		if(size_)
+			std::memcpy(newBuff.get(), buff.get(), size_);
+		buff = std::move(newBuff);
+		capacity_ = newCapacity;
+	}
+
+	void resize(size_t newSize)
+	{
+		if(newSize > capacity_)
+			reserve(std::max(newSize, capacity_ + capacity_ / 2));
+		size_ = newSize;
+	}
+
+	void clear()
+	{
+		size_ = 0;
+	}
+
+	void append(const void *data, size_t bytes)
+	{
+		auto offset = size_;
+		resize(size_ + bytes);
+		std::memcpy(buff.get() + offset, data, bytes);
+	}
+
+	void assign(const void *data, size_t bytes)
+	{
+		clear();
+		append(data, bytes);
+	}
+
+	// non-owning view of the current contents, valid until the buffer is resized or destroyed
+	ConstBufferView view() const
+	{
+		return {(const char*)buff.get(), size_, [](const char*){}};
+	}
+
+	explicit operator bool() const
+	{
+		return size_;
+	}
+
+protected:
+	std::unique_ptr<uint8_t[]> buff{};
+	size_t size_ = 0;
+	size_t capacity_ = 0;
+};
+
+}
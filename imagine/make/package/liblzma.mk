@@ -0,0 +1,10 @@
+ifndef inc_pkg_liblzma
+inc_pkg_liblzma := 1
+
+ifeq ($(ENV), linux)
+ pkgConfigDeps += liblzma
+else
+ pkgConfigStaticDeps += liblzma
+endif
+
+endif
\ No newline at end of file
@@ -0,0 +1,283 @@
+/*  This file is part of Imagine.
+
+	Imagine is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	Imagine is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with Imagine.  If not, see <http://www.gnu.org/licenses/> */
+
+#define LOGTAG "Resampler"
+#include <imagine/audio/Resampler.hh>
+#include <imagine/logger/logger.h>
+#include <imagine/util/utility.h>
+#include <imagine/util/algorithm.h>
+#include <imagine/util/math/math.hh>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace IG::Audio
+{
+
+struct QualityParams
+{
+	uint32_t taps;
+	uint32_t phases;
+	float cutoff;
+	float beta;
+};
+
+static constexpr QualityParams qualityParams[]
+{
+	{8, 64, .85f, 5.f},
+	{16, 128, .90f, 7.f},
+	{32, 256, .94f, 8.6f},
+};
+
+// only rebuild the table when the downsampling ratio moves more than this,
+// small drift from frame size rounding or rate control reuses the old one
+static constexpr float TABLE_STEP_TOLERANCE = .02f;
+
+static double besselI0(double x)
+{
+	double sum = 1, term = 1;
+	for(int k = 1; k < 32; k++)
+	{
+		double t = x / (2 * k);
+		term *= t * t;
+		sum += term;
+		if(term < sum * 1e-12)
+			break;
+	}
+	return sum;
+}
+
+static double sinc(double x)
+{
+	if(std::abs(x) < 1e-9)
+		return 1.;
+	return std::sin(M_PI * x) / (M_PI * x);
+}
+
+// 4 independent accumulators so the compiler can map the loop onto SSE/NEON
+// lanes without needing to reorder float additions, taps are a multiple of 8
+static float dotProduct(const float * __restrict__ a, const float * __restrict__ b, uint32_t taps)
+{
+	float acc[4]{};
+	for(uint32_t i = 0; i < taps; i += 4)
+	{
+		acc[0] += a[i] * b[i];
+		acc[1] += a[i + 1] * b[i + 1];
+		acc[2] += a[i + 2] * b[i + 2];
+		acc[3] += a[i + 3] * b[i + 3];
+	}
+	return (acc[0] + acc[1]) + (acc[2] + acc[3]);
+}
+
+static float toFloat(int16_t s) { return s / 32768.f; }
+static float toFloat(float s) { return s; }
+
+static void fromFloat(float x, int16_t &s) { s = IG::clampFromFloat<int16_t>(x, 16); }
+static void fromFloat(float x, float &s) { s = x; }
+
+void Resampler::setFormat(Format format)
+{
+	if(format.sample == sample && format.channels == channels)
+		return;
+	assumeExpr(format.sample == SampleFormats::i16 || format.sample == SampleFormats::f32);
+	sample = format.sample;
+	channels = format.channels;
+	work.reset();
+	workFrames = 0;
+}
+
+void Resampler::setQuality(ResamplerQuality q)
+{
+	if(q == quality_)
+		return;
+	quality_ = q;
+	coeff.reset();
+}
+
+void Resampler::reset()
+{
+	if(!work)
+		return;
+	iterateTimes(channels, ch)
+	{
+		std::fill_n(channelData(ch), MAX_TAPS, 0.f);
+	}
+}
+
+void Resampler::makeTable(float step)
+{
+	const auto &params = qualityParams[(uint8_t)quality_];
+	// widen the filter in proportion when decimating so the transition band stays the same
+	taps = std::min(IG::ceilMult((uint32_t)std::ceil(params.taps * step), 8u), MAX_TAPS);
+	phases = params.phases;
+	tableStep = step;
+	coeff = std::make_unique<float[]>(taps * phases);
+	const double cutoff = params.cutoff / step;
+	const double halfTaps = taps / 2;
+	const double i0Beta = besselI0(params.beta);
+	iterateTimes(phases, p)
+	{
+		auto phaseCoeff = &coeff[p * taps];
+		double frac = (double)p / phases;
+		double sum = 0;
+		iterateTimes(taps, k)
+		{
+			double d = k + 1 - halfTaps - frac;
+			double x = d / halfTaps;
+			double window = besselI0(params.beta * std::sqrt(std::max(1. - x * x, 0.))) / i0Beta;
+			double h = cutoff * sinc(cutoff * d) * window;
+			phaseCoeff[k] = h;
+			sum += h;
+		}
+		// unity gain at DC for every phase
+		iterateTimes(taps, k)
+		{
+			phaseCoeff[k] /= sum;
+		}
+	}
+	logMsg("made %u tap, %u phase filter for step:%.3f", taps, phases, step);
+}
+
+float *Resampler::channelData(uint32_t ch) const
+{
+	return &work[ch * (MAX_TAPS + workFrames)];
+}
+
+void Resampler::loadInput(const void *src, uint32_t srcFrames)
+{
+	if(srcFrames > workFrames)
+	{
+		// grow the buffer, keeping each channel's history at the start
+		auto newFrames = std::max(srcFrames, workFrames * 2);
+		auto newWork = std::make_unique<float[]>(channels * (MAX_TAPS + newFrames));
+		if(work)
+		{
+			iterateTimes(channels, ch)
+			{
+				std::copy_n(channelData(ch), MAX_TAPS, &newWork[ch * (MAX_TAPS + newFrames)]);
+			}
+		}
+		work = std::move(newWork);
+		workFrames = newFrames;
+	}
+	auto convert = [&](auto *samples)
+	{
+		iterateTimes(channels, ch)
+		{
+			auto data = channelData(ch) + MAX_TAPS;
+			iterateTimes(srcFrames, i)
+			{
+				data[i] = toFloat(samples[i * channels + ch]);
+			}
+		}
+	};
+	if(sample.isFloat())
+		convert((const float*)src);
+	else
+		convert((const int16_t*)src);
+}
+
+void Resampler::saveHistory(uint32_t srcFrames)
+{
+	iterateTimes(channels, ch)
+	{
+		auto data = channelData(ch);
+		std::memmove(data, data + srcFrames, MAX_TAPS * sizeof(float));
+	}
+}
+
+void Resampler::updateHistory(const void *src, uint32_t srcFrames)
+{
+	if(srcFrames > MAX_TAPS)
+	{
+		// only the most recent frames are needed
+		src = (const char*)src + (srcFrames - MAX_TAPS) * sample.bytes() * channels;
+		srcFrames = MAX_TAPS;
+	}
+	loadInput(src, srcFrames);
+	saveHistory(srcFrames);
+}
+
+void Resampler::delay(void *dest, uint32_t frames)
+{
+	auto process = [&](auto *out)
+	{
+		iterateTimes(channels, ch)
+		{
+			auto data = channelData(ch) + MAX_TAPS - DELAY_FRAMES;
+			iterateTimes(frames, i)
+			{
+				fromFloat(data[i], out[i * channels + ch]);
+			}
+		}
+	};
+	if(sample.isFloat())
+		process((float*)dest);
+	else
+		process((int16_t*)dest);
+}
+
+void Resampler::resample(void *dest, uint32_t destFrames, const void *src, uint32_t srcFrames)
+{
+	assumeExpr(channels);
+	if(!destFrames)
+	{
+		updateHistory(src, srcFrames);
+		return;
+	}
+	if(!srcFrames)
+	{
+		std::fill_n((char*)dest, destFrames * sample.bytes() * channels, 0);
+		return;
+	}
+	loadInput(src, srcFrames);
+	if(srcFrames == destFrames)
+	{
+		delay(dest, srcFrames);
+		saveHistory(srcFrames);
+		return;
+	}
+	float step = std::max((float)srcFrames / destFrames, 1.f);
+	if(!coeff || std::abs(step - tableStep) > tableStep * TABLE_STEP_TOLERANCE)
+	{
+		makeTable(step);
+	}
+	// 32.32 fixed point source position, output frame i is centered DELAY_FRAMES
+	// behind it regardless of the tap count so the latency never changes and
+	// the window only reads history and the current input
+	const uint64_t posStep = ((uint64_t)srcFrames << 32) / destFrames;
+	auto process = [&](auto *out)
+	{
+		iterateTimes(destFrames, i)
+		{
+			uint64_t pos = i * posStep;
+			uint32_t idx = pos >> 32;
+			uint32_t phase = ((pos & 0xFFFFFFFF) * phases) >> 32;
+			auto phaseCoeff = &coeff[phase * taps];
+			uint32_t start = MAX_TAPS - DELAY_FRAMES + idx + 1 - taps / 2;
+			iterateTimes(channels, ch)
+			{
+				fromFloat(dotProduct(channelData(ch) + start, phaseCoeff, taps), out[i * channels + ch]);
+			}
+		}
+	};
+	if(sample.isFloat())
+		process((float*)dest);
+	else
+		process((int16_t*)dest);
+	saveHistory(srcFrames);
+}
+
+}
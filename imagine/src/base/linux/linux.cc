@@ -232,6 +232,10 @@ int main(int argc, char** argv)
 	logger_init();
 	engineInit();
 	appPath = FS::makeAppPathFromLaunchCommand(argv[0]);
+	if(runHeadless)
+	{
+		return runHeadless(argc, argv);
+	}
 	auto eventLoop = EventLoop::makeForThread();
 	#ifdef CONFIG_BASE_X11
 	auto [ec, fd] = initWindowSystem(eventLoop);
@@ -15,7 +15,17 @@
 
 #define LOGTAG "ArchFS"
 #include <imagine/fs/ArchiveFS.hh>
+#include <imagine/fs/FS.hh>
+#include <imagine/io/FileIO.hh>
+#include <imagine/logger/logger.h>
 #include <imagine/util/string.h>
+#include <imagine/util/ScopeGuard.hh>
+#include <zlib.h>
+#include <algorithm>
+#include <mutex>
+#include <cstring>
+#include <climits>
+#include <new>
 
 namespace FS
 {
@@ -82,6 +92,345 @@ void ArchiveIterator::rewind()
 	impl->rewind();
 }
 
+static uint16_t readLE16(const uint8_t *p)
+{
+	return p[0] | (p[1] << 8);
+}
+
+static uint32_t readLE32(const uint8_t *p)
+{
+	return p[0] | (p[1] << 8) | (p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static uint64_t readLE64(const uint8_t *p)
+{
+	return readLE32(p) | ((uint64_t)readLE32(p + 4) << 32);
+}
+
+static bool readAll(IO &io, void *buff, size_t bytes, off_t offset)
+{
+	return io.readAtPos(buff, bytes, offset, nullptr) == (ssize_t)bytes;
+}
+
+static constexpr uint32_t ZIP_LOCAL_HEADER_SIG = 0x04034b50;
+static constexpr uint32_t ZIP_CENTRAL_HEADER_SIG = 0x02014b50;
+static constexpr uint32_t ZIP_END_SIG = 0x06054b50;
+static constexpr uint32_t ZIP64_END_SIG = 0x06064b50;
+static constexpr uint32_t ZIP64_END_LOCATOR_SIG = 0x07064b50;
+static constexpr size_t ZIP_LOCAL_HEADER_SIZE = 30;
+static constexpr size_t ZIP_CENTRAL_HEADER_SIZE = 46;
+static constexpr size_t ZIP_END_SIZE = 22;
+static constexpr uint16_t ZIP_METHOD_STORE = 0;
+static constexpr uint16_t ZIP_METHOD_DEFLATE = 8;
+// deflate can't expand data more than this, a larger size in the directory is corrupt
+static constexpr uint64_t DEFLATE_MAX_RATIO = 1032;
+
+FS::file_type ArchiveIndex::Entry::type() const
+{
+	return name.size() && name.back() == '/' ? file_type::directory : file_type::regular;
+}
+
+bool ArchiveIndex::Entry::isCompressed() const
+{
+	return method != ZIP_METHOD_STORE;
+}
+
+ArchiveIndex::ArchiveIndex(const char *path, IO &io, std::error_code &ec):
+	path{makePathString(path)}
+{
+	if(!readDirectory(io))
+	{
+		ec = {EILSEQ, std::system_category()};
+		entries_.clear();
+	}
+}
+
+bool ArchiveIndex::readDirectory(IO &io)
+{
+	// end of central directory record, followed by a comment of up to 64KB
+	off_t fileSize = io.size();
+	if(fileSize < (off_t)ZIP_END_SIZE)
+		return false;
+	size_t tailSize = std::min(fileSize, (off_t)(ZIP_END_SIZE + 0xFFFF));
+	std::vector<uint8_t> tail(tailSize);
+	off_t tailOffset = fileSize - tailSize;
+	if(!readAll(io, tail.data(), tailSize, tailOffset))
+		return false;
+	ssize_t endPos = tailSize - ZIP_END_SIZE;
+	for(; endPos >= 0; endPos--)
+	{
+		if(readLE32(&tail[endPos]) == ZIP_END_SIG)
+			break;
+	}
+	if(endPos < 0)
+		return false;
+	const uint8_t *end = &tail[endPos];
+	if(readLE16(end + 4) != readLE16(end + 6)) // multi-volume
+		return false;
+	uint64_t entryCount = readLE16(end + 10);
+	uint64_t dirSize = readLE32(end + 12);
+	uint64_t dirOffset = readLE32(end + 16);
+	if(entryCount == 0xFFFF || dirSize == 0xFFFFFFFF || dirOffset == 0xFFFFFFFF)
+	{
+		uint8_t locator[20], end64[56];
+		off_t locatorOffset = tailOffset + endPos - sizeof(locator);
+		if(locatorOffset < 0 || !readAll(io, locator, sizeof(locator), locatorOffset)
+			|| readLE32(locator) != ZIP64_END_LOCATOR_SIG
+			|| readLE64(locator + 8) > (uint64_t)fileSize
+			|| !readAll(io, end64, sizeof(end64), readLE64(locator + 8))
+			|| readLE32(end64) != ZIP64_END_SIG)
+			return false;
+		entryCount = readLE64(end64 + 32);
+		dirSize = readLE64(end64 + 40);
+		dirOffset = readLE64(end64 + 48);
+	}
+	if(dirOffset > (uint64_t)fileSize || dirSize > (uint64_t)fileSize - dirOffset
+		|| entryCount > dirSize / ZIP_CENTRAL_HEADER_SIZE)
+		return false;
+	std::vector<uint8_t> dir(dirSize);
+	if(!readAll(io, dir.data(), dirSize, dirOffset))
+		return false;
+	entries_.reserve(entryCount);
+	const uint8_t *p = dir.data(), *dirEnd = dir.data() + dirSize;
+	for(uint64_t i = 0; i < entryCount; i++)
+	{
+		if(dirEnd - p < (ssize_t)ZIP_CENTRAL_HEADER_SIZE || readLE32(p) != ZIP_CENTRAL_HEADER_SIG)
+			return false;
+		auto flags = readLE16(p + 8);
+		auto nameLen = readLE16(p + 28);
+		auto extraLen = readLE16(p + 30);
+		auto commentLen = readLE16(p + 32);
+		if(dirEnd - p < (ssize_t)(ZIP_CENTRAL_HEADER_SIZE + nameLen + extraLen + commentLen))
+			return false;
+		if(flags & 1) // encrypted
+			return false;
+		Entry e{{(const char*)p + ZIP_CENTRAL_HEADER_SIZE, nameLen},
+			readLE32(p + 42), readLE32(p + 20), readLE32(p + 24), readLE32(p + 16), readLE16(p + 10)};
+		// zip64 extended info replaces the fields that are saturated
+		const uint8_t *extra = p + ZIP_CENTRAL_HEADER_SIZE + nameLen, *extraEnd = extra + extraLen;
+		while(extraEnd - extra >= 4)
+		{
+			auto id = readLE16(extra);
+			const uint8_t *field = extra + 4, *fieldEnd = field + readLE16(extra + 2);
+			if(fieldEnd > extraEnd)
+				break;
+			if(id == 0x0001)
+			{
+				for(auto member : {&e.size, &e.compressedSize, &e.headerOffset})
+				{
+					if(*member != 0xFFFFFFFF)
+						continue;
+					if(fieldEnd - field < 8)
+						return false;
+					*member = readLE64(field);
+					field += 8;
+				}
+			}
+			extra = fieldEnd;
+		}
+		if(e.headerOffset >= (uint64_t)fileSize)
+			return false;
+		entries_.emplace_back(std::move(e));
+		p += ZIP_CENTRAL_HEADER_SIZE + nameLen + extraLen + commentLen;
+	}
+	return true;
+}
+
+const ArchiveIndex::Entry *ArchiveIndex::find(const char *name) const
+{
+	for(auto &e : entries_)
+	{
+		if(e.name == name)
+			return &e;
+	}
+	return nullptr;
+}
+
+const ArchiveIndex::Entry *ArchiveIndex::findCRC(uint32_t crc) const
+{
+	for(auto &e : entries_)
+	{
+		if(e.crc32 == crc && e.type() == file_type::regular)
+			return &e;
+	}
+	return nullptr;
+}
+
+BufferMapIO ArchiveIndex::open(const Entry &entry, std::error_code *ecOut) const
+{
+	auto setError = [&](int err){ if(ecOut) *ecOut = {err, std::system_category()}; };
+	if((entry.method != ZIP_METHOD_STORE && entry.method != ZIP_METHOD_DEFLATE)
+		|| entry.size > SIZE_MAX || entry.compressedSize > SIZE_MAX)
+	{
+		setError(ENOTSUP);
+		return {};
+	}
+	FileIO file;
+	if(auto ec = file.open(path.data(), IO::AccessHint::RANDOM);
+		ec)
+	{
+		if(ecOut)
+			*ecOut = ec;
+		return {};
+	}
+	uint8_t header[ZIP_LOCAL_HEADER_SIZE];
+	if(!readAll(file, header, sizeof(header), entry.headerOffset)
+		|| readLE32(header) != ZIP_LOCAL_HEADER_SIG)
+	{
+		setError(EILSEQ);
+		return {};
+	}
+	// the sizes come from the archive, check them without overflowing
+	// before using them for the mapped view or allocating for them
+	uint64_t fileSize = file.size();
+	uint64_t dataOffset = entry.headerOffset + ZIP_LOCAL_HEADER_SIZE + readLE16(header + 26) + readLE16(header + 28);
+	if(dataOffset > fileSize || entry.compressedSize > fileSize - dataOffset)
+	{
+		setError(EILSEQ);
+		return {};
+	}
+	if(entry.method == ZIP_METHOD_STORE ? entry.compressedSize != entry.size
+		: entry.size / DEFLATE_MAX_RATIO > entry.compressedSize)
+	{
+		setError(EILSEQ);
+		return {};
+	}
+	auto fileMap = (const uint8_t*)file.mmapConst();
+	BufferMapIO io{};
+	if(entry.method == ZIP_METHOD_STORE && fileMap)
+	{
+		// not checked against its CRC32, that would read the whole entry up front
+		// and lose the lazy paging, it's trusted like a plain file would be.
+		// Keep the archive mapped for as long as the view
+		auto mapIO = new GenericIO{file.makeGeneric()};
+		io.open(fileMap + dataOffset, entry.size,
+			[mapIO](BufferMapIO &){ delete mapIO; });
+		return io;
+	}
+	auto data = new (std::nothrow) uint8_t[entry.size];
+	if(!data)
+	{
+		setError(ENOMEM);
+		return {};
+	}
+	auto freeData = IG::scopeGuard([&](){ delete[] data; });
+	if(entry.method == ZIP_METHOD_STORE)
+	{
+		if(!readAll(file, data, entry.size, dataOffset))
+		{
+			setError(EIO);
+			return {};
+		}
+	}
+	else
+	{
+		std::vector<uint8_t> readBuff;
+		const uint8_t *src = fileMap ? fileMap + dataOffset : nullptr;
+		if(!src)
+		{
+			readBuff.resize(entry.compressedSize);
+			if(!readAll(file, readBuff.data(), readBuff.size(), dataOffset))
+			{
+				setError(EIO);
+				return {};
+			}
+			src = readBuff.data();
+		}
+		z_stream strm{};
+		if(inflateInit2(&strm, -MAX_WBITS) != Z_OK)
+		{
+			setError(ENOMEM);
+			return {};
+		}
+		// zlib counts in uInt, feed larger entries in pieces
+		uint64_t inLeft = entry.compressedSize, outLeft = entry.size;
+		strm.next_in = (Bytef*)src;
+		strm.next_out = data;
+		int result;
+		do
+		{
+			auto inChunk = (uInt)std::min(inLeft, (uint64_t)UINT_MAX);
+			auto outChunk = (uInt)std::min(outLeft, (uint64_t)UINT_MAX);
+			strm.avail_in = inChunk;
+			strm.avail_out = outChunk;
+			result = inflate(&strm, Z_NO_FLUSH);
+			inLeft -= inChunk - strm.avail_in;
+			outLeft -= outChunk - strm.avail_out;
+		} while(result == Z_OK);
+		inflateEnd(&strm);
+		if(result != Z_STREAM_END || outLeft)
+		{
+			logErr("error inflating:%s", entry.name.c_str());
+			setError(EILSEQ);
+			return {};
+		}
+	}
+	uLong crc = ::crc32(0, nullptr, 0);
+	for(uint64_t pos = 0; pos < entry.size;)
+	{
+		auto chunk = std::min(entry.size - pos, (uint64_t)UINT_MAX);
+		crc = ::crc32(crc, data + pos, chunk);
+		pos += chunk;
+	}
+	if(crc != entry.crc32)
+	{
+		logErr("CRC32 mismatch in:%s", entry.name.c_str());
+		setError(EILSEQ);
+		return {};
+	}
+	freeData.cancel();
+	io.open(data, entry.size, [data](BufferMapIO &){ delete[] data; });
+	return io;
+}
+
+std::shared_ptr<const ArchiveIndex> archiveIndex(const char *path)
+{
+	struct CachedIndex
+	{
+		PathString path;
+		file_time_type lastWriteTime;
+		std::uintmax_t size;
+		std::shared_ptr<const ArchiveIndex> index;
+	};
+	static constexpr size_t MAX_CACHED = 8;
+	static std::mutex cacheMutex;
+	static std::vector<CachedIndex> cache;
+	std::error_code ec{};
+	auto fileStatus = status(path, ec);
+	if(ec)
+		return {};
+	{
+		std::lock_guard<std::mutex> lock{cacheMutex};
+		auto it = std::find_if(cache.begin(), cache.end(),
+			[&](const CachedIndex &c){ return string_equal(c.path.data(), path); });
+		if(it != cache.end())
+		{
+			if(it->lastWriteTime == fileStatus.lastWriteTime() && it->size == fileStatus.size())
+			{
+				// keep the most recently used at the back
+				std::rotate(it, it + 1, cache.end());
+				return cache.back().index;
+			}
+			cache.erase(it);
+		}
+	}
+	FileIO file;
+	if(file.open(path, IO::AccessHint::RANDOM))
+		return {};
+	auto index = std::make_shared<const ArchiveIndex>(path, file, ec);
+	if(ec)
+	{
+		logMsg("no central directory index for:%s", path);
+		return {};
+	}
+	logMsg("indexed %zu entries in:%s", index->entries().size(), path);
+	std::lock_guard<std::mutex> lock{cacheMutex};
+	if(cache.size() == MAX_CACHED)
+		cache.erase(cache.begin());
+	cache.push_back({makePathString(path), fileStatus.lastWriteTime(), fileStatus.size(), index});
+	return index;
+}
+
 ArchiveIO fileFromArchive(const char *archivePath, const char *filePath)
 {
 	for(auto &entry : FS::ArchiveIterator{archivePath})
@@ -0,0 +1,385 @@
+/*  This file is part of Imagine.
+
+	Imagine is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	Imagine is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with Imagine.  If not, see <http://www.gnu.org/licenses/> */
+
+#define LOGTAG "Pixmap"
+#include <imagine/pixmap/Pixmap.hh>
+#include <imagine/logger/logger.h>
+#include <imagine/util/algorithm.h>
+#include <imagine/util/container/array.hh>
+#include "simd.hh"
+
+// Pixel format conversion. Results must stay bit-exact with the original division based
+// formulas, which the scalar paths get from lookup tables and the SIMD paths from these
+// equivalent multiply & shift forms (checked over every input value):
+//   (c5 * 255 + 15) / 31 == (c5 * 527 + 23) >> 6
+//   (c6 * 255 + 31) / 63 == (c6 * 259 + 33) >> 6
+//   (r * 62 + 255) / 510 == div255(r * 31 + 127)
+//   (g * 63 + 127) / 255 == div255(g * 63 + 127)
+//   (b * 31 + 127) / 255 == div255(b * 31 + 127)
+// with div255(t) = (t + 1 + (t >> 8)) >> 8 for t < 2^14.
+// The 3-byte RGB888 formats only use the tables since they don't map onto vector lanes.
+
+namespace IG
+{
+
+template<unsigned BITS>
+static constexpr std::array<uint8_t, 1 << BITS> makeExpandTable()
+{
+	constexpr unsigned max = (1 << BITS) - 1;
+	std::array<uint8_t, 1 << BITS> table{};
+	for(unsigned i = 0; i < table.size(); i++)
+	{
+		table[i] = (i * 255 + max / 2) / max;
+	}
+	return table;
+}
+
+static constexpr auto expand5 = makeExpandTable<5>();
+static constexpr auto expand6 = makeExpandTable<6>();
+
+// 8-bit channel values already shifted into their RGB565 position
+static constexpr auto reduceR = []()
+{
+	std::array<uint16_t, 256> table{};
+	for(unsigned i = 0; i < 256; i++) { table[i] = ((i * (31 * 2) + 255) / (255 * 2)) << 11; }
+	return table;
+}();
+static constexpr auto reduceG = []()
+{
+	std::array<uint16_t, 256> table{};
+	for(unsigned i = 0; i < 256; i++) { table[i] = ((i * 63 + 127) / 255) << 5; }
+	return table;
+}();
+static constexpr auto reduceB = []()
+{
+	std::array<uint16_t, 256> table{};
+	for(unsigned i = 0; i < 256; i++) { table[i] = (i * 31 + 127) / 255; }
+	return table;
+}();
+
+static uint16_t toRGB565(unsigned r, unsigned g, unsigned b)
+{
+	return reduceR[r] | reduceG[g] | reduceB[b];
+}
+
+static void rgbx8888ToRGB565Scalar(const uint32_t *src, uint16_t *dest, uint32_t pixels)
+{
+	iterateTimes(pixels, i)
+	{
+		auto p = src[i];
+		dest[i] = toRGB565(p & 0xFF, p >> 8 & 0xFF, p >> 16 & 0xFF);
+	}
+}
+
+static void rgb565ToRGBX8888Scalar(const uint16_t *src, uint32_t *dest, uint32_t pixels)
+{
+	iterateTimes(pixels, i)
+	{
+		auto p = src[i];
+		dest[i] = expand5[p >> 11] << 16 |
+			expand6[p >> 5 & 0x3F] << 8 |
+			expand5[p & 0x1F];
+	}
+}
+
+#ifdef __SSE2__
+static __m128i div255SSE2(__m128i t)
+{
+	return _mm_srli_epi16(_mm_add_epi16(_mm_add_epi16(t, _mm_set1_epi16(1)), _mm_srli_epi16(t, 8)), 8);
+}
+
+// 8-bit channels in 16-bit lanes to RGB565
+static __m128i reduceToRGB565SSE2(__m128i r, __m128i g, __m128i b)
+{
+	r = div255SSE2(_mm_add_epi16(_mm_mullo_epi16(r, _mm_set1_epi16(31)), _mm_set1_epi16(127)));
+	g = div255SSE2(_mm_add_epi16(_mm_mullo_epi16(g, _mm_set1_epi16(63)), _mm_set1_epi16(127)));
+	b = div255SSE2(_mm_add_epi16(_mm_mullo_epi16(b, _mm_set1_epi16(31)), _mm_set1_epi16(127)));
+	return _mm_or_si128(_mm_or_si128(_mm_slli_epi16(r, 11), _mm_slli_epi16(g, 5)), b);
+}
+
+static void rgbx8888ToRGB565SSE2(const uint32_t *src, uint16_t *dest, uint32_t pixels)
+{
+	const auto mask = _mm_set1_epi32(0xFF);
+	uint32_t i = 0;
+	for(; i + 8 <= pixels; i += 8)
+	{
+		auto lo = _mm_loadu_si128((const __m128i*)(src + i));
+		auto hi = _mm_loadu_si128((const __m128i*)(src + i + 4));
+		// channels are at most 255 so the signed saturating pack keeps them intact
+		auto r = _mm_packs_epi32(_mm_and_si128(lo, mask), _mm_and_si128(hi, mask));
+		auto g = _mm_packs_epi32(_mm_and_si128(_mm_srli_epi32(lo, 8), mask), _mm_and_si128(_mm_srli_epi32(hi, 8), mask));
+		auto b = _mm_packs_epi32(_mm_and_si128(_mm_srli_epi32(lo, 16), mask), _mm_and_si128(_mm_srli_epi32(hi, 16), mask));
+		_mm_storeu_si128((__m128i*)(dest + i), reduceToRGB565SSE2(r, g, b));
+	}
+	rgbx8888ToRGB565Scalar(src + i, dest + i, pixels - i);
+}
+
+static void rgb565ToRGBX8888SSE2(const uint16_t *src, uint32_t *dest, uint32_t pixels)
+{
+	uint32_t i = 0;
+	for(; i + 8 <= pixels; i += 8)
+	{
+		auto p = _mm_loadu_si128((const __m128i*)(src + i));
+		auto r = _mm_srli_epi16(p, 11);
+		auto g = _mm_and_si128(_mm_srli_epi16(p, 5), _mm_set1_epi16(0x3F));
+		auto b = _mm_and_si128(p, _mm_set1_epi16(0x1F));
+		r = _mm_srli_epi16(_mm_add_epi16(_mm_mullo_epi16(r, _mm_set1_epi16(527)), _mm_set1_epi16(23)), 6);
+		g = _mm_srli_epi16(_mm_add_epi16(_mm_mullo_epi16(g, _mm_set1_epi16(259)), _mm_set1_epi16(33)), 6);
+		b = _mm_srli_epi16(_mm_add_epi16(_mm_mullo_epi16(b, _mm_set1_epi16(527)), _mm_set1_epi16(23)), 6);
+		// interleaving the g|b words with the r words forms the 32-bit pixels
+		auto gb = _mm_or_si128(_mm_slli_epi16(g, 8), b);
+		_mm_storeu_si128((__m128i*)(dest + i), _mm_unpacklo_epi16(gb, r));
+		_mm_storeu_si128((__m128i*)(dest + i + 4), _mm_unpackhi_epi16(gb, r));
+	}
+	rgb565ToRGBX8888Scalar(src + i, dest + i, pixels - i);
+}
+#endif
+
+#ifdef IG_PIXMAP_X86_SIMD
+IG_TARGET_AVX2
+static __m256i div255AVX2(__m256i t)
+{
+	return _mm256_srli_epi16(_mm256_add_epi16(_mm256_add_epi16(t, _mm256_set1_epi16(1)), _mm256_srli_epi16(t, 8)), 8);
+}
+
+IG_TARGET_AVX2
+static void rgbx8888ToRGB565AVX2(const uint32_t *src, uint16_t *dest, uint32_t pixels)
+{
+	const auto mask = _mm256_set1_epi32(0xFF);
+	uint32_t i = 0;
+	for(; i + 16 <= pixels; i += 16)
+	{
+		auto lo = _mm256_loadu_si256((const __m256i*)(src + i));
+		auto hi = _mm256_loadu_si256((const __m256i*)(src + i + 8));
+		auto r = _mm256_packs_epi32(_mm256_and_si256(lo, mask), _mm256_and_si256(hi, mask));
+		auto g = _mm256_packs_epi32(_mm256_and_si256(_mm256_srli_epi32(lo, 8), mask), _mm256_and_si256(_mm256_srli_epi32(hi, 8), mask));
+		auto b = _mm256_packs_epi32(_mm256_and_si256(_mm256_srli_epi32(lo, 16), mask), _mm256_and_si256(_mm256_srli_epi32(hi, 16), mask));
+		r = div255AVX2(_mm256_add_epi16(_mm256_mullo_epi16(r, _mm256_set1_epi16(31)), _mm256_set1_epi16(127)));
+		g = div255AVX2(_mm256_add_epi16(_mm256_mullo_epi16(g, _mm256_set1_epi16(63)), _mm256_set1_epi16(127)));
+		b = div255AVX2(_mm256_add_epi16(_mm256_mullo_epi16(b, _mm256_set1_epi16(31)), _mm256_set1_epi16(127)));
+		auto px = _mm256_or_si256(_mm256_or_si256(_mm256_slli_epi16(r, 11), _mm256_slli_epi16(g, 5)), b);
+		// packing works within 128-bit lanes, reorder the 64-bit halves afterwards
+		_mm256_storeu_si256((__m256i*)(dest + i), _mm256_permute4x64_epi64(px, 0xD8));
+	}
+	rgbx8888ToRGB565Scalar(src + i, dest + i, pixels - i);
+}
+
+IG_TARGET_AVX2
+static void rgb565ToRGBX8888AVX2(const uint16_t *src, uint32_t *dest, uint32_t pixels)
+{
+	uint32_t i = 0;
+	for(; i + 16 <= pixels; i += 16)
+	{
+		auto p = _mm256_loadu_si256((const __m256i*)(src + i));
+		auto r = _mm256_srli_epi16(p, 11);
+		auto g = _mm256_and_si256(_mm256_srli_epi16(p, 5), _mm256_set1_epi16(0x3F));
+		auto b = _mm256_and_si256(p, _mm256_set1_epi16(0x1F));
+		r = _mm256_srli_epi16(_mm256_add_epi16(_mm256_mullo_epi16(r, _mm256_set1_epi16(527)), _mm256_set1_epi16(23)), 6);
+		g = _mm256_srli_epi16(_mm256_add_epi16(_mm256_mullo_epi16(g, _mm256_set1_epi16(259)), _mm256_set1_epi16(33)), 6);
+		b = _mm256_srli_epi16(_mm256_add_epi16(_mm256_mullo_epi16(b, _mm256_set1_epi16(527)), _mm256_set1_epi16(23)), 6);
+		auto gb = _mm256_or_si256(_mm256_slli_epi16(g, 8), b);
+		// unpacking works within 128-bit lanes, so each half holds pixels 0-3 & 8-11 or 4-7 & 12-15
+		auto lo = _mm256_unpacklo_epi16(gb, r);
+		auto hi = _mm256_unpackhi_epi16(gb, r);
+		_mm256_storeu_si256((__m256i*)(dest + i), _mm256_permute2x128_si256(lo, hi, 0x20));
+		_mm256_storeu_si256((__m256i*)(dest + i + 8), _mm256_permute2x128_si256(lo, hi, 0x31));
+	}
+	rgb565ToRGBX8888Scalar(src + i, dest + i, pixels - i);
+}
+#endif
+
+#ifdef IG_PIXMAP_NEON
+static uint16x8_t div255NEON(uint16x8_t t)
+{
+	return vshrq_n_u16(vaddq_u16(vaddq_u16(t, vdupq_n_u16(1)), vshrq_n_u16(t, 8)), 8);
+}
+
+static uint16x8_t reduceToRGB565NEON(uint8x8_t r, uint8x8_t g, uint8x8_t b)
+{
+	const auto bias = vdupq_n_u16(127);
+	auto r5 = div255NEON(vmlal_u8(bias, r, vdup_n_u8(31)));
+	auto g6 = div255NEON(vmlal_u8(bias, g, vdup_n_u8(63)));
+	auto b5 = div255NEON(vmlal_u8(bias, b, vdup_n_u8(31)));
+	return vorrq_u16(vorrq_u16(vshlq_n_u16(r5, 11), vshlq_n_u16(g6, 5)), b5);
+}
+
+static void rgbx8888ToRGB565NEON(const uint32_t *src, uint16_t *dest, uint32_t pixels)
+{
+	uint32_t i = 0;
+	for(; i + 16 <= pixels; i += 16)
+	{
+		// de-interleaving load splits the pixels into r, g, b, x byte planes
+		auto p = vld4q_u8((const uint8_t*)(src + i));
+		vst1q_u16(dest + i, reduceToRGB565NEON(vget_low_u8(p.val[0]), vget_low_u8(p.val[1]), vget_low_u8(p.val[2])));
+		vst1q_u16(dest + i + 8, reduceToRGB565NEON(vget_high_u8(p.val[0]), vget_high_u8(p.val[1]), vget_high_u8(p.val[2])));
+	}
+	rgbx8888ToRGB565Scalar(src + i, dest + i, pixels - i);
+}
+
+static void rgb565ToRGBX8888NEON(const uint16_t *src, uint32_t *dest, uint32_t pixels)
+{
+	uint32_t i = 0;
+	for(; i + 8 <= pixels; i += 8)
+	{
+		auto p = vld1q_u16(src + i);
+		auto r = vshrq_n_u16(p, 11);
+		auto g = vandq_u16(vshrq_n_u16(p, 5), vdupq_n_u16(0x3F));
+		auto b = vandq_u16(p, vdupq_n_u16(0x1F));
+		r = vshrq_n_u16(vaddq_u16(vmulq_n_u16(r, 527), vdupq_n_u16(23)), 6);
+		g = vshrq_n_u16(vaddq_u16(vmulq_n_u16(g, 259), vdupq_n_u16(33)), 6);
+		b = vshrq_n_u16(vaddq_u16(vmulq_n_u16(b, 527), vdupq_n_u16(23)), 6);
+		// little-endian pixels are stored as b, g, r, x bytes
+		vst4_u8((uint8_t*)(dest + i), (uint8x8x4_t{{vmovn_u16(b), vmovn_u16(g), vmovn_u16(r), vdup_n_u8(0)}}));
+	}
+	rgb565ToRGBX8888Scalar(src + i, dest + i, pixels - i);
+}
+#endif
+
+static void convertRGB888ToRGBX8888(Pixmap dest, Pixmap src)
+{
+	dest.writeTransformedDirect<ByteArray<3>, uint32_t>(
+		[](auto p)
+		{
+			return p[0] << 16 |
+					p[1] << 8 |
+					p[2];
+		}, src);
+}
+
+static void convertRGB565ToRGBX8888(Pixmap dest, Pixmap src)
+{
+	#ifdef IG_PIXMAP_X86_SIMD
+	if(cpuHasAVX2())
+	{
+		transformLines<uint16_t, uint32_t>(dest, src, rgb565ToRGBX8888AVX2);
+		return;
+	}
+	#endif
+	#if defined IG_PIXMAP_NEON
+	transformLines<uint16_t, uint32_t>(dest, src, rgb565ToRGBX8888NEON);
+	#elif defined __SSE2__
+	transformLines<uint16_t, uint32_t>(dest, src, rgb565ToRGBX8888SSE2);
+	#else
+	transformLines<uint16_t, uint32_t>(dest, src, rgb565ToRGBX8888Scalar);
+	#endif
+}
+
+static void convertRGBX8888ToRGB888(Pixmap dest, Pixmap src)
+{
+	dest.writeTransformedDirect<uint32_t, ByteArray<3>>(
+		[](auto p)
+		{
+			unsigned r = p       & 0xFF;
+			unsigned g = p >>  8 & 0xFF;
+			unsigned b = p >> 16 & 0xFF;
+			return ByteArray<3>
+				{
+					(uint8_t)r,
+					(uint8_t)g,
+					(uint8_t)b
+				};
+		}, src);
+}
+
+static void convertRGB565ToRGB888(Pixmap dest, Pixmap src)
+{
+	dest.writeTransformedDirect<uint16_t, ByteArray<3>>(
+		[](auto p)
+		{
+			return ByteArray<3>
+				{
+					expand5[p >> 11],
+					expand6[p >> 5 & 0x3F],
+					expand5[p & 0x1F]
+				};
+		}, src);
+}
+
+static void convertRGB888ToRGB565(Pixmap dest, Pixmap src)
+{
+	dest.writeTransformedDirect<ByteArray<3>, uint16_t>(
+		[](ByteArray<3> p)
+		{
+			return toRGB565(p[0], p[1], p[2]);
+		}, src);
+}
+
+static void convertRGBX8888ToRGB565(Pixmap dest, Pixmap src)
+{
+	#ifdef IG_PIXMAP_X86_SIMD
+	if(cpuHasAVX2())
+	{
+		transformLines<uint32_t, uint16_t>(dest, src, rgbx8888ToRGB565AVX2);
+		return;
+	}
+	#endif
+	#if defined IG_PIXMAP_NEON
+	transformLines<uint32_t, uint16_t>(dest, src, rgbx8888ToRGB565NEON);
+	#elif defined __SSE2__
+	transformLines<uint32_t, uint16_t>(dest, src, rgbx8888ToRGB565SSE2);
+	#else
+	transformLines<uint32_t, uint16_t>(dest, src, rgbx8888ToRGB565Scalar);
+	#endif
+}
+
+static void invalidFormatConversion(Pixmap dest, Pixmap src)
+{
+	logErr("unimplemented conversion:%s -> %s", src.format().name(), dest.format().name());
+}
+
+void Pixmap::writeConverted(Pixmap pixmap)
+{
+	if(format() == pixmap.format())
+	{
+		write(pixmap);
+		return;
+	}
+	auto srcFormatID = pixmap.format().id();
+	switch(format().id())
+	{
+		bcase PIXEL_RGBX8888:
+			switch(srcFormatID)
+			{
+				bcase PIXEL_RGB888: convertRGB888ToRGBX8888(*this, pixmap);
+				bcase PIXEL_RGB565: convertRGB565ToRGBX8888(*this, pixmap);
+				bdefault: invalidFormatConversion(*this, pixmap);
+			}
+		bcase PIXEL_RGB888:
+			switch(srcFormatID)
+			{
+				bcase PIXEL_RGBX8888: convertRGBX8888ToRGB888(*this, pixmap);
+				bcase PIXEL_RGBA8888: convertRGBX8888ToRGB888(*this, pixmap);
+				bcase PIXEL_RGB565: convertRGB565ToRGB888(*this, pixmap);
+				bdefault: invalidFormatConversion(*this, pixmap);
+			}
+		bcase PIXEL_RGB565:
+			switch(srcFormatID)
+			{
+				bcase PIXEL_RGB888: convertRGB888ToRGB565(*this, pixmap);
+				bcase PIXEL_RGBX8888: convertRGBX8888ToRGB565(*this, pixmap);
+				bcase PIXEL_RGBA8888: convertRGBX8888ToRGB565(*this, pixmap);
+				bdefault: invalidFormatConversion(*this, pixmap);
+			}
+		bdefault:
+			invalidFormatConversion(*this, pixmap);
+	}
+}
+
+void Pixmap::writeConverted(Pixmap pixmap, WP destPos)
+{
+	subView(destPos, size() - destPos).writeConverted(pixmap);
+}
+
+}
@@ -0,0 +1,234 @@
+/*  This file is part of Imagine.
+
+	Imagine is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	Imagine is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with Imagine.  If not, see <http://www.gnu.org/licenses/> */
+
+#include <imagine/pixmap/Pixmap.hh>
+#include <imagine/util/algorithm.h>
+#include "simd.hh"
+#include <algorithm>
+
+// Expansion of 8-bit palette indices into 16/32-bit pixels. x86 has no byte-indexed
+// table lookup wider than 16 entries, so SSE2 assembles each vector from scalar loads
+// and AVX2 uses 32-bit gathers. AArch64 NEON keeps the palette in registers as byte
+// planes and looks up 16 pixels per plane with 4 chained 64-byte table lookups.
+
+namespace IG
+{
+
+template<class Dest>
+static void expandScalar(const uint8_t *src, Dest *dest, uint32_t pixels, const Dest *palette)
+{
+	iterateTimes(pixels, i)
+	{
+		dest[i] = palette[src[i]];
+	}
+}
+
+#ifdef __SSE2__
+static void expandSSE2(const uint8_t *src, uint16_t *dest, uint32_t pixels, const uint16_t *palette)
+{
+	uint32_t i = 0;
+	for(; i + 8 <= pixels; i += 8)
+	{
+		auto s = src + i;
+		auto px = _mm_setr_epi16(palette[s[0]], palette[s[1]], palette[s[2]], palette[s[3]],
+			palette[s[4]], palette[s[5]], palette[s[6]], palette[s[7]]);
+		_mm_storeu_si128((__m128i*)(dest + i), px);
+	}
+	expandScalar(src + i, dest + i, pixels - i, palette);
+}
+
+static void expandSSE2(const uint8_t *src, uint32_t *dest, uint32_t pixels, const uint32_t *palette)
+{
+	uint32_t i = 0;
+	for(; i + 4 <= pixels; i += 4)
+	{
+		auto s = src + i;
+		auto px = _mm_setr_epi32(palette[s[0]], palette[s[1]], palette[s[2]], palette[s[3]]);
+		_mm_storeu_si128((__m128i*)(dest + i), px);
+	}
+	expandScalar(src + i, dest + i, pixels - i, palette);
+}
+#endif
+
+#ifdef IG_PIXMAP_X86_SIMD
+// palette32 holds the 16-bit entries zero-extended so gathers never read past the end
+IG_TARGET_AVX2
+static void expandAVX2(const uint8_t *src, uint16_t *dest, uint32_t pixels, const uint32_t *palette32)
+{
+	uint32_t i = 0;
+	for(; i + 16 <= pixels; i += 16)
+	{
+		auto idx = _mm_loadu_si128((const __m128i*)(src + i));
+		auto lo = _mm256_i32gather_epi32((const int*)palette32, _mm256_cvtepu8_epi32(idx), 4);
+		auto hi = _mm256_i32gather_epi32((const int*)palette32, _mm256_cvtepu8_epi32(_mm_srli_si128(idx, 8)), 4);
+		// packing works within 128-bit lanes, reorder the 64-bit halves afterwards
+		auto px = _mm256_permute4x64_epi64(_mm256_packus_epi32(lo, hi), 0xD8);
+		_mm256_storeu_si256((__m256i*)(dest + i), px);
+	}
+	for(; i < pixels; i++)
+	{
+		dest[i] = palette32[src[i]];
+	}
+}
+
+IG_TARGET_AVX2
+static void expandAVX2(const uint8_t *src, uint32_t *dest, uint32_t pixels, const uint32_t *palette)
+{
+	uint32_t i = 0;
+	for(; i + 8 <= pixels; i += 8)
+	{
+		auto idx = _mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i*)(src + i)));
+		_mm256_storeu_si256((__m256i*)(dest + i), _mm256_i32gather_epi32((const int*)palette, idx, 4));
+	}
+	expandScalar(src + i, dest + i, pixels - i, palette);
+}
+#endif
+
+#ifdef IG_PIXMAP_NEON
+// one byte of every palette entry, as 4 tables of 64 entries
+struct NeonPalettePlane
+{
+	uint8x16x4_t table[4];
+
+	template<class Entry>
+	NeonPalettePlane(const Entry *palette, uint32_t byteIdx)
+	{
+		uint8_t bytes[256];
+		iterateTimes(256, i)
+		{
+			bytes[i] = palette[i] >> (byteIdx * 8);
+		}
+		iterateTimes(4, t)
+		{
+			iterateTimes(4, v)
+			{
+				table[t].val[v] = vld1q_u8(&bytes[t * 64 + v * 16]);
+			}
+		}
+	}
+
+	uint8x16_t lookup(uint8x16_t idx) const
+	{
+		// out of range indices give 0 with tbl and leave the existing byte with tbx,
+		// and subtracting wraps indices of earlier tables out of range
+		auto r = vqtbl4q_u8(table[0], idx);
+		r = vqtbx4q_u8(r, table[1], vsubq_u8(idx, vdupq_n_u8(64)));
+		r = vqtbx4q_u8(r, table[2], vsubq_u8(idx, vdupq_n_u8(128)));
+		return vqtbx4q_u8(r, table[3], vsubq_u8(idx, vdupq_n_u8(192)));
+	}
+};
+
+struct NeonPalette16
+{
+	NeonPalettePlane plane[2];
+
+	NeonPalette16(const uint16_t *palette):
+		plane{{palette, 0}, {palette, 1}} {}
+};
+
+struct NeonPalette32
+{
+	NeonPalettePlane plane[4];
+
+	NeonPalette32(const uint32_t *palette):
+		plane{{palette, 0}, {palette, 1}, {palette, 2}, {palette, 3}} {}
+};
+
+static void expandNEON(const uint8_t *src, uint16_t *dest, uint32_t pixels,
+	const NeonPalette16 &table, const uint16_t *palette)
+{
+	uint32_t i = 0;
+	for(; i + 16 <= pixels; i += 16)
+	{
+		auto idx = vld1q_u8(src + i);
+		// interleaving store writes the low & high byte planes as little-endian pixels
+		vst2q_u8((uint8_t*)(dest + i), (uint8x16x2_t{{table.plane[0].lookup(idx), table.plane[1].lookup(idx)}}));
+	}
+	expandScalar(src + i, dest + i, pixels - i, palette);
+}
+
+static void expandNEON(const uint8_t *src, uint32_t *dest, uint32_t pixels,
+	const NeonPalette32 &table, const uint32_t *palette)
+{
+	uint32_t i = 0;
+	for(; i + 16 <= pixels; i += 16)
+	{
+		auto idx = vld1q_u8(src + i);
+		vst4q_u8((uint8_t*)(dest + i), (uint8x16x4_t{{table.plane[0].lookup(idx), table.plane[1].lookup(idx),
+			table.plane[2].lookup(idx), table.plane[3].lookup(idx)}}));
+	}
+	expandScalar(src + i, dest + i, pixels - i, palette);
+}
+#endif
+
+void Pixmap::writePaletted(Pixmap pixmap, const uint16_t *palette)
+{
+	#ifdef IG_PIXMAP_X86_SIMD
+	if(cpuHasAVX2())
+	{
+		uint32_t palette32[256];
+		std::copy_n(palette, 256, palette32);
+		transformLines<uint8_t, uint16_t>(*this, pixmap,
+			[&](const uint8_t *src, uint16_t *dest, uint32_t pixels){ expandAVX2(src, dest, pixels, palette32); });
+		return;
+	}
+	#endif
+	#if defined IG_PIXMAP_NEON
+	NeonPalette16 table{palette};
+	transformLines<uint8_t, uint16_t>(*this, pixmap,
+		[&](const uint8_t *src, uint16_t *dest, uint32_t pixels){ expandNEON(src, dest, pixels, table, palette); });
+	#elif defined __SSE2__
+	transformLines<uint8_t, uint16_t>(*this, pixmap,
+		[&](const uint8_t *src, uint16_t *dest, uint32_t pixels){ expandSSE2(src, dest, pixels, palette); });
+	#else
+	transformLines<uint8_t, uint16_t>(*this, pixmap,
+		[&](const uint8_t *src, uint16_t *dest, uint32_t pixels){ expandScalar(src, dest, pixels, palette); });
+	#endif
+}
+
+void Pixmap::writePaletted(Pixmap pixmap, const uint32_t *palette)
+{
+	#ifdef IG_PIXMAP_X86_SIMD
+	if(cpuHasAVX2())
+	{
+		transformLines<uint8_t, uint32_t>(*this, pixmap,
+			[&](const uint8_t *src, uint32_t *dest, uint32_t pixels){ expandAVX2(src, dest, pixels, palette); });
+		return;
+	}
+	#endif
+	#if defined IG_PIXMAP_NEON
+	NeonPalette32 table{palette};
+	transformLines<uint8_t, uint32_t>(*this, pixmap,
+		[&](const uint8_t *src, uint32_t *dest, uint32_t pixels){ expandNEON(src, dest, pixels, table, palette); });
+	#elif defined __SSE2__
+	transformLines<uint8_t, uint32_t>(*this, pixmap,
+		[&](const uint8_t *src, uint32_t *dest, uint32_t pixels){ expandSSE2(src, dest, pixels, palette); });
+	#else
+	transformLines<uint8_t, uint32_t>(*this, pixmap,
+		[&](const uint8_t *src, uint32_t *dest, uint32_t pixels){ expandScalar(src, dest, pixels, palette); });
+	#endif
+}
+
+void Pixmap::writePaletted(Pixmap pixmap, const uint16_t *palette, WP destPos)
+{
+	subView(destPos, size() - destPos).writePaletted(pixmap, palette);
+}
+
+void Pixmap::writePaletted(Pixmap pixmap, const uint32_t *palette, WP destPos)
+{
+	subView(destPos, size() - destPos).writePaletted(pixmap, palette);
+}
+
+}
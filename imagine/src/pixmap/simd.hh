@@ -0,0 +1,70 @@
+#pragma once
+
+/*  This file is part of Imagine.
+
+	Imagine is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	Imagine is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with Imagine.  If not, see <http://www.gnu.org/licenses/> */
+
+#include <imagine/pixmap/Pixmap.hh>
+
+// SIMD helpers shared by the pixmap conversion kernels. SSE2 and NEON paths are picked
+// at compile time from the target's baseline, AVX2 ones at runtime since x86_64 builds
+// don't assume it.
+
+#if defined __x86_64__ || defined __i386__
+#include <immintrin.h>
+#define IG_PIXMAP_X86_SIMD
+#define IG_TARGET_AVX2 [[gnu::target("avx2")]]
+#endif
+
+#if defined __aarch64__
+#include <arm_neon.h>
+#define IG_PIXMAP_NEON
+#endif
+
+namespace IG
+{
+
+#ifdef IG_PIXMAP_X86_SIMD
+static bool cpuHasAVX2()
+{
+	static const bool hasAVX2 = __builtin_cpu_supports("avx2");
+	return hasAVX2;
+}
+#endif
+
+// calls func(src, dest, pixels) once for the whole image when neither side is padded,
+// otherwise once per line
+template<class Src, class Dest, class Func>
+static void transformLines(Pixmap dest, Pixmap src, Func func)
+{
+	assumeExpr(dest.format().bytesPerPixel() == sizeof(Dest));
+	assumeExpr(src.format().bytesPerPixel() == sizeof(Src));
+	auto srcData = src.data();
+	auto destData = dest.data();
+	if(dest.w() == src.w() && !dest.isPadded() && !src.isPadded())
+	{
+		func((const Src*)srcData, (Dest*)destData, src.w() * src.h());
+	}
+	else
+	{
+		iterateTimes(src.h(), h)
+		{
+			func((const Src*)srcData, (Dest*)destData, src.w());
+			srcData += src.pitchBytes();
+			destData += dest.pitchBytes();
+		}
+	}
+}
+
+}
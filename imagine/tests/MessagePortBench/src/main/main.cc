@@ -0,0 +1,168 @@
+/*  This file is part of Imagine.
+
+	Imagine is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	Imagine is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with Imagine.  If not, see <http://www.gnu.org/licenses/> */
+
+#define LOGTAG "main"
+#include <imagine/base/Base.hh>
+#include <imagine/base/EventLoop.hh>
+#include <imagine/base/MessagePort.hh>
+#include <imagine/base/SPSCMessagePort.hh>
+#include <imagine/thread/Thread.hh>
+#include <imagine/time/Time.hh>
+#include <imagine/logger/logger.h>
+#include <cstdio>
+#include <cstdlib>
+#include <algorithm>
+
+// Bounces messages between the main thread and a worker thread, each running its
+// own event loop like EmuSystemTask, and reports the average round trip time.
+// Usage: messageportbench [messages per test]
+
+struct BenchMessage
+{
+	enum class Type: uint8_t
+	{
+		UNSET,
+		PING,
+		EXIT,
+	};
+
+	IG::Semaphore *semPtr{};
+	uint32_t seq{};
+	Type type{Type::UNSET};
+
+	constexpr BenchMessage() {}
+	constexpr BenchMessage(Type type, uint32_t seq = 0):
+		seq{seq}, type{type} {}
+	explicit operator bool() const { return type != Type::UNSET; }
+	void setReplySemaphore(IG::Semaphore *semPtr_) { semPtr = semPtr_; };
+};
+
+template<class MsgType>
+using PipePort = Base::PipeMessagePort<MsgType>;
+
+template<class MsgType>
+using SPSCPort = Base::SPSCMessagePort<MsgType>;
+
+template<template<class> class Port>
+struct PingPong
+{
+	Port<BenchMessage> cmdPort{"Bench Command"};
+	Port<BenchMessage> replyPort{"Bench Reply"};
+	Base::EventLoop loop;
+	uint32_t messages;
+	uint32_t burst;
+	uint32_t sent = 0;
+	uint32_t received = 0;
+	bool running = true;
+
+	PingPong(Base::EventLoop loop, uint32_t messages, uint32_t burst):
+		loop{loop}, messages{messages}, burst{burst} {}
+
+	void sendBurst()
+	{
+		for(uint32_t i = 0; i < burst && sent < messages; i++)
+		{
+			cmdPort.send({BenchMessage::Type::PING, sent++});
+		}
+	}
+
+	// burst == 1 measures wakeup latency since the receiver is always parked,
+	// larger bursts let it find more messages waiting while it's still busy
+	IG::Time run()
+	{
+		IG::makeDetachedThreadSync(
+			[this](auto &sem)
+			{
+				auto threadLoop = Base::EventLoop::makeForThread();
+				bool threadRunning = true;
+				cmdPort.attach(threadLoop,
+					[this, &threadRunning](auto msgs)
+					{
+						for(auto msg : msgs)
+						{
+							if(msg.type == BenchMessage::Type::EXIT)
+							{
+								threadRunning = false;
+								Base::EventLoop::forThread().stop();
+								msg.semPtr->notify();
+								return false;
+							}
+							replyPort.send(msg);
+						}
+						return true;
+					});
+				sem.notify();
+				threadLoop.run(threadRunning);
+				cmdPort.detach();
+			});
+		replyPort.attach(loop,
+			[this](auto msgs)
+			{
+				for(auto msg : msgs)
+				{
+					if(msg.seq != received)
+						logErr("got reply %u, expected %u", msg.seq, received);
+					received++;
+				}
+				if(received == sent)
+				{
+					if(sent == messages)
+					{
+						running = false;
+						loop.stop();
+					}
+					else
+					{
+						sendBurst();
+					}
+				}
+				return true;
+			});
+		auto startTime = IG::steadyClockTimestamp();
+		sendBurst();
+		loop.run(running);
+		auto totalTime = IG::steadyClockTimestamp() - startTime;
+		cmdPort.send({BenchMessage::Type::EXIT}, true);
+		replyPort.detach();
+		return totalTime / messages;
+	}
+};
+
+template<template<class> class Port>
+static void printResult(const char *portName, Base::EventLoop loop, uint32_t messages, uint32_t burst)
+{
+	auto time = PingPong<Port>{loop, messages, burst}.run();
+	printf("%-5s burst:%u  %8.0fns per round trip\n", portName, burst,
+		std::chrono::duration_cast<std::chrono::duration<double, std::nano>>(time).count());
+}
+
+namespace Base
+{
+
+int runHeadless(int argc, char** argv)
+{
+	uint32_t messages = argc > 1 ? std::max(strtoul(argv[1], nullptr, 10), 1ul) : 100000;
+	auto loop = EventLoop::makeForThread();
+	for(auto burst : {1u, 8u})
+	{
+		printResult<PipePort>("pipe", loop, messages, burst);
+		printResult<SPSCPort>("spsc", loop, messages, burst);
+	}
+	return 0;
+}
+
+void onInit(int argc, char** argv) {}
+
+}
@@ -0,0 +1,7 @@
+metadata_name = Pixel Palette Benchmark
+metadata_pkgName = PixelPaletteBench
+metadata_exec = pixelpalettebench
+metadata_id = com.explusalpha.$(metadata_pkgName)
+metadata_vendor = Robert Broglia
+metadata_version = 1.0.0
+metadata_noIcon = 1
@@ -0,0 +1,92 @@
+/*  This file is part of Imagine.
+
+	Imagine is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	Imagine is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with Imagine.  If not, see <http://www.gnu.org/licenses/> */
+
+#define LOGTAG "main"
+#include <imagine/base/Base.hh>
+#include <imagine/pixmap/Pixmap.hh>
+#include <imagine/time/Time.hh>
+#include <imagine/logger/logger.h>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <algorithm>
+#include <vector>
+
+// Times Pixmap::writePaletted() against the per-pixel writeTransformed() lookup it
+// replaces in the indexed framebuffer cores and checks both produce the same output.
+// Usage: pixelpalettebench [iterations per test]
+
+template<class Entry>
+static IG::Time timeWrites(uint32_t iterations, auto &&writeFunc)
+{
+	auto time = IG::Time::max();
+	// best of several runs to filter out scheduling noise
+	iterateTimes(5, run)
+	{
+		time = std::min(time, IG::timeFunc([&]()
+			{
+				iterateTimes(iterations, i)
+				{
+					writeFunc();
+				}
+			}));
+	}
+	return time / iterations;
+}
+
+template<class Entry>
+static void runTest(const char *name, IG::WP size, uint32_t srcPitch, uint32_t iterations)
+{
+	constexpr auto destFormat = sizeof(Entry) == 2 ? IG::PIXEL_FMT_RGB565 : IG::PIXEL_FMT_RGBA8888;
+	Entry palette[256];
+	iterateTimes(256, i)
+	{
+		palette[i] = (Entry)(i * 0x9E3779B9u);
+	}
+	std::vector<uint8_t> srcData(srcPitch * size.y);
+	std::generate(srcData.begin(), srcData.end(), [](){ return (uint8_t)rand(); });
+	std::vector<Entry> destData(size.x * size.y), refData(size.x * size.y);
+	IG::Pixmap src{{size, IG::PIXEL_FMT_I8}, srcData.data(), {srcPitch, IG::Pixmap::BYTE_UNITS}};
+	IG::Pixmap dest{{size, destFormat}, destData.data()};
+	IG::Pixmap ref{{size, destFormat}, refData.data()};
+	auto scalarTime = timeWrites<Entry>(iterations,
+		[&](){ ref.writeTransformed([&](uint8_t p){ return palette[p]; }, src); });
+	auto palettedTime = timeWrites<Entry>(iterations,
+		[&](){ dest.writePaletted(src, palette); });
+	bool matches = destData == refData;
+	auto toUSecs = [](IG::Time t){ return std::chrono::duration_cast<std::chrono::duration<double, std::micro>>(t).count(); };
+	printf("%-18s %dx%d %2zu-bit  transformed:%8.2fus  paletted:%8.2fus  %.2fx%s\n",
+		name, size.x, size.y, sizeof(Entry) * 8, toUSecs(scalarTime), toUSecs(palettedTime),
+		toUSecs(scalarTime) / toUSecs(palettedTime), matches ? "" : "  OUTPUT MISMATCH");
+}
+
+namespace Base
+{
+
+int runHeadless(int argc, char** argv)
+{
+	uint32_t iterations = argc > 1 ? std::max(strtoul(argv[1], nullptr, 10), 1ul) : 200;
+	// frame sizes of the cores using it, plus a padded source to cover the line loop
+	runTest<uint16_t>("NES", {256, 224}, 256, iterations);
+	runTest<uint32_t>("NES", {256, 224}, 256, iterations);
+	runTest<uint16_t>("2600", {160, 210}, 160, iterations);
+	runTest<uint32_t>("2600", {160, 210}, 160, iterations);
+	runTest<uint16_t>("padded odd width", {250, 224}, 256, iterations);
+	return 0;
+}
+
+void onInit(int argc, char** argv) {}
+
+}
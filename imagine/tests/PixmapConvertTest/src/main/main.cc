@@ -0,0 +1,171 @@
+/*  This file is part of Imagine.
+
+	Imagine is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	Imagine is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with Imagine.  If not, see <http://www.gnu.org/licenses/> */
+
+#define LOGTAG "main"
+#include <imagine/base/Base.hh>
+#include <imagine/pixmap/Pixmap.hh>
+#include <imagine/time/Time.hh>
+#include <imagine/logger/logger.h>
+#include <imagine/util/container/array.hh>
+#include <imagine/util/FunctionTraits.hh>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <algorithm>
+#include <vector>
+
+// Checks Pixmap::writeConverted() output is bit-exact with the original per-pixel
+// division based conversions kept below as the reference, and times both.
+// 16-bit sources cover every possible pixel value, the others use random data.
+// Returns non-zero if any conversion mismatches.
+// Usage: pixmapconverttest [iterations per test]
+
+using IG::ByteArray;
+
+static constexpr auto rgb888ToRGBX8888 = [](ByteArray<3> p) -> uint32_t
+	{
+		return p[0] << 16 |
+				p[1] << 8 |
+				p[2];
+	};
+
+static constexpr auto rgb565ToRGBX8888 = [](uint16_t p) -> uint32_t
+	{
+		unsigned b = p       & 0x1F;
+		unsigned g = p >>  5 & 0x3F;
+		unsigned r = p >> 11 & 0x1F;
+		return ((r * 255 + 15) / 31) << 16 |
+				((g * 255 + 31) / 63) << 8 |
+				((b * 255 + 15) / 31);
+	};
+
+static constexpr auto rgbx8888ToRGB888 = [](uint32_t p) -> ByteArray<3>
+	{
+		return {(uint8_t)(p & 0xFF), (uint8_t)(p >> 8 & 0xFF), (uint8_t)(p >> 16 & 0xFF)};
+	};
+
+static constexpr auto rgb565ToRGB888 = [](uint16_t p) -> ByteArray<3>
+	{
+		unsigned b = p       & 0x1F;
+		unsigned g = p >>  5 & 0x3F;
+		unsigned r = p >> 11 & 0x1F;
+		return {uint8_t((r * 255 + 15) / 31), uint8_t((g * 255 + 31) / 63), uint8_t((b * 255 + 15) / 31)};
+	};
+
+static constexpr auto rgb888ToRGB565 = [](ByteArray<3> p) -> uint16_t
+	{
+		unsigned r = p[0];
+		unsigned g = p[1];
+		unsigned b = p[2];
+		return ((r * (31 * 2) + 255) / (255 * 2)) << 11 |
+				((g * 63 + 127) / 255) << 5 |
+				((b * 31 + 127) / 255);
+	};
+
+static constexpr auto rgbx8888ToRGB565 = [](uint32_t p) -> uint16_t
+	{
+		unsigned r = p       & 0xFF;
+		unsigned g = p >>  8 & 0xFF;
+		unsigned b = p >> 16 & 0xFF;
+		return ((r * (31 * 2) + 255) / (255 * 2)) << 11 |
+				((g * 63 + 127) / 255) << 5 |
+				((b * 31 + 127) / 255);
+	};
+
+static IG::Time timeWrites(uint32_t iterations, auto &&writeFunc)
+{
+	auto time = IG::Time::max();
+	// best of several runs to filter out scheduling noise
+	iterateTimes(5, run)
+	{
+		time = std::min(time, IG::timeFunc([&]()
+			{
+				iterateTimes(iterations, i)
+				{
+					writeFunc();
+				}
+			}));
+	}
+	return time / iterations;
+}
+
+template<class RefFunc>
+static bool runTest(IG::PixelFormat srcFormat, IG::PixelFormat destFormat, RefFunc refFunc,
+	IG::WP size, uint32_t srcPitch, uint32_t destPitch, uint32_t iterations)
+{
+	using Src = IG::FunctionTraitsArg<RefFunc, 0>;
+	using Dest = IG::FunctionTraitsR<RefFunc>;
+	std::vector<uint8_t> srcData(srcPitch * size.y * sizeof(Src));
+	if constexpr(sizeof(Src) == 2)
+	{
+		// every 16-bit value, repeating if the image is larger
+		auto src16 = (uint16_t*)srcData.data();
+		iterateTimes(srcPitch * size.y, i)
+		{
+			src16[i] = i;
+		}
+	}
+	else
+	{
+		std::generate(srcData.begin(), srcData.end(), [](){ return (uint8_t)rand(); });
+	}
+	// fill both outputs the same so the padding between lines is also compared
+	std::vector<uint8_t> destData(destPitch * size.y * sizeof(Dest), 0xAA), refData(destData);
+	IG::Pixmap src{{size, srcFormat}, srcData.data(), {srcPitch, IG::Pixmap::PIXEL_UNITS}};
+	IG::Pixmap dest{{size, destFormat}, destData.data(), {destPitch, IG::Pixmap::PIXEL_UNITS}};
+	IG::Pixmap ref{{size, destFormat}, refData.data(), {destPitch, IG::Pixmap::PIXEL_UNITS}};
+	auto refTime = timeWrites(iterations,
+		[&](){ ref.writeTransformedDirect<Src, Dest>(refFunc, src); });
+	auto convertTime = timeWrites(iterations,
+		[&](){ dest.writeConverted(src); });
+	bool matches = destData == refData;
+	auto toUSecs = [](IG::Time t){ return std::chrono::duration_cast<std::chrono::duration<double, std::micro>>(t).count(); };
+	printf("%-4s %8s -> %-8s %3dx%-3d  reference:%8.2fus  converted:%8.2fus  %5.2fx\n",
+		matches ? "PASS" : "FAIL", srcFormat.name(), destFormat.name(), size.x, size.y,
+		toUSecs(refTime), toUSecs(convertTime), toUSecs(refTime) / toUSecs(convertTime));
+	return matches;
+}
+
+template<class RefFunc>
+static bool runTests(IG::PixelFormat srcFormat, IG::PixelFormat destFormat, RefFunc refFunc, uint32_t iterations)
+{
+	// full block conversion covering all 65536 16-bit values, then a padded
+	// odd width to cover the line loop and SIMD remainder handling
+	bool pass = runTest(srcFormat, destFormat, refFunc, {256, 256}, 256, 256, iterations);
+	pass &= runTest(srcFormat, destFormat, refFunc, {251, 37}, 256, 259, iterations);
+	return pass;
+}
+
+namespace Base
+{
+
+int runHeadless(int argc, char** argv)
+{
+	uint32_t iterations = argc > 1 ? std::max(strtoul(argv[1], nullptr, 10), 1ul) : 100;
+	bool pass = runTests(IG::PIXEL_FMT_RGB888, IG::PIXEL_FMT_RGBX8888, rgb888ToRGBX8888, iterations);
+	pass &= runTests(IG::PIXEL_FMT_RGB565, IG::PIXEL_FMT_RGBX8888, rgb565ToRGBX8888, iterations);
+	pass &= runTests(IG::PIXEL_FMT_RGBX8888, IG::PIXEL_FMT_RGB888, rgbx8888ToRGB888, iterations);
+	pass &= runTests(IG::PIXEL_FMT_RGBA8888, IG::PIXEL_FMT_RGB888, rgbx8888ToRGB888, iterations);
+	pass &= runTests(IG::PIXEL_FMT_RGB565, IG::PIXEL_FMT_RGB888, rgb565ToRGB888, iterations);
+	pass &= runTests(IG::PIXEL_FMT_RGB888, IG::PIXEL_FMT_RGB565, rgb888ToRGB565, iterations);
+	pass &= runTests(IG::PIXEL_FMT_RGBX8888, IG::PIXEL_FMT_RGB565, rgbx8888ToRGB565, iterations);
+	pass &= runTests(IG::PIXEL_FMT_RGBA8888, IG::PIXEL_FMT_RGB565, rgbx8888ToRGB565, iterations);
+	printf("%s\n", pass ? "all conversions match" : "CONVERSION MISMATCH");
+	return pass ? 0 : 1;
+}
+
+void onInit(int argc, char** argv) {}
+
+}
@@ -0,0 +1,122 @@
+/*  This file is part of Imagine.
+
+	Imagine is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	Imagine is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with Imagine.  If not, see <http://www.gnu.org/licenses/> */
+
+#define LOGTAG "main"
+#include <imagine/base/Base.hh>
+#include <imagine/audio/Resampler.hh>
+#include <imagine/logger/logger.h>
+#include <cstdio>
+#include <cstdlib>
+#include <cmath>
+#include <algorithm>
+#include <vector>
+
+// Feeds a sine through Resampler in emulator frame sized blocks while switching
+// between a 1:1 ratio and rate control/fast-forward ratios, and checks every
+// output frame against the sine evaluated at the source position it represents
+// minus Resampler::DELAY_FRAMES. A skip or repeat at a ratio switch, or latency
+// changing with the tap count, shows up as a large error at the block boundary.
+// Returns non-zero if any frame is off by more than the tolerance.
+
+static constexpr uint32_t rate = 48000;
+static constexpr uint32_t blockFrames = 800;
+static constexpr double toneHz = 1000;
+
+// output frames per block, blockFrames passes samples through unconverted
+static constexpr uint32_t destFramesSequence[]
+{
+	blockFrames, blockFrames, 792, blockFrames, 808, 808, blockFrames,
+	400, blockFrames, 267, 200, blockFrames, 533, blockFrames, blockFrames,
+};
+
+template<class T>
+static T makeSample(double x);
+template<> float makeSample(double x) { return x; }
+template<> int16_t makeSample(double x) { return std::lround(x * 32767.); }
+
+template<class T>
+static double sampleValue(T s);
+template<> double sampleValue(float s) { return s; }
+template<> double sampleValue(int16_t s) { return s / 32768.; }
+
+template<class T>
+static bool runTest(IG::Audio::ResamplerQuality quality, IG::Audio::SampleFormat sampleFmt, double tolerance)
+{
+	using namespace IG::Audio;
+	constexpr uint8_t channels = 2;
+	Resampler resampler;
+	resampler.setFormat({rate, sampleFmt, channels});
+	resampler.setQuality(quality);
+	const double w = 2. * M_PI * toneHz / rate;
+	auto sine = [&](double pos){ return pos < 0 ? 0. : .5 * std::sin(w * pos); };
+	std::vector<T> src(blockFrames * channels);
+	std::vector<T> dest(*std::max_element(std::begin(destFramesSequence), std::end(destFramesSequence)) * channels);
+	double maxError = 0;
+	uint32_t worstBlock = 0, worstFrame = 0;
+	uint64_t srcPos = 0;
+	uint32_t block = 0;
+	for(auto destFrames : destFramesSequence)
+	{
+		for(uint32_t i = 0; i < blockFrames; i++)
+		{
+			// right channel is phase inverted to catch channel mixups
+			src[i * channels] = makeSample<T>(sine(srcPos + i));
+			src[i * channels + 1] = makeSample<T>(-sine(srcPos + i));
+		}
+		resampler.resample(dest.data(), destFrames, src.data(), blockFrames);
+		for(uint32_t i = 0; i < destFrames; i++)
+		{
+			double pos = srcPos + (double)i * blockFrames / destFrames - (double)Resampler::DELAY_FRAMES;
+			// skip frames whose window still reaches the silence before the stream
+			if(pos < Resampler::MAX_TAPS)
+				continue;
+			double expected = sine(pos);
+			double error = std::max(std::abs(sampleValue(dest[i * channels]) - expected),
+				std::abs(sampleValue(dest[i * channels + 1]) + expected));
+			if(error > maxError)
+			{
+				maxError = error;
+				worstBlock = block;
+				worstFrame = i;
+			}
+		}
+		srcPos += blockFrames;
+		block++;
+	}
+	bool pass = maxError <= tolerance;
+	printf("quality:%u %-3s max error:%.6f (block %u frame %u) %s\n",
+		(unsigned)quality, sampleFmt.isFloat() ? "f32" : "i16", maxError, worstBlock, worstFrame, pass ? "ok" : "FAIL");
+	return pass;
+}
+
+namespace Base
+{
+
+int runHeadless(int argc, char** argv)
+{
+	using namespace IG::Audio;
+	bool pass = true;
+	for(auto quality : {ResamplerQuality::LOW, ResamplerQuality::MEDIUM, ResamplerQuality::HIGH})
+	{
+		pass &= runTest<float>(quality, SampleFormats::f32, 5e-3);
+		pass &= runTest<int16_t>(quality, SampleFormats::i16, 5e-3);
+	}
+	printf("%s\n", pass ? "output continuous across ratio changes" : "DISCONTINUITY");
+	return pass ? 0 : 1;
+}
+
+void onInit(int argc, char** argv) {}
+
+}